@@ -0,0 +1,134 @@
+# Measures how long the compiler takes on a large generated program, or with `--examples` how long running an example
+# through `quart run` takes compared to building it natively and running the executable
+
+from __future__ import annotations
+
+from typing import List
+
+import argparse
+import pathlib
+import statistics
+import subprocess
+import tempfile
+import time
+
+cwd = pathlib.Path(__file__).parent
+EXECUTABLE = cwd / 'bin' / 'quart'
+
+def generate_function(module: int, index: int, statements: int) -> str:
+    lines: List[str] = [f'    pub func f{index}(a: i32, b: i32) -> i32 {{']
+    lines.append('        let x0 = a + b;')
+
+    for i in range(1, statements):
+        lines.append(f'        let x{i} = x{i - 1} + {i % 7 + 1} - b;')
+
+    last = f'x{statements - 1}'
+    if index > 0:
+        lines.append(f'        if {last} > {index * 10} {{')
+        lines.append(f'            return f{index - 1}({last}, b) + m{module}_helper(a);')
+        lines.append('        }')
+
+    lines.append(f'        return {last};')
+    lines.append('    }')
+
+    return '\n'.join(lines)
+
+def generate_program(modules: int, functions: int, statements: int, depth: int) -> str:
+    parts: List[str] = []
+    for module in range(modules):
+        parts.append(f'func m{module}_helper(x: i32) -> i32 {{\n    return x + x;\n}}\n')
+
+        # The functions live `depth` modules deep so every reference to the helper has to walk out to the global scope
+        body = '\n\n'.join(generate_function(module, i, statements) for i in range(functions))
+        for level in reversed(range(1, depth)):
+            body = f'module d{level} {{\n{body}\n}}'
+
+        parts.append(f'module m{module} {{\n{body}\n}}\n')
+
+    path = '::'.join(f'd{level}' for level in range(1, depth))
+    prefix = f'{path}::' if path else ''
+
+    calls = ' + '.join(f'm{module}::{prefix}f{functions - 1}(1, 2)' for module in range(modules))
+    parts.append(f'func main() -> i32 {{\n    return {calls};\n}}\n')
+
+    return '\n'.join(parts)
+
+def time_command(command: List[str], directory: str) -> float:
+    start = time.perf_counter()
+    process = subprocess.run(command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, cwd=directory)
+    elapsed = time.perf_counter() - start
+
+    if process.returncode != 0:
+        print(process.stderr.decode())
+        print(f'{" ".join(command)!r} failed with return code {process.returncode}.')
+
+        exit(1)
+
+    return elapsed
+
+def compare_examples(executable: pathlib.Path, names: List[str], runs: int) -> None:
+    print(f'{"example":<12} {"quart run":>12} {"build + run":>12}')
+
+    with tempfile.TemporaryDirectory() as directory:
+        for name in names:
+            file = cwd / 'examples' / f'{name}.qr'
+            output = pathlib.Path(directory) / name
+
+            interpreted: List[float] = []
+            native: List[float] = []
+
+            for _ in range(runs):
+                interpreted.append(time_command([str(executable), 'run', str(file)], directory))
+                native.append(
+                    time_command([str(executable), '-o', str(output), str(file)], directory) + time_command([str(output)], directory)
+                )
+
+            print(f'{name:<12} {min(interpreted) * 1000:>9.1f} ms {min(native) * 1000:>9.1f} ms')
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description='Benchmark compile throughput on a generated program.')
+
+    parser.add_argument('--executable', type=pathlib.Path, default=EXECUTABLE)
+    parser.add_argument('--modules', type=int, default=40)
+    parser.add_argument('--functions', type=int, default=100)
+    parser.add_argument('--statements', type=int, default=10)
+    parser.add_argument('--depth', type=int, default=1, help='How many modules deep the generated functions are nested')
+    parser.add_argument('--runs', type=int, default=5)
+    parser.add_argument('--examples', nargs='+', metavar='NAME', help='Compare `quart run` against a native build on these examples')
+    parser.add_argument('args', nargs='*', help='Extra arguments passed to the compiler')
+
+    args = parser.parse_args()
+    if not args.executable.exists():
+        print(f'Quart executable not found at {str(args.executable)!r}. Please build it or pass --executable.')
+        exit(1)
+
+    if args.examples:
+        compare_examples(args.executable, args.examples, args.runs)
+        return
+
+    with tempfile.TemporaryDirectory() as directory:
+        file = pathlib.Path(directory) / 'benchmark.qr'
+        file.write_text(generate_program(args.modules, args.functions, args.statements, args.depth))
+
+        size = file.stat().st_size
+        print(f'Generated {args.modules * args.functions} functions ({size / 1024:.0f} KiB)')
+
+        command = [str(args.executable), '--no-cache', *args.args, str(file)]
+        timings: List[float] = []
+
+        for _ in range(args.runs):
+            start = time.perf_counter()
+            process = subprocess.run(command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, cwd=directory)
+            timings.append(time.perf_counter() - start)
+
+            if process.returncode != 0:
+                print(process.stderr.decode())
+                print(f'Compilation failed with return code {process.returncode}.')
+
+                exit(1)
+
+    best, mean = min(timings), statistics.mean(timings)
+    print(f'min {best * 1000:.1f} ms, mean {mean * 1000:.1f} ms over {args.runs} runs ({size / 1024 / best:.0f} KiB/s)')
+
+if __name__ == '__main__':
+    main()
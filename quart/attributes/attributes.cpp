@@ -17,6 +17,8 @@ namespace quart {
 
 SIMPLE_ATTRIBUTE(noreturn, Attribute::Noreturn)
 SIMPLE_ATTRIBUTE(packed, Attribute::Packed)
+SIMPLE_ATTRIBUTE(inline, Attribute::Inline)
+SIMPLE_ATTRIBUTE(noinline, Attribute::Noinline)
 
 ATTRIBUTE(link) {
     static const Set<String> ALLOWED_LINK_PARAMETERS = { "name", "arch", "section", "platform" };
@@ -30,7 +32,9 @@ void Attributes::init(Parser& parser) {
     parser.set_attributes({
         ENTRY(noreturn),
         ENTRY(packed),
-        ENTRY(link)
+        ENTRY(link),
+        ENTRY(inline),
+        ENTRY(noinline)
     });
 }
 
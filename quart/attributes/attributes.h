@@ -40,7 +40,9 @@ public:
         None = 0,
         Noreturn,
         Packed,
-        Link
+        Link,
+        Inline,
+        Noinline
     };
 
     Attribute() = default;
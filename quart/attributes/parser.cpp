@@ -11,7 +11,7 @@ ErrorOr<HashMap<String, String>> AttributeParser::parse_call_like_attribute(
 
     while (true) {
         Token token = TRY(parser.expect(TokenKind::Identifier));
-        String key = token.value();
+        String key(token.value());
 
         Span span = token.span();
         if (!allowed_parameters.contains(key)) {
@@ -22,7 +22,7 @@ ErrorOr<HashMap<String, String>> AttributeParser::parse_call_like_attribute(
 
         TRY(parser.expect(TokenKind::Assign));
 
-        String value = TRY(parser.expect(TokenKind::String)).value();
+        String value(TRY(parser.expect(TokenKind::String)).value());
         args[key] = value;
 
         auto option = parser.try_expect(TokenKind::Comma);
@@ -0,0 +1,176 @@
+#include <quart/bytecode/analysis/call_graph.h>
+#include <quart/bytecode/basic_block.h>
+#include <quart/language/functions.h>
+
+namespace quart::bytecode {
+
+CallGraph::CallGraph(HashMap<Identifier, RefPtr<Function>> const& functions) {
+    for (auto& [_, function] : functions) {
+        if (!function->is_decl() && function->entry_block()) {
+            m_functions.push_back(function.get());
+        }
+    }
+
+    std::sort(m_functions.begin(), m_functions.end(), [](Function* lhs, Function* rhs) {
+        return lhs->qualified_name().str() < rhs->qualified_name().str();
+    });
+
+    for (auto [index, function] : llvm::enumerate(m_functions)) {
+        m_indices[function] = index;
+    }
+
+    size_t count = m_functions.size();
+
+    m_callees.resize(count);
+    m_callers.resize(count);
+
+    for (auto [index, function] : llvm::enumerate(m_functions)) {
+        HashMap<Register, Function*> definitions;
+        for (auto* block : function->basic_blocks()) {
+            for (auto& inst : block->instructions()) {
+                if (auto* get_function = inst->as<GetFunction>()) {
+                    definitions[get_function->dst()] = get_function->function();
+                }
+            }
+        }
+
+        auto& callees = m_callees[index];
+        for (auto* block : function->basic_blocks()) {
+            for (auto& inst : block->instructions()) {
+                auto* call = inst->as<Call>();
+                if (!call) {
+                    continue;
+                }
+
+                auto callee = this->index_of(callee_of(call, definitions));
+                if (callee.has_value()) {
+                    callees.push_back(*callee);
+                }
+            }
+        }
+
+        std::sort(callees.begin(), callees.end());
+        callees.erase(std::unique(callees.begin(), callees.end()), callees.end());
+
+        for (u32 callee : callees) {
+            m_callers[callee].push_back(index);
+        }
+    }
+
+    this->find_components();
+}
+
+Function* CallGraph::callee_of(Call const* call, HashMap<Register, Function*> const& definitions) {
+    auto iterator = definitions.find(call->function());
+    if (iterator == definitions.end()) {
+        return nullptr;
+    }
+
+    return iterator->second;
+}
+
+Optional<u32> CallGraph::index_of(Function* function) const {
+    auto iterator = m_indices.find(function);
+    if (iterator == m_indices.end()) {
+        return {};
+    }
+
+    return iterator->second;
+}
+
+bool CallGraph::is_recursive(u32 index) const {
+    if (m_components[m_component_of[index]].size() > 1) {
+        return true;
+    }
+
+    auto& callees = m_callees[index];
+    return std::binary_search(callees.begin(), callees.end(), index);
+}
+
+void CallGraph::find_components() {
+    static constexpr u32 UNVISITED = -1;
+
+    size_t count = m_functions.size();
+
+    // Tarjan's algorithm, which finishes a component only after every component reachable from it
+    Vector<u32> order(count, UNVISITED);
+    Vector<u32> lowlink(count, 0);
+    Vector<bool> on_stack(count, false);
+
+    Vector<u32> stack;
+    u32 next = 0;
+
+    m_component_of.assign(count, 0);
+
+    // Each frame is a function along with the position of the next callee to visit
+    Vector<std::pair<u32, u32>> frames;
+    for (u32 root = 0; root < count; root++) {
+        if (order[root] != UNVISITED) {
+            continue;
+        }
+
+        frames.push_back({ root, 0 });
+        while (!frames.empty()) {
+            auto& [index, position] = frames.back();
+            if (position == 0) {
+                order[index] = lowlink[index] = next++;
+
+                stack.push_back(index);
+                on_stack[index] = true;
+            }
+
+            auto& callees = m_callees[index];
+            if (position < callees.size()) {
+                u32 callee = callees[position++];
+                if (order[callee] == UNVISITED) {
+                    frames.push_back({ callee, 0 });
+                } else if (on_stack[callee]) {
+                    lowlink[index] = std::min(lowlink[index], order[callee]);
+                }
+
+                continue;
+            }
+
+            u32 finished = index;
+            frames.pop_back();
+
+            if (!frames.empty()) {
+                u32 parent = frames.back().first;
+                lowlink[parent] = std::min(lowlink[parent], lowlink[finished]);
+            }
+
+            if (lowlink[finished] != order[finished]) {
+                continue;
+            }
+
+            Vector<u32> component;
+            u32 member = 0;
+
+            do {
+                member = stack.back();
+                stack.pop_back();
+
+                on_stack[member] = false;
+                m_component_of[member] = m_components.size();
+
+                component.push_back(member);
+            } while (member != finished);
+
+            std::sort(component.begin(), component.end());
+            m_components.push_back(move(component));
+        }
+    }
+}
+
+void CallGraph::dump() const {
+    for (auto [index, function] : llvm::enumerate(m_functions)) {
+        out("{}:", function->qualified_name());
+        for (u32 callee : m_callees[index]) {
+            out(" {}", m_functions[callee]->qualified_name());
+        }
+
+        outln();
+    }
+}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <quart/common.h>
+#include <quart/identifier.h>
+#include <quart/bytecode/register.h>
+
+namespace quart {
+    class Function;
+}
+
+namespace quart::bytecode {
+
+class Call;
+
+// Direct calls between the functions of a program that have a body. A call is direct when the register it calls comes
+// straight from a `GetFunction`, calls through any other value are unknown and don't add an edge. Functions are
+// numbered by their qualified name so that walking the graph doesn't depend on hash map order.
+class CallGraph {
+public:
+    explicit CallGraph(HashMap<Identifier, RefPtr<Function>> const& functions);
+
+    // The function called by `call` if it's a direct call, `definitions` maps every register of the caller to the
+    // `GetFunction` that defines it
+    static Function* callee_of(Call const* call, HashMap<Register, Function*> const& definitions);
+
+    size_t size() const { return m_functions.size(); }
+
+    Function* function(u32 index) const { return m_functions[index]; }
+    Optional<u32> index_of(Function*) const;
+
+    // Deduplicated and sorted
+    Vector<u32> const& callees(u32 index) const { return m_callees[index]; }
+    Vector<u32> const& callers(u32 index) const { return m_callers[index]; }
+
+    // Strongly connected components in bottom-up order, every component comes after the ones it calls into
+    Vector<Vector<u32>> const& components() const { return m_components; }
+    u32 component_of(u32 index) const { return m_component_of[index]; }
+
+    // Whether the function can end up calling itself, either directly or through other functions of its component
+    bool is_recursive(u32 index) const;
+
+    void dump() const;
+
+private:
+    void find_components();
+
+    Vector<Function*> m_functions;
+    HashMap<Function*, u32> m_indices;
+
+    Vector<Vector<u32>> m_callees;
+    Vector<Vector<u32>> m_callers;
+
+    Vector<Vector<u32>> m_components;
+    Vector<u32> m_component_of;
+};
+
+}
@@ -0,0 +1,100 @@
+#include <quart/bytecode/analysis/cfg.h>
+#include <quart/bytecode/instruction.h>
+#include <quart/language/functions.h>
+
+namespace quart::bytecode {
+
+Vector<BasicBlock*> ControlFlowGraph::successors_of(BasicBlock* block) {
+    auto* terminator = block->terminator();
+    if (!terminator) {
+        return {};
+    }
+
+    if (auto* jump = terminator->as<Jump>()) {
+        return { jump->target() };
+    } else if (auto* jump_if = terminator->as<JumpIf>()) {
+        return { jump_if->true_target(), jump_if->false_target() };
+    }
+
+    return {};
+}
+
+ControlFlowGraph::ControlFlowGraph(Function* function) : m_function(function) {
+    auto* entry = function->entry_block();
+    if (!entry) {
+        return;
+    }
+
+    Vector<BasicBlock*> post_order;
+    Set<BasicBlock*> visited;
+
+    Vector<std::pair<BasicBlock*, Vector<BasicBlock*>>> stack;
+    stack.emplace_back(entry, successors_of(entry));
+
+    visited.insert(entry);
+    while (!stack.empty()) {
+        auto& [block, successors] = stack.back();
+        if (successors.empty()) {
+            post_order.push_back(block);
+            stack.pop_back();
+
+            continue;
+        }
+
+        BasicBlock* successor = successors.back();
+        successors.pop_back();
+
+        if (visited.insert(successor).second) {
+            stack.emplace_back(successor, successors_of(successor));
+        }
+    }
+
+    m_blocks.assign(post_order.rbegin(), post_order.rend());
+    for (auto [index, block] : llvm::enumerate(m_blocks)) {
+        m_indices[block] = index;
+    }
+
+    m_successors.resize(m_blocks.size());
+    m_predecessors.resize(m_blocks.size());
+
+    for (auto [index, block] : llvm::enumerate(m_blocks)) {
+        for (auto* successor : successors_of(block)) {
+            u32 target = m_indices[successor];
+
+            // Both targets of a `JumpIf` may be the same block, which is still a single edge
+            auto& successors = m_successors[index];
+            if (std::find(successors.begin(), successors.end(), target) != successors.end()) {
+                continue;
+            }
+
+            successors.push_back(target);
+            m_predecessors[target].push_back(index);
+        }
+
+        if (m_successors[index].empty()) {
+            m_exits.push_back(index);
+        }
+    }
+}
+
+Optional<u32> ControlFlowGraph::index_of(BasicBlock* block) const {
+    auto iterator = m_indices.find(block);
+    if (iterator == m_indices.end()) {
+        return {};
+    }
+
+    return iterator->second;
+}
+
+void ControlFlowGraph::dump() const {
+    for (auto [index, block] : llvm::enumerate(m_blocks)) {
+        out("{}:", block->name());
+        for (u32 successor : m_successors[index]) {
+            out(" {}", m_blocks[successor]->name());
+        }
+
+        outln();
+    }
+}
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <quart/common.h>
+
+namespace quart {
+    class Function;
+}
+
+namespace quart::bytecode {
+
+class BasicBlock;
+
+// The control flow graph of a function, derived from the `Jump`/`JumpIf` terminating each block. Only blocks reachable
+// from the entry are part of it, each one identified by its position in reverse post-order so that analyses built on
+// top of it can use plain vectors instead of maps.
+class ControlFlowGraph {
+public:
+    explicit ControlFlowGraph(Function*);
+
+    static Vector<BasicBlock*> successors_of(BasicBlock*);
+
+    Function* function() const { return m_function; }
+
+    size_t size() const { return m_blocks.size(); }
+
+    BasicBlock* entry() const { return m_blocks.front(); }
+    BasicBlock* block(u32 index) const { return m_blocks[index]; }
+
+    Vector<BasicBlock*> const& reverse_post_order() const { return m_blocks; }
+
+    Optional<u32> index_of(BasicBlock*) const;
+    bool is_reachable(BasicBlock* block) const { return m_indices.contains(block); }
+
+    Vector<u32> const& successors(u32 index) const { return m_successors[index]; }
+    Vector<u32> const& predecessors(u32 index) const { return m_predecessors[index]; }
+
+    // Blocks without any successors, usually the ones ending in a `Return`
+    Vector<u32> const& exits() const { return m_exits; }
+
+    void dump() const;
+
+private:
+    Function* m_function;
+
+    Vector<BasicBlock*> m_blocks;
+    HashMap<BasicBlock*, u32> m_indices;
+
+    Vector<Vector<u32>> m_successors;
+    Vector<Vector<u32>> m_predecessors;
+
+    Vector<u32> m_exits;
+};
+
+}
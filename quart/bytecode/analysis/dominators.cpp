@@ -0,0 +1,186 @@
+#include <quart/bytecode/analysis/dominators.h>
+#include <quart/bytecode/analysis/cfg.h>
+
+#include <llvm/ADT/STLExtras.h>
+
+namespace quart::bytecode {
+
+DominatorTree::DominatorTree(ControlFlowGraph const& cfg, Direction direction) : m_direction(direction), m_size(cfg.size()) {
+    // Every node gets an extra root so that the post-dominator tree can join multiple exits. Going forward it only ever
+    // has the entry block as a successor.
+    size_t count = m_size + 1;
+    m_root = m_size;
+
+    Vector<Vector<u32>> successors(count);
+    Vector<Vector<u32>> predecessors(count);
+
+    if (direction == Direction::Forward) {
+        for (u32 index = 0; index < m_size; index++) {
+            successors[index] = cfg.successors(index);
+            predecessors[index] = cfg.predecessors(index);
+        }
+
+        if (m_size) {
+            successors[m_root].push_back(0);
+            predecessors[0].push_back(m_root);
+        }
+    } else {
+        for (u32 index = 0; index < m_size; index++) {
+            successors[index] = cfg.predecessors(index);
+            predecessors[index] = cfg.successors(index);
+        }
+
+        for (u32 exit : cfg.exits()) {
+            successors[m_root].push_back(exit);
+            predecessors[exit].push_back(m_root);
+        }
+    }
+
+    this->compute(successors, predecessors);
+}
+
+void DominatorTree::compute(Vector<Vector<u32>> const& successors, Vector<Vector<u32>> const& predecessors) {
+    size_t count = successors.size();
+
+    Vector<u32> order;
+    Vector<u32> numbers(count, UNDEFINED);
+
+    {
+        Vector<bool> visited(count, false);
+        Vector<std::pair<u32, size_t>> stack = { { m_root, 0 } };
+
+        visited[m_root] = true;
+        while (!stack.empty()) {
+            auto& [node, next] = stack.back();
+            if (next == successors[node].size()) {
+                order.push_back(node);
+                stack.pop_back();
+
+                continue;
+            }
+
+            u32 successor = successors[node][next++];
+            if (!visited[successor]) {
+                visited[successor] = true;
+                stack.emplace_back(successor, 0);
+            }
+        }
+
+        std::reverse(order.begin(), order.end());
+        for (auto [index, node] : llvm::enumerate(order)) {
+            numbers[node] = index;
+        }
+    }
+
+    // "A Simple, Fast Dominance Algorithm" by Cooper, Harvey and Kennedy, iterating in reverse post-order
+    m_idoms.assign(count, UNDEFINED);
+    m_idoms[m_root] = m_root;
+
+    auto intersect = [&](u32 a, u32 b) {
+        while (a != b) {
+            while (numbers[a] > numbers[b]) {
+                a = m_idoms[a];
+            }
+
+            while (numbers[b] > numbers[a]) {
+                b = m_idoms[b];
+            }
+        }
+
+        return a;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (u32 node : llvm::drop_begin(order)) {
+            u32 idom = UNDEFINED;
+            for (u32 predecessor : predecessors[node]) {
+                if (m_idoms[predecessor] == UNDEFINED) {
+                    continue;
+                }
+
+                idom = idom == UNDEFINED ? predecessor : intersect(predecessor, idom);
+            }
+
+            if (m_idoms[node] != idom) {
+                m_idoms[node] = idom;
+                changed = true;
+            }
+        }
+    }
+
+    m_children.resize(count);
+    for (u32 node : llvm::drop_begin(order)) {
+        m_children[m_idoms[node]].push_back(node);
+    }
+
+    m_frontiers.resize(count);
+    for (u32 node : order) {
+        if (predecessors[node].size() < 2) {
+            continue;
+        }
+
+        for (u32 predecessor : predecessors[node]) {
+            u32 runner = predecessor;
+            while (runner != m_idoms[node] && m_idoms[runner] != UNDEFINED) {
+                auto& frontier = m_frontiers[runner];
+                if (std::find(frontier.begin(), frontier.end(), node) == frontier.end()) {
+                    frontier.push_back(node);
+                }
+
+                if (runner == m_root) {
+                    break;
+                }
+
+                runner = m_idoms[runner];
+            }
+        }
+    }
+
+    // The virtual root is never handed out, neither as a frontier nor as an immediate dominator
+    for (auto& frontier : m_frontiers) {
+        std::erase(frontier, m_root);
+    }
+
+    m_preorder.assign(count, UNDEFINED);
+    m_postorder.assign(count, UNDEFINED);
+
+    u32 counter = 0;
+    Vector<std::pair<u32, size_t>> stack = { { m_root, 0 } };
+
+    m_preorder[m_root] = counter++;
+    while (!stack.empty()) {
+        auto& [node, next] = stack.back();
+        if (next == m_children[node].size()) {
+            m_postorder[node] = counter++;
+            stack.pop_back();
+
+            continue;
+        }
+
+        u32 child = m_children[node][next++];
+
+        m_preorder[child] = counter++;
+        stack.emplace_back(child, 0);
+    }
+}
+
+Optional<u32> DominatorTree::idom(u32 index) const {
+    u32 idom = m_idoms[index];
+    if (idom == UNDEFINED || idom == m_root) {
+        return {};
+    }
+
+    return idom;
+}
+
+bool DominatorTree::dominates(u32 a, u32 b) const {
+    if (!this->contains(a) || !this->contains(b)) {
+        return false;
+    }
+
+    return m_preorder[a] <= m_preorder[b] && m_postorder[b] <= m_postorder[a];
+}
+
+}
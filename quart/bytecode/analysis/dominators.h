@@ -0,0 +1,61 @@
+#pragma once
+
+#include <quart/common.h>
+
+#include <limits>
+
+namespace quart::bytecode {
+
+class ControlFlowGraph;
+
+// Dominator tree over a `ControlFlowGraph`, or its post-dominator tree when built backwards. Blocks are referred to by
+// their index in the graph.
+//
+// A function may have several exits, so the post-dominator tree hangs all of them off a virtual exit node that is never
+// exposed. Blocks that can't reach any exit (e.g. infinite loops) don't have a place in it at all.
+class DominatorTree {
+public:
+    enum class Direction {
+        Forward,
+        Backward
+    };
+
+    DominatorTree(ControlFlowGraph const&, Direction);
+
+    bool is_post_dominator_tree() const { return m_direction == Direction::Backward; }
+
+    // The immediate (post-)dominator of a block, empty for the roots of the tree and blocks that are not part of it
+    Optional<u32> idom(u32 index) const;
+
+    // Blocks without an immediate (post-)dominator, only ever the entry for a dominator tree
+    Vector<u32> const& roots() const { return m_children[m_root]; }
+    Vector<u32> const& children(u32 index) const { return m_children[index]; }
+
+    Vector<u32> const& frontier(u32 index) const { return m_frontiers[index]; }
+
+    bool contains(u32 index) const { return m_preorder[index] != UNDEFINED; }
+
+    // Whether `a` (post-)dominates `b`, every block dominates itself
+    bool dominates(u32 a, u32 b) const;
+    bool strictly_dominates(u32 a, u32 b) const { return a != b && this->dominates(a, b); }
+
+private:
+    static constexpr u32 UNDEFINED = std::numeric_limits<u32>::max();
+
+    void compute(Vector<Vector<u32>> const& successors, Vector<Vector<u32>> const& predecessors);
+
+    Direction m_direction;
+
+    size_t m_size;
+    u32 m_root;
+
+    Vector<u32> m_idoms;
+    Vector<Vector<u32>> m_children;
+    Vector<Vector<u32>> m_frontiers;
+
+    // Numbering of a depth-first walk over the tree, which makes dominance queries constant time
+    Vector<u32> m_preorder;
+    Vector<u32> m_postorder;
+};
+
+}
@@ -0,0 +1,37 @@
+#include <quart/bytecode/analysis/function_analysis.h>
+
+namespace quart::bytecode {
+
+ControlFlowGraph const& FunctionAnalysis::cfg() {
+    if (!m_cfg) {
+        m_cfg = make<ControlFlowGraph>(m_function);
+    }
+
+    return *m_cfg;
+}
+
+DominatorTree const& FunctionAnalysis::dominators() {
+    if (!m_dominators) {
+        m_dominators = make<DominatorTree>(this->cfg(), DominatorTree::Direction::Forward);
+    }
+
+    return *m_dominators;
+}
+
+DominatorTree const& FunctionAnalysis::post_dominators() {
+    if (!m_post_dominators) {
+        m_post_dominators = make<DominatorTree>(this->cfg(), DominatorTree::Direction::Backward);
+    }
+
+    return *m_post_dominators;
+}
+
+LoopInfo const& FunctionAnalysis::loops() {
+    if (!m_loops) {
+        m_loops = make<LoopInfo>(this->cfg(), this->dominators());
+    }
+
+    return *m_loops;
+}
+
+}
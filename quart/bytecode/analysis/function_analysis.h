@@ -0,0 +1,35 @@
+#pragma once
+
+#include <quart/common.h>
+#include <quart/bytecode/analysis/cfg.h>
+#include <quart/bytecode/analysis/dominators.h>
+#include <quart/bytecode/analysis/loops.h>
+
+namespace quart::bytecode {
+
+// Lazily computed analyses of a single function, cached on the function itself. Anything that changes the shape of
+// the control flow graph has to go through `Function::invalidate_analysis()` afterwards, which the `PassManager` does
+// after every pass that doesn't promise to preserve it.
+class FunctionAnalysis {
+public:
+    explicit FunctionAnalysis(Function* function) : m_function(function) {}
+
+    ControlFlowGraph const& cfg();
+
+    DominatorTree const& dominators();
+    DominatorTree const& post_dominators();
+
+    LoopInfo const& loops();
+
+private:
+    Function* m_function;
+
+    OwnPtr<ControlFlowGraph> m_cfg;
+
+    OwnPtr<DominatorTree> m_dominators;
+    OwnPtr<DominatorTree> m_post_dominators;
+
+    OwnPtr<LoopInfo> m_loops;
+};
+
+}
@@ -0,0 +1,83 @@
+#include <quart/bytecode/analysis/loops.h>
+#include <quart/bytecode/analysis/cfg.h>
+#include <quart/bytecode/analysis/dominators.h>
+
+namespace quart::bytecode {
+
+LoopInfo::LoopInfo(ControlFlowGraph const& cfg, DominatorTree const& dominators) {
+    size_t count = cfg.size();
+    m_innermost.assign(count, nullptr);
+
+    HashMap<u32, NaturalLoop*> headers;
+    for (u32 index = 0; index < count; index++) {
+        for (u32 successor : cfg.successors(index)) {
+            if (!dominators.dominates(successor, index)) {
+                continue;
+            }
+
+            auto& loop = headers[successor];
+            if (!loop) {
+                m_loops.push_back(make<NaturalLoop>(NaturalLoop { successor, {}, {}, nullptr, 1 }));
+                loop = m_loops.back().get();
+            }
+
+            loop->latches.push_back(index);
+        }
+    }
+
+    for (auto& loop : m_loops) {
+        // Everything that reaches a latch without going through the header belongs to the loop
+        Vector<bool> visited(count, false);
+        Vector<u32> worklist = loop->latches;
+
+        visited[loop->header] = true;
+        loop->blocks.push_back(loop->header);
+
+        while (!worklist.empty()) {
+            u32 index = worklist.back();
+            worklist.pop_back();
+
+            if (visited[index]) {
+                continue;
+            }
+
+            visited[index] = true;
+            loop->blocks.push_back(index);
+
+            for (u32 predecessor : cfg.predecessors(index)) {
+                if (!visited[predecessor]) {
+                    worklist.push_back(predecessor);
+                }
+            }
+        }
+
+        std::sort(loop->blocks.begin(), loop->blocks.end());
+    }
+
+    // A loop can only be nested in a bigger one, so going from the biggest to the smallest means the innermost loop
+    // seen so far for a header is always its parent
+    std::sort(m_loops.begin(), m_loops.end(), [](auto const& a, auto const& b) {
+        return a->blocks.size() != b->blocks.size() ? a->blocks.size() > b->blocks.size() : a->header < b->header;
+    });
+
+    for (auto& loop : m_loops) {
+        loop->parent = m_innermost[loop->header];
+        loop->depth = loop->parent ? loop->parent->depth + 1 : 1;
+
+        for (u32 index : loop->blocks) {
+            m_innermost[index] = loop.get();
+        }
+    }
+}
+
+u32 LoopInfo::depth(u32 index) const {
+    auto* loop = m_innermost[index];
+    return loop ? loop->depth : 0;
+}
+
+bool LoopInfo::is_header(u32 index) const {
+    auto* loop = m_innermost[index];
+    return loop && loop->header == index;
+}
+
+}
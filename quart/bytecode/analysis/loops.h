@@ -0,0 +1,47 @@
+#pragma once
+
+#include <quart/common.h>
+
+namespace quart::bytecode {
+
+class ControlFlowGraph;
+class DominatorTree;
+
+struct NaturalLoop {
+    u32 header;
+
+    // Sorted indices of every block in the loop, including the header and the blocks of nested loops
+    Vector<u32> blocks;
+
+    // Blocks with a back edge to the header
+    Vector<u32> latches;
+
+    NaturalLoop* parent = nullptr;
+    u32 depth = 1;
+
+    bool contains(u32 index) const { return std::binary_search(blocks.begin(), blocks.end(), index); }
+};
+
+// Natural loops of a function, found through back edges whose target dominates their source. Back edges sharing a
+// header form a single loop. Irreducible cycles don't have such a header and are not reported.
+class LoopInfo {
+public:
+    LoopInfo(ControlFlowGraph const&, DominatorTree const&);
+
+    // Outer loops come before the loops nested in them
+    Vector<OwnPtr<NaturalLoop>> const& loops() const { return m_loops; }
+
+    // The innermost loop containing the given block, if any
+    NaturalLoop* loop_for(u32 index) const { return m_innermost[index]; }
+
+    // How many loops the block is nested in, zero outside of any loop
+    u32 depth(u32 index) const;
+
+    bool is_header(u32 index) const;
+
+private:
+    Vector<OwnPtr<NaturalLoop>> m_loops;
+    Vector<NaturalLoop*> m_innermost;
+};
+
+}
@@ -1,5 +1,6 @@
 #include <quart/language/state.h>
 #include <quart/parser/parser.h>
+#include <quart/module_loader.h>
 #include <quart/parser/ast.h>
 #include <quart/temporary_change.h>
 #include <quart/lexer/lexer.h>
@@ -13,21 +14,20 @@
 namespace quart::ast {
 
 struct ModuleQualifiedName {
-    String name;
+    Identifier name;
 
-    explicit ModuleQualifiedName(String name) : name(move(name)) {}
+    explicit ModuleQualifiedName(Identifier name) : name(name) {}
     explicit ModuleQualifiedName() = default;
 
-    operator String() const { return name; }
+    operator Identifier() const { return name; }
 
-    void append(String const& segment) {
+    void append(Identifier segment) {
         if (name.empty()) {
-            name.append(segment);
+            name = segment;
             return;
         }
 
-        name.append("::");
-        name.append(segment);
+        name = Identifier::join(name, segment);
     }
 };
 
@@ -188,6 +188,7 @@ BytecodeResult IdentifierExpr::generate(State& state, Optional<bytecode::Registe
             auto reg = select_dst(state, dst);
 
             if (!function->has_trait_parameter()) {
+                state.reference_function(function);
                 state.emit<bytecode::GetFunction>(reg, function);
             }
 
@@ -210,7 +211,7 @@ BytecodeResult FloatExpr::generate(State& state, Optional<bytecode::Register> ds
     return bytecode::Operand(reg);
 }
 
-static ErrorOr<void> create_global_variable(State& state, String const& name, ast::Expr* value, Type* type, u8 flags) {
+static ErrorOr<void> create_global_variable(State& state, Identifier name, ast::Expr* value, Type* type, u8 flags) {
     state.set_type_context(type);
 
     Constant* constant = nullptr;
@@ -463,7 +464,7 @@ static ErrorOr<void> generate_generic_function_call(
     State& state,
     Vector<bytecode::Operand>& arguments,
     FunctionType const* function_type, 
-    Vector<OwnPtr<Expr>> const& args,
+    ExprList<Expr> const& args,
     size_t index,
     size_t params
 ) {
@@ -495,7 +496,7 @@ static ErrorOr<void> generate_function_call(
     Vector<bytecode::Operand>& arguments,
     Function* function,
     FunctionType const* function_type,
-    Vector<OwnPtr<Expr>> const& args,
+    ExprList<Expr> const& args,
     size_t index,
     size_t params
 ) {
@@ -642,7 +643,7 @@ static ErrorOr<RefPtr<Function>> generate_trait_function_call(
     Vector<bytecode::Operand>& arguments,
     Function* function,
     FunctionType const* function_type,
-    Vector<OwnPtr<Expr>> const& args,
+    ExprList<Expr> const& args,
     size_t index,
     size_t params
 ) {
@@ -789,6 +790,18 @@ BytecodeResult CallExpr::generate(State& state, Optional<bytecode::Register> dst
     return bytecode::Operand(reg);
 }
 
+static ErrorOr<void> set_inline_hint(Function* function, Span span, Attributes const& attrs) {
+    if (attrs.has(Attribute::Inline) && attrs.has(Attribute::Noinline)) {
+        return err(span, "Function '{}' can't be both ![inline] and ![noinline]", function->name());
+    } else if (attrs.has(Attribute::Inline)) {
+        function->set_inline_hint(Function::InlineHint::Always);
+    } else if (attrs.has(Attribute::Noinline)) {
+        function->set_inline_hint(Function::InlineHint::Never);
+    }
+
+    return {};
+}
+
 static ErrorOr<void> generate_struct_return(State& state, Function* function, ast::Expr const& value) {
     auto result = state.resolve_reference(value, false, {}, false);
     bytecode::Register reg;
@@ -960,6 +973,8 @@ BytecodeResult FunctionDeclExpr::generate(State& state, Optional<bytecode::Regis
         m_is_async
     );
 
+    TRY(set_inline_hint(function.get(), span(), m_attrs));
+
     function->set_module(state.module());
     if (auto* original = state.get_global_function(function->qualified_name())) {
         auto error = err(span(), "Function '{}' is already defined", function->qualified_name());
@@ -979,6 +994,21 @@ BytecodeResult FunctionExpr::generate(State& state, Optional<bytecode::Register>
     TRY(m_decl->generate(state, {}));
     auto* function = state.scope()->resolve<Function>(m_decl->name());
 
+    // Attributes written in front of a definition end up on the definition rather than on its declaration
+    TRY(set_inline_hint(function, span(), m_attrs));
+
+    // Functions taking traits are type checked right away and specialized later on, so they're never deferred
+    if (state.lazy_function_bodies() && !function->is_main() && !function->has_trait_parameter()) {
+        state.defer_function_body(function, *this);
+        return {};
+    }
+
+    return this->generate_body(state, function);
+}
+
+BytecodeResult FunctionExpr::generate_body(State& state, Function* function) const {
+    auto* body = TRY(this->parse_body());
+
     auto* previous_function = state.function();
     auto previous_scope = state.scope();
 
@@ -988,12 +1018,12 @@ BytecodeResult FunctionExpr::generate(State& state, Optional<bytecode::Register>
 
         function->set_local_parameters();
 
-        TRY(state.type_checker().type_check(*m_body));
+        TRY(state.type_checker().type_check(*body));
 
         state.set_current_function(previous_function);
         state.set_current_scope(previous_scope);
 
-        function->set_body(m_body.get());
+        function->set_body(body);
         return {};
     }
 
@@ -1031,7 +1061,7 @@ BytecodeResult FunctionExpr::generate(State& state, Optional<bytecode::Register>
     function->set_return_block(return_block);
     function->emit_return_block_body(state);
 
-    TRY(m_body->generate(state, {}));
+    TRY(body->generate(state, {}));
     TRY(function->finalize_body(state));
 
     function->insert_return_block();
@@ -1152,18 +1182,18 @@ BytecodeResult ContinueExpr::generate(State& state, Optional<bytecode::Register>
 
 static ErrorOr<void> generate_generic_struct(State& state, StructExpr const& expr) {
     Vector<GenericTypeParameter> generic_parameters;
-    Set<String> names;
+    Vector<Identifier> names;
 
     auto scope = Scope::create(expr.name(), ScopeType::Struct, state.scope());
 
     for (auto& parameter : expr.parameters()) {
         generic_parameters.emplace_back(parameter.name, parameter.span);
-        names.insert(parameter.name);
+        names.push_back(parameter.name);
     
         scope->add_symbol(
             TypeAlias::create(
                 parameter.name,
-                EmptyType::get(state.context(), parameter.name),
+                EmptyType::get(state.context(), String(parameter.name)),
                 false
             )
         );
@@ -1171,7 +1201,7 @@ static ErrorOr<void> generate_generic_struct(State& state, StructExpr const& exp
 
     auto* type = StructType::get(
         state.context(),
-        Symbol::parse_qualified_name(expr.name(), state.scope()),
+        String(Symbol::parse_qualified_name(expr.name(), state.scope())),
         {}
     );
 
@@ -1185,8 +1215,8 @@ static ErrorOr<void> generate_generic_struct(State& state, StructExpr const& exp
         Type* type = nullptr;
         if (isa<NamedTypeExpr>(field.type)) {
             auto& path = cast_unchecked<NamedTypeExpr>(field.type)->path();
-            if (!path.has_segments() && names.contains(path.name())) {
-                type = EmptyType::get(state.context(), path.name());
+            if (!path.has_segments() && llvm::is_contained(names, path.name())) {
+                type = EmptyType::get(state.context(), String(path.name()));
             }
         }
 
@@ -1229,7 +1259,7 @@ static ErrorOr<void> generate_generic_struct(State& state, StructExpr const& exp
 
 BytecodeResult StructExpr::generate(State& state, Optional<bytecode::Register>) const {
     if (m_opaque) {
-        auto* type = StructType::get(state.context(), Symbol::parse_qualified_name(m_name, state.scope()), {});
+        auto* type = StructType::get(state.context(), String(Symbol::parse_qualified_name(m_name, state.scope())), {});
         auto structure = Struct::create(m_name, type, state.scope(), m_is_public);
 
         state.scope()->add_symbol(structure);
@@ -1244,7 +1274,9 @@ BytecodeResult StructExpr::generate(State& state, Optional<bytecode::Register>)
         return {};
     }
 
-    auto* type = StructType::get(state.context(), Symbol::parse_qualified_name(m_name, state.scope()), {});
+    auto* type = StructType::get(state.context(), String(Symbol::parse_qualified_name(m_name, state.scope())), {});
+    type->set_packed(m_attrs.has(Attribute::Packed));
+
     auto scope = Scope::create(m_name, ScopeType::Struct, state.scope());
 
     auto structure = Struct::create(m_name, type, {}, scope, m_is_public);
@@ -1402,6 +1434,8 @@ BytecodeResult PathExpr::generate(State& state, Optional<bytecode::Register> dst
         }
         case Symbol::Function: {
             auto* function = cast_unchecked<Function>(symbol);
+
+            state.reference_function(function);
             state.emit<bytecode::GetFunction>(reg, function);
 
             state.set_register_state(reg, function->underlying_type()->get_pointer_to(), function);
@@ -1439,7 +1473,7 @@ BytecodeResult EnumExpr::generate(State&, Optional<bytecode::Register>) const {
 }
 
 BytecodeResult ImportExpr::generate(State& state, Optional<bytecode::Register>) const {
-    String qualified_name = m_path.format();
+    Identifier qualified_name = m_path.qualified_name();
 
     auto module = state.get_global_module(qualified_name);
 
@@ -1465,7 +1499,7 @@ BytecodeResult ImportExpr::generate(State& state, Optional<bytecode::Register>)
             return err(span(), "Generic arguments are not allowed in import paths");
         }
 
-        auto& segment = seg.name();
+        Identifier segment = seg.name();
 
         fullpath.append(segment);
         fs::Path path(fullpath);
@@ -1477,7 +1511,7 @@ BytecodeResult ImportExpr::generate(State& state, Optional<bytecode::Register>)
                 return err(span(), "Could not find module '{}'", m_path.name());
             }
 
-            fullpath = fullpath.substr(0, fullpath.size() - segment.size()) + String(path);
+            fullpath = fullpath.substr(0, fullpath.size() - segment.str().size()) + String(path);
         }
 
         if (!path.is_dir()) {
@@ -1509,7 +1543,7 @@ BytecodeResult ImportExpr::generate(State& state, Optional<bytecode::Register>)
         fullpath.push_back('/');
     }
 
-    fs::Path path = fs::Path(fullpath + m_path.name() + FILE_EXTENSION);
+    fs::Path path = fs::Path(fullpath + String(m_path.name()) + FILE_EXTENSION);
     String name = path;
 
     if (!path.exists()) {
@@ -1553,15 +1587,10 @@ BytecodeResult ImportExpr::generate(State& state, Optional<bytecode::Register>)
     state.set_current_scope(scope);
     state.set_current_module(&*module);
 
-    auto source_code = SourceCode::from_path(path);
-    Lexer lexer(source_code);
+    auto parsed = TRY(state.module_loader().load(path));
+    module->set_arena(move(parsed.arena));
 
-    Vector<Token> tokens = TRY(lexer.lex());
-
-    Parser parser(move(tokens));
-    auto ast = TRY(parser.parse());
-
-    for (auto& expr : ast) {
+    for (auto& expr : parsed.ast) {
         TRY(expr->generate(state, {}));
     }
 
@@ -1618,9 +1647,9 @@ BytecodeResult ModuleExpr::generate(State& state, Optional<bytecode::Register>)
     auto* prev_module = state.module();
     auto current_scope = state.scope();
 
-    String qualified_name = m_name;
+    Identifier qualified_name = m_name;
     if (prev_module) {
-        qualified_name = format("{}::{}", prev_module->qualified_name(), m_name);
+        qualified_name = Identifier::join(prev_module->qualified_name(), m_name);
     }
 
     auto scope = Scope::create(m_name, ScopeType::Module, current_scope);
@@ -1672,8 +1701,6 @@ BytecodeResult RangeForExpr::generate(State& state, Optional<bytecode::Register>
         end = TRY(state.type_check_and_cast(m_end->span(), *end, type, "Cannot iterate over a range of different types"));
     }
 
-    auto reg = state.allocate_register();
-
     size_t local_index = current_function->allocate_local();
     current_function->set_local_type(local_index, type);
 
@@ -1688,19 +1715,27 @@ BytecodeResult RangeForExpr::generate(State& state, Optional<bytecode::Register>
     state.switch_to(body_block);
     TRY(m_body->generate(state, {}));
 
-    state.set_register_state(reg, type);
-    state.emit<bytecode::GetLocal>(reg, local_index);
+    // Every register is only ever defined once, the passes rely on that
+    auto current = state.allocate_register();
+    auto next = state.allocate_register();
+
+    state.set_register_state(current, type);
+    state.emit<bytecode::GetLocal>(current, local_index);
 
-    state.emit<bytecode::Add>(reg, reg, bytecode::Operand(1, type));
-    state.emit<bytecode::SetLocal>(local_index, reg);
+    state.set_register_state(next, type);
+    state.emit<bytecode::Add>(next, current, bytecode::Operand(1, type));
+    state.emit<bytecode::SetLocal>(local_index, next);
     if (m_end) {
+        auto condition = state.allocate_register();
+        state.set_register_state(condition, state.context().i1());
+
         if (m_inclusive) {
-            state.emit<bytecode::Lt>(reg, *end, reg);
+            state.emit<bytecode::Lt>(condition, *end, next);
         } else {
-            state.emit<bytecode::Eq>(reg, *end, reg);
+            state.emit<bytecode::Eq>(condition, *end, next);
         }
 
-        state.emit<bytecode::JumpIf>(reg, end_block, body_block);
+        state.emit<bytecode::JumpIf>(condition, end_block, body_block);
     } else {
         state.emit<bytecode::Jump>(body_block);
     }
@@ -1836,9 +1871,14 @@ BytecodeResult MatchExpr::generate(State& state, Optional<bytecode::Register>) c
                 auto operand = cast_unchecked<ConstantInt>(constant)->to_operand();
     
                 bytecode::Register temp = state.allocate_register();
+                bytecode::Register combined = state.allocate_register();
+
+                state.set_register_state(combined, state.context().i1());
         
                 state.emit<bytecode::Eq>(temp, match, operand);
-                state.emit<bytecode::Or>(reg, reg, bytecode::Operand(temp));
+                state.emit<bytecode::Or>(combined, reg, bytecode::Operand(temp));
+
+                reg = combined;
             }
         } else {
             auto& value = *pattern.values[0];
@@ -1900,15 +1940,15 @@ BytecodeResult ImplExpr::generate(State& state, Optional<bytecode::Register>) co
     if (!m_parameters.empty()) {
         auto scope = Scope::create({}, ScopeType::Impl, current_scope);
 
-        auto range = llvm::map_range(m_parameters, [](auto& param) { return param.name; });
-        Set<String> parameters = { range.begin(), range.end() };
-
-        for (auto& parameter : parameters) {
+        Vector<Identifier> parameters;
+        for (auto& parameter : m_parameters) {
             scope->add_symbol(TypeAlias::create(
-                parameter,
-                EmptyType::get(state.context(), parameter),
+                parameter.name,
+                EmptyType::get(state.context(), String(parameter.name)),
                 false
             ));
+
+            parameters.push_back(parameter.name);
         }
         
         auto previous_scope = state.scope();
@@ -1950,7 +1990,7 @@ BytecodeResult ImplExpr::generate(State& state, Optional<bytecode::Register>) co
         return {};
     }
 
-    auto scope = Scope::create(underlying_type->str(), ScopeType::Impl, current_scope);
+    auto scope = Scope::create(Identifier(underlying_type->str()), ScopeType::Impl, current_scope);
 
     auto impl = Impl::create(underlying_type, scope);
     state.set_self_type(impl->underlying_type());
@@ -1968,14 +2008,14 @@ BytecodeResult ImplExpr::generate(State& state, Optional<bytecode::Register>) co
 BytecodeResult TraitExpr::generate(State& state, Optional<bytecode::Register>) const {
     auto current_scope = state.scope();
 
-    auto* type = TraitType::get(state.context(), Symbol::parse_qualified_name(m_name, current_scope));
-    auto scope = Scope::create(type->name(), ScopeType::Namespace, current_scope);
+    auto* type = TraitType::get(state.context(), String(Symbol::parse_qualified_name(m_name, current_scope)));
+    auto scope = Scope::create(Identifier(type->name()), ScopeType::Namespace, current_scope);
     
     auto trait = Trait::create(m_name, type, scope);
     for (auto& parameter : m_parameters) {
         auto alias = TypeAlias::create(
             parameter.name,
-            EmptyType::get(state.context(), parameter.name), 
+            EmptyType::get(state.context(), String(parameter.name)), 
             true
         );
 
@@ -2094,7 +2134,7 @@ BytecodeResult ImplTraitExpr::generate(State& state, Optional<bytecode::Register
         }
 
         TRY(expr->generate(state, {}));
-        String name = cast_unchecked<FunctionExpr>(expr)->decl().name();
+        Identifier name = cast_unchecked<FunctionExpr>(expr)->decl().name();
 
         Function const* function = scope->resolve<Function>(name);
         if (!function) {
@@ -2148,10 +2188,16 @@ BytecodeResult ImplTraitExpr::generate(State& state, Optional<bytecode::Register
         }
     }
 
+    // The generic parameters of the trait are only in scope until the end of this, so these can't be deferred
+    bool lazy_function_bodies = state.lazy_function_bodies();
+    state.set_lazy_function_bodies(false);
+
     for (auto& function : trait->predefined_functions()) {
         TRY(function->generate(state, {}));
     }
 
+    state.set_lazy_function_bodies(lazy_function_bodies);
+
     if (trait->has_generic_parameters()) {
         auto& parameters = trait->generic_parameters();
         auto scope = structure->scope();
@@ -2169,9 +2215,9 @@ BytecodeResult ImplTraitExpr::generate(State& state, Optional<bytecode::Register
 }
 
 BytecodeResult ConstEvalExpr::generate(State& state, Optional<bytecode::Register>) const {
-    for (auto& expr : m_body) {
-        TRY(state.constant_evaluator().evaluate(*expr));
-    }
+    // The body is generated into a function of its own and run in the interpreter, see `ConstantEvaluator::execute`
+    Expr const& expr = *this;
+    TRY(state.constant_evaluator().evaluate(expr));
 
     return {};
 }
@@ -27,6 +27,35 @@ void BasicBlock::add_instruction(Instruction* inst) {
     }
 }
 
+void BasicBlock::set_instructions(Vector<OwnPtr<Instruction>> instructions) {
+    m_instructions = move(instructions);
+    m_terminated = false;
+
+    Instruction* prev = nullptr;
+    for (auto& inst : m_instructions) {
+        inst->set_parent(this);
+        inst->set_next(nullptr);
+
+        if (prev) {
+            prev->set_next(inst.get());
+        }
+
+        prev = inst.get();
+    }
+
+    if (prev && prev->is_terminator()) {
+        m_terminated = true;
+    }
+}
+
+Instruction* BasicBlock::terminator() const {
+    if (!m_terminated) {
+        return nullptr;
+    }
+
+    return m_instructions.back().get();
+}
+
 void BasicBlock::dump() const {
     outln("{}:", m_name);
     for (auto& instruction : m_instructions) {
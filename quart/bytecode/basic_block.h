@@ -26,6 +26,11 @@ public:
 
     void add_instruction(Instruction*);
 
+    // Replaces every instruction in this block, used by passes that rewrite it as a whole
+    void set_instructions(Vector<OwnPtr<Instruction>> instructions);
+
+    Instruction* terminator() const;
+
     bool is_terminated() const { return m_terminated; }
     void terminate() { m_terminated = true; }
 
@@ -11,6 +11,9 @@ public:
 
     Vector<Instruction*> const& all_references() const { return m_references; }
     void add(Instruction* instruction) { m_references.push_back(instruction); }
+    void remove(Instruction* instruction) {
+        m_references.erase(std::remove(m_references.begin(), m_references.end(), instruction), m_references.end());
+    }
 
     template<typename T> requires(std::is_base_of_v<Instruction, T>)
     T* get() {
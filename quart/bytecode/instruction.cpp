@@ -79,6 +79,30 @@ static void set_operands_use(Generator& gen, const Instruction* instruction, con
     }
 }
 
+static void visit_register(Register& reg, OperandVisitor visitor) {
+    Operand operand(reg);
+    visitor(operand);
+
+    ASSERT(operand.is_register(), "Register operands can't be replaced with values");
+    reg = operand.reg();
+}
+
+static void visit_operands(Vector<Operand>& operands, OperandVisitor visitor) {
+    for (auto& operand : operands) {
+        visitor(operand);
+    }
+}
+
+OwnPtr<Instruction> Instruction::clone() const {
+    switch (m_type) {
+    #define Op(x) case x: return make<bytecode::x>(static_cast<bytecode::x const&>(*this)); // NOLINT
+        ENUMERATE_BYTECODE_INSTRUCTIONS(Op)
+    #undef Op
+    }
+
+    return nullptr;
+}
+
 void Move::dump() const {
     outln("Move {}, {}", fmt(m_dst), m_src);
 }
@@ -95,6 +119,10 @@ void NewArray::set_register_uses(Generator& gen) const {
     set_operands_use(gen, this, m_elements);
 }
 
+void NewArray::visit_operands(OperandVisitor visitor) {
+    bytecode::visit_operands(m_elements, visitor);
+}
+
 void NewLocalScope::dump() const {
     outln("NewLocalScope");
 }
@@ -121,6 +149,12 @@ void SetLocal::set_register_uses(Generator& gen) const {
     }
 }
 
+void SetLocal::visit_operands(OperandVisitor visitor) {
+    if (m_src.has_value()) {
+        visitor(*m_src);
+    }
+}
+
 void GetGlobal::dump() const {
     outln("GetGlobal {}, {}", fmt(m_dst), m_index);
 }
@@ -141,6 +175,11 @@ void GetMember::set_register_uses(Generator& gen) const {
     set_register_use(gen, this, m_src);
 }
 
+void GetMember::visit_operands(OperandVisitor visitor) {
+    visit_register(m_src, visitor);
+    visitor(m_index);
+}
+
 void GetMemberRef::dump() const {
     outln("GetMemberRef {}, {}, {}", fmt(m_dst), fmt(m_src), fmt(m_index));
 }
@@ -149,6 +188,11 @@ void GetMemberRef::set_register_uses(Generator& gen) const {
     set_register_use(gen, this, m_src);
 }
 
+void GetMemberRef::visit_operands(OperandVisitor visitor) {
+    visit_register(m_src, visitor);
+    visitor(m_index);
+}
+
 void SetMember::dump() const {
     outln("SetMember {}, {}, {}", fmt(m_src), fmt(m_dst), fmt(m_index));
 }
@@ -158,6 +202,12 @@ void SetMember::set_register_uses(Generator& gen) const {
     set_operand_use(gen, this, m_index);
 }
 
+void SetMember::visit_operands(OperandVisitor visitor) {
+    visit_register(m_dst, visitor);
+    visitor(m_index);
+    visitor(m_src);
+}
+
 void Read::dump() const {
     outln("Read {}, {}", fmt(m_dst), fmt(m_src));
 }
@@ -166,6 +216,10 @@ void Read::set_register_uses(Generator& gen) const {
     set_register_use(gen, this, m_src);
 }
 
+void Read::visit_operands(OperandVisitor visitor) {
+    visit_register(m_src, visitor);
+}
+
 void Write::dump() const {
     outln("Write {}, {}", fmt(m_dst), fmt(m_src));
 }
@@ -174,6 +228,11 @@ void Write::set_register_uses(Generator& gen) const {
     set_operand_use(gen, this, m_src);
 }
 
+void Write::visit_operands(OperandVisitor visitor) {
+    visit_register(m_dst, visitor);
+    visitor(m_src);
+}
+
 // NOLINTNEXTLINE
 #define Op(x)                                                           \
     void x::dump() const {                                              \
@@ -182,6 +241,10 @@ void Write::set_register_uses(Generator& gen) const {
     void x::set_register_uses(Generator& gen) const {                   \
         set_operand_use(gen, this, m_lhs);                              \
         set_operand_use(gen, this, m_rhs);                              \
+    }                                                                   \
+    void x::visit_operands(OperandVisitor visitor) {                    \
+        visitor(m_lhs);                                                 \
+        visitor(m_rhs);                                                 \
     }
 
 ENUMERATE_BINARY_OPS(Op)
@@ -200,6 +263,10 @@ void JumpIf::set_register_uses(Generator& gen) const {
     set_operand_use(gen, this, m_condition);
 }
 
+void JumpIf::visit_operands(OperandVisitor visitor) {
+    visitor(m_condition);
+}
+
 void NewFunction::dump() const {
     outln("NewFunction {}", m_function->qualified_name());
 }
@@ -222,6 +289,12 @@ void Return::set_register_uses(Generator& gen) const {
     }
 }
 
+void Return::visit_operands(OperandVisitor visitor) {
+    if (m_value.has_value()) {
+        visitor(*m_value);
+    }
+}
+
 void Call::dump() const {
     outln("Call {}, {}, {}", fmt(m_dst), fmt(m_function), fmt(m_arguments));
 }
@@ -231,6 +304,11 @@ void Call::set_register_uses(Generator& gen) const {
     set_operands_use(gen, this, m_arguments);
 }
 
+void Call::visit_operands(OperandVisitor visitor) {
+    visit_register(m_function, visitor);
+    bytecode::visit_operands(m_arguments, visitor);
+}
+
 void Cast::dump() const {
     outln("Cast {}, {}, {}", fmt(m_dst), fmt(m_src), m_type->str());
 }
@@ -239,6 +317,10 @@ void Cast::set_register_uses(Generator& gen) const {
     set_operand_use(gen, this, m_src);
 }
 
+void Cast::visit_operands(OperandVisitor visitor) {
+    visitor(m_src);
+}
+
 void NewStruct::dump() const {
     outln("NewStruct {}", m_structure->qualified_name());
 }
@@ -251,6 +333,10 @@ void Construct::set_register_uses(Generator& gen) const {
     set_operands_use(gen, this, m_arguments);
 }
 
+void Construct::visit_operands(OperandVisitor visitor) {
+    bytecode::visit_operands(m_arguments, visitor);
+}
+
 void Alloca::dump() const {
     outln("Alloca {}, {}", fmt(m_dst), m_type->str());
 }
@@ -271,6 +357,10 @@ void Not::set_register_uses(Generator& gen) const {
     set_operand_use(gen, this, m_src);
 }
 
+void Not::visit_operands(OperandVisitor visitor) {
+    visitor(m_src);
+}
+
 void Memcpy::dump() const {
     outln("Memcpy {}, {}, {}", fmt(m_dst), fmt(m_src), m_size);
 }
@@ -279,6 +369,11 @@ void Memcpy::set_register_uses(Generator& gen) const {
     set_register_use(gen, this, m_src);
 }
 
+void Memcpy::visit_operands(OperandVisitor visitor) {
+    visit_register(m_dst, visitor);
+    visit_register(m_src, visitor);
+}
+
 void GetReturn::dump() const {
     outln("GetReturn {}", fmt(m_dst));
 }
@@ -291,4 +386,44 @@ void NewTuple::set_register_uses(Generator& gen) const {
     set_operands_use(gen, this, m_elements);
 }
 
+void NewTuple::visit_operands(OperandVisitor visitor) {
+    bytecode::visit_operands(m_elements, visitor);
+}
+
+void Phi::dump() const {
+    String incoming;
+    for (auto [index, entry] : llvm::enumerate(m_incoming)) {
+        incoming.append(format("[{}: {}]", entry.block->name(), fmt(entry.value)));
+        if (index != m_incoming.size() - 1) {
+            incoming.append(", ");
+        }
+    }
+
+    outln("Phi {}, {}", fmt(m_dst), incoming);
+}
+
+void Phi::set_register_uses(Generator& gen) const {
+    for (auto& entry : m_incoming) {
+        set_operand_use(gen, this, entry.value);
+    }
+}
+
+void Phi::visit_operands(OperandVisitor visitor) {
+    for (auto& entry : m_incoming) {
+        visitor(entry.value);
+    }
+}
+
+void Copy::dump() const {
+    outln("Copy {}, {}", fmt(m_dst), fmt(m_src));
+}
+
+void Copy::set_register_uses(Generator& gen) const {
+    set_operand_use(gen, this, m_src);
+}
+
+void Copy::visit_operands(OperandVisitor visitor) {
+    visitor(m_src);
+}
+
 }
\ No newline at end of file
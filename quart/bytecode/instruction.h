@@ -6,6 +6,8 @@
 #include <quart/lexer/tokens.h>
 #include <quart/language/types.h>
 
+#include <llvm/ADT/STLFunctionalExtras.h>
+
 #include <string>
 #include <vector>
 
@@ -59,6 +61,8 @@
     Op(Not)                                         \
     Op(Memcpy)                                      \
     Op(GetReturn)                                   \
+    Op(Phi)                                         \
+    Op(Copy)                                        \
 
 namespace quart {
     class Function;
@@ -91,6 +95,10 @@ public:
 
     quart::Type* value_type() const { return m_value_type; }
 
+    bool operator==(Operand const& other) const {
+        return m_type == other.m_type && m_value == other.m_value;
+    }
+
 private:
     u64 m_value = 0;
     quart::Type* m_value_type = nullptr;
@@ -98,9 +106,11 @@ private:
     Type m_type = Type::Value;
 };
 
+// Passed every operand an instruction reads, operands that are stored as plain registers must stay registers
+using OperandVisitor = ::llvm::function_ref<void(Operand&)>;
+
 class Instruction {
 public:
-    NO_COPY(Instruction)
     DEFAULT_MOVE(Instruction)
 
     static bool classof(Instruction const*) { return true; }
@@ -127,6 +137,11 @@ public:
         return T::classof(this) ? static_cast<T const*>(this) : nullptr;
     }
 
+    template<typename T> requires(std::is_base_of_v<Instruction, T>)
+    [[nodiscard]] T* as() {
+        return T::classof(this) ? static_cast<T*>(this) : nullptr;
+    }
+
     virtual bool is_terminator() const { return false; }
 
     StringView type_name() const {
@@ -145,9 +160,24 @@ public:
     virtual void dump() const = 0;
     virtual void set_register_uses(Generator&) const = 0;
 
+    // The register this instruction defines, if any. Registers that are only read through (e.g. the destination
+    // pointer of a `Write`) are operands and not results.
+    virtual Optional<Register> result() const { return {}; }
+    virtual void set_result(Register) {}
+
+    // Calls `visitor` on every operand of this instruction, changes made to an operand are written back
+    virtual void visit_operands(OperandVisitor) {}
+
+    // Returns a detached copy of this instruction that refers to the same registers, locals and blocks
+    OwnPtr<Instruction> clone() const;
+
 protected:
     Instruction(InstructionType type) : m_type(type) {}
 
+    // Only used by `clone()`, the copy doesn't belong to any block
+    Instruction(Instruction const& other) : m_type(other.m_type) {}
+    Instruction& operator=(Instruction const&) = delete;
+
 private:
     InstructionType m_type;
     BasicBlock* m_parent = nullptr;
@@ -171,6 +201,8 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override {}
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
 
 private:
     Register m_dst;
@@ -186,6 +218,8 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override {}
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
 
 private:
     Register m_dst;
@@ -202,6 +236,9 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override;
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
+    void visit_operands(OperandVisitor) override;
 
 private:
     Register m_dst;
@@ -219,6 +256,9 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override;
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
+    void visit_operands(OperandVisitor) override;
 
 private:
     Register m_dst;
@@ -236,6 +276,7 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override;
+    void visit_operands(OperandVisitor) override;
 
 private:
     Register m_dst;
@@ -253,6 +294,9 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override;
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
+    void visit_operands(OperandVisitor) override;
 
 private:
     Register m_dst;
@@ -282,8 +326,12 @@ public:
     Register dst() const { return m_dst; }
     u32 index() const { return m_index; }
 
+    void set_index(u32 index) { m_index = index; }
+
     void dump() const override;
     void set_register_uses(Generator&) const override {}
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
 
 private:
     Register m_dst;
@@ -297,8 +345,12 @@ public:
     Register dst() const { return m_dst; }
     u32 index() const { return m_index; }
 
+    void set_index(u32 index) { m_index = index; }
+
     void dump() const override;
     void set_register_uses(Generator&) const override {}
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
 
 private:
     Register m_dst;
@@ -312,8 +364,11 @@ public:
     u32 index() const { return m_index; }
     Optional<Operand> src() const { return m_src; }
 
+    void set_index(u32 index) { m_index = index; }
+
     void dump() const override;
     void set_register_uses(Generator&) const override;
+    void visit_operands(OperandVisitor) override;
 
 private:
     u32 m_index;
@@ -329,6 +384,8 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override {}
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
 
 private:
     Register m_dst;
@@ -344,6 +401,8 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override {}
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
 
 private:
     Register m_dst;
@@ -374,6 +433,9 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override;
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
+    void visit_operands(OperandVisitor) override;
 
 private:
     Register m_dst;
@@ -389,6 +451,7 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override;
+    void visit_operands(OperandVisitor) override;
 
 private:
     Register m_dst;
@@ -408,6 +471,9 @@ private:
                                                                                                                         \
         void dump() const override;                                                                                     \
         void set_register_uses(Generator&) const override;                                                                  \
+        Optional<Register> result() const override { return m_dst; }                                                    \
+        void set_result(Register reg) override { m_dst = reg; }                                                         \
+        void visit_operands(OperandVisitor) override;                                                                   \
     private:                                                                                                            \
         Register m_dst;                                                                                                 \
         Operand m_lhs;                                                                                                  \
@@ -424,6 +490,7 @@ public:
     Jump(BasicBlock* target) : m_target(target) {}
 
     BasicBlock* target() const { return m_target; }
+    void set_target(BasicBlock* target) { m_target = target; }
 
     bool is_terminator() const override { return true; }
     void dump() const override;
@@ -445,10 +512,16 @@ public:
     BasicBlock* true_target() const { return m_true_target; }
     BasicBlock* false_target() const { return m_false_target; }
 
+    void set_targets(BasicBlock* true_target, BasicBlock* false_target) {
+        m_true_target = true_target;
+        m_false_target = false_target;
+    }
+
     bool is_terminator() const override { return true; }
     void dump() const override;
 
     void set_register_uses(Generator&) const override;
+    void visit_operands(OperandVisitor) override;
 
 private:
     Operand m_condition;
@@ -479,6 +552,8 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override {}
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
 
 private:
     Register m_dst;
@@ -495,6 +570,7 @@ public:
     void dump() const override;
 
     void set_register_uses(Generator&) const override;
+    void visit_operands(OperandVisitor) override;
 
 private:
     Optional<Operand> m_value;
@@ -513,6 +589,9 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override;
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
+    void visit_operands(OperandVisitor) override;
 
 private:
     Register m_dst;
@@ -531,6 +610,9 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override;
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
+    void visit_operands(OperandVisitor) override;
 
 private:
     Register m_dst;
@@ -562,6 +644,9 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override;
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
+    void visit_operands(OperandVisitor) override;
 
 private:
     Register m_dst;
@@ -578,6 +663,8 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override {}
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
 
 private:
     Register m_dst;
@@ -594,6 +681,9 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override;
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
+    void visit_operands(OperandVisitor) override;
 
 private:
     Register m_dst;
@@ -610,6 +700,8 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override {}
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
 
 private:
     Register m_dst;
@@ -625,6 +717,8 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override {}
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
 
 private:
     Register m_dst;
@@ -640,6 +734,9 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override;
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
+    void visit_operands(OperandVisitor) override;
 
 private:
     Register m_dst;
@@ -656,6 +753,7 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override;
+    void visit_operands(OperandVisitor) override;
 
 private:
     Register m_dst;
@@ -671,9 +769,60 @@ public:
 
     void dump() const override;
     void set_register_uses(Generator&) const override {}
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
+
+private:
+    Register m_dst;
+};
+
+// `dst = <value coming from the predecessor control reached this block from>`. Only present while a function is in
+// SSA form, always at the start of a block.
+class Phi : public InstructionBase<Instruction::Phi> {
+public:
+    struct Incoming {
+        BasicBlock* block;
+        Operand value;
+    };
+
+    Phi(Register dst) : m_dst(dst) {}
+
+    Register dst() const { return m_dst; }
+    Vector<Incoming> const& incoming() const { return m_incoming; }
+
+    void add_incoming(BasicBlock* block, Operand value) { m_incoming.push_back({ block, value }); }
+    void remove_incoming(BasicBlock* block) {
+        std::erase_if(m_incoming, [block](auto const& incoming) { return incoming.block == block; });
+    }
+
+    void dump() const override;
+    void set_register_uses(Generator&) const override;
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
+    void visit_operands(OperandVisitor) override;
+
+private:
+    Register m_dst;
+    Vector<Incoming> m_incoming;
+};
+
+// `dst = src`, what phis are lowered to when leaving SSA form
+class Copy : public InstructionBase<Instruction::Copy> {
+public:
+    Copy(Register dst, Operand src) : m_dst(dst), m_src(src) {}
+
+    Register dst() const { return m_dst; }
+    Operand src() const { return m_src; }
+
+    void dump() const override;
+    void set_register_uses(Generator&) const override;
+    Optional<Register> result() const override { return m_dst; }
+    void set_result(Register reg) override { m_dst = reg; }
+    void visit_operands(OperandVisitor) override;
 
 private:
     Register m_dst;
+    Operand m_src;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,1922 @@
+#include <quart/bytecode/interpreter.h>
+#include <quart/language/data_layout.h>
+#include <quart/language/state.h>
+#include <quart/temporary_change.h>
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#include <dlfcn.h>
+
+namespace quart::bytecode {
+
+static constexpr size_t STACK_SIZE = 64 * 1024 * 1024;
+static constexpr size_t MAX_CALL_DEPTH = 4096;
+
+// Jumps and calls executed before a constant expression is considered to never finish
+static constexpr u64 MAX_STEPS = u64(1) << 32;
+
+static constexpr size_t MAX_MEMOIZED_CALLS = 1 << 20;
+
+// Extern functions are called through a prototype that fills every argument register, so only calls whose
+// arguments all fit in registers can be made. Anything that would have to go on the stack is rejected.
+#if defined(__x86_64__) && !defined(_WIN32)
+static constexpr size_t FFI_INTEGER_REGISTERS = 6;
+static constexpr size_t FFI_FLOAT_REGISTERS = 8;
+#elif defined(__aarch64__) && !defined(__APPLE__)
+static constexpr size_t FFI_INTEGER_REGISTERS = 8;
+static constexpr size_t FFI_FLOAT_REGISTERS = 8;
+#else
+static constexpr size_t FFI_INTEGER_REGISTERS = 0;
+static constexpr size_t FFI_FLOAT_REGISTERS = 0;
+#endif
+
+// Declaring the prototype as variadic makes the caller report how many vector registers are used, which variadic
+// callees rely on and everything else ignores
+template<typename R>
+using NativePrototype = R(*)(u64, u64, u64, u64, u64, u64, u64, u64, f64, f64, f64, f64, f64, f64, f64, f64, ...);
+
+// How a value is moved between a register and memory. Integers are sign or zero extended to 64 bits in registers
+// and floats are always held as doubles, `F32` ones are rounded after every operation.
+enum class ValueKind : u8 {
+    None,
+    I8,
+    U8,
+    I16,
+    U16,
+    I32,
+    U32,
+    I64,
+    F32,
+    F64,
+    Pointer,
+    Aggregate
+};
+
+enum class Opcode : u8 {
+    Constant,
+    Copy,
+
+    Add,
+    Sub,
+    Mul,
+    SDiv,
+    UDiv,
+    SRem,
+    URem,
+    And,
+    Or,
+    Xor,
+    Shl,
+    Shr,
+    LogicalAnd,
+    LogicalOr,
+
+    FAdd,
+    FSub,
+    FMul,
+    FDiv,
+    FRem,
+
+    Eq,
+    Neq,
+    SLt,
+    SLte,
+    SGt,
+    SGte,
+    ULt,
+    ULte,
+    UGt,
+    UGte,
+
+    FEq,
+    FNeq,
+    FLt,
+    FLte,
+    FGt,
+    FGte,
+
+    Not,
+
+    IntCast,
+    SIToFP,
+    UIToFP,
+    FPToSI,
+    FPToUI,
+    FPCast,
+    IsNotNull,
+
+    // `value` is an offset into the frame's memory
+    FrameAddress,
+    LoadFrame,
+    StoreFrame,
+    ZeroFrame,
+
+    // Struct locals and by value parameters point to memory they don't own, the frame only holds that pointer
+    AliasAddress,
+    LoadAlias,
+    StoreAlias,
+
+    // `value` is an offset from the address in `a`
+    Address,
+    AddressIndexed,
+    Load,
+    Store,
+    Zero,
+    Memcpy,
+
+    // `value` is the index of the global
+    GlobalAddress,
+    LoadGlobal,
+    SetGlobal,
+
+    ReturnAddress,
+    Call,
+
+    Jump,
+    JumpIf,
+    Return,
+    ReturnValue
+};
+
+struct Operation {
+    Opcode opcode;
+
+    // The kind of the value being loaded or stored and the width integer results get truncated to
+    ValueKind kind = ValueKind::None;
+    u8 bits = 64;
+    bool is_signed = false;
+
+    u32 dst = 0;
+    u32 a = 0;
+    u32 b = 0;
+
+    u64 value = 0;
+    u64 extra = 0;
+};
+
+struct CompiledFunction {
+    struct Parameter {
+        u64 offset;
+        ValueKind kind;
+        u64 size;
+
+        bool is_alias;
+    };
+
+    Function* function = nullptr;
+    Vector<Operation> code;
+
+    // Copied over the register slots of every new frame, this is where operands that were immediates live
+    Vector<u64> initial_registers;
+
+    // Registers holding aggregates point to a buffer in the frame, these are (slot, offset) pairs
+    Vector<Pair<u32, u64>> aggregate_registers;
+
+    Vector<Parameter> parameters;
+
+    Vector<u32> call_arguments;
+    Vector<ValueKind> call_argument_kinds;
+
+    size_t memory_size = 0;
+    bool is_struct_return = false;
+
+    Deque<String> strings;
+
+    Vector<Function*> callees;
+
+    // No global is touched and nothing is called indirectly
+    bool is_pure = true;
+    bool has_scalar_signature = false;
+
+    Optional<bool> is_memoizable;
+
+    // Extern functions called through the FFI have no code, only the address of the native function
+    void* native = nullptr;
+    ValueKind native_return = ValueKind::None;
+
+    size_t frame_size() const {
+        return initial_registers.size() * sizeof(u64) + memory_size;
+    }
+};
+
+static size_t align_to(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static u64 normalize(u64 value, u8 bits, bool is_signed) {
+    if (bits >= 64) {
+        return value;
+    } else if (!is_signed || bits == 1) {
+        return value & ((u64(1) << bits) - 1);
+    }
+
+    u8 shift = 64 - bits;
+    return static_cast<u64>(static_cast<i64>(value << shift) >> shift);
+}
+
+static Type* scalar_type_of(Type* type) {
+    if (type && type->is_enum()) {
+        return type->get_inner_enum_type();
+    }
+
+    return type;
+}
+
+static bool is_scalar(Type* type) {
+    type = scalar_type_of(type);
+    return type->is_int() || type->is_floating_point();
+}
+
+static f64 as_float(u64 value) {
+    return std::bit_cast<f64>(value);
+}
+
+static u64 from_float(f64 value, ValueKind kind) {
+    if (kind == ValueKind::F32) {
+        value = static_cast<f64>(static_cast<f32>(value));
+    }
+
+    return std::bit_cast<u64>(value);
+}
+
+template<typename T>
+static T read(u8 const* address) {
+    T value;
+    std::memcpy(&value, address, sizeof(T));
+
+    return value;
+}
+
+template<typename T>
+static void write(u8* address, T value) {
+    std::memcpy(address, &value, sizeof(T));
+}
+
+static u64 load(ValueKind kind, u8 const* address) {
+    switch (kind) {
+        case ValueKind::I8: return static_cast<u64>(static_cast<i64>(read<i8>(address)));
+        case ValueKind::U8: return read<u8>(address);
+        case ValueKind::I16: return static_cast<u64>(static_cast<i64>(read<i16>(address)));
+        case ValueKind::U16: return read<u16>(address);
+        case ValueKind::I32: return static_cast<u64>(static_cast<i64>(read<i32>(address)));
+        case ValueKind::U32: return read<u32>(address);
+        case ValueKind::F32: return std::bit_cast<u64>(static_cast<f64>(read<f32>(address)));
+        case ValueKind::I64:
+        case ValueKind::F64:
+        case ValueKind::Pointer:
+            return read<u64>(address);
+        case ValueKind::None:
+        case ValueKind::Aggregate:
+            break;
+    }
+
+    return 0;
+}
+
+static void store(ValueKind kind, u8* address, u64 value) {
+    switch (kind) {
+        case ValueKind::I8:
+        case ValueKind::U8:
+            return write(address, static_cast<u8>(value));
+        case ValueKind::I16:
+        case ValueKind::U16:
+            return write(address, static_cast<u16>(value));
+        case ValueKind::I32:
+        case ValueKind::U32:
+            return write(address, static_cast<u32>(value));
+        case ValueKind::F32:
+            return write(address, static_cast<f32>(as_float(value)));
+        case ValueKind::I64:
+        case ValueKind::F64:
+        case ValueKind::Pointer:
+            return write(address, value);
+        case ValueKind::None:
+        case ValueKind::Aggregate:
+            break;
+    }
+}
+
+static ValueKind kind_of(DataLayout const& data_layout, Type* type) {
+    type = scalar_type_of(type);
+    if (!type) {
+        return ValueKind::None;
+    }
+
+    switch (type->kind()) {
+        case TypeKind::Float:
+            return ValueKind::F32;
+        case TypeKind::Double:
+            return ValueKind::F64;
+        case TypeKind::Int: {
+            bool is_signed = !type->is_int_unsigned() && type->get_int_bit_width() > 1;
+            switch (data_layout.size_of(type)) {
+                case 1: return is_signed ? ValueKind::I8 : ValueKind::U8;
+                case 2: return is_signed ? ValueKind::I16 : ValueKind::U16;
+                case 4: return is_signed ? ValueKind::I32 : ValueKind::U32;
+                default: return ValueKind::I64;
+            }
+        }
+        case TypeKind::Pointer:
+        case TypeKind::Reference:
+            return ValueKind::Pointer;
+        case TypeKind::Struct:
+        case TypeKind::Array:
+        case TypeKind::Tuple:
+            return ValueKind::Aggregate;
+        default:
+            return ValueKind::None;
+    }
+}
+
+// Lowers the basic blocks of a single function into a `CompiledFunction`
+class FunctionCompiler {
+public:
+    FunctionCompiler(
+        State& state, DataLayout const& data_layout, CompiledFunction& compiled
+    ) : m_state(state), m_data_layout(data_layout), m_compiled(compiled) {}
+
+    ErrorOr<void> compile(Function* function);
+
+private:
+    struct PendingJump {
+        size_t index;
+
+        BasicBlock* target;
+        BasicBlock* false_target;
+    };
+
+    struct Local {
+        u64 offset;
+        bool is_alias;
+    };
+
+    u32 slot(Register reg);
+    u32 slot(Operand const& operand);
+
+    u32 constant(u64 value);
+    u32 scratch();
+
+    ErrorOr<Local const*> local(size_t index) const;
+
+    u64 reserve(size_t size, size_t alignment);
+
+    ValueKind kind_of(Type* type) const { return quart::bytecode::kind_of(m_data_layout, type); }
+    ErrorOr<ValueKind> memory_kind_of(Type* type) const;
+
+    Operation& emit(Opcode opcode, u32 dst = 0, u32 a = 0, u32 b = 0, u64 value = 0, u64 extra = 0);
+
+    ErrorOr<void> emit_memory_access(Opcode opcode, Type* type, u32 dst, u32 a, u32 b, u64 value);
+    ErrorOr<void> emit_aggregate_stores(u32 dst, Type* type, Vector<Operand> const& elements);
+
+    void emit_integer_operation(Opcode opcode, u32 dst, Type* type, u32 lhs, u32 rhs);
+
+    // Returns the slot holding the base address and the offset of the member relative to it
+    ErrorOr<Pair<u32, u64>> member_address(Register src, Operand index);
+
+    ErrorOr<void> compile(Instruction const& inst);
+    ErrorOr<void> compile_binary(BinaryOp op, Register dst, Operand lhs, Operand rhs);
+    ErrorOr<void> compile_cast(Cast const& inst);
+    ErrorOr<void> compile_call(bytecode::Call const& inst);
+
+    State& m_state;
+    DataLayout const& m_data_layout;
+
+    CompiledFunction& m_compiled;
+    Function* m_function = nullptr;
+
+    HashMap<u32, u32> m_slots;
+    Set<u32> m_function_slots;
+
+    Vector<Local> m_locals;
+    Vector<PendingJump> m_jumps;
+};
+
+u32 FunctionCompiler::slot(Register reg) {
+    auto iterator = m_slots.find(reg.index());
+    if (iterator != m_slots.end()) {
+        return iterator->second;
+    }
+
+    u32 slot = this->scratch();
+    m_slots[reg.index()] = slot;
+
+    Type* type = m_state.type(reg);
+    if (type && type->is_aggregate()) {
+        auto& layout = m_data_layout.layout_of(type);
+        m_compiled.aggregate_registers.emplace_back(slot, this->reserve(layout.size, layout.alignment));
+    }
+
+    return slot;
+}
+
+u32 FunctionCompiler::slot(Operand const& operand) {
+    if (operand.is_register()) {
+        return this->slot(operand.reg());
+    }
+
+    Type* type = scalar_type_of(operand.value_type());
+    if (type && type->is_int()) {
+        return this->constant(normalize(operand.value(), type->get_int_bit_width(), !type->is_int_unsigned()));
+    }
+
+    return this->constant(operand.value());
+}
+
+u32 FunctionCompiler::constant(u64 value) {
+    u32 slot = this->scratch();
+    m_compiled.initial_registers[slot] = value;
+
+    return slot;
+}
+
+u32 FunctionCompiler::scratch() {
+    m_compiled.initial_registers.push_back(0);
+    return m_compiled.initial_registers.size() - 1;
+}
+
+ErrorOr<FunctionCompiler::Local const*> FunctionCompiler::local(size_t index) const {
+    // Constant expressions are compiled into functions of their own, any local they refer to belongs to a different function
+    if (index >= m_locals.size()) {
+        return err(m_function->span(), "Local variables can't be used in a constant expression");
+    }
+
+    return &m_locals[index];
+}
+
+u64 FunctionCompiler::reserve(size_t size, size_t alignment) {
+    u64 offset = align_to(m_compiled.memory_size, std::max<size_t>(alignment, 1));
+    m_compiled.memory_size = offset + size;
+
+    return offset;
+}
+
+ErrorOr<ValueKind> FunctionCompiler::memory_kind_of(Type* type) const {
+    ValueKind kind = this->kind_of(type);
+    if (kind == ValueKind::Pointer && m_data_layout.pointer_size() != sizeof(void*)) {
+        return err(m_function->span(), "Pointers can't be stored in memory at compile time when targeting a {}-bit platform", m_data_layout.pointer_size() * 8);
+    } else if (kind == ValueKind::None) {
+        return err(m_function->span(), "Values of type '{}' can't be stored in memory at compile time", type ? type->str() : "void");
+    }
+
+    return kind;
+}
+
+Operation& FunctionCompiler::emit(Opcode opcode, u32 dst, u32 a, u32 b, u64 value, u64 extra) {
+    return m_compiled.code.emplace_back(Operation { opcode, ValueKind::None, 64, false, dst, a, b, value, extra });
+}
+
+ErrorOr<void> FunctionCompiler::emit_memory_access(Opcode opcode, Type* type, u32 dst, u32 a, u32 b, u64 value) {
+    ValueKind kind = TRY(this->memory_kind_of(type));
+
+    auto& op = this->emit(opcode, dst, a, b, value, m_data_layout.size_of(type));
+    op.kind = kind;
+
+    return {};
+}
+
+ErrorOr<void> FunctionCompiler::emit_aggregate_stores(u32 dst, Type* type, Vector<Operand> const& elements) {
+    if (elements.empty()) {
+        this->emit(Opcode::Zero, 0, dst, 0, m_data_layout.size_of(type));
+        return {};
+    }
+
+    for (auto [index, element] : llvm::enumerate(elements)) {
+        u64 offset = 0;
+        if (type->is_array()) {
+            offset = index * m_data_layout.size_of(type->get_array_element_type());
+        } else {
+            offset = m_data_layout.offset_of(type, index);
+        }
+
+        TRY(this->emit_memory_access(Opcode::Store, m_state.type(element), 0, dst, this->slot(element), offset));
+    }
+
+    return {};
+}
+
+void FunctionCompiler::emit_integer_operation(Opcode opcode, u32 dst, Type* type, u32 lhs, u32 rhs) {
+    auto& op = this->emit(opcode, dst, lhs, rhs);
+    if (type->is_int()) {
+        op.bits = type->get_int_bit_width();
+        op.is_signed = !type->is_int_unsigned();
+    }
+}
+
+ErrorOr<Pair<u32, u64>> FunctionCompiler::member_address(Register src, Operand index) {
+    Type* type = m_state.type(src)->underlying_type();
+    u32 base = this->slot(src);
+
+    // Mirrors the GEP the LLVM backend emits, indexing through a pointer to a pointer treats the base as an array
+    if (type->is_pointer() || type->is_array()) {
+        Type* element = type->is_pointer() ? type->get_pointee_type() : type->get_array_element_type();
+        u64 bound = type->is_array() ? type->get_array_size() : 0;
+
+        u32 address = this->scratch();
+        this->emit(Opcode::AddressIndexed, address, base, this->slot(index), m_data_layout.size_of(element), bound);
+
+        return Pair<u32, u64> { address, 0 };
+    }
+
+    if (!index.is_value()) {
+        return err(m_function->span(), "Members of '{}' can only be accessed with a constant index", type->str());
+    }
+
+    return Pair<u32, u64> { base, m_data_layout.offset_of(type, index.value()) };
+}
+
+ErrorOr<void> FunctionCompiler::compile(Function* function) {
+    m_function = function;
+
+    m_compiled.function = function;
+    m_compiled.is_struct_return = function->is_struct_return();
+
+    Type* return_type = function->return_type();
+    m_compiled.has_scalar_signature = is_scalar(return_type) && std::all_of(
+        function->parameters().begin(), function->parameters().end(), [](auto& parameter) { return is_scalar(parameter.type); }
+    );
+
+    size_t parameter_count = function->parameters().size();
+    for (auto [index, type] : llvm::enumerate(function->locals())) {
+        bool is_byval = index < parameter_count && function->parameters()[index].is_byval();
+        if (is_byval || function->is_struct_local(index)) {
+            m_locals.push_back({ this->reserve(sizeof(u8*), alignof(u8*)), true });
+            continue;
+        }
+
+        if (!type) {
+            m_locals.push_back({ this->reserve(sizeof(u64), alignof(u64)), false });
+            continue;
+        }
+
+        auto& layout = m_data_layout.layout_of(type);
+        m_locals.push_back({ this->reserve(layout.size, layout.alignment), false });
+    }
+
+    for (auto& parameter : function->parameters()) {
+        auto& local = m_locals[parameter.index];
+        ValueKind kind = local.is_alias ? ValueKind::Pointer : TRY(this->memory_kind_of(parameter.type));
+
+        m_compiled.parameters.push_back({ local.offset, kind, m_data_layout.size_of(parameter.type), local.is_alias });
+    }
+
+    HashMap<BasicBlock*, u32> blocks;
+    for (auto* block : function->basic_blocks()) {
+        blocks[block] = m_compiled.code.size();
+        for (auto& inst : block->instructions()) {
+            TRY(this->compile(*inst));
+        }
+    }
+
+    for (auto& jump : m_jumps) {
+        auto& op = m_compiled.code[jump.index];
+
+        auto iterator = blocks.find(jump.target);
+        ASSERT(iterator != blocks.end(), "Jump to a block outside of the function");
+
+        op.value = iterator->second;
+        if (jump.false_target) {
+            iterator = blocks.find(jump.false_target);
+            ASSERT(iterator != blocks.end(), "Jump to a block outside of the function");
+
+            op.extra = iterator->second;
+        }
+    }
+
+    m_compiled.memory_size = align_to(m_compiled.memory_size, 16);
+    if (m_compiled.initial_registers.size() % 2) {
+        m_compiled.initial_registers.push_back(0);
+    }
+
+    return {};
+}
+
+ErrorOr<void> FunctionCompiler::compile_binary(BinaryOp op, Register dst, Operand lhs, Operand rhs) {
+    Type* type = scalar_type_of(m_state.type(lhs));
+    Type* result = scalar_type_of(m_state.type(dst));
+
+    u32 d = this->slot(dst);
+    u32 a = this->slot(lhs);
+    u32 b = this->slot(rhs);
+
+    if (type->is_floating_point()) {
+        Opcode opcode = Opcode::FAdd;
+        switch (op) {
+            case BinaryOp::Add: opcode = Opcode::FAdd; break;
+            case BinaryOp::Sub: opcode = Opcode::FSub; break;
+            case BinaryOp::Mul: opcode = Opcode::FMul; break;
+            case BinaryOp::Div: opcode = Opcode::FDiv; break;
+            case BinaryOp::Mod: opcode = Opcode::FRem; break;
+            case BinaryOp::Eq: opcode = Opcode::FEq; break;
+            case BinaryOp::Neq: opcode = Opcode::FNeq; break;
+            case BinaryOp::Lt: opcode = Opcode::FLt; break;
+            case BinaryOp::Lte: opcode = Opcode::FLte; break;
+            case BinaryOp::Gt: opcode = Opcode::FGt; break;
+            case BinaryOp::Gte: opcode = Opcode::FGte; break;
+            default:
+                return err(m_function->span(), "Invalid operation on floating point values in a constant expression");
+        }
+
+        auto& instruction = this->emit(opcode, d, a, b);
+        instruction.kind = this->kind_of(type);
+
+        return {};
+    }
+
+    bool is_signed = type->is_int() && !type->is_int_unsigned();
+    switch (op) {
+        case BinaryOp::Add: this->emit_integer_operation(Opcode::Add, d, result, a, b); break;
+        case BinaryOp::Sub: this->emit_integer_operation(Opcode::Sub, d, result, a, b); break;
+        case BinaryOp::Mul: this->emit_integer_operation(Opcode::Mul, d, result, a, b); break;
+        case BinaryOp::Div: this->emit_integer_operation(is_signed ? Opcode::SDiv : Opcode::UDiv, d, result, a, b); break;
+        case BinaryOp::Mod: this->emit_integer_operation(is_signed ? Opcode::SRem : Opcode::URem, d, result, a, b); break;
+        case BinaryOp::Or: this->emit_integer_operation(Opcode::Or, d, result, a, b); break;
+        case BinaryOp::And: this->emit_integer_operation(Opcode::And, d, result, a, b); break;
+        case BinaryOp::Xor: this->emit_integer_operation(Opcode::Xor, d, result, a, b); break;
+        case BinaryOp::Lsh: this->emit_integer_operation(Opcode::Shl, d, result, a, b); break;
+        case BinaryOp::Rsh: this->emit_integer_operation(Opcode::Shr, d, result, a, b); break;
+        case BinaryOp::LogicalOr: this->emit(Opcode::LogicalOr, d, a, b); break;
+        case BinaryOp::LogicalAnd: this->emit(Opcode::LogicalAnd, d, a, b); break;
+        case BinaryOp::Eq: this->emit(Opcode::Eq, d, a, b); break;
+        case BinaryOp::Neq: this->emit(Opcode::Neq, d, a, b); break;
+        case BinaryOp::Lt: this->emit(is_signed ? Opcode::SLt : Opcode::ULt, d, a, b); break;
+        case BinaryOp::Lte: this->emit(is_signed ? Opcode::SLte : Opcode::ULte, d, a, b); break;
+        case BinaryOp::Gt: this->emit(is_signed ? Opcode::SGt : Opcode::UGt, d, a, b); break;
+        case BinaryOp::Gte: this->emit(is_signed ? Opcode::SGte : Opcode::UGte, d, a, b); break;
+        default:
+            return err(m_function->span(), "Invalid binary operation in a constant expression");
+    }
+
+    return {};
+}
+
+ErrorOr<void> FunctionCompiler::compile_cast(Cast const& inst) {
+    Type* from = scalar_type_of(m_state.type(inst.src()));
+    Type* to = scalar_type_of(inst.type());
+
+    u32 dst = this->slot(inst.dst());
+    u32 src = this->slot(inst.src());
+
+    Opcode opcode = Opcode::Copy;
+    if (from->is_int()) {
+        if (to->is_floating_point()) {
+            opcode = from->is_int_unsigned() ? Opcode::UIToFP : Opcode::SIToFP;
+        } else if (to->is_int()) {
+            opcode = Opcode::IntCast;
+        }
+    } else if (from->is_floating_point()) {
+        if (to->is_floating_point()) {
+            opcode = Opcode::FPCast;
+        } else if (to->is_int()) {
+            opcode = to->is_int_unsigned() ? Opcode::FPToUI : Opcode::FPToSI;
+        }
+    } else if (from->is_pointer() && to->is_int()) {
+        opcode = to->get_int_bit_width() == 1 ? Opcode::IsNotNull : Opcode::IntCast;
+    }
+
+    auto& op = this->emit(opcode, dst, src);
+    op.kind = this->kind_of(to);
+
+    if (to->is_int()) {
+        op.bits = to->get_int_bit_width();
+        op.is_signed = !to->is_int_unsigned();
+    }
+
+    return {};
+}
+
+ErrorOr<void> FunctionCompiler::compile_call(bytecode::Call const& inst) {
+    u32 callee = this->slot(inst.function());
+    if (!m_function_slots.contains(callee)) {
+        m_compiled.is_pure = false;
+    }
+
+    u64 start = m_compiled.call_arguments.size();
+    for (auto& argument : inst.arguments()) {
+        m_compiled.call_arguments.push_back(this->slot(argument));
+        m_compiled.call_argument_kinds.push_back(this->kind_of(m_state.type(argument)));
+    }
+
+    // Aggregates other than structs are returned by value and have to be copied out of the callee's frame
+    Type* return_type = inst.function_type()->return_type();
+    u32 size = 0;
+
+    if (return_type->is_aggregate() && !return_type->is_struct()) {
+        size = m_data_layout.size_of(return_type);
+    }
+
+    this->emit(Opcode::Call, this->slot(inst.dst()), callee, size, start, inst.arguments().size());
+    return {};
+}
+
+ErrorOr<void> FunctionCompiler::compile(Instruction const& inst) {
+    switch (inst.type()) {
+        case Instruction::Move: {
+            auto& mov = static_cast<bytecode::Move const&>(inst);
+            Type* type = scalar_type_of(m_state.type(mov.dst()));
+
+            u64 value = mov.src();
+            if (type->is_floating_point()) {
+                value = from_float(as_float(value), this->kind_of(type));
+            } else if (type->is_int()) {
+                value = normalize(value, type->get_int_bit_width(), !type->is_int_unsigned());
+            }
+
+            this->emit(Opcode::Constant, this->slot(mov.dst()), 0, 0, value);
+            break;
+        }
+        case Instruction::NewString: {
+            auto& string = static_cast<NewString const&>(inst);
+            auto& value = m_compiled.strings.emplace_back(string.value());
+
+            this->emit(Opcode::Constant, this->slot(string.dst()), 0, 0, reinterpret_cast<u64>(value.c_str()));
+            break;
+        }
+        case Instruction::NewArray: {
+            auto& array = static_cast<NewArray const&>(inst);
+            TRY(this->emit_aggregate_stores(this->slot(array.dst()), array.type(), array.elements()));
+
+            break;
+        }
+        case Instruction::NewTuple: {
+            auto& tuple = static_cast<NewTuple const&>(inst);
+            TRY(this->emit_aggregate_stores(this->slot(tuple.dst()), tuple.type(), tuple.elements()));
+
+            break;
+        }
+        case Instruction::Construct: {
+            auto& construct = static_cast<Construct const&>(inst);
+            Type* type = construct.structure()->underlying_type();
+
+            TRY(this->emit_aggregate_stores(this->slot(construct.dst()), type, construct.arguments()));
+            break;
+        }
+        case Instruction::NewLocalScope:
+        case Instruction::NewFunction:
+        case Instruction::NewStruct:
+            break;
+        case Instruction::GetLocal: {
+            auto& get = static_cast<GetLocal const&>(inst);
+            auto& local = *TRY(this->local(get.index()));
+
+            Type* type = m_function->locals()[get.index()];
+            TRY(this->emit_memory_access(local.is_alias ? Opcode::LoadAlias : Opcode::LoadFrame, type, this->slot(get.dst()), 0, 0, local.offset));
+
+            break;
+        }
+        case Instruction::GetLocalRef: {
+            auto& get = static_cast<GetLocalRef const&>(inst);
+            auto& local = *TRY(this->local(get.index()));
+
+            this->emit(local.is_alias ? Opcode::AliasAddress : Opcode::FrameAddress, this->slot(get.dst()), 0, 0, local.offset);
+            break;
+        }
+        case Instruction::SetLocal: {
+            auto& set = static_cast<SetLocal const&>(inst);
+            auto& local = *TRY(this->local(set.index()));
+
+            Optional<Operand> src = set.src();
+            Type* type = m_function->locals()[set.index()];
+
+            if (local.is_alias) {
+                ASSERT(src.has_value(), "Struct locals must be set to a value");
+                this->emit(Opcode::StoreAlias, 0, this->slot(*src), 0, local.offset);
+            } else if (src.has_value()) {
+                TRY(this->emit_memory_access(Opcode::StoreFrame, type, 0, this->slot(*src), 0, local.offset));
+            } else {
+                this->emit(Opcode::ZeroFrame, 0, 0, 0, local.offset, m_data_layout.size_of(type));
+            }
+
+            break;
+        }
+        case Instruction::GetGlobal: {
+            auto& get = static_cast<GetGlobal const&>(inst);
+            m_compiled.is_pure = false;
+
+            TRY(this->emit_memory_access(Opcode::LoadGlobal, m_state.type(get.dst()), this->slot(get.dst()), 0, 0, get.index()));
+            break;
+        }
+        case Instruction::GetGlobalRef: {
+            auto& get = static_cast<GetGlobalRef const&>(inst);
+            m_compiled.is_pure = false;
+
+            this->emit(Opcode::GlobalAddress, this->slot(get.dst()), 0, 0, get.index());
+            break;
+        }
+        case Instruction::SetGlobal: {
+            auto& set = static_cast<SetGlobal const&>(inst);
+            m_compiled.is_pure = false;
+
+            this->emit(Opcode::SetGlobal, 0, 0, 0, set.index(), reinterpret_cast<u64>(set.src()));
+            break;
+        }
+        case Instruction::GetMember: {
+            auto& get = static_cast<GetMember const&>(inst);
+            auto [base, offset] = TRY(this->member_address(get.src(), get.index()));
+
+            TRY(this->emit_memory_access(Opcode::Load, m_state.type(get.dst()), this->slot(get.dst()), base, 0, offset));
+            break;
+        }
+        case Instruction::GetMemberRef: {
+            auto& get = static_cast<GetMemberRef const&>(inst);
+            auto [base, offset] = TRY(this->member_address(get.src(), get.index()));
+
+            this->emit(Opcode::Address, this->slot(get.dst()), base, 0, offset);
+            break;
+        }
+        case Instruction::SetMember: {
+            auto& set = static_cast<SetMember const&>(inst);
+            auto [base, offset] = TRY(this->member_address(set.dst(), set.index()));
+
+            TRY(this->emit_memory_access(Opcode::Store, m_state.type(set.src()), 0, base, this->slot(set.src()), offset));
+            break;
+        }
+        case Instruction::Read: {
+            auto& read = static_cast<Read const&>(inst);
+            Type* type = m_state.type(read.src())->underlying_type();
+
+            TRY(this->emit_memory_access(Opcode::Load, type, this->slot(read.dst()), this->slot(read.src()), 0, 0));
+            break;
+        }
+        case Instruction::Write: {
+            auto& write = static_cast<Write const&>(inst);
+            TRY(this->emit_memory_access(Opcode::Store, m_state.type(write.src()), 0, this->slot(write.dst()), this->slot(write.src()), 0));
+
+            break;
+        }
+
+    // NOLINTNEXTLINE
+    #define Op(x)                                                                           \
+        case Instruction::x: {                                                              \
+            auto& operation = static_cast<bytecode::x const&>(inst);                        \
+            TRY(this->compile_binary(BinaryOp::x, operation.dst(), operation.lhs(), operation.rhs())); \
+            break;                                                                          \
+        }
+        ENUMERATE_BINARY_OPS(Op)
+    #undef Op
+
+        case Instruction::Not: {
+            auto& n = static_cast<bytecode::Not const&>(inst);
+            this->emit(Opcode::Not, this->slot(n.dst()), this->slot(n.src()));
+
+            break;
+        }
+        case Instruction::Boolean: {
+            auto& boolean = static_cast<Boolean const&>(inst);
+            this->emit(Opcode::Constant, this->slot(boolean.dst()), 0, 0, boolean.value());
+
+            break;
+        }
+        case Instruction::Null: {
+            auto& null = static_cast<Null const&>(inst);
+            u32 dst = this->slot(null.dst());
+
+            if (null.type()->is_aggregate()) {
+                this->emit(Opcode::Zero, 0, dst, 0, m_data_layout.size_of(null.type()));
+            } else {
+                this->emit(Opcode::Constant, dst, 0, 0, 0);
+            }
+
+            break;
+        }
+        case Instruction::Cast:
+            TRY(this->compile_cast(static_cast<Cast const&>(inst)));
+            break;
+        case Instruction::Alloca: {
+            auto& alloca = static_cast<Alloca const&>(inst);
+            auto& layout = m_data_layout.layout_of(alloca.type());
+
+            // Like the LLVM backend every alloca gets a single slot for the whole call, frames start out zeroed
+            this->emit(Opcode::FrameAddress, this->slot(alloca.dst()), 0, 0, this->reserve(layout.size, layout.alignment));
+            break;
+        }
+        case Instruction::Memcpy: {
+            auto& copy = static_cast<bytecode::Memcpy const&>(inst);
+            this->emit(Opcode::Memcpy, 0, this->slot(copy.dst()), this->slot(copy.src()), copy.size());
+
+            break;
+        }
+        case Instruction::GetReturn: {
+            auto& get = static_cast<GetReturn const&>(inst);
+            this->emit(Opcode::ReturnAddress, this->slot(get.dst()));
+
+            break;
+        }
+        case Instruction::GetFunction: {
+            auto& get = static_cast<GetFunction const&>(inst);
+            u32 dst = this->slot(get.dst());
+
+            m_function_slots.insert(dst);
+            m_compiled.callees.push_back(get.function());
+
+            this->emit(Opcode::Constant, dst, 0, 0, reinterpret_cast<u64>(get.function()));
+            break;
+        }
+        case Instruction::Call:
+            TRY(this->compile_call(static_cast<bytecode::Call const&>(inst)));
+            break;
+        case Instruction::Return: {
+            auto& ret = static_cast<bytecode::Return const&>(inst);
+            if (ret.value().has_value()) {
+                this->emit(Opcode::ReturnValue, 0, this->slot(*ret.value()));
+            } else {
+                this->emit(Opcode::Return);
+            }
+
+            break;
+        }
+        case Instruction::Jump: {
+            auto& jump = static_cast<bytecode::Jump const&>(inst);
+
+            m_jumps.push_back({ m_compiled.code.size(), jump.target(), nullptr });
+            this->emit(Opcode::Jump);
+
+            break;
+        }
+        case Instruction::JumpIf: {
+            auto& jump = static_cast<JumpIf const&>(inst);
+
+            m_jumps.push_back({ m_compiled.code.size(), jump.true_target(), jump.false_target() });
+            this->emit(Opcode::JumpIf, 0, this->slot(jump.condition()));
+
+            break;
+        }
+        case Instruction::Copy: {
+            auto& copy = static_cast<bytecode::Copy const&>(inst);
+            this->emit(Opcode::Copy, this->slot(copy.dst()), this->slot(copy.src()));
+
+            break;
+        }
+        case Instruction::Phi:
+            // Bodies are interpreted straight out of the generator, before any pass puts them into SSA form
+            return err(m_function->span(), "Functions in SSA form can't be interpreted");
+    }
+
+    return {};
+}
+
+Interpreter::Interpreter(
+    State& state, ExecutionMode mode
+) : m_state(state), m_data_layout(state.context().data_layout()), m_mode(mode) {
+    bool is_program = mode == ExecutionMode::Program;
+
+    m_max_steps = is_program ? std::numeric_limits<u64>::max() : MAX_STEPS;
+    m_max_depth = is_program ? std::numeric_limits<size_t>::max() : MAX_CALL_DEPTH;
+}
+
+Interpreter::~Interpreter() {
+    for (auto* library : m_libraries) {
+        dlclose(library);
+    }
+}
+
+ErrorOr<void> Interpreter::load_library(String const& name, std::set<String> const& paths) {
+    String filename = format("lib{}.so", name);
+    for (auto& path : paths) {
+        String candidate = format("{}/{}", path, filename);
+        if (void* library = dlopen(candidate.c_str(), RTLD_NOW | RTLD_GLOBAL)) {
+            m_libraries.push_back(library);
+            return {};
+        }
+    }
+
+    void* library = dlopen(filename.c_str(), RTLD_NOW | RTLD_GLOBAL);
+    if (!library) {
+        return err("Could not load library '{}': {}", name, dlerror());
+    }
+
+    m_libraries.push_back(library);
+    return {};
+}
+
+ErrorOr<bool> Interpreter::ensure_body(Function* function) {
+    if (function->has_trait_parameter()) {
+        return false;
+    }
+
+    if (function->is_decl()) {
+        // Generating a body resets the return register of whatever function is currently being generated
+        auto return_register = m_state.return_register();
+
+        m_state.reference_function(function);
+        auto generated = m_state.generate_deferred_functions();
+
+        if (return_register.has_value()) {
+            m_state.inject_return(*return_register);
+        }
+
+        TRY(generated);
+    }
+
+    if (function->is_decl()) {
+        return false;
+    }
+
+    // The body is still being generated when a function is called from a constant expression inside of itself.
+    // Specializations never get a separate return block so their body is complete as soon as they're not a declaration.
+    auto* return_block = function->return_block();
+    if (!return_block) {
+        return true;
+    }
+
+    auto& blocks = function->basic_blocks();
+    return std::find(blocks.begin(), blocks.end(), return_block) != blocks.end();
+}
+
+ErrorOr<CompiledFunction*> Interpreter::compile(Function* function) {
+    auto& entry = m_functions[function];
+    if (entry) {
+        return entry.get();
+    }
+
+    if (!TRY(this->ensure_body(function))) {
+        if (function->is_extern() && m_mode == ExecutionMode::Program) {
+            return this->compile_native(function);
+        } else if (function->is_extern()) {
+            return err(m_span, "Cannot call extern function '{}' at compile time", function->qualified_name());
+        }
+
+        return err(m_span, "Function '{}' must be defined before it can be called at compile time", function->qualified_name());
+    }
+
+    auto compiled = make<CompiledFunction>();
+
+    FunctionCompiler compiler(m_state, m_data_layout, *compiled);
+    TRY(compiler.compile(function));
+
+    for (auto& string : compiled->strings) {
+        m_static_regions.push_back({ reinterpret_cast<u8 const*>(string.data()), string.size() + 1, false });
+    }
+
+    // Only functions the interpreter has seen referenced can be called through a register
+    for (auto* callee : compiled->callees) {
+        m_functions.try_emplace(callee);
+    }
+
+    // Generating a body can add entries to the map, so the reference from before can't be used anymore
+    auto* result = compiled.get();
+    m_functions[function] = move(compiled);
+
+    return result;
+}
+
+ErrorOr<CompiledFunction*> Interpreter::compile_native(Function* function) {
+    if (!FFI_INTEGER_REGISTERS) {
+        return err(m_span, "Calling extern functions from the interpreter is not supported on this platform");
+    }
+
+    void* address = dlsym(RTLD_DEFAULT, function->qualified_name().str().data());
+    for (auto* library : m_libraries) {
+        if (address) {
+            break;
+        }
+
+        address = dlsym(library, function->qualified_name().str().data());
+    }
+
+    if (!address) {
+        return err(m_span, "Could not find extern function '{}'", function->qualified_name());
+    }
+
+    auto compiled = make<CompiledFunction>();
+
+    compiled->function = function;
+    compiled->native = address;
+    compiled->is_pure = false;
+
+    Type* return_type = function->return_type();
+    if (!return_type->is_void()) {
+        compiled->native_return = kind_of(m_data_layout, return_type);
+    }
+
+    for (auto& parameter : function->parameters()) {
+        ValueKind kind = kind_of(m_data_layout, parameter.type);
+        if (kind == ValueKind::Aggregate || kind == ValueKind::None) {
+            return err(m_span, "Cannot pass a value of type '{}' to extern function '{}'", parameter.type->str(), function->qualified_name());
+        }
+
+        compiled->parameters.push_back({ 0, kind, m_data_layout.size_of(parameter.type), false });
+    }
+
+    if (compiled->native_return == ValueKind::Aggregate) {
+        return err(m_span, "Cannot return a value of type '{}' from extern function '{}'", return_type->str(), function->qualified_name());
+    }
+
+    auto* result = compiled.get();
+    m_functions[function] = move(compiled);
+
+    return result;
+}
+
+ErrorOr<u64> Interpreter::call_native(CompiledFunction& function, u64 const* arguments, ValueKind const* kinds, size_t count) {
+    u64 integers[8] = {};
+    f64 floats[8] = {};
+
+    size_t integer_count = 0;
+    size_t float_count = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        // Variadic arguments only have the kind of the value being passed, floats among them are promoted to doubles
+        bool is_variadic = i >= function.parameters.size();
+        ValueKind kind = is_variadic ? kinds[i] : function.parameters[i].kind;
+
+        if (kind == ValueKind::F32 || kind == ValueKind::F64) {
+            if (float_count == FFI_FLOAT_REGISTERS) {
+                return err(m_span, "Too many floating point arguments passed to extern function '{}'", function.function->qualified_name());
+            }
+
+            f64 value = as_float(arguments[i]);
+            if (kind == ValueKind::F32 && !is_variadic) {
+                // A float lives in the low 32 bits of the register
+                value = std::bit_cast<f64>(static_cast<u64>(std::bit_cast<u32>(static_cast<f32>(value))));
+            }
+
+            floats[float_count++] = value;
+        } else if (kind == ValueKind::Aggregate) {
+            return err(m_span, "Cannot pass an aggregate to extern function '{}'", function.function->qualified_name());
+        } else {
+            if (integer_count == FFI_INTEGER_REGISTERS) {
+                return err(m_span, "Too many arguments passed to extern function '{}'", function.function->qualified_name());
+            }
+
+            integers[integer_count++] = arguments[i];
+        }
+    }
+
+    auto invoke = [&]<typename R>() -> R {
+        auto prototype = reinterpret_cast<NativePrototype<R>>(function.native);
+        return prototype(
+            integers[0], integers[1], integers[2], integers[3], integers[4], integers[5], integers[6], integers[7],
+            floats[0], floats[1], floats[2], floats[3], floats[4], floats[5], floats[6], floats[7]
+        );
+    };
+
+    switch (function.native_return) {
+        case ValueKind::F32:
+            return from_float(invoke.operator()<f32>(), ValueKind::F32);
+        case ValueKind::F64:
+            return from_float(invoke.operator()<f64>(), ValueKind::F64);
+        case ValueKind::None:
+            invoke.operator()<u64>();
+            return 0;
+        default:
+            break;
+    }
+
+    // Only the low bits of the return register are defined for narrow integers
+    u64 value = invoke.operator()<u64>();
+
+    u8 buffer[sizeof(u64)];
+    store(function.native_return, buffer, value);
+
+    return load(function.native_return, buffer);
+}
+
+ErrorOr<bool> Interpreter::is_memoizable(CompiledFunction* function) {
+    if (function->is_memoizable.has_value()) {
+        return *function->is_memoizable;
+    }
+
+    // A call can only be replaced by its previous result if nothing it can reach has effects outside of its own frames
+    bool result = function->has_scalar_signature;
+
+    Vector<CompiledFunction*> worklist = { function };
+    HashMap<Function*, bool> visited;
+
+    visited[function->function] = true;
+    while (result && !worklist.empty()) {
+        auto* current = worklist.back();
+        worklist.pop_back();
+
+        if (!current->is_pure) {
+            result = false;
+            break;
+        }
+
+        for (auto* callee : current->callees) {
+            if (visited.contains(callee)) {
+                continue;
+            }
+
+            visited[callee] = true;
+            if (!TRY(this->ensure_body(callee))) {
+                result = false;
+                break;
+            }
+
+            worklist.push_back(TRY(this->compile(callee)));
+        }
+    }
+
+    function->is_memoizable = result;
+    return result;
+}
+
+u8* Interpreter::allocate(size_t size, bool is_writable) {
+    auto& allocation = m_allocations.emplace_back(new u8[std::max<size_t>(size, 1)]());
+    m_regions.push_back({ allocation.get(), size, is_writable });
+
+    return allocation.get();
+}
+
+bool Interpreter::is_valid_address(u8 const* address, size_t size, bool is_write) const {
+    auto contains = [&](u8 const* start, size_t length) {
+        return address >= start && size <= length && static_cast<size_t>(address - start) <= length - size;
+    };
+
+    if (m_stack && contains(m_stack.get(), m_stack_top)) {
+        return true;
+    }
+
+    for (auto& region : m_regions) {
+        if (contains(region.start, region.size)) {
+            return region.is_writable || !is_write;
+        }
+    }
+
+    for (auto& region : m_static_regions) {
+        if (contains(region.start, region.size)) {
+            return region.is_writable || !is_write;
+        }
+    }
+
+    return false;
+}
+
+ErrorOr<u8*> Interpreter::global_address(u32 index) {
+    auto iterator = m_globals.find(index);
+    if (iterator != m_globals.end()) {
+        return iterator->second;
+    }
+
+    for (auto& global : m_state.globals()) {
+        if (global->index() != index) {
+            continue;
+        }
+
+        u8* address = this->allocate(m_data_layout.size_of(global->value_type()));
+        if (global->initializer()) {
+            TRY(this->store_constant(address, global->initializer()));
+        }
+
+        m_globals[index] = address;
+        return address;
+    }
+
+    return err(m_span, "Global variable is not available at compile time");
+}
+
+ErrorOr<void> Interpreter::store_constant(u8* address, Constant* constant) {
+    Type* type = constant->type();
+    switch (constant->kind()) {
+        case Constant::Kind::Array: {
+            auto* array = cast_unchecked<ConstantArray>(constant);
+            size_t size = m_data_layout.size_of(type->get_array_element_type());
+
+            for (auto [index, element] : llvm::enumerate(array->elements())) {
+                TRY(this->store_constant(address + index * size, element));
+            }
+
+            return {};
+        }
+        case Constant::Kind::Struct: {
+            auto* structure = cast_unchecked<ConstantStruct>(constant);
+            for (auto [index, field] : llvm::enumerate(structure->fields())) {
+                TRY(this->store_constant(address + m_data_layout.offset_of(type, index), field));
+            }
+
+            return {};
+        }
+        case Constant::Kind::Null:
+            std::memset(address, 0, m_data_layout.size_of(type));
+            return {};
+        default:
+            break;
+    }
+
+    u64 value = TRY(this->to_value(constant));
+    if (type->is_pointer() && m_data_layout.pointer_size() != sizeof(void*)) {
+        return err(m_span, "Pointers can't be stored in memory at compile time when targeting a {}-bit platform", m_data_layout.pointer_size() * 8);
+    }
+
+    Type* scalar = scalar_type_of(type);
+    if (scalar->is_float()) {
+        store(ValueKind::F32, address, value);
+    } else if (scalar->is_pointer() || scalar->is_double()) {
+        store(ValueKind::I64, address, value);
+    } else {
+        std::memcpy(address, &value, m_data_layout.size_of(type));
+    }
+
+    return {};
+}
+
+ErrorOr<u64> Interpreter::to_value(Constant* constant) {
+    Type* type = scalar_type_of(constant->type());
+    switch (constant->kind()) {
+        case Constant::Kind::Int: {
+            u64 value = cast_unchecked<ConstantInt>(constant)->value();
+            if (!type->is_int()) {
+                return value;
+            }
+
+            return normalize(value, type->get_int_bit_width(), !type->is_int_unsigned());
+        }
+        case Constant::Kind::Float: {
+            f64 value = cast_unchecked<ConstantFloat>(constant)->value();
+            return from_float(value, type->is_float() ? ValueKind::F32 : ValueKind::F64);
+        }
+        case Constant::Kind::String: {
+            String value = cast_unchecked<ConstantString>(constant)->value();
+
+            u8* address = this->allocate(value.size() + 1, false);
+            std::memcpy(address, value.c_str(), value.size() + 1);
+
+            return reinterpret_cast<u64>(address);
+        }
+        case Constant::Kind::Array:
+        case Constant::Kind::Struct: {
+            u8* address = this->allocate(m_data_layout.size_of(type));
+            TRY(this->store_constant(address, constant));
+
+            return reinterpret_cast<u64>(address);
+        }
+        case Constant::Kind::Null:
+            return 0;
+    }
+
+    return 0;
+}
+
+ErrorOr<Constant*> Interpreter::to_constant(Type* type, u64 value) {
+    auto& context = m_state.context();
+    Type* scalar = scalar_type_of(type);
+
+    if (scalar->is_int()) {
+        return ConstantInt::get(context, type, value);
+    } else if (scalar->is_floating_point()) {
+        return ConstantFloat::get(context, type, as_float(value));
+    } else if (scalar->is_pointer()) {
+        if (!value) {
+            return ConstantNull::get(context, type);
+        }
+
+        // Pointers can't outlive the call, strings are the only thing they can point to that can be turned into a constant
+        auto* address = reinterpret_cast<u8 const*>(value);
+        if (scalar->get_pointee_type()->is_int() && scalar->get_pointee_type()->get_int_bit_width() == 8) {
+            size_t length = 0;
+            while (this->is_valid_address(address + length, 1, false)) {
+                if (!address[length]) {
+                    return ConstantString::get(context, type, String(reinterpret_cast<char const*>(address), length));
+                }
+
+                length++;
+            }
+        }
+
+        return err(m_span, "A pointer computed at compile time can't be used as a constant");
+    }
+
+    if (!scalar->is_array() && !scalar->is_struct()) {
+        return err(m_span, "A value of type '{}' can't be used as a constant", type->str());
+    }
+
+    auto* address = reinterpret_cast<u8 const*>(value);
+    auto element_at = [&](Type* element, size_t offset) -> ErrorOr<Constant*> {
+        u8 const* field = address + offset;
+        if (element->is_aggregate()) {
+            return this->to_constant(element, reinterpret_cast<u64>(field));
+        }
+
+        return this->to_constant(element, load(kind_of(m_data_layout, element), field));
+    };
+
+    Vector<Constant*> elements;
+    if (scalar->is_array()) {
+        Type* element = scalar->get_array_element_type();
+        size_t size = m_data_layout.size_of(element);
+
+        elements.reserve(scalar->get_array_size());
+        for (size_t i = 0; i < scalar->get_array_size(); i++) {
+            elements.push_back(TRY(element_at(element, i * size)));
+        }
+
+        return ConstantArray::get(context, type, elements);
+    }
+
+    auto& fields = cast_unchecked<StructType>(scalar)->fields();
+    for (auto [index, field] : llvm::enumerate(fields)) {
+        elements.push_back(TRY(element_at(field, m_data_layout.offset_of(scalar, index))));
+    }
+
+    return ConstantStruct::get(context, type, elements);
+}
+
+ErrorOr<Constant*> Interpreter::call(Span span, Function* function, Vector<Constant*> const& arguments) {
+    TemporaryChange<Span> change(m_span, span);
+    m_steps = 0;
+
+    size_t allocations = m_allocations.size();
+    auto result = this->run(function, arguments);
+
+    // Globals and whatever the arguments were materialized into only live for a single top level call
+    m_allocations.resize(allocations);
+    m_regions.resize(allocations);
+    m_globals.clear();
+
+    return result;
+}
+
+ErrorOr<void> Interpreter::call_and_commit_globals(Span span, Function* function) {
+    TemporaryChange<Span> change(m_span, span);
+    m_steps = 0;
+
+    auto run = [&]() -> ErrorOr<void> {
+        TRY(this->run(function, {}));
+        return this->commit_globals();
+    };
+
+    size_t allocations = m_allocations.size();
+    auto result = run();
+
+    m_allocations.resize(allocations);
+    m_regions.resize(allocations);
+    m_globals.clear();
+
+    return result;
+}
+
+ErrorOr<void> Interpreter::commit_globals() {
+    // Globals are only materialized once something touches them, and most of those are only ever read
+    for (auto& global : m_state.globals()) {
+        auto iterator = m_globals.find(global->index());
+        if (iterator == m_globals.end()) {
+            continue;
+        }
+
+        Type* type = global->value_type();
+        size_t size = m_data_layout.size_of(type);
+
+        u8* initial = this->allocate(size);
+        if (global->initializer()) {
+            TRY(this->store_constant(initial, global->initializer()));
+        }
+
+        u8* address = iterator->second;
+        if (std::memcmp(initial, address, size) == 0) {
+            continue;
+        }
+
+        u64 value = type->is_aggregate() ? reinterpret_cast<u64>(address) : load(kind_of(m_data_layout, type), address);
+        global->set_initializer(TRY(this->to_constant(type, value)));
+    }
+
+    return {};
+}
+
+ErrorOr<Constant*> Interpreter::run(Function* function, Vector<Constant*> const& arguments) {
+    auto* compiled = TRY(this->compile(function));
+
+    Vector<u64> values;
+    values.reserve(arguments.size() + 1);
+
+    for (auto* argument : arguments) {
+        values.push_back(TRY(this->to_value(argument)));
+    }
+
+    Type* return_type = function->return_type();
+    if (compiled->is_struct_return) {
+        u8* address = this->allocate(m_data_layout.size_of(return_type));
+        values.push_back(reinterpret_cast<u64>(address));
+    }
+
+    u64 result = TRY(this->call(*compiled, values.data()));
+    if (return_type->is_void()) {
+        return nullptr;
+    } else if (compiled->is_struct_return) {
+        result = values.back();
+    }
+
+    return this->to_constant(return_type, result);
+}
+
+ErrorOr<u64> Interpreter::call(CompiledFunction& function, u64 const* arguments) {
+    if (m_mode == ExecutionMode::Program || !TRY(this->is_memoizable(&function))) {
+        return this->execute(function, arguments);
+    }
+
+    Pair<Function*, Vector<u64>> key = { function.function, Vector<u64>(arguments, arguments + function.parameters.size()) };
+
+    auto iterator = m_memoized.find(key);
+    if (iterator != m_memoized.end()) {
+        return iterator->second;
+    }
+
+    u64 result = TRY(this->execute(function, arguments));
+    if (m_memoized.size() < MAX_MEMOIZED_CALLS) {
+        m_memoized[move(key)] = result;
+    }
+
+    return result;
+}
+
+ErrorOr<u64> Interpreter::execute(CompiledFunction& function, u64 const* arguments) {
+    if (m_depth >= m_max_depth) {
+        return err(m_span, "Exceeded the maximum call depth of {} while evaluating a constant expression", MAX_CALL_DEPTH);
+    }
+
+    size_t frame_size = function.frame_size();
+    if (STACK_SIZE - m_stack_top < frame_size) {
+        return err(m_span, "Ran out of stack space while evaluating a constant expression");
+    }
+
+    if (!m_stack) {
+        m_stack = OwnPtr<u8[]>(new u8[STACK_SIZE]);
+    }
+
+    u8* base = m_stack.get() + m_stack_top;
+
+    TemporaryChange<size_t> stack(m_stack_top, m_stack_top + frame_size);
+    TemporaryChange<size_t> depth(m_depth, m_depth + 1);
+
+    u64* r = reinterpret_cast<u64*>(base);
+    u8* frame = base + function.initial_registers.size() * sizeof(u64);
+
+    std::memcpy(r, function.initial_registers.data(), function.initial_registers.size() * sizeof(u64));
+    std::memset(frame, 0, function.memory_size);
+
+    for (auto& [slot, offset] : function.aggregate_registers) {
+        r[slot] = reinterpret_cast<u64>(frame + offset);
+    }
+
+    for (auto [index, parameter] : llvm::enumerate(function.parameters)) {
+        u8* address = frame + parameter.offset;
+        if (parameter.is_alias) {
+            write(address, arguments[index]);
+        } else if (parameter.kind == ValueKind::Aggregate) {
+            std::memcpy(address, reinterpret_cast<u8 const*>(arguments[index]), parameter.size);
+        } else {
+            store(parameter.kind, address, arguments[index]);
+        }
+    }
+
+    u8* return_address = nullptr;
+    if (function.is_struct_return) {
+        return_address = reinterpret_cast<u8*>(arguments[function.parameters.size()]);
+    }
+
+    auto check = [this](u64 address, size_t size, bool is_write) -> ErrorOr<u8*> {
+        auto* pointer = reinterpret_cast<u8*>(address);
+        if (m_mode == ExecutionMode::Program) {
+            // Programs get to use memory the interpreter knows nothing about, like whatever `malloc` returns
+            if (!address) {
+                return err(m_span, "Null pointer dereference");
+            }
+
+            return pointer;
+        } else if (!this->is_valid_address(pointer, size, is_write)) {
+            if (!address) {
+                return err(m_span, "Null pointer dereference in a constant expression");
+            }
+
+            return err(m_span, "Invalid memory access in a constant expression");
+        }
+
+        return pointer;
+    };
+
+    auto load_into = [&](Operation const& op, u8 const* address) {
+        if (op.kind == ValueKind::Aggregate) {
+            std::memmove(reinterpret_cast<u8*>(r[op.dst]), address, op.extra);
+        } else {
+            r[op.dst] = load(op.kind, address);
+        }
+    };
+
+    auto store_from = [&](Operation const& op, u8* address, u64 value) {
+        if (op.kind == ValueKind::Aggregate) {
+            std::memmove(address, reinterpret_cast<u8 const*>(value), op.extra);
+        } else {
+            store(op.kind, address, value);
+        }
+    };
+
+    Operation const* code = function.code.data();
+    size_t pc = 0;
+
+    for (;;) {
+        Operation const& op = code[pc++];
+        switch (op.opcode) {
+            case Opcode::Constant:
+                r[op.dst] = op.value;
+                break;
+            case Opcode::Copy:
+                r[op.dst] = r[op.a];
+                break;
+
+        // NOLINTNEXTLINE
+        #define INTEGER_OPERATION(name, expression)                                   \
+            case Opcode::name: {                                                      \
+                u64 lhs = r[op.a];                                                    \
+                u64 rhs = r[op.b];                                                    \
+                r[op.dst] = normalize(expression, op.bits, op.is_signed);             \
+                break;                                                                \
+            }
+
+            INTEGER_OPERATION(Add, lhs + rhs)
+            INTEGER_OPERATION(Sub, lhs - rhs)
+            INTEGER_OPERATION(Mul, lhs * rhs)
+            INTEGER_OPERATION(And, lhs & rhs)
+            INTEGER_OPERATION(Or, lhs | rhs)
+            INTEGER_OPERATION(Xor, lhs ^ rhs)
+        #undef INTEGER_OPERATION
+
+            case Opcode::SDiv:
+            case Opcode::SRem: {
+                i64 lhs = static_cast<i64>(r[op.a]);
+                i64 rhs = static_cast<i64>(r[op.b]);
+
+                if (!rhs) {
+                    return err(m_span, "Division by zero in a constant expression");
+                } else if (rhs == -1 && lhs == std::numeric_limits<i64>::min()) {
+                    return err(m_span, "Integer overflow in a constant expression");
+                }
+
+                i64 result = op.opcode == Opcode::SDiv ? lhs / rhs : lhs % rhs;
+                r[op.dst] = normalize(static_cast<u64>(result), op.bits, op.is_signed);
+
+                break;
+            }
+            case Opcode::UDiv:
+            case Opcode::URem: {
+                u64 lhs = r[op.a];
+                u64 rhs = r[op.b];
+
+                if (!rhs) {
+                    return err(m_span, "Division by zero in a constant expression");
+                }
+
+                r[op.dst] = normalize(op.opcode == Opcode::UDiv ? lhs / rhs : lhs % rhs, op.bits, op.is_signed);
+                break;
+            }
+            case Opcode::Shl:
+            case Opcode::Shr: {
+                u64 amount = r[op.b];
+                if (amount >= op.bits) {
+                    return err(m_span, "Shift amount {} is out of range for a {}-bit integer", amount, op.bits);
+                }
+
+                // Right shifts are logical, so the sign extension has to be dropped first
+                u64 value = normalize(r[op.a], op.bits, false);
+                r[op.dst] = normalize(op.opcode == Opcode::Shl ? value << amount : value >> amount, op.bits, op.is_signed);
+
+                break;
+            }
+            case Opcode::LogicalAnd:
+                r[op.dst] = r[op.a] && r[op.b];
+                break;
+            case Opcode::LogicalOr:
+                r[op.dst] = r[op.a] || r[op.b];
+                break;
+
+        // NOLINTNEXTLINE
+        #define FLOAT_OPERATION(name, expression)                                     \
+            case Opcode::name: {                                                      \
+                f64 lhs = as_float(r[op.a]);                                          \
+                f64 rhs = as_float(r[op.b]);                                          \
+                r[op.dst] = from_float(expression, op.kind);                          \
+                break;                                                                \
+            }
+
+            FLOAT_OPERATION(FAdd, lhs + rhs)
+            FLOAT_OPERATION(FSub, lhs - rhs)
+            FLOAT_OPERATION(FMul, lhs * rhs)
+            FLOAT_OPERATION(FDiv, lhs / rhs)
+            FLOAT_OPERATION(FRem, std::fmod(lhs, rhs))
+        #undef FLOAT_OPERATION
+
+        // NOLINTNEXTLINE
+        #define COMPARISON(name, type, expression)                                    \
+            case Opcode::name: {                                                      \
+                type lhs = static_cast<type>(r[op.a]);                                \
+                type rhs = static_cast<type>(r[op.b]);                                \
+                r[op.dst] = (expression);                                             \
+                break;                                                                \
+            }
+
+            COMPARISON(Eq, u64, lhs == rhs)
+            COMPARISON(Neq, u64, lhs != rhs)
+            COMPARISON(SLt, i64, lhs < rhs)
+            COMPARISON(SLte, i64, lhs <= rhs)
+            COMPARISON(SGt, i64, lhs > rhs)
+            COMPARISON(SGte, i64, lhs >= rhs)
+            COMPARISON(ULt, u64, lhs < rhs)
+            COMPARISON(ULte, u64, lhs <= rhs)
+            COMPARISON(UGt, u64, lhs > rhs)
+            COMPARISON(UGte, u64, lhs >= rhs)
+        #undef COMPARISON
+
+        // Equality is ordered and everything else is unordered, the same predicates the LLVM backend uses
+        // NOLINTNEXTLINE
+        #define FLOAT_COMPARISON(name, expression)                                    \
+            case Opcode::name: {                                                      \
+                f64 lhs = as_float(r[op.a]);                                          \
+                f64 rhs = as_float(r[op.b]);                                          \
+                r[op.dst] = (expression);                                             \
+                break;                                                                \
+            }
+
+            FLOAT_COMPARISON(FEq, lhs == rhs)
+            FLOAT_COMPARISON(FNeq, lhs < rhs || lhs > rhs)
+            FLOAT_COMPARISON(FLt, !(lhs >= rhs))
+            FLOAT_COMPARISON(FLte, !(lhs > rhs))
+            FLOAT_COMPARISON(FGt, !(lhs <= rhs))
+            FLOAT_COMPARISON(FGte, !(lhs < rhs))
+        #undef FLOAT_COMPARISON
+
+            case Opcode::Not:
+                r[op.dst] = r[op.a] == 0;
+                break;
+            case Opcode::IntCast:
+                r[op.dst] = normalize(r[op.a], op.bits, op.is_signed);
+                break;
+            case Opcode::SIToFP:
+                if (op.kind == ValueKind::F32) {
+                    r[op.dst] = from_float(static_cast<f32>(static_cast<i64>(r[op.a])), op.kind);
+                } else {
+                    r[op.dst] = from_float(static_cast<f64>(static_cast<i64>(r[op.a])), op.kind);
+                }
+
+                break;
+            case Opcode::UIToFP:
+                if (op.kind == ValueKind::F32) {
+                    r[op.dst] = from_float(static_cast<f32>(r[op.a]), op.kind);
+                } else {
+                    r[op.dst] = from_float(static_cast<f64>(r[op.a]), op.kind);
+                }
+
+                break;
+            case Opcode::FPToSI:
+            case Opcode::FPToUI: {
+                f64 value = std::trunc(as_float(r[op.a]));
+                bool is_signed = op.opcode == Opcode::FPToSI;
+
+                f64 min = is_signed ? -0x1p63 : 0.0;
+                f64 max = is_signed ? 0x1p63 : 0x1p64;
+
+                if (!(value >= min && value < max)) {
+                    return err(m_span, "Floating point value is out of range of the integer type it's cast to");
+                }
+
+                u64 result = is_signed ? static_cast<u64>(static_cast<i64>(value)) : static_cast<u64>(value);
+                r[op.dst] = normalize(result, op.bits, op.is_signed);
+
+                break;
+            }
+            case Opcode::FPCast:
+                r[op.dst] = from_float(as_float(r[op.a]), op.kind);
+                break;
+            case Opcode::IsNotNull:
+                r[op.dst] = r[op.a] != 0;
+                break;
+
+            case Opcode::FrameAddress:
+                r[op.dst] = reinterpret_cast<u64>(frame + op.value);
+                break;
+            case Opcode::LoadFrame:
+                load_into(op, frame + op.value);
+                break;
+            case Opcode::StoreFrame:
+                store_from(op, frame + op.value, r[op.a]);
+                break;
+            case Opcode::ZeroFrame:
+                std::memset(frame + op.value, 0, op.extra);
+                break;
+
+            case Opcode::AliasAddress:
+                r[op.dst] = read<u64>(frame + op.value);
+                break;
+            case Opcode::LoadAlias: {
+                u8* address = TRY(check(read<u64>(frame + op.value), op.extra, false));
+                load_into(op, address);
+
+                break;
+            }
+            case Opcode::StoreAlias:
+                write(frame + op.value, r[op.a]);
+                break;
+
+            case Opcode::Address:
+                r[op.dst] = r[op.a] + op.value;
+                break;
+            case Opcode::AddressIndexed: {
+                u64 index = r[op.b];
+                if (op.extra && index >= op.extra) {
+                    return err(m_span, "Index {} is out of bounds for an array of {} elements", static_cast<i64>(index), op.extra);
+                }
+
+                r[op.dst] = r[op.a] + index * op.value;
+                break;
+            }
+            case Opcode::Load: {
+                u8* address = TRY(check(r[op.a] + op.value, op.extra, false));
+                load_into(op, address);
+
+                break;
+            }
+            case Opcode::Store: {
+                u8* address = TRY(check(r[op.a] + op.value, op.extra, true));
+                store_from(op, address, r[op.b]);
+
+                break;
+            }
+            case Opcode::Zero: {
+                u8* address = TRY(check(r[op.a], op.value, true));
+                std::memset(address, 0, op.value);
+
+                break;
+            }
+            case Opcode::Memcpy: {
+                u8* dst = TRY(check(r[op.a], op.value, true));
+                u8* src = TRY(check(r[op.b], op.value, false));
+
+                std::memmove(dst, src, op.value);
+                break;
+            }
+
+            case Opcode::GlobalAddress:
+                r[op.dst] = reinterpret_cast<u64>(TRY(this->global_address(op.value)));
+                break;
+            case Opcode::LoadGlobal:
+                load_into(op, TRY(this->global_address(op.value)));
+                break;
+            case Opcode::SetGlobal: {
+                u8* address = TRY(this->global_address(op.value));
+                TRY(this->store_constant(address, reinterpret_cast<Constant*>(op.extra)));
+
+                break;
+            }
+
+            case Opcode::ReturnAddress:
+                r[op.dst] = reinterpret_cast<u64>(return_address);
+                break;
+            case Opcode::Call: {
+                if (++m_steps > m_max_steps) {
+                    return err(m_span, "Constant expression took too long to evaluate");
+                }
+
+                auto* callee = reinterpret_cast<Function*>(r[op.a]);
+
+                auto iterator = m_functions.find(callee);
+                if (iterator == m_functions.end()) {
+                    return err(m_span, "Called a value that isn't a function in a constant expression");
+                }
+
+                auto* compiled = iterator->second ? iterator->second.get() : TRY(this->compile(callee));
+
+                Vector<u64> values(op.extra);
+                for (size_t i = 0; i < op.extra; i++) {
+                    values[i] = r[function.call_arguments[op.value + i]];
+                }
+
+                u64 result = 0;
+                if (compiled->native) {
+                    result = TRY(this->call_native(*compiled, values.data(), function.call_argument_kinds.data() + op.value, op.extra));
+                } else {
+                    result = TRY(this->call(*compiled, values.data()));
+                }
+
+                if (op.b) {
+                    // The callee's frame was just popped but nothing has been pushed over it yet
+                    std::memcpy(reinterpret_cast<u8*>(r[op.dst]), reinterpret_cast<u8 const*>(result), op.b);
+                } else {
+                    r[op.dst] = result;
+                }
+
+                break;
+            }
+
+            case Opcode::Jump:
+                if (++m_steps > m_max_steps) {
+                    return err(m_span, "Constant expression took too long to evaluate");
+                }
+
+                pc = op.value;
+                break;
+            case Opcode::JumpIf:
+                if (++m_steps > m_max_steps) {
+                    return err(m_span, "Constant expression took too long to evaluate");
+                }
+
+                pc = (r[op.a] & 1) ? op.value : op.extra;
+                break;
+            case Opcode::Return:
+                return 0;
+            case Opcode::ReturnValue:
+                return r[op.a];
+        }
+    }
+}
+
+}
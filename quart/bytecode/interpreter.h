@@ -0,0 +1,117 @@
+#pragma once
+
+#include <quart/common.h>
+#include <quart/errors.h>
+#include <quart/bytecode/instruction.h>
+
+#include <set>
+
+namespace quart {
+    class State;
+    class DataLayout;
+}
+
+namespace quart::bytecode {
+
+struct CompiledFunction;
+enum class ValueKind : u8;
+
+enum class ExecutionMode : u8 {
+    // Memory accesses are checked and evaluation gives up after a fixed number of steps
+    ConstantEvaluation,
+
+    // Runs a whole program like the native backends would, extern functions are called through the FFI
+    Program
+};
+
+// Runs functions by interpreting their bytecode. Before a function runs for the first time its basic blocks are
+// flattened into a single array of instructions that only refer to dense per-frame register slots, so the dispatch
+// loop never has to look anything up by the global register index or walk linked blocks.
+//
+// Values live in 64-bit registers. Aggregates are kept in memory laid out by the target's `DataLayout` and registers
+// holding them point to it. When evaluating constants every memory access is checked against the memory the
+// interpreter handed out so a bad constant expression can only produce an error.
+class Interpreter {
+public:
+    NO_COPY(Interpreter)
+    NO_MOVE(Interpreter)
+
+    explicit Interpreter(State& state, ExecutionMode mode = ExecutionMode::ConstantEvaluation);
+    ~Interpreter();
+
+    ExecutionMode mode() const { return m_mode; }
+
+    // Calls `function` with constant arguments and converts whatever it returns back into a constant.
+    // Globals start out with their initializers on every call and changes made to them are thrown away afterwards.
+    ErrorOr<Constant*> call(Span span, Function* function, Vector<Constant*> const& arguments);
+
+    // Calls `function`, which takes no arguments, and keeps whatever it did to globals by turning every global whose
+    // memory changed back into a constant and making that its new initializer. This is how `consteval` blocks run.
+    ErrorOr<void> call_and_commit_globals(Span span, Function* function);
+
+    // Makes the symbols of `lib<name>.so` available to extern functions, `paths` are searched before the system ones
+    ErrorOr<void> load_library(String const& name, std::set<String> const& paths);
+
+private:
+    ErrorOr<Constant*> run(Function* function, Vector<Constant*> const& arguments);
+
+    ErrorOr<CompiledFunction*> compile(Function* function);
+    ErrorOr<CompiledFunction*> compile_native(Function* function);
+    ErrorOr<bool> ensure_body(Function* function);
+
+    ErrorOr<bool> is_memoizable(CompiledFunction* function);
+
+    ErrorOr<u64> execute(CompiledFunction& function, u64 const* arguments);
+    ErrorOr<u64> call(CompiledFunction& function, u64 const* arguments);
+    ErrorOr<u64> call_native(CompiledFunction& function, u64 const* arguments, ValueKind const* kinds, size_t count);
+
+    ErrorOr<u8*> global_address(u32 index);
+    ErrorOr<void> commit_globals();
+
+    // The memory the interpreter owns, everything a load or store touches has to fall inside one of these
+    u8* allocate(size_t size, bool is_writable = true);
+    bool is_valid_address(u8 const* address, size_t size, bool is_write) const;
+
+    ErrorOr<void> store_constant(u8* address, Constant* constant);
+    ErrorOr<u64> to_value(Constant* constant);
+    ErrorOr<Constant*> to_constant(Type* type, u64 value);
+
+    State& m_state;
+    DataLayout const& m_data_layout;
+
+    ExecutionMode m_mode;
+
+    u64 m_max_steps;
+    size_t m_max_depth;
+
+    Vector<void*> m_libraries;
+
+    HashMap<Function*, OwnPtr<CompiledFunction>> m_functions;
+    HashMap<Pair<Function*, Vector<u64>>, u64> m_memoized;
+
+    // Frames are pushed onto a single stack holding both their register slots and their memory
+    OwnPtr<u8[]> m_stack;
+    size_t m_stack_top = 0;
+    size_t m_depth = 0;
+
+    struct Allocation {
+        u8 const* start;
+        size_t size;
+        bool is_writable;
+    };
+
+    Vector<OwnPtr<u8[]>> m_allocations;
+    Vector<Allocation> m_regions;
+
+    // String literals baked into compiled functions, these live as long as the interpreter does
+    Vector<Allocation> m_static_regions;
+
+    // Only live for the duration of a single top level call
+    HashMap<u32, u8*> m_globals;
+    size_t m_global_allocations = 0;
+
+    Span m_span;
+    u64 m_steps = 0;
+};
+
+}
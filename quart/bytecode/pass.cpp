@@ -2,6 +2,10 @@
 #include <quart/language/functions.h>
 
 #include <quart/bytecode/passes/eliminate_unreachable_blocks.h>
+#include <quart/bytecode/passes/promote_locals.h>
+#include <quart/bytecode/passes/constant_propagation.h>
+#include <quart/bytecode/passes/dead_code_elimination.h>
+#include <quart/bytecode/passes/value_numbering.h>
 
 namespace quart::bytecode {
 
@@ -23,9 +27,13 @@ PassManager::~PassManager() {
     }
 }
 
-PassManager PassManager::create_default() {
+PassManager PassManager::create_default(State& state) {
     PassManager manager;
     manager.add_pass<bytecode::EliminateUnreachableBlocksPass>();
+    manager.add_pass<bytecode::PromoteLocalsPass>(state);
+    manager.add_pass<bytecode::ConstantPropagationPass>(state);
+    manager.add_pass<bytecode::ValueNumberingPass>(state);
+    manager.add_pass<bytecode::DeadCodeEliminationPass>(state);
 
     return manager;
 }
@@ -37,6 +45,9 @@ void PassManager::add_pass(OwnPtr<Pass> pass) {
 void PassManager::run(Function* function) {
     for (auto& pass : m_passes) {
         pass->run(function);
+        if (!pass->preserves_control_flow()) {
+            function->invalidate_analysis();
+        }
     }
 }
 
@@ -4,6 +4,10 @@
 #include <quart/bytecode/instruction.h>
 #include <quart/bytecode/basic_block.h>
 
+namespace quart {
+    class State;
+}
+
 namespace quart::bytecode {
 
 class Pass {
@@ -17,6 +21,9 @@ public:
     virtual void run(Function*);
     virtual void finalize() {}
 
+    // Passes that never add, remove or retarget blocks keep the function's cached analyses valid
+    virtual bool preserves_control_flow() const { return false; }
+
     virtual void on_block(BasicBlock*);
     virtual void on_instruction(Instruction*) = 0;
 };
@@ -29,7 +36,7 @@ public:
     DEFAULT_COPY(PassManager)
     DEFAULT_MOVE(PassManager)
 
-    static PassManager create_default();
+    static PassManager create_default(State&);
 
     void add_pass(OwnPtr<Pass> pass);
 
@@ -0,0 +1,476 @@
+#include <quart/bytecode/passes/constant_propagation.h>
+#include <quart/language/functions.h>
+#include <quart/language/state.h>
+
+#include <limits>
+
+namespace quart::bytecode {
+
+// Immediates are kept the way they would be as a 64-bit integer, sign-extended for signed types and zero-extended for
+// unsigned ones, so that backends can use them as is
+static u64 normalize(u64 value, Type* type) {
+    u32 bits = type->get_int_bit_width();
+    if (bits >= 64) {
+        return value;
+    }
+
+    u64 mask = (u64(1) << bits) - 1;
+    value &= mask;
+
+    if (bits > 1 && !type->is_int_unsigned() && (value >> (bits - 1)) & 1) {
+        value |= ~mask;
+    }
+
+    return value;
+}
+
+static bool is_int(Type* type) {
+    return type && type->is_int();
+}
+
+// Instructions where every integer register is read through an `Operand`, which lets it be replaced by an immediate
+static bool accepts_immediates(Instruction* inst) {
+    switch (inst->type()) {
+    #define Op(x) case Instruction::x: // NOLINT
+        ENUMERATE_BINARY_OPS(Op)
+    #undef Op
+        case Instruction::SetLocal:
+        case Instruction::Write:
+        case Instruction::SetMember:
+        case Instruction::GetMember:
+        case Instruction::GetMemberRef:
+        case Instruction::NewArray:
+        case Instruction::Return:
+        case Instruction::Call:
+        case Instruction::JumpIf:
+        case Instruction::Cast:
+        case Instruction::Not:
+        case Instruction::Phi:
+        case Instruction::Copy:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void ConstantPropagationPass::run(Function* function) {
+    m_definitions.clear();
+    m_values.clear();
+    m_users.clear();
+    m_executable_edges.clear();
+    m_block_worklist.clear();
+    m_instruction_worklist.clear();
+
+    if (!function->entry_block()) {
+        return;
+    }
+
+    m_cfg = &function->analysis().cfg();
+    m_executable_blocks.assign(m_cfg->size(), false);
+
+    for (auto [index, block] : llvm::enumerate(m_cfg->reverse_post_order())) {
+        for (auto& inst : block->instructions()) {
+            if (auto result = inst->result()) {
+                m_definitions[*result]++;
+            }
+
+            inst->visit_operands([&](Operand& operand) {
+                if (operand.is_register()) {
+                    m_users[operand.reg()].emplace_back(index, inst.get());
+                }
+            });
+        }
+    }
+
+    m_executable_blocks[0] = true;
+    m_block_worklist.push_back(0);
+
+    this->propagate();
+    this->rewrite(function);
+}
+
+void ConstantPropagationPass::propagate() {
+    while (!m_block_worklist.empty() || !m_instruction_worklist.empty()) {
+        while (!m_instruction_worklist.empty()) {
+            auto [block, inst] = m_instruction_worklist.back();
+            m_instruction_worklist.pop_back();
+
+            if (m_executable_blocks[block]) {
+                this->visit(block, inst);
+            }
+        }
+
+        if (!m_block_worklist.empty()) {
+            u32 block = m_block_worklist.back();
+            m_block_worklist.pop_back();
+
+            for (auto& inst : m_cfg->block(block)->instructions()) {
+                this->visit(block, inst.get());
+            }
+        }
+    }
+}
+
+void ConstantPropagationPass::visit(u32 block, Instruction* inst) {
+    if (auto* jump = inst->as<Jump>()) {
+        this->mark_edge(block, *m_cfg->index_of(jump->target()));
+        return;
+    } else if (auto* jump_if = inst->as<JumpIf>()) {
+        u32 true_target = *m_cfg->index_of(jump_if->true_target());
+        u32 false_target = *m_cfg->index_of(jump_if->false_target());
+
+        Value condition = this->value_of(jump_if->condition());
+        if (condition.kind == Value::Undefined) {
+            return;
+        } else if (condition.is_constant()) {
+            this->mark_edge(block, condition.value ? true_target : false_target);
+            return;
+        }
+
+        this->mark_edge(block, true_target);
+        this->mark_edge(block, false_target);
+
+        return;
+    }
+
+    auto result = inst->result();
+    if (!result.has_value()) {
+        return;
+    }
+
+    this->mark(*result, this->evaluate(block, inst));
+}
+
+void ConstantPropagationPass::mark_edge(u32 from, u32 to) {
+    if (!m_executable_edges.insert({ from, to }).second) {
+        return;
+    }
+
+    if (!m_executable_blocks[to]) {
+        m_executable_blocks[to] = true;
+        m_block_worklist.push_back(to);
+
+        return;
+    }
+
+    // Only phis depend on which edges are executable, everything else in the block has been visited already
+    for (auto& inst : m_cfg->block(to)->instructions()) {
+        if (!inst->is<Phi>()) {
+            break;
+        }
+
+        this->visit(to, inst.get());
+    }
+}
+
+void ConstantPropagationPass::mark(Register reg, Value value) {
+    auto& current = m_values[reg];
+    if (current.kind == Value::Overdefined || value.kind == Value::Undefined || current == value) {
+        return;
+    }
+
+    current = current.kind == Value::Undefined ? value : overdefined();
+    for (auto& user : m_users[reg]) {
+        m_instruction_worklist.push_back(user);
+    }
+}
+
+ConstantPropagationPass::Value ConstantPropagationPass::value_of(Operand const& operand) const {
+    if (operand.is_value()) {
+        Type* type = operand.value_type();
+        return is_int(type) ? constant(normalize(operand.value(), type)) : overdefined();
+    }
+
+    // Registers defined more than once, or not at all, are not in SSA form and could hold anything
+    auto definitions = m_definitions.find(operand.reg());
+    if (definitions == m_definitions.end() || definitions->second != 1) {
+        return overdefined();
+    }
+
+    auto iterator = m_values.find(operand.reg());
+    if (iterator == m_values.end()) {
+        return {};
+    }
+
+    return iterator->second;
+}
+
+ConstantPropagationPass::Value ConstantPropagationPass::evaluate(u32 block, Instruction* inst) const {
+    Register dst = *inst->result();
+
+    Type* type = m_state.type(dst);
+    if (!is_int(type)) {
+        return overdefined();
+    }
+
+    auto definitions = m_definitions.find(dst);
+    if (definitions == m_definitions.end() || definitions->second != 1) {
+        return overdefined();
+    }
+
+    switch (inst->type()) {
+        case Instruction::Move:
+            return constant(normalize(inst->as<Move>()->src(), type));
+        case Instruction::Boolean:
+            return constant(inst->as<Boolean>()->value());
+        case Instruction::Copy:
+            return this->value_of(inst->as<Copy>()->src());
+        case Instruction::Not: {
+            Value src = this->value_of(inst->as<Not>()->src());
+            return src.is_constant() ? constant(src.value == 0) : src;
+        }
+        case Instruction::Cast: {
+            auto* cast = inst->as<Cast>();
+            if (!is_int(m_state.type(cast->src()))) {
+                return overdefined();
+            }
+
+            Value src = this->value_of(cast->src());
+            if (!src.is_constant()) {
+                return src;
+            }
+
+            // Casting to a boolean checks against zero rather than truncating
+            if (type->get_int_bit_width() == 1) {
+                return constant(src.value != 0);
+            }
+
+            return constant(normalize(src.value, type));
+        }
+        case Instruction::Phi: {
+            Value value;
+            for (auto& incoming : inst->as<Phi>()->incoming()) {
+                auto predecessor = m_cfg->index_of(incoming.block);
+                if (!predecessor.has_value() || !this->is_executable(*predecessor, block)) {
+                    continue;
+                }
+
+                Value other = this->value_of(incoming.value);
+                if (other.kind == Value::Undefined) {
+                    continue;
+                } else if (other.kind == Value::Overdefined || (value.is_constant() && value.value != other.value)) {
+                    return overdefined();
+                }
+
+                value = other;
+            }
+
+            return value;
+        }
+    #define Op(x) /* NOLINT */                                                              \
+        case Instruction::x: {                                                              \
+            auto* operation = inst->as<x>();                                                \
+            return this->evaluate_binary(BinaryOp::x, dst, operation->lhs(), operation->rhs()); \
+        }
+        ENUMERATE_BINARY_OPS(Op)
+    #undef Op
+        default:
+            return overdefined();
+    }
+}
+
+ConstantPropagationPass::Value ConstantPropagationPass::evaluate_binary(
+    BinaryOp op, Register dst, Operand const& lhs, Operand const& rhs
+) const {
+    Type* type = m_state.type(lhs);
+    if (!is_int(type) || !is_int(m_state.type(rhs))) {
+        return overdefined();
+    }
+
+    Value a = this->value_of(lhs);
+    Value b = this->value_of(rhs);
+
+    if (a.kind == Value::Overdefined || b.kind == Value::Overdefined) {
+        return overdefined();
+    } else if (a.kind == Value::Undefined || b.kind == Value::Undefined) {
+        return {};
+    }
+
+    Type* result = m_state.type(dst);
+
+    bool is_signed = !type->is_int_unsigned() && type->get_int_bit_width() > 1;
+    u32 bits = type->get_int_bit_width();
+
+    u64 x = a.value;
+    u64 y = b.value;
+
+    auto sx = static_cast<i64>(x);
+    auto sy = static_cast<i64>(y);
+
+    switch (op) {
+        case BinaryOp::Add: return constant(normalize(x + y, result));
+        case BinaryOp::Sub: return constant(normalize(x - y, result));
+        case BinaryOp::Mul: return constant(normalize(x * y, result));
+        case BinaryOp::Div:
+        case BinaryOp::Mod: {
+            // Leave the trap (or whatever the target does) to runtime
+            if (y == 0 || (is_signed && sy == -1 && sx == std::numeric_limits<i64>::min())) {
+                return overdefined();
+            }
+
+            if (is_signed) {
+                return constant(normalize(static_cast<u64>(op == BinaryOp::Div ? sx / sy : sx % sy), result));
+            }
+
+            return constant(normalize(op == BinaryOp::Div ? x / y : x % y, result));
+        }
+        case BinaryOp::Or: return constant(normalize(x | y, result));
+        case BinaryOp::And: return constant(normalize(x & y, result));
+        case BinaryOp::Xor: return constant(normalize(x ^ y, result));
+        case BinaryOp::LogicalOr: return constant(x != 0 || y != 0);
+        case BinaryOp::LogicalAnd: return constant(x != 0 && y != 0);
+        case BinaryOp::Lsh:
+        case BinaryOp::Rsh: {
+            if (y >= bits) {
+                return overdefined();
+            }
+
+            // Right shifts are logical, matching what the backends emit
+            u64 mask = bits >= 64 ? ~u64(0) : (u64(1) << bits) - 1;
+            return constant(normalize(op == BinaryOp::Lsh ? x << y : (x & mask) >> y, result));
+        }
+        case BinaryOp::Eq: return constant(x == y);
+        case BinaryOp::Neq: return constant(x != y);
+        case BinaryOp::Gt: return constant(is_signed ? sx > sy : x > y);
+        case BinaryOp::Lt: return constant(is_signed ? sx < sy : x < y);
+        case BinaryOp::Gte: return constant(is_signed ? sx >= sy : x >= y);
+        case BinaryOp::Lte: return constant(is_signed ? sx <= sy : x <= y);
+        default:
+            return overdefined();
+    }
+}
+
+void ConstantPropagationPass::remove_instruction(OwnPtr<Instruction> inst) {
+    inst->visit_operands([this, &inst](Operand& operand) {
+        if (operand.is_register()) {
+            m_state.register_uses(operand.reg()).remove(inst.get());
+        }
+    });
+}
+
+void ConstantPropagationPass::rewrite(Function* function) {
+    auto constant_of = [this](Register reg) -> Optional<u64> {
+        Value value = this->value_of(Operand(reg));
+        if (!value.is_constant()) {
+            return {};
+        }
+
+        return value.value;
+    };
+
+    // Registers that are also read by instructions that need them in a register keep their definition around
+    Set<Register> materialized;
+    for (auto [index, block] : llvm::enumerate(m_cfg->reverse_post_order())) {
+        if (!m_executable_blocks[index]) {
+            continue;
+        }
+
+        for (auto& inst : block->instructions()) {
+            if (accepts_immediates(inst.get())) {
+                continue;
+            }
+
+            inst->visit_operands([&](Operand& operand) {
+                if (operand.is_register() && constant_of(operand.reg()).has_value()) {
+                    materialized.insert(operand.reg());
+                }
+            });
+        }
+    }
+
+    for (auto [index, block] : llvm::enumerate(m_cfg->reverse_post_order())) {
+        if (!m_executable_blocks[index]) {
+            continue;
+        }
+
+        Vector<OwnPtr<Instruction>> rewritten;
+        for (auto& inst : block->instructions()) {
+            if (auto* phi = inst->as<Phi>()) {
+                Vector<BasicBlock*> dead;
+                for (auto& incoming : phi->incoming()) {
+                    auto predecessor = m_cfg->index_of(incoming.block);
+                    if (predecessor.has_value() && this->is_executable(*predecessor, index)) {
+                        continue;
+                    }
+
+                    if (incoming.value.is_register()) {
+                        m_state.register_uses(incoming.value.reg()).remove(inst.get());
+                    }
+
+                    dead.push_back(incoming.block);
+                }
+
+                for (auto* predecessor : dead) {
+                    phi->remove_incoming(predecessor);
+                }
+            }
+
+            if (accepts_immediates(inst.get())) {
+                inst->visit_operands([&](Operand& operand) {
+                    if (!operand.is_register()) {
+                        return;
+                    }
+
+                    auto value = constant_of(operand.reg());
+                    if (!value.has_value()) {
+                        return;
+                    }
+
+                    m_state.register_uses(operand.reg()).remove(inst.get());
+                    operand = Operand(*value, m_state.type(operand.reg()));
+                });
+            }
+
+            if (auto* jump_if = inst->as<JumpIf>()) {
+                Operand condition = jump_if->condition();
+                if (condition.is_value()) {
+                    auto* target = condition.value() ? jump_if->true_target() : jump_if->false_target();
+                    rewritten.push_back(make<Jump>(target));
+
+                    continue;
+                }
+            }
+
+            auto result = inst->result();
+            auto value = result.has_value() ? constant_of(*result) : Optional<u64>();
+
+            if (!value.has_value()) {
+                rewritten.push_back(move(inst));
+                continue;
+            }
+
+            if (!materialized.contains(*result)) {
+                this->remove_instruction(move(inst));
+                continue;
+            }
+
+            if (!inst->is<Move>() && !inst->is<Boolean>()) {
+                this->remove_instruction(move(inst));
+                inst = make<Move>(*result, *value);
+            }
+
+            rewritten.push_back(move(inst));
+        }
+
+        block->set_instructions(move(rewritten));
+    }
+
+    Vector<BasicBlock*> dead_blocks;
+    for (auto* block : function->basic_blocks()) {
+        auto index = m_cfg->index_of(block);
+        if (!index.has_value() || !m_executable_blocks[*index]) {
+            dead_blocks.push_back(block);
+        }
+    }
+
+    for (auto* block : dead_blocks) {
+        for (auto& inst : block->instructions()) {
+            this->remove_instruction(move(inst));
+        }
+
+        block->set_instructions({});
+        function->remove_block(block);
+    }
+}
+
+}
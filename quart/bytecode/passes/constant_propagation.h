@@ -0,0 +1,70 @@
+#pragma once
+
+#include <quart/common.h>
+#include <quart/bytecode/pass.h>
+#include <quart/bytecode/analysis/function_analysis.h>
+
+namespace quart {
+    class State;
+}
+
+namespace quart::bytecode {
+
+// Sparse conditional constant propagation ("Constant Propagation with Conditional Branches" by Wegman and Zadeck).
+// Integer registers that always hold the same value are folded into immediates, `JumpIf`s on such values become
+// `Jump`s and blocks that can never run are removed.
+class ConstantPropagationPass : public Pass {
+public:
+    ConstantPropagationPass(State& state) : m_state(state) {}
+
+    void run(Function*) override;
+    void on_instruction(Instruction*) override {}
+
+private:
+    struct Value {
+        enum Kind : u8 {
+            Undefined,
+            Constant,
+            Overdefined
+        };
+
+        Kind kind = Undefined;
+        u64 value = 0;
+
+        bool is_constant() const { return kind == Constant; }
+        bool operator==(Value const&) const = default;
+    };
+
+    static Value constant(u64 value) { return { Value::Constant, value }; }
+    static Value overdefined() { return { Value::Overdefined, 0 }; }
+
+    void propagate();
+
+    void visit(u32 block, Instruction*);
+    void mark_edge(u32 from, u32 to);
+    void mark(Register, Value);
+
+    Value value_of(Operand const&) const;
+    Value evaluate(u32 block, Instruction*) const;
+    Value evaluate_binary(BinaryOp, Register dst, Operand const& lhs, Operand const& rhs) const;
+
+    bool is_executable(u32 from, u32 to) const { return m_executable_edges.contains({ from, to }); }
+
+    void rewrite(Function*);
+    void remove_instruction(OwnPtr<Instruction>);
+
+    State& m_state;
+    ControlFlowGraph const* m_cfg = nullptr;
+
+    HashMap<Register, u32> m_definitions;
+    HashMap<Register, Value> m_values;
+    HashMap<Register, Vector<Pair<u32, Instruction*>>> m_users;
+
+    Vector<bool> m_executable_blocks;
+    Set<Pair<u32, u32>> m_executable_edges;
+
+    Vector<u32> m_block_worklist;
+    Vector<Pair<u32, Instruction*>> m_instruction_worklist;
+};
+
+}
@@ -0,0 +1,247 @@
+#include <quart/bytecode/passes/dead_code_elimination.h>
+#include <quart/language/functions.h>
+#include <quart/language/state.h>
+
+namespace quart::bytecode {
+
+static bool is_pure(Instruction* inst) {
+    switch (inst->type()) {
+    #define Op(x) case Instruction::x: // NOLINT
+        ENUMERATE_BINARY_OPS(Op)
+    #undef Op
+        case Instruction::Move:
+        case Instruction::NewString:
+        case Instruction::NewArray:
+        case Instruction::GetLocal:
+        case Instruction::GetLocalRef:
+        case Instruction::GetGlobal:
+        case Instruction::GetGlobalRef:
+        case Instruction::GetMember:
+        case Instruction::GetMemberRef:
+        case Instruction::Read:
+        case Instruction::GetFunction:
+        case Instruction::Cast:
+        case Instruction::Construct:
+        case Instruction::Alloca:
+        case Instruction::NewTuple:
+        case Instruction::Null:
+        case Instruction::Boolean:
+        case Instruction::Not:
+        case Instruction::GetReturn:
+        case Instruction::Phi:
+        case Instruction::Copy:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void DeadCodeEliminationPass::run(Function* function) {
+    if (!function->entry_block()) {
+        return;
+    }
+
+    // Removing stores first lets the values they stored die along with everything computing them
+    this->eliminate_dead_stores(function);
+    this->eliminate_dead_instructions(function);
+}
+
+void DeadCodeEliminationPass::remove_uses(Instruction* inst) {
+    inst->visit_operands([this, inst](Operand& operand) {
+        if (operand.is_register()) {
+            m_state.register_uses(operand.reg()).remove(inst);
+        }
+    });
+}
+
+void DeadCodeEliminationPass::eliminate_dead_stores(Function* function) {
+    auto& cfg = function->analysis().cfg();
+
+    size_t locals = function->local_count();
+    size_t count = cfg.size();
+
+    // Locals whose address is taken can be read through it at any point, struct locals are aliases of other values
+    Vector<bool> tracked(locals, true);
+    for (u32 local = 0; local < locals; local++) {
+        tracked[local] = !function->is_struct_local(local);
+    }
+
+    for (auto* block : cfg.reverse_post_order()) {
+        for (auto& inst : block->instructions()) {
+            if (auto* ref = inst->as<GetLocalRef>()) {
+                tracked[ref->index()] = false;
+            }
+        }
+    }
+
+    if (std::none_of(tracked.begin(), tracked.end(), [](bool value) { return value; })) {
+        return;
+    }
+
+    // Upward exposed reads and writes of every block, the usual backward liveness problem over tracked locals
+    Vector<Vector<bool>> uses(count, Vector<bool>(locals, false));
+    Vector<Vector<bool>> definitions(count, Vector<bool>(locals, false));
+
+    for (auto [index, block] : llvm::enumerate(cfg.reverse_post_order())) {
+        for (auto& inst : block->instructions()) {
+            if (auto* get = inst->as<GetLocal>()) {
+                if (!definitions[index][get->index()]) {
+                    uses[index][get->index()] = true;
+                }
+            } else if (auto* set = inst->as<SetLocal>()) {
+                definitions[index][set->index()] = true;
+            }
+        }
+    }
+
+    Vector<Vector<bool>> live_in(count, Vector<bool>(locals, false));
+    Vector<Vector<bool>> live_out(count, Vector<bool>(locals, false));
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (u32 index = count; index-- > 0;) {
+            Vector<bool> out(locals, false);
+            for (u32 successor : cfg.successors(index)) {
+                for (u32 local = 0; local < locals; local++) {
+                    out[local] = out[local] || live_in[successor][local];
+                }
+            }
+
+            Vector<bool> in(locals, false);
+            for (u32 local = 0; local < locals; local++) {
+                in[local] = uses[index][local] || (out[local] && !definitions[index][local]);
+            }
+
+            if (in != live_in[index] || out != live_out[index]) {
+                live_in[index] = move(in);
+                live_out[index] = move(out);
+
+                changed = true;
+            }
+        }
+    }
+
+    for (auto [index, block] : llvm::enumerate(cfg.reverse_post_order())) {
+        Vector<bool> live = live_out[index];
+
+        auto& instructions = block->instructions();
+        Vector<bool> dead(instructions.size(), false);
+
+        bool any = false;
+        for (size_t i = instructions.size(); i-- > 0;) {
+            auto* inst = instructions[i].get();
+            if (auto* get = inst->as<GetLocal>()) {
+                live[get->index()] = true;
+            } else if (auto* set = inst->as<SetLocal>()) {
+                u32 local = set->index();
+                if (tracked[local] && !live[local]) {
+                    dead[i] = true;
+                    any = true;
+                }
+
+                live[local] = false;
+            }
+        }
+
+        if (!any) {
+            continue;
+        }
+
+        Vector<OwnPtr<Instruction>> rewritten;
+        for (auto [i, inst] : llvm::enumerate(instructions)) {
+            if (dead[i]) {
+                this->remove_uses(inst.get());
+                continue;
+            }
+
+            rewritten.push_back(move(inst));
+        }
+
+        block->set_instructions(move(rewritten));
+    }
+}
+
+void DeadCodeEliminationPass::eliminate_dead_instructions(Function* function) {
+    HashMap<Register, u32> use_counts;
+    for (auto* block : function->basic_blocks()) {
+        for (auto& inst : block->instructions()) {
+            inst->visit_operands([&use_counts](Operand& operand) {
+                if (operand.is_register()) {
+                    use_counts[operand.reg()]++;
+                }
+            });
+        }
+    }
+
+    Set<Instruction*> dead;
+    Vector<Instruction*> worklist;
+
+    HashMap<Register, Vector<Instruction*>> definitions;
+    for (auto* block : function->basic_blocks()) {
+        for (auto& inst : block->instructions()) {
+            auto result = inst->result();
+            if (!result.has_value() || !is_pure(inst.get())) {
+                continue;
+            }
+
+            definitions[*result].push_back(inst.get());
+            if (!use_counts[*result]) {
+                worklist.push_back(inst.get());
+            }
+        }
+    }
+
+    while (!worklist.empty()) {
+        auto* inst = worklist.back();
+        worklist.pop_back();
+
+        if (!dead.insert(inst).second) {
+            continue;
+        }
+
+        inst->visit_operands([&](Operand& operand) {
+            if (!operand.is_register()) {
+                return;
+            }
+
+            u32& count = use_counts[operand.reg()];
+            if (--count) {
+                return;
+            }
+
+            for (auto* definition : definitions[operand.reg()]) {
+                worklist.push_back(definition);
+            }
+        });
+    }
+
+    if (dead.empty()) {
+        return;
+    }
+
+    for (auto* block : function->basic_blocks()) {
+        auto& instructions = block->instructions();
+        bool any = std::any_of(instructions.begin(), instructions.end(), [&dead](auto& inst) {
+            return dead.contains(inst.get());
+        });
+
+        if (!any) {
+            continue;
+        }
+
+        Vector<OwnPtr<Instruction>> rewritten;
+        for (auto& inst : instructions) {
+            if (dead.contains(inst.get())) {
+                this->remove_uses(inst.get());
+                continue;
+            }
+
+            rewritten.push_back(move(inst));
+        }
+
+        block->set_instructions(move(rewritten));
+    }
+}
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <quart/common.h>
+#include <quart/bytecode/pass.h>
+
+namespace quart {
+    class State;
+}
+
+namespace quart::bytecode {
+
+// Removes instructions without side effects whose results are never read, following def-use chains until nothing else
+// becomes dead. Stores to locals that are overwritten or go out of scope before anything reads them are removed too.
+class DeadCodeEliminationPass : public Pass {
+public:
+    DeadCodeEliminationPass(State& state) : m_state(state) {}
+
+    void run(Function*) override;
+    void on_instruction(Instruction*) override {}
+
+    bool preserves_control_flow() const override { return true; }
+
+private:
+    void eliminate_dead_stores(Function*);
+    void eliminate_dead_instructions(Function*);
+
+    void remove_uses(Instruction*);
+
+    State& m_state;
+};
+
+}
@@ -0,0 +1,346 @@
+#include <quart/bytecode/passes/inliner.h>
+#include <quart/language/functions.h>
+#include <quart/language/state.h>
+
+namespace quart::bytecode {
+
+void Inliner::run(HashMap<Identifier, RefPtr<Function>> const& functions) {
+    CallGraph graph(functions);
+
+    for (auto& component : graph.components()) {
+        for (u32 index : component) {
+            this->inline_calls(graph, index);
+        }
+    }
+}
+
+size_t Inliner::size_of(Function* function) {
+    size_t size = 0;
+    for (auto* block : function->basic_blocks()) {
+        size += block->instructions().size();
+    }
+
+    return size;
+}
+
+bool Inliner::is_inlinable(Function* function) const {
+    if (function->inline_hint() == Function::InlineHint::Never) {
+        return false;
+    }
+
+    // These are called with arguments or return values that backends pass in a way a plain local can't stand in for
+    if (function->is_main() || function->is_async() || function->is_variadic() || function->is_struct_return()) {
+        return false;
+    } else if (function->has_trait_parameter()) {
+        return false;
+    }
+
+    auto& parameters = function->parameters();
+    if (std::any_of(parameters.begin(), parameters.end(), [](auto& parameter) { return parameter.is_byval(); })) {
+        return false;
+    }
+
+    for (auto* block : function->basic_blocks()) {
+        for (auto& inst : block->instructions()) {
+            switch (inst->type()) {
+                case Instruction::NewLocalScope: {
+                    // Only the scope of the function itself is dropped, anything else would end up in the wrong place
+                    bool is_own_scope = block == function->entry_block() && inst == block->instructions().front();
+                    if (!is_own_scope || inst->as<NewLocalScope>()->function() != function) {
+                        return false;
+                    }
+
+                    break;
+                }
+                case Instruction::NewFunction:
+                case Instruction::NewStruct:
+                case Instruction::GetReturn:
+                case Instruction::Phi:
+                    return false;
+                default:
+                    break;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool Inliner::should_inline(CallGraph const& graph, u32 caller, Function* callee, size_t caller_size) const {
+    auto index = graph.index_of(callee);
+    if (!index.has_value() || graph.component_of(*index) == graph.component_of(caller)) {
+        return false;
+    } else if (!this->is_inlinable(callee)) {
+        return false;
+    }
+
+    if (callee->inline_hint() == Function::InlineHint::Always) {
+        return true;
+    }
+
+    size_t size = size_of(callee);
+    return size <= INLINE_THRESHOLD && caller_size + size <= MAX_CALLER_SIZE;
+}
+
+void Inliner::inline_calls(CallGraph const& graph, u32 index) {
+    Function* caller = graph.function(index);
+    if (caller->has_trait_parameter()) {
+        return;
+    }
+
+    HashMap<Register, Function*> definitions;
+    for (auto* block : caller->basic_blocks()) {
+        for (auto& inst : block->instructions()) {
+            if (auto* get_function = inst->as<GetFunction>()) {
+                definitions[get_function->dst()] = get_function->function();
+            }
+        }
+    }
+
+    size_t size = size_of(caller);
+    bool changed = false;
+
+    // Inlined bodies are never scanned again, their calls were already rejected when the callee itself was visited
+    Vector<BasicBlock*> worklist(caller->basic_blocks().rbegin(), caller->basic_blocks().rend());
+    while (!worklist.empty()) {
+        auto* block = worklist.back();
+        worklist.pop_back();
+
+        auto& instructions = block->instructions();
+        for (size_t position = 0; position < instructions.size(); position++) {
+            auto* call = instructions[position]->as<Call>();
+            if (!call) {
+                continue;
+            }
+
+            Function* callee = CallGraph::callee_of(call, definitions);
+            if (!callee || !this->should_inline(graph, index, callee, size)) {
+                continue;
+            }
+
+            size += size_of(callee);
+            changed = true;
+
+            worklist.push_back(this->inline_call(caller, block, position, callee));
+            break;
+        }
+    }
+
+    if (changed) {
+        caller->invalidate_analysis();
+    }
+}
+
+BasicBlock* Inliner::inline_call(Function* caller, BasicBlock* block, size_t position, Function* callee) {
+    Vector<OwnPtr<Instruction>> instructions = move(block->instructions());
+
+    OwnPtr<Instruction> inst = move(instructions[position]);
+    auto* call = inst->as<Call>();
+
+    Vector<OwnPtr<Instruction>> head;
+    Vector<OwnPtr<Instruction>> tail;
+
+    for (size_t i = 0; i < instructions.size(); i++) {
+        if (i < position) {
+            head.push_back(move(instructions[i]));
+        } else if (i > position) {
+            tail.push_back(move(instructions[i]));
+        }
+    }
+
+    Vector<u32> locals(callee->local_count());
+    for (auto [index, type] : llvm::enumerate(callee->locals())) {
+        u32 local = caller->allocate_local();
+        caller->set_local_type(local, type);
+
+        if (callee->is_struct_local(index)) {
+            caller->add_struct_local(local);
+        }
+
+        locals[index] = local;
+    }
+
+    Optional<u32> return_local;
+    if (!callee->return_type()->is_void()) {
+        return_local = caller->allocate_local();
+        caller->set_local_type(*return_local, callee->return_type());
+    }
+
+    Vector<Instruction*> inserted;
+    auto append = [&inserted](Vector<OwnPtr<Instruction>>& instructions, OwnPtr<Instruction> inst) {
+        inserted.push_back(inst.get());
+        instructions.push_back(move(inst));
+    };
+
+    // Parameters are the first locals of a function, everything else has to start out zeroed on every call since the
+    // inlined body might now run more than once within the same frame
+    size_t parameters = callee->parameters().size();
+    for (auto [index, local] : llvm::enumerate(locals)) {
+        if (index < parameters) {
+            append(head, make<SetLocal>(local, call->arguments()[index]));
+        } else if (!callee->is_struct_local(index) && callee->locals()[index]) {
+            append(head, make<SetLocal>(local, Optional<Operand>()));
+        }
+    }
+
+    HashMap<BasicBlock*, BasicBlock*> blocks;
+    Vector<BasicBlock*> clones;
+
+    for (auto* original : callee->basic_blocks()) {
+        auto* clone = m_state.create_block();
+
+        blocks[original] = clone;
+        clones.push_back(clone);
+    }
+
+    auto* continuation = m_state.create_block();
+    append(head, make<Jump>(blocks[callee->entry_block()]));
+
+    HashMap<Register, Register> registers;
+    auto remap = [this, &registers](Register reg) {
+        auto iterator = registers.find(reg);
+        if (iterator != registers.end()) {
+            return iterator->second;
+        }
+
+        RegisterState state = m_state.register_state(reg);
+        Register mapped = m_state.allocate_register();
+
+        m_state.set_register_state(mapped, state.type, state.function, state.flags);
+        registers[reg] = mapped;
+
+        return mapped;
+    };
+
+    for (auto [original, clone] : llvm::zip(callee->basic_blocks(), clones)) {
+        Vector<OwnPtr<Instruction>> body;
+        for (auto& inst : original->instructions()) {
+            if (inst->is<NewLocalScope>()) {
+                continue;
+            } else if (auto* ret = inst->as<Return>()) {
+                auto value = ret->value();
+                if (value.has_value() && return_local.has_value()) {
+                    Operand operand = value->is_register() ? Operand(remap(value->reg())) : *value;
+                    append(body, make<SetLocal>(*return_local, operand));
+                }
+
+                append(body, make<Jump>(continuation));
+                continue;
+            }
+
+            auto copy = inst->clone();
+            copy->visit_operands([&remap](Operand& operand) {
+                if (operand.is_register()) {
+                    operand = Operand(remap(operand.reg()));
+                }
+            });
+
+            if (auto result = copy->result()) {
+                copy->set_result(remap(*result));
+            }
+
+            switch (copy->type()) {
+                case Instruction::GetLocal: {
+                    auto* get = copy->as<GetLocal>();
+                    get->set_index(locals[get->index()]);
+
+                    break;
+                }
+                case Instruction::GetLocalRef: {
+                    auto* ref = copy->as<GetLocalRef>();
+                    ref->set_index(locals[ref->index()]);
+
+                    break;
+                }
+                case Instruction::SetLocal: {
+                    auto* set = copy->as<SetLocal>();
+                    set->set_index(locals[set->index()]);
+
+                    break;
+                }
+                case Instruction::Jump: {
+                    auto* jump = copy->as<Jump>();
+                    jump->set_target(blocks[jump->target()]);
+
+                    break;
+                }
+                case Instruction::JumpIf: {
+                    auto* jump = copy->as<JumpIf>();
+                    jump->set_targets(blocks[jump->true_target()], blocks[jump->false_target()]);
+
+                    break;
+                }
+                default:
+                    break;
+            }
+
+            append(body, move(copy));
+        }
+
+        clone->set_instructions(move(body));
+    }
+
+    Vector<OwnPtr<Instruction>> rest;
+    if (return_local.has_value()) {
+        append(rest, make<GetLocal>(call->dst(), *return_local));
+    }
+
+    for (auto& inst : tail) {
+        rest.push_back(move(inst));
+    }
+
+    block->set_instructions(move(head));
+    continuation->set_instructions(move(rest));
+
+    BasicBlock* previous = block;
+    for (auto* clone : clones) {
+        caller->insert_block_after(previous, clone);
+        previous = clone;
+    }
+
+    caller->insert_block_after(previous, continuation);
+
+    for (auto* inserted_inst : inserted) {
+        inserted_inst->set_register_uses(m_state.generator());
+    }
+
+    Register function = call->function();
+
+    this->remove_uses(inst.get());
+    this->remove_function_reference(caller, function);
+
+    return continuation;
+}
+
+void Inliner::remove_uses(Instruction* inst) {
+    inst->visit_operands([this, inst](Operand& operand) {
+        if (operand.is_register()) {
+            m_state.register_uses(operand.reg()).remove(inst);
+        }
+    });
+}
+
+void Inliner::remove_function_reference(Function* caller, Register reg) {
+    if (!m_state.register_uses(reg).all_references().empty()) {
+        return;
+    }
+
+    // Once nothing calls through it, dropping the `GetFunction` lets the callee be eliminated if this was its last use
+    for (auto* block : caller->basic_blocks()) {
+        auto& instructions = block->instructions();
+        auto iterator = std::find_if(instructions.begin(), instructions.end(), [reg](OwnPtr<Instruction> const& inst) {
+            return inst->is<GetFunction>() && *inst->result() == reg;
+        });
+
+        if (iterator == instructions.end()) {
+            continue;
+        }
+
+        instructions.erase(iterator);
+        block->set_instructions(move(instructions));
+
+        return;
+    }
+}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <quart/common.h>
+#include <quart/bytecode/instruction.h>
+#include <quart/bytecode/basic_block.h>
+#include <quart/bytecode/analysis/call_graph.h>
+
+namespace quart {
+    class State;
+}
+
+namespace quart::bytecode {
+
+// Replaces direct calls with a copy of the callee's body. Functions are visited bottom-up over the call graph, so a
+// callee has already had its own calls inlined by the time it gets copied into its callers. Calls between functions of
+// the same recursive cycle are never inlined.
+//
+// Unlike the passes run by a `PassManager` this works on the whole program at once and has to run before them.
+class Inliner {
+public:
+    // Callees with at most this many instructions are inlined without being marked `![inline]`
+    static constexpr size_t INLINE_THRESHOLD = 32;
+
+    // Past this size a caller only gets `![inline]` callees inlined into it
+    static constexpr size_t MAX_CALLER_SIZE = 4096;
+
+    Inliner(State& state) : m_state(state) {}
+
+    void run(HashMap<Identifier, RefPtr<Function>> const& functions);
+
+private:
+    bool is_inlinable(Function*) const;
+    bool should_inline(CallGraph const&, u32 caller, Function* callee, size_t caller_size) const;
+
+    void inline_calls(CallGraph const&, u32 caller);
+
+    // Inlines the call at `position` in `block`, returning the block the instructions following it were moved to
+    BasicBlock* inline_call(Function* caller, BasicBlock* block, size_t position, Function* callee);
+
+    void remove_uses(Instruction*);
+    void remove_function_reference(Function*, Register);
+
+    static size_t size_of(Function*);
+
+    State& m_state;
+};
+
+}
@@ -0,0 +1,146 @@
+#include <quart/bytecode/passes/lower_phis.h>
+#include <quart/language/functions.h>
+#include <quart/language/state.h>
+
+namespace quart::bytecode {
+
+void LowerPhisPass::run(Function* function) {
+    // Splitting edges appends new blocks, none of which have phis
+    Vector<BasicBlock*> blocks = function->basic_blocks();
+    for (auto* block : blocks) {
+        if (block->instructions().empty() || !block->instructions().front()->is<Phi>()) {
+            continue;
+        }
+
+        this->lower(function, block);
+    }
+
+    function->invalidate_analysis();
+}
+
+void LowerPhisPass::lower(Function* function, BasicBlock* block) {
+    auto& generator = m_state.generator();
+    Vector<OwnPtr<Instruction>> instructions = move(block->instructions());
+
+    // Kept in the order predecessors first show up so that the blocks created for split edges are deterministic
+    Vector<std::pair<BasicBlock*, ParallelCopy>> edges;
+
+    auto iterator = instructions.begin();
+    for (; iterator != instructions.end() && (*iterator)->is<Phi>(); iterator++) {
+        auto* phi = (*iterator)->as<Phi>();
+        for (auto& incoming : phi->incoming()) {
+            auto edge = std::find_if(edges.begin(), edges.end(), [&incoming](auto& entry) {
+                return entry.first == incoming.block;
+            });
+
+            if (edge == edges.end()) {
+                edges.push_back({ incoming.block, {} });
+                edge = std::prev(edges.end());
+            }
+
+            // A predecessor that jumps here from both of its targets shows up twice with the same value
+            bool seen = std::any_of(edge->second.begin(), edge->second.end(), [phi](auto& copy) {
+                return copy.first == phi->dst();
+            });
+
+            if (!seen) {
+                edge->second.push_back({ phi->dst(), incoming.value });
+            }
+        }
+
+        (*iterator)->visit_operands([this, &iterator](Operand& operand) {
+            if (operand.is_register()) {
+                m_state.register_uses(operand.reg()).remove(iterator->get());
+            }
+        });
+    }
+
+    instructions.erase(instructions.begin(), iterator);
+    block->set_instructions(move(instructions));
+
+    for (auto& [predecessor, copies] : edges) {
+        auto sequence = this->sequentialize(move(copies));
+        for (auto& copy : sequence) {
+            copy->set_register_uses(generator);
+        }
+
+        Vector<OwnPtr<Instruction>> rewritten = move(predecessor->instructions());
+        OwnPtr<Instruction> terminator = move(rewritten.back());
+
+        rewritten.pop_back();
+        if (!terminator->is<JumpIf>()) {
+            for (auto& copy : sequence) {
+                rewritten.push_back(move(copy));
+            }
+
+            rewritten.push_back(move(terminator));
+            predecessor->set_instructions(move(rewritten));
+
+            continue;
+        }
+
+        BasicBlock* split = m_state.create_block();
+        function->insert_block(split);
+
+        sequence.push_back(make<Jump>(block));
+        split->set_instructions(move(sequence));
+
+        auto* jump_if = terminator->as<JumpIf>();
+        auto* true_target = jump_if->true_target() == block ? split : jump_if->true_target();
+        auto* false_target = jump_if->false_target() == block ? split : jump_if->false_target();
+
+        auto* retargeted = new JumpIf(jump_if->condition(), true_target, false_target);
+        if (jump_if->condition().is_register()) {
+            m_state.register_uses(jump_if->condition().reg()).remove(terminator.get());
+        }
+
+        retargeted->set_register_uses(generator);
+
+        rewritten.push_back(OwnPtr<Instruction>(retargeted));
+        predecessor->set_instructions(move(rewritten));
+    }
+}
+
+Vector<OwnPtr<Instruction>> LowerPhisPass::sequentialize(ParallelCopy copies) {
+    Vector<OwnPtr<Instruction>> sequence;
+    copies.erase(std::remove_if(copies.begin(), copies.end(), [](auto& copy) {
+        return copy.second == Operand(copy.first);
+    }), copies.end());
+
+    auto is_read = [&copies](Register reg) {
+        return std::any_of(copies.begin(), copies.end(), [reg](auto& copy) {
+            return copy.second == Operand(reg);
+        });
+    };
+
+    while (!copies.empty()) {
+        auto ready = std::find_if(copies.begin(), copies.end(), [&is_read](auto& copy) {
+            return !is_read(copy.first);
+        });
+
+        if (ready != copies.end()) {
+            sequence.push_back(make<Copy>(ready->first, ready->second));
+            copies.erase(ready);
+
+            continue;
+        }
+
+        // Every remaining destination is still needed as a source so they form a cycle, e.g. swapping two values.
+        // Saving one of them in a temporary breaks it.
+        Register reg = copies.front().first;
+        Register temporary = m_state.allocate_register();
+
+        m_state.set_register_state(temporary, m_state.type(reg));
+        sequence.push_back(make<Copy>(temporary, Operand(reg)));
+
+        for (auto& copy : copies) {
+            if (copy.second == Operand(reg)) {
+                copy.second = Operand(temporary);
+            }
+        }
+    }
+
+    return sequence;
+}
+
+}
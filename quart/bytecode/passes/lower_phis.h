@@ -0,0 +1,32 @@
+#pragma once
+
+#include <quart/common.h>
+#include <quart/bytecode/pass.h>
+
+namespace quart {
+    class State;
+}
+
+namespace quart::bytecode {
+
+// Takes a function out of SSA form by replacing every `Phi` with `Copy`s at the end of its predecessors. Edges coming
+// from blocks with more than one successor are split first so the copies only run when that edge is taken.
+class LowerPhisPass : public Pass {
+public:
+    LowerPhisPass(State& state) : m_state(state) {}
+
+    void run(Function*) override;
+    void on_instruction(Instruction*) override {}
+
+private:
+    using ParallelCopy = Vector<std::pair<Register, Operand>>;
+
+    void lower(Function*, BasicBlock*);
+
+    // Orders the copies of a single edge so that no destination is overwritten before every copy has read it
+    Vector<OwnPtr<Instruction>> sequentialize(ParallelCopy);
+
+    State& m_state;
+};
+
+}
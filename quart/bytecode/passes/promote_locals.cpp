@@ -0,0 +1,393 @@
+#include <quart/bytecode/passes/promote_locals.h>
+#include <quart/language/functions.h>
+#include <quart/language/state.h>
+
+namespace quart::bytecode {
+
+static bool is_promotable_type(Type* type) {
+    if (!type) {
+        return false;
+    }
+
+    return type->is_int() || type->is_floating_point() || type->is_pointer() || type->is_reference();
+}
+
+void PromoteLocalsPass::run(Function* function) {
+    m_promotable.clear();
+    m_local_references.clear();
+    m_phis.clear();
+    m_values.clear();
+    m_replacements.clear();
+
+    if (!function->entry_block() || function->local_count() == 0) {
+        return;
+    }
+
+    m_cfg = &function->analysis().cfg();
+
+    // Phis can't be placed in the entry block since there's nowhere to take the initial values from
+    if (!m_cfg->predecessors(0).empty()) {
+        return;
+    }
+
+    this->find_promotable_locals(function);
+    if (std::none_of(m_promotable.begin(), m_promotable.end(), [](bool promotable) { return promotable; })) {
+        return;
+    }
+
+    // Unreachable blocks are never renamed, so they could otherwise still refer to references that no longer exist
+    Vector<BasicBlock*> unreachable_blocks;
+    for (auto* block : function->basic_blocks()) {
+        if (!m_cfg->is_reachable(block)) {
+            unreachable_blocks.push_back(block);
+        }
+    }
+
+    for (auto* block : unreachable_blocks) {
+        function->remove_block(block);
+    }
+
+    m_dominators = &function->analysis().dominators();
+
+    this->insert_phis(function);
+    this->rename(function);
+    this->replace_uses(function);
+}
+
+Optional<u32> PromoteLocalsPass::promoted_local_of(Register ref) const {
+    auto iterator = m_local_references.find(ref);
+    if (iterator == m_local_references.end() || !m_promotable[iterator->second]) {
+        return {};
+    }
+
+    return iterator->second;
+}
+
+void PromoteLocalsPass::find_promotable_locals(Function* function) {
+    m_promotable.resize(function->local_count());
+    for (auto [index, type] : llvm::enumerate(function->locals())) {
+        m_promotable[index] = !function->is_struct_local(index) && is_promotable_type(type);
+    }
+
+    HashMap<Register, u32> definitions;
+    for (auto* block : m_cfg->reverse_post_order()) {
+        for (auto& inst : block->instructions()) {
+            if (auto result = inst->result()) {
+                definitions[*result]++;
+            }
+
+            if (auto* ref = inst->as<GetLocalRef>()) {
+                m_local_references[ref->dst()] = ref->index();
+            }
+        }
+    }
+
+    for (auto& [reg, local] : m_local_references) {
+        if (definitions[reg] > 1) {
+            m_promotable[local] = false;
+        }
+    }
+
+    // A reference may only be read from or written to directly, anything else lets the address escape
+    auto escape = [this](Operand const& operand) {
+        if (!operand.is_register()) {
+            return;
+        }
+
+        auto iterator = m_local_references.find(operand.reg());
+        if (iterator != m_local_references.end()) {
+            m_promotable[iterator->second] = false;
+        }
+    };
+
+    for (auto* block : m_cfg->reverse_post_order()) {
+        for (auto& inst : block->instructions()) {
+            if (inst->is<Read>()) {
+                continue;
+            } else if (auto* write = inst->as<Write>()) {
+                escape(write->src());
+                continue;
+            }
+
+            inst->visit_operands([&escape](Operand& operand) { escape(operand); });
+        }
+    }
+}
+
+void PromoteLocalsPass::insert_phis(Function* function) {
+    size_t count = m_cfg->size();
+
+    Vector<Vector<u32>> definitions(function->local_count());
+    for (auto [index, block] : llvm::enumerate(m_cfg->reverse_post_order())) {
+        for (auto& inst : block->instructions()) {
+            Optional<u32> local;
+            if (auto* set = inst->as<SetLocal>()) {
+                local = m_promotable[set->index()] ? Optional<u32>(set->index()) : Optional<u32>();
+            } else if (auto* write = inst->as<Write>()) {
+                local = this->promoted_local_of(write->dst());
+            }
+
+            if (!local.has_value()) {
+                continue;
+            }
+
+            auto& blocks = definitions[*local];
+            if (blocks.empty() || blocks.back() != index) {
+                blocks.push_back(index);
+            }
+        }
+    }
+
+    for (u32 local = 0; local < m_promotable.size(); local++) {
+        if (!m_promotable[local]) {
+            continue;
+        }
+
+        Vector<bool> has_phi(count, false);
+        Vector<bool> queued(count, false);
+
+        // Every local has a value on entry, either its argument or zero
+        Vector<u32> worklist = definitions[local];
+        worklist.push_back(0);
+
+        for (u32 index : worklist) {
+            queued[index] = true;
+        }
+
+        while (!worklist.empty()) {
+            u32 index = worklist.back();
+            worklist.pop_back();
+
+            for (u32 frontier : m_dominators->frontier(index)) {
+                if (has_phi[frontier]) {
+                    continue;
+                }
+
+                Register reg = m_state.allocate_register();
+                m_state.set_register_state(reg, function->locals()[local]);
+
+                m_phis[m_cfg->block(frontier)].push_back({ local, new Phi(reg) });
+                has_phi[frontier] = true;
+
+                if (!queued[frontier]) {
+                    queued[frontier] = true;
+                    worklist.push_back(frontier);
+                }
+            }
+        }
+    }
+}
+
+Operand PromoteLocalsPass::resolve(Operand operand) const {
+    while (operand.is_register()) {
+        auto iterator = m_replacements.find(operand.reg());
+        if (iterator == m_replacements.end()) {
+            break;
+        }
+
+        operand = Operand(iterator->second);
+    }
+
+    return operand;
+}
+
+void PromoteLocalsPass::remove_instruction(OwnPtr<Instruction> inst) {
+    inst->visit_operands([this, &inst](Operand& operand) {
+        if (operand.is_register()) {
+            m_state.register_uses(operand.reg()).remove(inst.get());
+        }
+    });
+}
+
+void PromoteLocalsPass::rename(Function* function) {
+    size_t count = m_cfg->size();
+    auto& locals = function->locals();
+
+    m_values.resize(function->local_count());
+
+    Vector<OwnPtr<Instruction>> parameter_loads;
+    for (u32 local = 0; local < m_promotable.size(); local++) {
+        if (!m_promotable[local]) {
+            continue;
+        }
+
+        // Backends still spill arguments into their slots on entry, so parameters are read from there exactly once
+        if (local < function->parameters().size()) {
+            Register reg = m_state.allocate_register();
+            m_state.set_register_state(reg, locals[local]);
+
+            parameter_loads.push_back(make<GetLocal>(reg, local));
+            m_values[local].push_back(Operand(reg));
+        } else {
+            m_values[local].push_back(Operand(0, locals[local]));
+        }
+    }
+
+    Vector<Vector<u32>> pushed(count);
+    Vector<std::pair<u32, bool>> stack = { { 0, false } };
+
+    while (!stack.empty()) {
+        auto [index, exiting] = stack.back();
+        stack.pop_back();
+
+        if (exiting) {
+            for (u32 local : pushed[index]) {
+                m_values[local].pop_back();
+            }
+
+            continue;
+        }
+
+        auto* block = m_cfg->block(index);
+        auto push = [&](u32 local, Operand value) {
+            m_values[local].push_back(value);
+            pushed[index].push_back(local);
+        };
+
+        auto load = [&](Register dst, u32 local, Vector<OwnPtr<Instruction>>& rewritten) {
+            Operand value = m_values[local].back();
+            if (value.is_register()) {
+                m_replacements[dst] = value.reg();
+            } else {
+                rewritten.push_back(make<Move>(dst, value.value()));
+            }
+        };
+
+        Vector<OwnPtr<Instruction>> rewritten;
+        for (auto& entry : m_phis[block]) {
+            push(entry.local, Operand(entry.phi->dst()));
+            rewritten.push_back(OwnPtr<Instruction>(entry.phi));
+        }
+
+        bool needs_parameters = index == 0 && !parameter_loads.empty();
+        if (needs_parameters && (block->instructions().empty() || !block->instructions().front()->is<NewLocalScope>())) {
+            for (auto& parameter : parameter_loads) {
+                rewritten.push_back(move(parameter));
+            }
+
+            needs_parameters = false;
+        }
+
+        Vector<OwnPtr<Instruction>> instructions = move(block->instructions());
+        for (auto& inst : instructions) {
+            switch (inst->type()) {
+                case Instruction::GetLocal: {
+                    auto* get = inst->as<GetLocal>();
+                    if (!m_promotable[get->index()]) {
+                        break;
+                    }
+
+                    load(get->dst(), get->index(), rewritten);
+                    this->remove_instruction(move(inst));
+
+                    continue;
+                }
+                case Instruction::GetLocalRef: {
+                    auto* ref = inst->as<GetLocalRef>();
+                    if (!m_promotable[ref->index()]) {
+                        break;
+                    }
+
+                    this->remove_instruction(move(inst));
+                    continue;
+                }
+                case Instruction::Read: {
+                    auto* read = inst->as<Read>();
+                    auto local = this->promoted_local_of(read->src());
+
+                    if (!local.has_value()) {
+                        break;
+                    }
+
+                    load(read->dst(), *local, rewritten);
+                    this->remove_instruction(move(inst));
+
+                    continue;
+                }
+                case Instruction::SetLocal: {
+                    auto* set = inst->as<SetLocal>();
+                    if (!m_promotable[set->index()]) {
+                        break;
+                    }
+
+                    Optional<Operand> src = set->src();
+                    push(set->index(), src.has_value() ? this->resolve(*src) : Operand(0, locals[set->index()]));
+
+                    this->remove_instruction(move(inst));
+                    continue;
+                }
+                case Instruction::Write: {
+                    auto* write = inst->as<Write>();
+                    auto local = this->promoted_local_of(write->dst());
+
+                    if (!local.has_value()) {
+                        break;
+                    }
+
+                    push(*local, this->resolve(write->src()));
+
+                    this->remove_instruction(move(inst));
+                    continue;
+                }
+                default:
+                    break;
+            }
+
+            bool is_scope = inst->is<NewLocalScope>();
+            rewritten.push_back(move(inst));
+
+            if (needs_parameters && is_scope) {
+                for (auto& parameter : parameter_loads) {
+                    rewritten.push_back(move(parameter));
+                }
+
+                needs_parameters = false;
+            }
+        }
+
+        block->set_instructions(move(rewritten));
+        for (u32 successor : m_cfg->successors(index)) {
+            auto iterator = m_phis.find(m_cfg->block(successor));
+            if (iterator == m_phis.end()) {
+                continue;
+            }
+
+            for (auto& entry : iterator->second) {
+                entry.phi->add_incoming(block, m_values[entry.local].back());
+            }
+        }
+
+        stack.push_back({ index, true });
+        for (u32 child : m_dominators->children(index)) {
+            stack.push_back({ child, false });
+        }
+    }
+}
+
+void PromoteLocalsPass::replace_uses(Function* function) {
+    for (auto* block : function->basic_blocks()) {
+        for (auto& inst : block->instructions()) {
+            // Phis are new and only get their uses recorded once all of their incoming values are known
+            bool is_phi = inst->is<Phi>();
+            inst->visit_operands([&](Operand& operand) {
+                Operand resolved = this->resolve(operand);
+                if (resolved == operand) {
+                    return;
+                }
+
+                if (!is_phi) {
+                    m_state.register_uses(operand.reg()).remove(inst.get());
+                    m_state.register_uses(resolved.reg()).add(inst.get());
+                }
+
+                operand = resolved;
+            });
+
+            if (is_phi) {
+                inst->set_register_uses(m_state.generator());
+            }
+        }
+    }
+}
+
+}
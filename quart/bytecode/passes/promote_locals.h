@@ -0,0 +1,52 @@
+#pragma once
+
+#include <quart/common.h>
+#include <quart/bytecode/pass.h>
+#include <quart/bytecode/analysis/function_analysis.h>
+
+namespace quart {
+    class State;
+}
+
+namespace quart::bytecode {
+
+// Turns locals whose address never escapes into registers, putting the function into SSA form (mem2reg). Loads of a
+// local are replaced by the value that reaches them and `Phi`s are inserted where values from different paths meet.
+class PromoteLocalsPass : public Pass {
+public:
+    PromoteLocalsPass(State& state) : m_state(state) {}
+
+    void run(Function*) override;
+    void on_instruction(Instruction*) override {}
+
+private:
+    struct PhiEntry {
+        u32 local;
+        Phi* phi;
+    };
+
+    void find_promotable_locals(Function*);
+    void insert_phis(Function*);
+    void rename(Function*);
+    void replace_uses(Function*);
+
+    Optional<u32> promoted_local_of(Register ref) const;
+    Operand resolve(Operand) const;
+
+    void remove_instruction(OwnPtr<Instruction>);
+
+    State& m_state;
+
+    ControlFlowGraph const* m_cfg = nullptr;
+    DominatorTree const* m_dominators = nullptr;
+
+    Vector<bool> m_promotable;
+    HashMap<Register, u32> m_local_references;
+
+    HashMap<BasicBlock*, Vector<PhiEntry>> m_phis;
+    Vector<Vector<Operand>> m_values;
+
+    HashMap<Register, Register> m_replacements;
+};
+
+}
@@ -0,0 +1,348 @@
+#include <quart/bytecode/passes/value_numbering.h>
+#include <quart/language/functions.h>
+#include <quart/language/state.h>
+
+namespace quart::bytecode {
+
+static bool is_commutative(Instruction::InstructionType type) {
+    switch (type) {
+        case Instruction::Add:
+        case Instruction::Mul:
+        case Instruction::And:
+        case Instruction::Or:
+        case Instruction::Xor:
+        case Instruction::LogicalAnd:
+        case Instruction::LogicalOr:
+        case Instruction::Eq:
+        case Instruction::Neq:
+            return true;
+        default:
+            return false;
+    }
+}
+
+template<typename T>
+static u64 key_of(T* pointer) {
+    return reinterpret_cast<u64>(pointer);
+}
+
+void ValueNumberingPass::run(Function* function) {
+    m_definitions.clear();
+    m_values.clear();
+    m_loads.clear();
+    m_inserted.clear();
+    m_replacements.clear();
+    m_redundant.clear();
+
+    if (!function->entry_block()) {
+        return;
+    }
+
+    m_cfg = &function->analysis().cfg();
+    m_dominators = &function->analysis().dominators();
+
+    for (auto* block : function->basic_blocks()) {
+        for (auto& inst : block->instructions()) {
+            if (auto result = inst->result()) {
+                m_definitions[*result]++;
+            }
+        }
+    }
+
+    m_loads.resize(m_cfg->size());
+    m_inserted.resize(m_cfg->size());
+
+    // Values numbered in a block are only available in the blocks it dominates, so they're dropped once its subtree
+    // has been walked
+    Vector<std::pair<u32, bool>> stack = { { 0, false } };
+    while (!stack.empty()) {
+        auto [index, exiting] = stack.back();
+        stack.pop_back();
+
+        if (exiting) {
+            for (auto& expression : m_inserted[index]) {
+                m_values.erase(expression);
+            }
+
+            continue;
+        }
+
+        this->number(function, index);
+
+        stack.push_back({ index, true });
+        for (u32 child : m_dominators->children(index)) {
+            stack.push_back({ child, false });
+        }
+    }
+
+    if (m_redundant.empty()) {
+        return;
+    }
+
+    for (auto* block : function->basic_blocks()) {
+        auto& instructions = block->instructions();
+        bool any = std::any_of(instructions.begin(), instructions.end(), [this](auto& inst) {
+            return m_redundant.contains(inst.get());
+        });
+
+        if (!any) {
+            continue;
+        }
+
+        Vector<OwnPtr<Instruction>> rewritten;
+        for (auto& inst : instructions) {
+            if (!m_redundant.contains(inst.get())) {
+                rewritten.push_back(move(inst));
+                continue;
+            }
+
+            inst->visit_operands([this, &inst](Operand& operand) {
+                if (operand.is_register()) {
+                    m_state.register_uses(operand.reg()).remove(inst.get());
+                }
+            });
+        }
+
+        block->set_instructions(move(rewritten));
+    }
+
+    this->replace_uses(function);
+}
+
+ValueNumberingPass::Effect ValueNumberingPass::effect_of(Function* function, Instruction* inst) const {
+    switch (inst->type()) {
+    #define Op(x) case Instruction::x: // NOLINT
+        ENUMERATE_BINARY_OPS(Op)
+    #undef Op
+        case Instruction::Move:
+        case Instruction::Boolean:
+        case Instruction::Null:
+        case Instruction::Not:
+        case Instruction::Cast:
+        case Instruction::GetGlobalRef:
+        case Instruction::GetMemberRef:
+            return Effect::Pure;
+        case Instruction::GetLocalRef:
+            // Struct locals are aliases that a `SetLocal` can point somewhere else
+            return function->is_struct_local(inst->as<GetLocalRef>()->index()) ? Effect::None : Effect::Pure;
+        case Instruction::GetLocal:
+            return function->is_struct_local(inst->as<GetLocal>()->index()) ? Effect::None : Effect::Load;
+        case Instruction::GetGlobal:
+        case Instruction::GetMember:
+        case Instruction::Read:
+            return Effect::Load;
+        case Instruction::SetLocal:
+        case Instruction::SetGlobal:
+        case Instruction::SetMember:
+        case Instruction::Write:
+        case Instruction::Memcpy:
+        case Instruction::Call:
+        case Instruction::NewLocalScope:
+            return Effect::Clobber;
+        default:
+            return Effect::None;
+    }
+}
+
+Optional<ValueNumberingPass::Expression> ValueNumberingPass::expression_of(Instruction* inst) const {
+    Expression expression = { inst->type(), key_of(m_state.type(*inst->result())) };
+
+    bool valid = true;
+    auto encode = [&](Operand operand) -> Array<u64, 3> {
+        operand = this->resolve(operand);
+        if (operand.is_value()) {
+            return { 0, operand.value(), key_of(operand.value_type()) };
+        }
+
+        // A register that's assigned more than once doesn't name a single value
+        auto iterator = m_definitions.find(operand.reg());
+        if (iterator == m_definitions.end() || iterator->second != 1) {
+            valid = false;
+        }
+
+        return { 1, operand.value(), 0 };
+    };
+
+    auto push = [&expression](Array<u64, 3> const& operand) {
+        expression.insert(expression.end(), operand.begin(), operand.end());
+    };
+
+    switch (inst->type()) {
+    #define Op(x) /* NOLINT */                                                  \
+        case Instruction::x: {                                                  \
+            auto* operation = inst->as<x>();                                    \
+            auto lhs = encode(operation->lhs());                                \
+            auto rhs = encode(operation->rhs());                                \
+                                                                                \
+            if (is_commutative(inst->type()) && rhs < lhs) {                    \
+                std::swap(lhs, rhs);                                            \
+            }                                                                   \
+                                                                                \
+            push(lhs);                                                          \
+            push(rhs);                                                          \
+            break;                                                              \
+        }
+        ENUMERATE_BINARY_OPS(Op)
+    #undef Op
+        case Instruction::Move:
+            expression.push_back(inst->as<Move>()->src());
+            break;
+        case Instruction::Boolean:
+            expression.push_back(inst->as<Boolean>()->value());
+            break;
+        case Instruction::Null:
+            expression.push_back(key_of(inst->as<Null>()->type()));
+            break;
+        case Instruction::Not:
+            push(encode(inst->as<Not>()->src()));
+            break;
+        case Instruction::Cast: {
+            auto* cast = inst->as<Cast>();
+
+            push(encode(cast->src()));
+            expression.push_back(key_of(cast->type()));
+
+            break;
+        }
+        case Instruction::GetLocal:
+            expression.push_back(inst->as<GetLocal>()->index());
+            break;
+        case Instruction::GetLocalRef:
+            expression.push_back(inst->as<GetLocalRef>()->index());
+            break;
+        case Instruction::GetGlobal:
+            expression.push_back(inst->as<GetGlobal>()->index());
+            break;
+        case Instruction::GetGlobalRef:
+            expression.push_back(inst->as<GetGlobalRef>()->index());
+            break;
+        case Instruction::GetMember: {
+            auto* member = inst->as<GetMember>();
+
+            push(encode(Operand(member->src())));
+            push(encode(member->index()));
+
+            break;
+        }
+        case Instruction::GetMemberRef: {
+            auto* member = inst->as<GetMemberRef>();
+
+            push(encode(Operand(member->src())));
+            push(encode(member->index()));
+
+            break;
+        }
+        case Instruction::Read:
+            push(encode(Operand(inst->as<Read>()->src())));
+            break;
+        default:
+            return {};
+    }
+
+    if (!valid) {
+        return {};
+    }
+
+    return expression;
+}
+
+void ValueNumberingPass::kill_loads(Function* function, ValueTable& loads, Instruction* inst) const {
+    auto* set = inst->as<SetLocal>();
+    if (!set || function->is_struct_local(set->index())) {
+        loads.clear();
+        return;
+    }
+
+    // Storing to a local only changes that local and whatever reads through a reference to it
+    Vector<Expression> killed;
+    for (auto& [expression, _] : loads) {
+        bool is_local = expression[0] == Instruction::GetLocal && expression[2] == set->index();
+        bool is_indirect = expression[0] == Instruction::Read || expression[0] == Instruction::GetMember;
+
+        if (is_local || is_indirect) {
+            killed.push_back(expression);
+        }
+    }
+
+    for (auto& expression : killed) {
+        loads.erase(expression);
+    }
+}
+
+void ValueNumberingPass::number(Function* function, u32 index) {
+    auto& loads = m_loads[index];
+
+    // With a single predecessor every path here goes through the end of that block, so its loads are still valid
+    auto& predecessors = m_cfg->predecessors(index);
+    if (predecessors.size() == 1 && predecessors[0] != index) {
+        loads = m_loads[predecessors[0]];
+    }
+
+    for (auto& inst : m_cfg->block(index)->instructions()) {
+        Effect effect = this->effect_of(function, inst.get());
+        if (effect == Effect::Clobber) {
+            this->kill_loads(function, loads, inst.get());
+            continue;
+        } else if (effect == Effect::None) {
+            continue;
+        }
+
+        Register dst = *inst->result();
+        if (m_definitions[dst] != 1) {
+            continue;
+        }
+
+        auto expression = this->expression_of(inst.get());
+        if (!expression.has_value()) {
+            continue;
+        }
+
+        auto& table = effect == Effect::Pure ? m_values : loads;
+
+        auto iterator = table.find(*expression);
+        if (iterator != table.end()) {
+            m_replacements[dst] = iterator->second;
+            m_redundant.insert(inst.get());
+
+            continue;
+        }
+
+        table[*expression] = dst;
+        if (effect == Effect::Pure) {
+            m_inserted[index].push_back(move(*expression));
+        }
+    }
+}
+
+Operand ValueNumberingPass::resolve(Operand operand) const {
+    while (operand.is_register()) {
+        auto iterator = m_replacements.find(operand.reg());
+        if (iterator == m_replacements.end()) {
+            break;
+        }
+
+        operand = Operand(iterator->second);
+    }
+
+    return operand;
+}
+
+void ValueNumberingPass::replace_uses(Function* function) {
+    for (auto* block : function->basic_blocks()) {
+        for (auto& inst : block->instructions()) {
+            inst->visit_operands([&](Operand& operand) {
+                Operand resolved = this->resolve(operand);
+                if (resolved == operand) {
+                    return;
+                }
+
+                m_state.register_uses(operand.reg()).remove(inst.get());
+                m_state.register_uses(resolved.reg()).add(inst.get());
+
+                operand = resolved;
+            });
+        }
+    }
+}
+
+}
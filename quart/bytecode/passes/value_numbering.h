@@ -0,0 +1,61 @@
+#pragma once
+
+#include <quart/common.h>
+#include <quart/bytecode/pass.h>
+#include <quart/bytecode/analysis/function_analysis.h>
+
+namespace quart {
+    class State;
+}
+
+namespace quart::bytecode {
+
+// Dominator-based global value numbering. A pure instruction computing the same thing as one that dominates it is
+// replaced by the earlier result. Loads (`GetLocal`, `GetGlobal`, `GetMember` and `Read`) are only reused within a chain of blocks
+// that each have a single predecessor, and only until something that may write to memory is seen in between.
+class ValueNumberingPass : public Pass {
+public:
+    ValueNumberingPass(State& state) : m_state(state) {}
+
+    void run(Function*) override;
+    void on_instruction(Instruction*) override {}
+
+    bool preserves_control_flow() const override { return true; }
+
+private:
+    using Expression = Vector<u64>;
+    using ValueTable = HashMap<Expression, Register>;
+
+    enum class Effect : u8 {
+        None,
+        Pure,
+        Load,
+        Clobber
+    };
+
+    Effect effect_of(Function*, Instruction*) const;
+    Optional<Expression> expression_of(Instruction*) const;
+
+    void number(Function*, u32 block);
+    void kill_loads(Function*, ValueTable&, Instruction*) const;
+
+    Operand resolve(Operand) const;
+    void replace_uses(Function*);
+
+    State& m_state;
+
+    ControlFlowGraph const* m_cfg = nullptr;
+    DominatorTree const* m_dominators = nullptr;
+
+    HashMap<Register, u32> m_definitions;
+
+    ValueTable m_values;
+    Vector<ValueTable> m_loads;
+
+    Vector<Vector<Expression>> m_inserted;
+
+    HashMap<Register, Register> m_replacements;
+    Set<Instruction*> m_redundant;
+};
+
+}
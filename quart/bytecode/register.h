@@ -18,6 +18,8 @@ public:
     }
 
     constexpr u32 index() const { return m_index; }
+
+    u64 hash() const { return hash_integer(m_index); }
     
 private:
     u32 m_index = 0;
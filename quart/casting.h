@@ -28,9 +28,9 @@ struct isa_impl<To, std::shared_ptr<From>> {
     static bool isa(const std::shared_ptr<From>& v) { return isa_impl<To, From>::isa(*v); }
 };
 
-template<typename To, typename From>
-struct isa_impl<To, std::unique_ptr<From>> {
-    static bool isa(const std::unique_ptr<From>& v) { return isa_impl<To, From>::isa(*v); }
+template<typename To, typename From, typename Deleter>
+struct isa_impl<To, std::unique_ptr<From, Deleter>> {
+    static bool isa(const std::unique_ptr<From, Deleter>& v) { return isa_impl<To, From>::isa(*v); }
 };
 
 template<typename To, typename From>
@@ -48,9 +48,9 @@ struct cast_impl<To, std::shared_ptr<From>> {
     static To* cast(const std::shared_ptr<From>& v) { return cast_impl<To, From>::cast(*v); }
 };
 
-template<typename To, typename From>
-struct cast_impl<To, std::unique_ptr<From>> {
-    static To* cast(const std::unique_ptr<From>& v) { return cast_impl<To, From>::cast(*v); }
+template<typename To, typename From, typename Deleter>
+struct cast_impl<To, std::unique_ptr<From, Deleter>> {
+    static To* cast(const std::unique_ptr<From, Deleter>& v) { return cast_impl<To, From>::cast(*v); }
 };
 
 }
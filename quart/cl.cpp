@@ -1,5 +1,6 @@
 #include <quart/cl.h>
 #include <quart/errors.h>
+#include <quart/module_cache.h>
 
 #include <llvm/Support/CommandLine.h>
 
@@ -116,7 +117,44 @@ const llvm::cl::opt<bool> jit(
     llvm::cl::cat(category)
 );
 
-const llvm::cl::list<String> files(llvm::cl::Positional, llvm::cl::desc("<files>"), llvm::cl::ZeroOrMore);
+const llvm::cl::opt<String> cache_dir(
+    "cache-dir",
+    llvm::cl::desc("Set the directory parsed modules are cached in (defaults to $XDG_CACHE_HOME/quart)"),
+    llvm::cl::value_desc("path"),
+    llvm::cl::Optional,
+    llvm::cl::cat(category)
+);
+
+const llvm::cl::opt<bool> no_cache(
+    "no-cache",
+    llvm::cl::desc("Always parse modules from scratch instead of using the cache"),
+    llvm::cl::init(false),
+    llvm::cl::cat(category)
+);
+
+const llvm::cl::opt<bool> lazy_functions(
+    "lazy-functions",
+    llvm::cl::desc("Only parse and generate the bodies of functions that are used"),
+    llvm::cl::init(false),
+    llvm::cl::cat(category)
+);
+
+const llvm::cl::opt<bool> dump_bytecode(
+    "dump-bytecode",
+    llvm::cl::desc("Print the bytecode of every function before and after the bytecode passes"),
+    llvm::cl::init(false),
+    llvm::cl::cat(category)
+);
+
+// libLLVM already registers an option called `threads`
+const llvm::cl::opt<unsigned> threads(
+    "codegen-threads",
+    llvm::cl::desc("Set the number of threads used for code generation (defaults to one per hardware thread)"),
+    llvm::cl::init(0),
+    llvm::cl::cat(category)
+);
+
+const llvm::cl::list<String> files(llvm::cl::Positional, llvm::cl::desc("[run] <files>"), llvm::cl::ZeroOrMore);
 
 ErrorOr<Arguments> parse_arguments(int argc, char** argv) {
     Arguments args;
@@ -133,7 +171,15 @@ ErrorOr<Arguments> parse_arguments(int argc, char** argv) {
         return args;
     }
 
-    args.file = files.front(); 
+    auto file = files.begin();
+    if (*file == "run") {
+        args.run = true;
+        if (++file == files.end()) {
+            return err("No input file provided to run");
+        }
+    }
+
+    args.file = *file;
     if (!args.file.exists()) {
         return err("File '{}' does not exist", args.file);
     } else if (!args.file.is_regular_file()) {
@@ -149,6 +195,13 @@ ErrorOr<Arguments> parse_arguments(int argc, char** argv) {
     args.target = target.getValue();
     args.mangle_style = mangle_style;
     args.jit = jit;
+    args.lazy_function_bodies = lazy_functions;
+    args.dump_bytecode = dump_bytecode;
+    args.threads = threads;
+
+    if (!no_cache) {
+        args.cache_dir = cache_dir.empty() ? String(ModuleCache::default_directory()) : cache_dir.getValue();
+    }
 
     args.library_names = std::set<String>(libraries.begin(), libraries.end());
 
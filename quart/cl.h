@@ -16,6 +16,8 @@ struct Arguments {
     String target;
 
     Vector<String> imports;
+
+    String cache_dir;
     
     std::set<String> library_names;
     std::set<String> library_paths;
@@ -28,7 +30,13 @@ struct Arguments {
     bool verbose = false;
     bool no_libc = false;
     bool print_all_targets = false;
+    bool lazy_function_bodies = false;
+    bool dump_bytecode = false;
+
+    unsigned threads = 0;
 
+    // `quart run <file>`, executes the program in the bytecode interpreter instead of building it
+    bool run = false;
     bool jit = false;
 };
 
@@ -22,6 +22,12 @@ public:
     NO_COPY(CodeGen)
 
     virtual ErrorOr<void> generate(CompilerOptions const&) = 0;
+
+    // The object files written by `generate`, in the order they should be linked in
+    Vector<String> const& objects() const { return m_objects; }
+
+protected:
+    Vector<String> m_objects;
 };
 
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 #include <quart/codegen/llvm/codegen.h>
+#include <quart/codegen/llvm/jit.h>
 #include <quart/compiler.h>
+#include <quart/thread_pool.h>
 
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/CFG.h>
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/PassManager.h>
@@ -10,9 +15,16 @@
 #include <llvm/MC/TargetRegistry.h>
 #include <llvm/Target/TargetOptions.h>
 #include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
 
 namespace quart::llvm {
 
+// Roughly how many instructions go into each partition when a module is split up for parallel code generation.
+// The partition count only depends on the module itself so the same input always produces the same objects.
+static constexpr size_t INSTRUCTIONS_PER_PARTITION = 16384;
+static constexpr size_t MAX_PARTITIONS = 32;
+
 LLVMCodeGen::LLVMCodeGen(State& state, String module_name) : m_state(state) {
     m_context = make<::llvm::LLVMContext>();
     m_module = make<::llvm::Module>(move(module_name), *m_context);
@@ -367,7 +379,7 @@ void LLVMCodeGen::generate(bytecode::NewFunction* inst) {
     auto* llvm_function = ::llvm::Function::Create(
         function_type,
         ::llvm::Function::ExternalLinkage,
-        function->qualified_name(),
+        ::llvm::StringRef(function->qualified_name()),
         &*m_module
     );
     
@@ -484,19 +496,19 @@ void LLVMCodeGen::generate(bytecode::NewArray* inst) {
 void LLVMCodeGen::generate(bytecode::NewStruct* inst) {
     Struct* structure = inst->structure();
     if (structure->opaque()) {
-        auto* type = ::llvm::StructType::create(*m_context, structure->qualified_name());
+        auto* type = ::llvm::StructType::create(*m_context, ::llvm::StringRef(structure->qualified_name()));
         m_structs[structure] = type;
 
         return;
     }
 
-    auto* type = ::llvm::StructType::create(*m_context, {}, structure->qualified_name());
+    auto* type = ::llvm::StructType::create(*m_context, {}, ::llvm::StringRef(structure->qualified_name()));
     auto range = ::llvm::map_range(structure->underlying_type()->fields(), [this](auto& entry) {
         return type_of(entry);
     });
 
     Vector<::llvm::Type*> fields = Vector<::llvm::Type*>(range.begin(), range.end());
-    type->setBody(fields);
+    type->setBody(fields, structure->underlying_type()->is_packed());
 
     m_structs[structure] = type;
 }
@@ -577,6 +589,35 @@ void LLVMCodeGen::generate(bytecode::GetReturn* inst) {
     this->set_register(inst->dst(), value);
 }
 
+void LLVMCodeGen::generate(bytecode::Phi* inst) {
+    ::llvm::Type* type = type_of(m_state.type(inst->dst()));
+    ::llvm::PHINode* phi = m_ir_builder->CreatePHI(type, inst->incoming().size());
+
+    // Incoming values along back edges aren't generated yet, so they're filled in once the whole function is
+    m_phis.emplace_back(inst, phi);
+    this->set_register(inst->dst(), phi);
+}
+
+void LLVMCodeGen::generate(bytecode::Copy* inst) {
+    this->set_register(inst->dst(), valueof(inst->src()));
+}
+
+void LLVMCodeGen::resolve_phis() {
+    for (auto& [inst, phi] : m_phis) {
+        // A conditional jump with the same block on both sides is two edges and LLVM wants an entry for each of them
+        for (auto* predecessor : ::llvm::predecessors(phi->getParent())) {
+            auto iterator = ::llvm::find_if(inst->incoming(), [&](auto const& incoming) {
+                return m_basic_blocks[incoming.block] == predecessor;
+            });
+
+            ASSERT(iterator != inst->incoming().end(), "Phi is missing an incoming value");
+            phi->addIncoming(valueof(iterator->value), predecessor);
+        }
+    }
+
+    m_phis.clear();
+}
+
 void LLVMCodeGen::set_register(bytecode::Register reg, ::llvm::Value* value) {
     m_registers[reg.index()] = value;
 }
@@ -591,6 +632,19 @@ void LLVMCodeGen::set_register(bytecode::Register reg, ::llvm::Value* value) {
     }
 
     ::llvm::Type* type = type_of(operand.value_type());
+    if (type->isPointerTy()) {
+        if (!operand.value()) {
+            return ::llvm::ConstantPointerNull::get(::llvm::cast<::llvm::PointerType>(type));
+        }
+
+        return ::llvm::ConstantExpr::getIntToPtr(m_ir_builder->getInt64(operand.value()), type);
+    } else if (type->isFloatingPointTy()) {
+        u64 v = operand.value();
+        f64 value = *(f64*)&v;
+
+        return ::llvm::ConstantFP::get(type, value);
+    }
+
     return ::llvm::ConstantInt::get(type, operand.value());
 }
 
@@ -685,7 +739,7 @@ void LLVMCodeGen::generate(bytecode::BasicBlock* block) {
     }
 }
 
-ErrorOr<void> LLVMCodeGen::generate(CompilerOptions const& options) {
+ErrorOr<void> LLVMCodeGen::build_module(CompilerOptions const& options, ::llvm::TargetMachine& machine) {
     for (auto& global : m_state.globals()) {
         ::llvm::Type* type = type_of(global->value_type());
         String name = format("global.{}", global->index());
@@ -710,33 +764,12 @@ ErrorOr<void> LLVMCodeGen::generate(CompilerOptions const& options) {
         for (auto& block : function->basic_blocks()) {
             this->generate(block);
         }
-    }
-
-    String triple, error;
-    if (options.has_target()) {
-        triple = options.target;
-    } else {
-        triple = ::llvm::sys::getDefaultTargetTriple();
-    }
 
-    ::llvm::InitializeAllTargetMCs();
-    ::llvm::InitializeAllAsmParsers();
-    ::llvm::InitializeAllAsmPrinters();
-
-    auto* target = ::llvm::TargetRegistry::lookupTarget(triple, error);
-    if (!target) {
-        return err("Failed to lookup target '{}'", triple);
+        this->resolve_phis();
     }
 
-    ::llvm::TargetOptions target_options;
-    auto reloc = Optional<::llvm::Reloc::Model>(::llvm::Reloc::Model::PIC_);
-
-    OwnPtr<::llvm::TargetMachine> machine(
-        target->createTargetMachine(triple, "generic", "", target_options, reloc)
-    );
-
-    m_module->setDataLayout(machine->createDataLayout());
-    m_module->setTargetTriple(machine->getTargetTriple().str());
+    m_module->setDataLayout(machine.createDataLayout());
+    m_module->setTargetTriple(machine.getTargetTriple().str());
 
     ::llvm::LoopAnalysisManager lam;
     ::llvm::FunctionAnalysisManager fam;
@@ -744,7 +777,7 @@ ErrorOr<void> LLVMCodeGen::generate(CompilerOptions const& options) {
     ::llvm::ModuleAnalysisManager mam;
 
     ::llvm::PassBuilder builder;
-    machine->registerPassBuilderCallbacks(builder);
+    machine.registerPassBuilderCallbacks(builder);
 
     builder.registerModuleAnalyses(mam);
     builder.registerCGSCCAnalyses(cgam);
@@ -813,7 +846,57 @@ ErrorOr<void> LLVMCodeGen::generate(CompilerOptions const& options) {
     for (auto& global : globals_to_erase) {
         m_module->eraseGlobalVariable(global);
     }
-    
+
+    return {};
+}
+
+ErrorOr<int> LLVMCodeGen::run(CompilerOptions const& options) {
+    ::llvm::InitializeNativeTarget();
+    ::llvm::InitializeNativeTargetAsmPrinter();
+
+    auto builder = ::llvm::orc::JITTargetMachineBuilder::detectHost();
+    if (!builder) {
+        return err("Failed to detect the host target: {}", ::llvm::toString(builder.takeError()));
+    }
+
+    auto machine = builder->createTargetMachine();
+    if (!machine) {
+        return err("Failed to create the target machine: {}", ::llvm::toString(machine.takeError()));
+    }
+
+    TRY(this->build_module(options, **machine));
+    m_ir_builder.reset();
+
+    ::llvm::orc::ThreadSafeModule module(move(m_module), move(m_context));
+    return run_in_process(move(*builder), move(module), options);
+}
+
+ErrorOr<void> LLVMCodeGen::generate(CompilerOptions const& options) {
+    String triple, error;
+    if (options.has_target()) {
+        triple = options.target;
+    } else {
+        triple = ::llvm::sys::getDefaultTargetTriple();
+    }
+
+    ::llvm::InitializeAllTargetMCs();
+    ::llvm::InitializeAllAsmParsers();
+    ::llvm::InitializeAllAsmPrinters();
+
+    auto* target = ::llvm::TargetRegistry::lookupTarget(triple, error);
+    if (!target) {
+        return err("Failed to lookup target '{}'", triple);
+    }
+
+    ::llvm::TargetOptions target_options;
+    auto reloc = Optional<::llvm::Reloc::Model>(::llvm::Reloc::Model::PIC_);
+
+    OwnPtr<::llvm::TargetMachine> machine(
+        target->createTargetMachine(triple, "generic", "", target_options, reloc)
+    );
+
+    TRY(this->build_module(options, *machine));
+
     {
         String out = options.file.with_extension("ll");
         std::error_code ec;
@@ -822,20 +905,99 @@ ErrorOr<void> LLVMCodeGen::generate(CompilerOptions const& options) {
         m_module->print(stream, nullptr);
     }
 
-    String output = options.file.with_extension("o");
+    // A single object is expected when not linking, so only executables and shared libraries get split up
+    size_t partitions = 1;
+    if (options.format == OutputFormat::Executable || options.format == OutputFormat::SharedLibrary) {
+        size_t instructions = 0;
+        for (auto& function : *m_module) {
+            instructions += function.getInstructionCount();
+        }
+
+        partitions = std::clamp<size_t>((instructions + INSTRUCTIONS_PER_PARTITION - 1) / INSTRUCTIONS_PER_PARTITION, 1, MAX_PARTITIONS);
+    }
+
+    if (partitions == 1) {
+        String output = options.file.with_extension("o");
 
-    std::error_code ec;
-    ::llvm::raw_fd_ostream stream(output, ec);
+        std::error_code ec;
+        ::llvm::raw_fd_ostream stream(output, ec);
+
+        if (ec) {
+            return err("Failed to open file '{}': {}", output, ec.message());
+        }
+
+        ::llvm::legacy::PassManager pm;
+        machine->addPassesToEmitFile(pm, stream, nullptr, ::llvm::CodeGenFileType::ObjectFile);
+
+        pm.run(*m_module);
+        stream.flush();
+
+        m_objects.push_back(output);
+        return {};
+    }
+
+    // Partitions share the module's context, which can't be used from more than one thread, so each one goes through
+    // bitcode and gets parsed back into a context of its own
+    Vector<::llvm::SmallString<0>> bitcode;
+    ::llvm::SplitModule(*m_module, partitions, [&bitcode](std::unique_ptr<::llvm::Module> partition) {
+        auto& buffer = bitcode.emplace_back();
+        ::llvm::raw_svector_ostream stream(buffer);
+
+        ::llvm::WriteBitcodeToFile(*partition, stream);
+    });
+
+    Vector<::llvm::SmallString<0>> objects(bitcode.size());
+    Vector<String> errors(bitcode.size());
+
+    ThreadPool pool(options.threads);
+    for (size_t index = 0; index < bitcode.size(); index++) {
+        pool.submit([&, index] {
+            ::llvm::LLVMContext context;
+
+            auto module = ::llvm::parseBitcodeFile(::llvm::MemoryBufferRef(bitcode[index], "partition"), context);
+            if (!module) {
+                errors[index] = ::llvm::toString(module.takeError());
+                return;
+            }
 
-    if (ec) {
-        return err("Failed to open file '{}': {}", output, ec.message());
+            // Target machines keep state while emitting, so every thread needs its own
+            OwnPtr<::llvm::TargetMachine> partition_machine(
+                target->createTargetMachine(triple, "generic", "", target_options, reloc)
+            );
+
+            ::llvm::raw_svector_ostream stream(objects[index]);
+            ::llvm::legacy::PassManager pm;
+
+            if (partition_machine->addPassesToEmitFile(pm, stream, nullptr, ::llvm::CodeGenFileType::ObjectFile)) {
+                errors[index] = "Target does not support emitting object files";
+                return;
+            }
+
+            pm.run(**module);
+        });
     }
 
-    ::llvm::legacy::PassManager pm;
-    machine->addPassesToEmitFile(pm, stream, nullptr, ::llvm::CodeGenFileType::ObjectFile);
+    pool.wait();
+
+    for (size_t index = 0; index < objects.size(); index++) {
+        if (!errors[index].empty()) {
+            return err("Failed to generate code for partition {}: {}", index, errors[index]);
+        }
+
+        String output = index == 0 ? options.file.with_extension("o") : options.file.with_extension(format("{}.o", index));
+
+        std::error_code ec;
+        ::llvm::raw_fd_ostream stream(output, ec);
 
-    pm.run(*m_module);
-    stream.flush();
+        if (ec) {
+            return err("Failed to open file '{}': {}", output, ec.message());
+        }
+
+        stream << objects[index];
+        stream.flush();
+
+        m_objects.push_back(output);
+    }
 
     return {};
 }
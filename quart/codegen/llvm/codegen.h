@@ -6,6 +6,7 @@
 
 #include <llvm/IR/Module.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/Target/TargetMachine.h>
 
 namespace quart {
     struct CompilerOptions;
@@ -51,6 +52,9 @@ public:
     LLVMCodeGen(State&, String module_name);
     
     ErrorOr<void> generate(CompilerOptions const&) override;
+
+    // Compiles the module in memory with ORC and calls the entry point, returns the exit code
+    ErrorOr<int> run(CompilerOptions const&);
     
     void generate(bytecode::BasicBlock*);
     void generate(bytecode::Instruction*);
@@ -58,6 +62,8 @@ public:
     ::llvm::Module& module() { return *m_module; }
 
 private:
+    ErrorOr<void> build_module(CompilerOptions const&, ::llvm::TargetMachine&);
+
     ::llvm::Value* valueof(bytecode::Register);
     ::llvm::Value* valueof(bytecode::Operand const&);
 
@@ -71,6 +77,8 @@ private:
     
     void set_register(bytecode::Register, ::llvm::Value*);
 
+    void resolve_phis();
+
 #define Op(x) void generate(bytecode::x*); // NOLINT
     ENUMERATE_BYTECODE_INSTRUCTIONS(Op)
 #undef Op
@@ -85,6 +93,7 @@ private:
     OwnPtr<::llvm::IRBuilder<>> m_ir_builder;
 
     Vector<::llvm::Value*> m_registers;
+    Vector<std::pair<bytecode::Phi*, ::llvm::PHINode*>> m_phis;
     Vector<::llvm::GlobalVariable*> m_globals;
 
     HashMap<TupleType*, ::llvm::StructType*> m_tuple_types;
@@ -0,0 +1,156 @@
+#include <quart/codegen/llvm/jit.h>
+
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/xxhash.h>
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+namespace quart::llvm {
+
+OwnPtr<JITObjectCache> JITObjectCache::create(fs::Path directory, String const& salt) {
+    if (::llvm::sys::fs::create_directories(String(directory))) {
+        return nullptr;
+    }
+
+    return OwnPtr<JITObjectCache>(new JITObjectCache(move(directory), ::llvm::xxh3_64bits(salt)));
+}
+
+fs::Path JITObjectCache::path_for(::llvm::Module const* module) {
+    auto iterator = m_hashes.find(module);
+    if (iterator != m_hashes.end()) {
+        return m_directory / std::format("{:016x}.o", iterator->second);
+    }
+
+    ::llvm::SmallVector<char, 0> buffer;
+    ::llvm::raw_svector_ostream stream(buffer);
+
+    ::llvm::WriteBitcodeToFile(*module, stream);
+
+    u64 hash = ::llvm::xxh3_64bits(StringView(buffer.data(), buffer.size())) ^ m_salt;
+    m_hashes[module] = hash;
+
+    return m_directory / std::format("{:016x}.o", hash);
+}
+
+std::unique_ptr<::llvm::MemoryBuffer> JITObjectCache::getObject(::llvm::Module const* module) {
+    auto buffer = ::llvm::MemoryBuffer::getFile(String(this->path_for(module)), false, false);
+    if (!buffer) {
+        return nullptr;
+    }
+
+    return move(*buffer);
+}
+
+void JITObjectCache::notifyObjectCompiled(::llvm::Module const* module, ::llvm::MemoryBufferRef object) {
+    String path = this->path_for(module);
+
+    // Same as the module cache, concurrent runs must never see a partially written object
+    String temporary = std::format(
+        "{}.{}.{}.tmp", path, ::llvm::sys::Process::getProcessId(), std::hash<std::thread::id>()(std::this_thread::get_id())
+    );
+    {
+        std::ofstream stream(temporary, std::ios::binary);
+        stream.write(object.getBufferStart(), static_cast<std::streamsize>(object.getBufferSize()));
+
+        if (!stream) {
+            stream.close();
+            std::remove(temporary.c_str());
+
+            return;
+        }
+    }
+
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+    }
+}
+
+static ::llvm::CodeGenOptLevel codegen_level_of(OptimizationLevel level) {
+    switch (level) {
+        case OptimizationLevel::O0:
+            return ::llvm::CodeGenOptLevel::None;
+        case OptimizationLevel::O1:
+            return ::llvm::CodeGenOptLevel::Less;
+        case OptimizationLevel::O3:
+            return ::llvm::CodeGenOptLevel::Aggressive;
+        case OptimizationLevel::O2:
+        case OptimizationLevel::Os:
+        case OptimizationLevel::Oz:
+            break;
+    }
+
+    return ::llvm::CodeGenOptLevel::Default;
+}
+
+ErrorOr<int> run_in_process(
+    ::llvm::orc::JITTargetMachineBuilder builder, ::llvm::orc::ThreadSafeModule module, CompilerOptions const& options
+) {
+    builder.setCodeGenOptLevel(codegen_level_of(options.opts.level));
+
+    OwnPtr<JITObjectCache> cache = nullptr;
+    if (!options.cache_dir.empty()) {
+        String salt = std::format("{}:{}", builder.getTargetTriple().str(), static_cast<u32>(options.opts.level));
+        cache = JITObjectCache::create(fs::Path(options.cache_dir) / "jit", salt);
+    }
+
+    auto jit = ::llvm::orc::LLJITBuilder()
+        .setJITTargetMachineBuilder(builder)
+        .setCompileFunctionCreator([&cache](::llvm::orc::JITTargetMachineBuilder builder) 
+            -> ::llvm::Expected<std::unique_ptr<::llvm::orc::IRCompileLayer::IRCompiler>> {
+            return std::make_unique<::llvm::orc::ConcurrentIRCompiler>(move(builder), cache.get());
+        })
+        .create();
+
+    if (!jit) {
+        return err("Failed to create the JIT: {}", ::llvm::toString(jit.takeError()));
+    }
+
+    auto& dylib = (*jit)->getMainJITDylib();
+    char prefix = (*jit)->getDataLayout().getGlobalPrefix();
+
+    auto process = ::llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(prefix);
+    if (!process) {
+        return err("Failed to load symbols from the current process: {}", ::llvm::toString(process.takeError()));
+    }
+
+    dylib.addGenerator(move(*process));
+    for (auto& name : options.library_names) {
+        String filename = std::format("lib{}.so", name);
+        for (auto& path : options.library_paths) {
+            String candidate = std::format("{}/{}", path, filename);
+            if (::llvm::sys::fs::exists(candidate)) {
+                filename = move(candidate);
+                break;
+            }
+        }
+
+        auto library = ::llvm::orc::DynamicLibrarySearchGenerator::Load(filename.c_str(), prefix);
+        if (!library) {
+            return err("Could not load library '{}': {}", name, ::llvm::toString(library.takeError()));
+        }
+
+        dylib.addGenerator(move(*library));
+    }
+
+    if (auto error = (*jit)->addIRModule(move(module))) {
+        return err("Failed to add the module to the JIT: {}", ::llvm::toString(move(error)));
+    }
+
+    auto entry = (*jit)->lookup(options.entry);
+    if (!entry) {
+        return err("Entry point '{}' is not defined: {}", options.entry, ::llvm::toString(entry.takeError()));
+    }
+
+    auto* function = entry->toPtr<int(*)()>();
+    return function();
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <quart/compiler.h>
+#include <quart/errors.h>
+
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+
+namespace quart::llvm {
+
+// Keeps the objects ORC compiles on disk so running an unchanged program again skips machine code generation.
+// Entries are keyed by a hash of the module's bitcode and a salt covering whatever else changes the generated code.
+class JITObjectCache : public ::llvm::ObjectCache {
+public:
+    // Returns nullptr if `directory` doesn't exist and can't be created
+    static OwnPtr<JITObjectCache> create(fs::Path directory, String const& salt);
+
+    void notifyObjectCompiled(::llvm::Module const*, ::llvm::MemoryBufferRef) override;
+    std::unique_ptr<::llvm::MemoryBuffer> getObject(::llvm::Module const*) override;
+
+private:
+    JITObjectCache(fs::Path directory, u64 salt) : m_directory(move(directory)), m_salt(salt) {}
+
+    fs::Path path_for(::llvm::Module const*);
+
+    fs::Path m_directory;
+    u64 m_salt;
+
+    HashMap<::llvm::Module const*, u64> m_hashes;
+};
+
+// Compiles `module` in memory and calls the entry point, returning whatever it returns. Symbols the module doesn't
+// define are looked up in the compiler's own process and in the libraries passed with `-l`.
+ErrorOr<int> run_in_process(
+    ::llvm::orc::JITTargetMachineBuilder builder, ::llvm::orc::ThreadSafeModule module, CompilerOptions const& options
+);
+
+}
@@ -0,0 +1,385 @@
+#include <quart/codegen/x86_64/assembler.h>
+#include <quart/assert.h>
+
+namespace quart::x86_64 {
+
+static bool fits_in_imm8(i64 value) {
+    return value >= INT8_MIN && value <= INT8_MAX;
+}
+
+static bool fits_in_imm32(i64 value) {
+    return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+// The condition encoded in the low 4 bits of `jcc` and `setcc`
+static u8 encoding_of(ConditionCode cc) {
+    switch (cc) {
+        case ConditionCode::o:   return 0x0;
+        case ConditionCode::no:  return 0x1;
+        case ConditionCode::b:
+        case ConditionCode::c:
+        case ConditionCode::nae: return 0x2;
+        case ConditionCode::ae:
+        case ConditionCode::nb:
+        case ConditionCode::nc:  return 0x3;
+        case ConditionCode::e:
+        case ConditionCode::z:   return 0x4;
+        case ConditionCode::ne:
+        case ConditionCode::nz:  return 0x5;
+        case ConditionCode::be:
+        case ConditionCode::na:  return 0x6;
+        case ConditionCode::a:
+        case ConditionCode::nbe: return 0x7;
+        case ConditionCode::s:   return 0x8;
+        case ConditionCode::ns:  return 0x9;
+        case ConditionCode::p:
+        case ConditionCode::pe:  return 0xA;
+        case ConditionCode::np:
+        case ConditionCode::po:  return 0xB;
+        case ConditionCode::l:
+        case ConditionCode::nge: return 0xC;
+        case ConditionCode::ge:
+        case ConditionCode::nl:  return 0xD;
+        case ConditionCode::le:
+        case ConditionCode::ng:  return 0xE;
+        case ConditionCode::g:
+        case ConditionCode::nle: return 0xF;
+        case ConditionCode::None:
+            break;
+    }
+
+    ASSERT(false, "Invalid condition code");
+    return 0;
+}
+
+void Assembler::emit32(u32 value) {
+    for (size_t i = 0; i < sizeof(u32); i++) {
+        m_code.push_back(static_cast<u8>(value >> (i * 8)));
+    }
+}
+
+void Assembler::emit64(u64 value) {
+    for (size_t i = 0; i < sizeof(u64); i++) {
+        m_code.push_back(static_cast<u8>(value >> (i * 8)));
+    }
+}
+
+size_t Assembler::assemble(Vector<Instruction> const& instructions) {
+    size_t start = m_code.size();
+    for (auto& instruction : instructions) {
+        this->emit(instruction);
+    }
+
+    for (auto& fixup : m_fixups) {
+        auto iterator = m_labels.find(fixup.label);
+        ASSERT(iterator != m_labels.end(), "Jump to a label that was never defined");
+
+        auto displacement = static_cast<u32>(static_cast<i64>(iterator->second) - static_cast<i64>(fixup.offset + 4));
+        for (size_t i = 0; i < sizeof(u32); i++) {
+            m_code[fixup.offset + i] = static_cast<u8>(displacement >> (i * 8));
+        }
+    }
+
+    m_labels.clear();
+    m_fixups.clear();
+
+    return start;
+}
+
+void Assembler::emit_rm(std::initializer_list<u8> opcode, u8 reg, Operand const& rm, bool wide, bool byte_register) {
+    u8 rex = 0x40;
+    if (wide) {
+        rex |= 0x08;
+    }
+
+    if (reg & 8) {
+        rex |= 0x04;
+    }
+
+    // Without a REX prefix, encodings 4 through 7 of a byte register refer to ah, ch, dh and bh instead
+    bool force_rex = false;
+    switch (rm.kind()) {
+        case Operand::Kind::Register: {
+            u8 encoding = rm.reg().encoding();
+            if (encoding & 8) {
+                rex |= 0x01;
+            }
+
+            force_rex = byte_register && encoding >= 4 && encoding < 8;
+            break;
+        }
+        case Operand::Kind::Memory:
+            if (rm.reg().encoding() & 8) {
+                rex |= 0x01;
+            }
+
+            if (rm.index().type != Register::None && (rm.index().encoding() & 8)) {
+                rex |= 0x02;
+            }
+
+            break;
+        case Operand::Kind::Relative:
+            break;
+        default:
+            ASSERT(false, "Invalid r/m operand");
+    }
+
+    if (rex != 0x40 || force_rex) {
+        this->emit8(rex);
+    }
+
+    for (u8 byte : opcode) {
+        this->emit8(byte);
+    }
+
+    u8 field = (reg & 7) << 3;
+    if (rm.is_register()) {
+        this->emit8(0xC0 | field | (rm.reg().encoding() & 7));
+        return;
+    }
+
+    if (rm.kind() == Operand::Kind::Relative) {
+        this->emit8(field | 0x05);
+
+        // Nothing codegen emits has an immediate after a rip-relative displacement, so it always ends the instruction
+        Relocation::Type type = rm.is_external() ? Relocation::Type::GOTPCRELX : Relocation::Type::PC32;
+        m_relocations.push_back({ m_code.size(), rm.name(), type, -4 });
+
+        this->emit32(0);
+        return;
+    }
+
+    u8 base = rm.reg().encoding();
+    i64 displacement = rm.value();
+
+    // A base of rbp or r13 with no displacement would mean rip-relative (or no base at all with a SIB byte)
+    u8 mod = 0x80;
+    if (displacement == 0 && (base & 7) != 5) {
+        mod = 0x00;
+    } else if (fits_in_imm8(displacement)) {
+        mod = 0x40;
+    }
+
+    // rsp and r12 can only be used as a base through a SIB byte
+    bool has_index = rm.index().type != Register::None;
+    if (has_index || (base & 7) == 4) {
+        u8 index = has_index ? rm.index().encoding() : 4;
+        u8 scale = 0;
+
+        switch (rm.scale()) {
+            case 1: scale = 0; break;
+            case 2: scale = 1; break;
+            case 4: scale = 2; break;
+            case 8: scale = 3; break;
+            default:
+                ASSERT(false, "Invalid scale");
+        }
+
+        this->emit8(mod | field | 0x04);
+        this->emit8((scale << 6) | ((index & 7) << 3) | (base & 7));
+    } else {
+        this->emit8(mod | field | (base & 7));
+    }
+
+    if (mod == 0x40) {
+        this->emit8(static_cast<u8>(displacement));
+    } else if (mod == 0x80) {
+        ASSERT(fits_in_imm32(displacement), "Displacement does not fit in 32 bits");
+        this->emit32(static_cast<u32>(displacement));
+    }
+}
+
+void Assembler::emit_label_displacement(String const& label) {
+    m_fixups.push_back({ m_code.size(), label });
+    this->emit32(0);
+}
+
+void Assembler::emit_mov(Operand const& dst, Operand const& src) {
+    ASSERT(dst.size() == DataType::QWord || dst.size() == DataType::DWord, "Unsupported operand size");
+    bool wide = dst.size() == DataType::QWord;
+
+    if (dst.is_register() && src.is_immediate()) {
+        u8 encoding = dst.reg().encoding();
+        i64 value = src.value();
+
+        // Writing to a 32-bit register zeroes the upper half, so anything that fits in 32 unsigned bits can skip REX.W
+        if (value >= 0 && value <= UINT32_MAX) {
+            if (encoding & 8) {
+                this->emit8(0x41);
+            }
+
+            this->emit8(0xB8 + (encoding & 7));
+            this->emit32(static_cast<u32>(value));
+        } else if (fits_in_imm32(value)) {
+            this->emit_rm({ 0xC7 }, 0, dst, true);
+            this->emit32(static_cast<u32>(value));
+        } else {
+            this->emit8((encoding & 8) ? 0x49 : 0x48);
+            this->emit8(0xB8 + (encoding & 7));
+            this->emit64(static_cast<u64>(value));
+        }
+
+        return;
+    }
+
+    if (src.is_immediate()) {
+        ASSERT(fits_in_imm32(src.value()), "Immediate does not fit in 32 bits");
+
+        this->emit_rm({ 0xC7 }, 0, dst, wide);
+        this->emit32(static_cast<u32>(src.value()));
+    } else if (src.is_register()) {
+        this->emit_rm({ 0x89 }, src.reg().encoding(), dst, src.size() == DataType::QWord);
+    } else {
+        ASSERT(dst.is_register(), "Can't move from memory to memory");
+        this->emit_rm({ 0x8B }, dst.reg().encoding(), src, wide);
+    }
+}
+
+void Assembler::emit_arithmetic(u8 opcode, u8 extension, Operand const& dst, Operand const& src) {
+    if (src.is_immediate()) {
+        i64 value = src.value();
+        if (fits_in_imm8(value)) {
+            this->emit_rm({ 0x83 }, extension, dst, true);
+            this->emit8(static_cast<u8>(value));
+        } else {
+            ASSERT(fits_in_imm32(value), "Immediate does not fit in 32 bits");
+
+            this->emit_rm({ 0x81 }, extension, dst, true);
+            this->emit32(static_cast<u32>(value));
+        }
+    } else if (src.is_register()) {
+        this->emit_rm({ opcode }, src.reg().encoding(), dst, true);
+    } else {
+        // The reg, r/m form of each of these is right after the r/m, reg one
+        ASSERT(dst.is_register(), "Can't operate from memory to memory");
+        this->emit_rm({ static_cast<u8>(opcode + 2) }, dst.reg().encoding(), src, true);
+    }
+}
+
+void Assembler::emit(Instruction const& instruction) {
+    auto& first = instruction.operand(0);
+    auto& second = instruction.operand(1);
+
+    switch (instruction.opcode) {
+        case Opcode::Label:
+            m_labels[first.name()] = m_code.size();
+            break;
+        case Opcode::mov:
+            this->emit_mov(first, second);
+            break;
+        case Opcode::movzx: {
+            ASSERT(second.size() == DataType::Byte || second.size() == DataType::Word, "Unsupported operand size");
+            u8 opcode = second.size() == DataType::Byte ? 0xB6 : 0xB7;
+
+            this->emit_rm({ 0x0F, opcode }, first.reg().encoding(), second, true, true);
+            break;
+        }
+        case Opcode::lea:
+            this->emit_rm({ 0x8D }, first.reg().encoding(), second, true);
+            break;
+        case Opcode::add:
+            this->emit_arithmetic(0x01, 0, first, second);
+            break;
+        case Opcode::sub:
+            this->emit_arithmetic(0x29, 5, first, second);
+            break;
+        case Opcode::cmp:
+            this->emit_arithmetic(0x39, 7, first, second);
+            break;
+        case Opcode::imul: {
+            if (instruction.count == 2) {
+                this->emit_rm({ 0x0F, 0xAF }, first.reg().encoding(), second, true);
+                break;
+            }
+
+            i64 value = instruction.operand(2).value();
+            if (fits_in_imm8(value)) {
+                this->emit_rm({ 0x6B }, first.reg().encoding(), second, true);
+                this->emit8(static_cast<u8>(value));
+            } else {
+                ASSERT(fits_in_imm32(value), "Immediate does not fit in 32 bits");
+
+                this->emit_rm({ 0x69 }, first.reg().encoding(), second, true);
+                this->emit32(static_cast<u32>(value));
+            }
+
+            break;
+        }
+        case Opcode::test:
+            this->emit_rm({ 0x85 }, second.reg().encoding(), first, true);
+            break;
+        case Opcode::set:
+            this->emit_rm({ 0x0F, static_cast<u8>(0x90 | encoding_of(instruction.cc)) }, 0, first, false, true);
+            break;
+        case Opcode::jmp:
+            if (first.kind() == Operand::Kind::Label) {
+                this->emit8(0xE9);
+                this->emit_label_displacement(first.name());
+            } else {
+                this->emit_rm({ 0xFF }, 4, first, false);
+            }
+
+            break;
+        case Opcode::j:
+            this->emit8(0x0F);
+            this->emit8(0x80 | encoding_of(instruction.cc));
+
+            this->emit_label_displacement(first.name());
+            break;
+        case Opcode::push:
+            if (first.is_register()) {
+                u8 encoding = first.reg().encoding();
+                if (encoding & 8) {
+                    this->emit8(0x41);
+                }
+
+                this->emit8(0x50 + (encoding & 7));
+            } else if (first.is_immediate()) {
+                // The immediate is sign-extended to 64 bits
+                if (fits_in_imm8(first.value())) {
+                    this->emit8(0x6A);
+                    this->emit8(static_cast<u8>(first.value()));
+                } else {
+                    ASSERT(fits_in_imm32(first.value()), "Immediate does not fit in 32 bits");
+
+                    this->emit8(0x68);
+                    this->emit32(static_cast<u32>(first.value()));
+                }
+            } else {
+                this->emit_rm({ 0xFF }, 6, first, false);
+            }
+
+            break;
+        case Opcode::pop: {
+            ASSERT(first.is_register(), "Can only pop into a register");
+
+            u8 encoding = first.reg().encoding();
+            if (encoding & 8) {
+                this->emit8(0x41);
+            }
+
+            this->emit8(0x58 + (encoding & 7));
+            break;
+        }
+        case Opcode::call:
+            if (first.kind() == Operand::Kind::Symbol) {
+                // Calls always go through PLT32 like most assemblers do, the linker turns it into a direct call if it can
+                this->emit8(0xE8);
+                m_relocations.push_back({ m_code.size(), first.name(), Relocation::Type::PLT32, -4 });
+
+                this->emit32(0);
+            } else {
+                this->emit_rm({ 0xFF }, 2, first, false);
+            }
+
+            break;
+        case Opcode::leave:
+            this->emit8(0xC9);
+            break;
+        case Opcode::ret:
+            this->emit8(0xC3);
+            break;
+    }
+}
+
+}
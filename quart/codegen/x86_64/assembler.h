@@ -0,0 +1,65 @@
+#pragma once
+
+#include <quart/common.h>
+#include <quart/codegen/x86_64/instruction.h>
+
+namespace quart::x86_64 {
+
+struct Relocation {
+    enum class Type : u8 {
+        PC32,       // symbol + addend - offset
+        PLT32,      // Same as PC32 but through the PLT entry of the symbol if it's defined elsewhere
+        GOTPCRELX   // The GOT entry of the symbol, relative to the offset
+    };
+
+    size_t offset = 0;
+    String symbol;
+
+    Type type = Type::PC32;
+    i64 addend = 0;
+};
+
+// Encodes the instructions emitted by `x86_64CodeGen` into machine code. Only the forms codegen actually emits are
+// supported, anything else is a bug in codegen and asserts.
+//
+// Jumps to labels are always encoded with a 32-bit displacement, so the size of an instruction never depends on where its
+// target ends up and labels can be resolved in a single pass once the function is done.
+class Assembler {
+public:
+    Assembler() = default;
+
+    Vector<u8> const& code() const { return m_code; }
+    Vector<Relocation> const& relocations() const { return m_relocations; }
+
+    // Appends the code of a function, returning the offset it starts at
+    size_t assemble(Vector<Instruction> const& instructions);
+
+private:
+    struct Fixup {
+        size_t offset;
+        String label;
+    };
+
+    void emit8(u8 value) { m_code.push_back(value); }
+    void emit32(u32 value);
+    void emit64(u64 value);
+
+    void emit(Instruction const&);
+
+    void emit_mov(Operand const& dst, Operand const& src);
+    void emit_arithmetic(u8 opcode, u8 extension, Operand const& dst, Operand const& src);
+
+    // Emits an optional REX prefix followed by `opcode`, a ModR/M byte and whatever `rm` needs after it.
+    // `reg` is either a register encoding or an opcode extension.
+    void emit_rm(std::initializer_list<u8> opcode, u8 reg, Operand const& rm, bool wide, bool byte_register = false);
+
+    void emit_label_displacement(String const& label);
+
+    Vector<u8> m_code;
+    Vector<Relocation> m_relocations;
+
+    HashMap<String, size_t> m_labels;
+    Vector<Fixup> m_fixups;
+};
+
+}
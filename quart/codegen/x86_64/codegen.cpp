@@ -1,7 +1,10 @@
 #include <quart/codegen/x86_64/codegen.h>
+#include <quart/codegen/x86_64/assembler.h>
+#include <quart/codegen/x86_64/elf.h>
+#include <quart/bytecode/passes/lower_phis.h>
 #include <quart/language/state.h>
 
-#include <unordered_set>
+#include <llvm/Support/raw_ostream.h>
 
 namespace quart::x86_64 {
 
@@ -9,132 +12,278 @@ static const Vector<Register::Type> SYS_V_CALL_REGISTERS = {
     Register::rdi, Register::rsi, Register::rdx, Register::rcx, Register::r8, Register::r9,
 };
 
-static const std::unordered_set<Register::Type> SYS_V_CALLEE_SAVED_REGISTERS = {
-    Register::rbx, Register::r12, Register::r13, Register::r14, Register::r15
-};
+static const Register RBP = { Register::rbp };
+static const Register RSP = { Register::rsp };
+
+// Functions that are only declared here and have to be resolved by the linker
+static bool is_external(Function* function) {
+    return function->is_extern() && function->is_decl();
+}
 
-x86_64CodeGen::x86_64CodeGen(State& state, String module) : m_state(state), m_module(move(module)) {
-    reset_all_registers();
+static bool fits_in_imm32(u64 value) {
+    auto signed_value = static_cast<i64>(value);
+    return signed_value >= INT32_MIN && signed_value <= INT32_MAX;
 }
 
-void x86_64CodeGen::reset_all_registers() {
-    m_available_registers = {};
+static Type* element_type_of(Type* type) {
+    if (type->is_pointer()) {
+        return type->get_pointee_type();
+    }
 
-    m_available_registers.push({ Register::r11 });
-    m_available_registers.push({ Register::r10 });
-    m_available_registers.push({ Register::r9 });
-    m_available_registers.push({ Register::r8 });
-    m_available_registers.push({ Register::rdi });
-    m_available_registers.push({ Register::rsi });
-    m_available_registers.push({ Register::rdx });
-    m_available_registers.push({ Register::rcx });
-    m_available_registers.push({ Register::rax });
+    return type->get_array_element_type();
+}
 
-    for (auto& reg : SYS_V_CALLEE_SAVED_REGISTERS) {
-        m_callee_saved_registers.push({ reg });
+// Only values that fit into a register can be loaded directly, aggregates have to go through `GetMemberRef`
+static DataType data_type_of(size_t size) {
+    ASSERT(size == 1 || size == 2 || size == 4 || size == 8, "Can only load members of size 1, 2, 4 or 8");
+    return static_cast<DataType>(size);
+}
+
+// Layouts are computed the first time they're asked for and cached on the type, which can't happen from several threads
+// at once. Everything generating `function` is going to ask for is computed here, before any of it runs in parallel.
+static void compute_layouts(State& state, Function* function) {
+    for (auto& block : function->basic_blocks()) {
+        for (auto& inst : block->instructions()) {
+            Optional<bytecode::Register> src;
+            if (auto* member = inst->as<bytecode::GetMember>()) {
+                src = member->src();
+            } else if (auto* member_ref = inst->as<bytecode::GetMemberRef>()) {
+                src = member_ref->src();
+            } else {
+                continue;
+            }
+
+            Type* type = state.type(*src)->get_pointee_type();
+            if (type->is_struct() || type->is_tuple()) {
+                type->layout();
+            } else {
+                element_type_of(type)->layout();
+            }
+        }
     }
 }
- 
-Register x86_64CodeGen::pop_reg() {
-    Register reg = m_available_registers.top();
-    m_available_registers.pop();
 
-    if (reg.type == Register::rax && !m_next_calls.empty()) {
-        return pop_reg();
+x86_64CodeGen::x86_64CodeGen(State& state, String module) : m_state(state), m_module(move(module)) {}
+
+Location const& x86_64CodeGen::location_of(CodeGenFunction* cg, bytecode::Register reg) const {
+    auto iterator = cg->allocation().locations.find(reg);
+    ASSERT(iterator != cg->allocation().locations.end(), "Register was never allocated");
+
+    return iterator->second;
+}
+
+Register x86_64CodeGen::load(CodeGenFunction* cg, bytecode::Operand operand, Register scratch) {
+    if (operand.is_value()) {
+        cg->emit(Opcode::mov, { scratch, Operand::imm(static_cast<i64>(operand.value())) });
+        return scratch;
     }
 
-    return reg;
+    auto& location = this->location_of(cg, operand.reg());
+    if (location.is_register()) {
+        return { location.reg };
+    }
+
+    cg->emit(Opcode::mov, { scratch, this->spill_slot(cg, location.slot) });
+    return scratch;
 }
 
-void x86_64CodeGen::push_reg(Register reg) {
-    m_available_registers.push(reg);
+Register x86_64CodeGen::target(CodeGenFunction* cg, bytecode::Register dst, Register scratch) const {
+    auto& location = this->location_of(cg, dst);
+    return location.is_register() ? Register { location.reg } : scratch;
 }
 
-String x86_64CodeGen::normalize(String qualified_name) {
-    static constexpr StringView DOUBLE_COLON = "::";
-    static constexpr StringView DOT = ".";
+void x86_64CodeGen::store(CodeGenFunction* cg, bytecode::Register dst, Register reg) {
+    auto& location = this->location_of(cg, dst);
 
-    auto pos = qualified_name.find(DOUBLE_COLON);
-    while (pos != String::npos) {
-        qualified_name.replace(pos, DOUBLE_COLON.size(), ".");
-        pos = qualified_name.find(DOUBLE_COLON, pos + DOT.size());
+    if (location.is_stack()) {
+        cg->emit(Opcode::mov, { this->spill_slot(cg, location.slot), reg });
+    } else if (location.reg != reg.type) {
+        cg->emit(Opcode::mov, { Register { location.reg }, reg });
+    }
+}
+
+Operand x86_64CodeGen::source(CodeGenFunction* cg, bytecode::Operand operand, Register scratch) {
+    if (operand.is_value() && fits_in_imm32(operand.value())) {
+        return Operand::imm(static_cast<i64>(operand.value()));
     }
 
-    return qualified_name;
+    return this->load(cg, operand, scratch);
 }
 
-Register x86_64CodeGen::generate_binary_op(BinaryInstruction instruction, bytecode::Operand lhs, bytecode::Operand rhs) {
-    auto cg = m_current_function;
-    Register r1 = {};
+Operand x86_64CodeGen::spill_slot(CodeGenFunction* cg, u32 slot) const {
+    return Operand::mem(RBP, -static_cast<i32>(cg->allocation().spill_offset(slot)));
+}
 
-    if (lhs.is_value()) {
-        r1 = this->pop_reg();
-        cg->fwriteln("  mov {}, {}", r1.as_qword(), lhs.value());
-    } else {
-        r1 = m_register_map[lhs.reg()];
+Operand x86_64CodeGen::local(CodeGenFunction* cg, size_t index) const {
+    auto local = cg->local(index);
+    ASSERT(local.has_value(), "Local does not exist");
+
+    return Operand::mem(RBP, -static_cast<i32>(local->offset));
+}
+
+void x86_64CodeGen::load_memory(CodeGenFunction* cg, Register dst, Operand address) {
+    switch (address.size()) {
+        case DataType::QWord:
+            cg->emit(Opcode::mov, { dst, address });
+            break;
+        case DataType::DWord:
+            // Writing to the lower half of a register already zeroes the upper half
+            cg->emit(Opcode::mov, { Operand(dst, DataType::DWord), address });
+            break;
+        case DataType::Word:
+        case DataType::Byte:
+            cg->emit(Opcode::movzx, { dst, address });
+            break;
     }
+}
 
-    // TODO: Optimize for some instructions like `imul` where r1 could be the accumulator
-    //       and in such case the generated instruction could simply be `imul r2`
-    if (rhs.is_value()) {
-        cg->fwriteln("  {} {}, {}", instruction, r1.as_qword(), rhs.value());
-    } else {
-        Register r2 = m_register_map[rhs.reg()];
-        cg->fwriteln("  {} {}, {}", instruction, r1.as_qword(), r2.as_qword());
+Operand x86_64CodeGen::element_address(CodeGenFunction* cg, Register base, bytecode::Operand index, size_t size, DataType data_type) {
+    if (index.is_value()) {
+        return Operand::mem(base, static_cast<i32>(index.value() * size), data_type);
+    }
+
+    Register reg = this->load(cg, index, { Register::r11 });
+    if (size == 1 || size == 2 || size == 4 || size == 8) {
+        return Operand::mem(base, reg, size, 0, data_type);
+    }
 
-        this->push_reg(r2);
+    // Anything else can't be expressed as a scale so the offset has to be computed beforehand
+    cg->emit(Opcode::imul, { Register { Register::r11 }, reg, Operand::imm(static_cast<i64>(size)) });
+    return Operand::mem(base, { Register::r11 }, 1, 0, data_type);
+}
+
+void x86_64CodeGen::generate_epilogue(CodeGenFunction* cg) {
+    for (auto [index, reg] : llvm::enumerate(cg->allocation().callee_saved)) {
+        i32 offset = static_cast<i32>(cg->allocation().callee_saved_offset(index));
+        cg->emit(Opcode::mov, { Register { reg }, Operand::mem(RBP, -offset) });
     }
 
-    return r1;
+    cg->emit(Opcode::leave);
+    cg->emit(Opcode::ret);
 }
 
-Register x86_64CodeGen::generate_binary_op_with_dst(
-    BinaryInstruction instruction, bytecode::Register dst, bytecode::Operand lhs, bytecode::Operand rhs
+String x86_64CodeGen::normalize(StringView qualified_name) {
+    static constexpr StringView DOUBLE_COLON = "::";
+    static constexpr StringView DOT = ".";
+
+    String name(qualified_name);
+
+    auto pos = name.find(DOUBLE_COLON);
+    while (pos != String::npos) {
+        name.replace(pos, DOUBLE_COLON.size(), ".");
+        pos = name.find(DOUBLE_COLON, pos + DOT.size());
+    }
+
+    return name;
+}
+
+void x86_64CodeGen::generate_binary_op(
+    CodeGenFunction* cg, Opcode opcode, bytecode::Register dst, bytecode::Operand lhs, bytecode::Operand rhs
 ) {
-    Register reg = this->generate_binary_op(instruction, lhs, rhs);
-    m_register_map[dst] = reg;
+    // A result never shares a register with the operands of its own instruction, so `rhs` survives the move
+    Register reg = this->target(cg, dst, { Register::rax });
+    Register src = this->load(cg, lhs, reg);
 
-    return reg;
+    if (src.type != reg.type) {
+        cg->emit(Opcode::mov, { reg, src });
+    }
+
+    // TODO: Optimize for some instructions like `imul` where r1 could be the accumulator
+    //       and in such case the generated instruction could simply be `imul r2`
+    cg->emit(opcode, { reg, this->source(cg, rhs, { Register::r11 }) });
+    this->store(cg, dst, reg);
 }
 
 void x86_64CodeGen::generate_condition(
-    ConditionCode cc, bytecode::Instruction* instruction, bytecode::Register dst, bytecode::Operand lhs, bytecode::Operand rhs
+    CodeGenFunction* cg, ConditionCode cc, bytecode::Register dst, bytecode::Operand lhs, bytecode::Operand rhs
 ) {
-    auto cg = m_current_function;
-    Register reg = this->generate_binary_op_with_dst(
-        BinaryInstruction::cmp,
-        dst, lhs, rhs
-    );
+    Register reg = this->load(cg, lhs, { Register::r10 });
+    cg->emit(Opcode::cmp, { reg, this->source(cg, rhs, { Register::r11 }) });
 
-    if (instruction->next()->is<bytecode::JumpIf>()) {
-        m_next_cc = cc;
+    if (cg->allocation().fused_conditions.contains(dst)) {
+        cg->set_next_cc(cc);
         return;
     }
 
-    cg->fwriteln("  set{} {}", cc, reg.as_byte());
+    Register result = this->target(cg, dst, { Register::rax });
+
+    Operand al({ Register::rax }, DataType::Byte);
+
+    cg->emit(Opcode::set, cc, { al });
+    cg->emit(Opcode::movzx, { result, al });
+
+    this->store(cg, dst, result);
 }
 
 ErrorOr<void> x86_64CodeGen::generate(const CompilerOptions& options) {
     auto& functions = m_state.functions();
-    
-    for (auto& instruction : m_state.global_instructions()) {
-        this->generate(instruction.get());
-    }
+    ThreadPool pool(options.threads);
 
+    // Registers are allocated before any `NewFunction` since spill slots and saved registers make up the stack frame.
+    // Lowering phis creates registers and blocks and computing layouts fills caches on shared types, so both happen
+    // up front. Allocation only touches the function itself.
+    bytecode::LowerPhisPass lower_phis(m_state);
+
+    Vector<std::pair<Function*, Allocation*>> allocations;
     for (auto& [name, function] : functions) {
-        if (function->should_eliminate()) {
+        if (function->should_eliminate() || function->has_trait_parameter() || function->is_decl()) {
             continue;
         }
 
-        for (auto& block : function->basic_blocks()) {
-            this->generate(block);
-        }
+        lower_phis.run(function.get());
+        compute_layouts(m_state, function.get());
+
+        allocations.push_back({ function.get(), &m_allocations[function.get()] });
     }
 
-    String output = options.file.with_extension("s");
+    for (auto& [function, allocation] : allocations) {
+        pool.submit([function, allocation] {
+            RegisterAllocator allocator;
+            *allocation = allocator.allocate(function);
+        });
+    }
 
-    std::ofstream stream(output, std::ios_base::out);
+    pool.wait();
     
+    for (auto& instruction : m_state.global_instructions()) {
+        this->generate(nullptr, instruction.get());
+    }
+
+    // With layouts already computed, every function only writes to its own `CodeGenFunction`, so they can all be
+    // generated at the same time
+    for (auto& [function, cg] : m_functions) {
+        pool.submit([this, function, cg = cg.get()] {
+            for (auto& block : function->basic_blocks()) {
+                this->generate(cg, block);
+            }
+        });
+    }
+
+    pool.wait();
+
+    // Text is only emitted when asked for, going through an external assembler is a lot slower than encoding directly
+    if (options.format == OutputFormat::Assembly) {
+        return this->write_assembly(pool, options.file.with_extension("s"));
+    }
+
+    return this->write_object(pool, options.file.with_extension("o"));
+}
+
+ErrorOr<void> x86_64CodeGen::write_assembly(ThreadPool& pool, String const& output) {
+    std::ofstream stream(output, std::ios_base::out);
+    if (!stream) {
+        return err("Failed to open file '{}'", output);
+    }
+
+    Vector<String> code(m_functions.size());
+    for (auto [index, entry] : llvm::enumerate(m_functions)) {
+        pool.submit([&code, index, cg = entry.second.get()] {
+            code[index] = cg->code();
+        });
+    }
+
+    pool.wait();
+
     stream << "section .text" << '\n' << '\n';
     {
         for (auto& external : m_extern_functions) {
@@ -144,25 +293,24 @@ ErrorOr<void> x86_64CodeGen::generate(const CompilerOptions& options) {
 
         stream << '\n';
 
-        for (auto& [fn, cg] : m_functions) {
-            String name = normalize(fn->qualified_name());
-            stream << "global" << ' ' << name << '\n';
-            stream << name << ':' << '\n';
-            stream << cg->code() << '\n';
+        for (auto [index, entry] : llvm::enumerate(m_functions)) {
+            auto& cg = entry.second;
+
+            stream << "global" << ' ' << cg->name() << '\n';
+            stream << cg->name() << ':' << '\n';
+            stream << code[index] << '\n';
         }
     }
 
-    stream << "section .data" << '\n' << '\n';
-    {
-        size_t index = 0;
-        for (auto& str : m_strings) {
-            stream << "__str." << index << ": db ";
+    stream << "section .rodata" << '\n' << '\n';
+    for (auto& [_, cg] : m_functions) {
+        for (auto [index, str] : llvm::enumerate(cg->strings())) {
+            stream << cg->string_symbol(index) << ": db ";
             for (auto ch : str) {
                 stream << (int)ch << ", ";
             }
 
             stream << 0 << '\n';
-            index++;
         }
     }
 
@@ -172,32 +320,89 @@ ErrorOr<void> x86_64CodeGen::generate(const CompilerOptions& options) {
     return {};
 }
 
-void x86_64CodeGen::generate(bytecode::BasicBlock* block) {
-    auto cg = m_current_function;
-    if (cg) {
-        cg->fwriteln(".{}:", block->name());
+ErrorOr<void> x86_64CodeGen::write_object(ThreadPool& pool, String const& output) {
+    // Each function is encoded into its own buffer, which are then laid out in the order functions were created in.
+    // The output is the same no matter how many threads ran or in which order they finished.
+    Vector<Assembler> assemblers(m_functions.size());
+    for (auto [index, entry] : llvm::enumerate(m_functions)) {
+        pool.submit([&assemblers, index, cg = entry.second.get()] {
+            assemblers[index].assemble(cg->instructions());
+        });
+    }
+
+    pool.wait();
+
+    ELFObjectWriter writer;
+    Vector<u8> text;
+
+    for (auto [index, entry] : llvm::enumerate(m_functions)) {
+        auto& assembler = assemblers[index];
+        auto& code = assembler.code();
+
+        size_t offset = text.size();
+        writer.add_symbol({ entry.second->name(), ELFObjectWriter::Section::Text, offset, code.size(), true, true });
+
+        for (auto relocation : assembler.relocations()) {
+            relocation.offset += offset;
+            writer.add_relocation(move(relocation));
+        }
+
+        text.insert(text.end(), code.begin(), code.end());
+    }
+
+    Vector<u8> rodata;
+    for (auto& [_, cg] : m_functions) {
+        for (auto [index, str] : llvm::enumerate(cg->strings())) {
+            writer.add_symbol({ cg->string_symbol(index), ELFObjectWriter::Section::Rodata, rodata.size(), str.size() + 1, false, false });
+
+            rodata.insert(rodata.end(), str.begin(), str.end());
+            rodata.push_back(0);
+        }
+    }
+
+    writer.set_text(move(text));
+    writer.set_rodata(move(rodata));
+
+    Vector<u8> object = writer.write();
+
+    std::error_code ec;
+    ::llvm::raw_fd_ostream stream(output, ec);
+
+    if (ec) {
+        return err("Failed to open file '{}': {}", output, ec.message());
     }
 
-    m_current_block = block;
+    stream.write(reinterpret_cast<char const*>(object.data()), object.size());
+    stream.flush();
+
+    m_objects.push_back(output);
+    return {};
+}
+
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::BasicBlock* block) {
+    cg->label(block->name());
+    cg->set_block(block);
+
     for (auto& instruction : block->instructions()) {
-        this->generate(instruction.get());
+        this->generate(cg, instruction.get());
     }
 
-    m_current_block = nullptr;
+    cg->set_block(nullptr);
 }
 
-void x86_64CodeGen::generate(bytecode::Instruction* inst) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Instruction* inst) {
     switch (inst->type()) {
     #define Op(x) /* NOLINT */                                           \
         case bytecode::Instruction::x:                                   \
-            return this->generate(static_cast<bytecode::x*>(inst)); \
+            this->generate(cg, static_cast<bytecode::x*>(inst));         \
+            break;
 
         ENUMERATE_BYTECODE_INSTRUCTIONS(Op) /* NOLINT */
     #undef Op
     }
 }
 
-void x86_64CodeGen::generate(bytecode::NewFunction* inst) {
+void x86_64CodeGen::generate(CodeGenFunction*, bytecode::NewFunction* inst) {
     auto* function = inst->function();
     auto& parameters = function->parameters();
 
@@ -210,20 +415,27 @@ void x86_64CodeGen::generate(bytecode::NewFunction* inst) {
         return;
     }
 
-    auto cg = CodeGenFunction::create({});
+    auto cg = CodeGenFunction::create(normalize(function->qualified_name()), {});
 
-    cg->writeln("  push rbp");
-    cg->writeln("  mov rbp, rsp");
+    cg->emit(Opcode::push, { RBP });
+    cg->emit(Opcode::mov, { RBP, RSP });
     
-    size_t stack_space = function->locals().size() * 8;
-    cg->fwriteln("  sub rsp, {}", stack_space);
+    auto& allocation = m_allocations[function];
+    cg->set_allocation(&allocation);
+
+    cg->emit(Opcode::sub, { RSP, Operand::imm(static_cast<i64>(allocation.frame_size())) });
+
+    for (auto [index, reg] : llvm::enumerate(allocation.callee_saved)) {
+        i32 offset = static_cast<i32>(allocation.callee_saved_offset(index));
+        cg->emit(Opcode::mov, { Operand::mem(RBP, -offset), Register { reg } });
+    }
 
     ASSERT(parameters.size() <= SYS_V_CALL_REGISTERS.size(), "TODO: Allow for more parameters");
 
     size_t offset = 8;
     for (auto& parameter : parameters) {
         Register reg { SYS_V_CALL_REGISTERS[parameter.index] };
-        cg->fwriteln("  mov QWORD [rbp - {}], {}", offset, reg.as_qword());
+        cg->emit(Opcode::mov, { Operand::mem(RBP, -static_cast<i32>(offset)), reg });
 
         offset += 8;
     }
@@ -237,447 +449,376 @@ void x86_64CodeGen::generate(bytecode::NewFunction* inst) {
     m_functions[function] = cg;
 }
 
-void x86_64CodeGen::generate(bytecode::NewLocalScope* inst) {
-    auto cg = m_functions[inst->function()];
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::NewLocalScope*) {
+    // Blocks are generated with their function's `CodeGenFunction` already, there's nothing left to switch to
     ASSERT(cg, "Codegen function does not exist");
-
-    m_current_function = cg;
-    reset_all_registers();
 }
 
-void x86_64CodeGen::generate(bytecode::Move* inst) {
-    auto cg = m_current_function;
-
-    Register dst = this->pop_reg();
-    cg->fwriteln("  mov {}, {}", dst.as_qword(), inst->src());
-    
-    m_register_map[inst->dst()] = dst;
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Move* inst) {
+    Register reg = this->load(cg, bytecode::Operand(inst->src(), nullptr), this->target(cg, inst->dst(), { Register::rax }));
+    this->store(cg, inst->dst(), reg);
 }
 
-void x86_64CodeGen::generate(bytecode::GetLocal* inst) {
-    auto cg = m_current_function;
-    auto local = cg->local(inst->index());
-
-    ASSERT(local.has_value(), "Local does not exist");
-
-    Register dst = this->pop_reg();
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::GetLocal* inst) {
+    Register dst = this->target(cg, inst->dst(), { Register::rax });
+    cg->emit(Opcode::mov, { dst, this->local(cg, inst->index()) });
 
-    cg->fwriteln("  mov {}, QWORD [rbp - {}]", dst.as_qword(), local->offset);
-    m_register_map[inst->dst()] = dst;
+    this->store(cg, inst->dst(), dst);
 }
 
-void x86_64CodeGen::generate(bytecode::GetLocalRef* inst) {
-    auto cg = m_current_function;
-    auto local = cg->local(inst->index());
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::GetLocalRef* inst) {
+    Register dst = this->target(cg, inst->dst(), { Register::rax });
+    cg->emit(Opcode::lea, { dst, this->local(cg, inst->index()) });
 
-    ASSERT(local.has_value(), "Local does not exist");
-
-    Register dst = this->pop_reg();
-
-    cg->fwriteln("  lea {}, QWORD [rbp - {}]", dst.as_qword(), local->offset);
-    m_register_map[inst->dst()] = dst;
+    this->store(cg, inst->dst(), dst);
 }
 
-void x86_64CodeGen::generate(bytecode::SetLocal* inst) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::SetLocal* inst) {
     auto src = inst->src();
 
-    auto cg = m_current_function;
-    auto local = cg->local(inst->index());
-
-    ASSERT(local.has_value(), "Local does not exist");
+    Operand local = this->local(cg, inst->index());
 
     if (!src.has_value()) {
-        cg->fwriteln("  mov QWORD [rbp - {}], 0", local->offset);
+        cg->emit(Opcode::mov, { local, Operand::imm(0) });
         return;
-    } else if (src->is_register()) {
-        Register reg = m_register_map[src->reg()];
-        cg->fwriteln("  mov QWORD [rbp - {}], {}", local->offset, reg.as_qword());
-
-        this->push_reg(reg);
-    } else {
-        Register reg = this->pop_reg();
-        
-        cg->fwriteln("  mov {}, {}", reg.as_qword(), src->value());
-        cg->fwriteln("  mov QWORD [rbp - {}], {}", local->offset, reg.as_qword());
-
-        this->push_reg(reg);
     }
+
+    cg->emit(Opcode::mov, { local, this->source(cg, *src, { Register::r11 }) });
 }
 
-void x86_64CodeGen::generate(bytecode::GetGlobal*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::GetGlobal*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::GetGlobalRef*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::GetGlobalRef*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::SetGlobal*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::SetGlobal*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::GetMember* inst) {
-    auto cg = m_current_function;
-
-    Register dst = this->pop_reg();
-    Register src = m_register_map[inst->src()];
+// The type of what an index into `type` (the pointee of a GetMember(Ref) source) refers to when it's a pointer or an array
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::GetMember* inst) {
+    Register src = this->load(cg, bytecode::Operand(inst->src()), { Register::r10 });
+    Register dst = this->target(cg, inst->dst(), { Register::rax });
 
     bytecode::Operand index = inst->index();
     Type* type = m_state.type(inst->src())->get_pointee_type();
 
-    if (type->is_pointer()) {
-        type = type->get_pointee_type();
-    } else {
-        type = type->get_array_element_type();
-    }
+    // Struct fields and tuple elements are always indexed by a constant
+    if (type->is_struct() || type->is_tuple()) {
+        Type* member = type->is_struct() ? type->get_struct_field_at(index.value()) : type->get_tuple_element(index.value());
+        DataType data_type = data_type_of(member->size());
 
-    size_t byte_size = type->size();
-    auto data_type = static_cast<DataType>(byte_size);
+        this->load_memory(cg, dst, Operand::mem(src, static_cast<i32>(type->offset_of(index.value())), data_type));
+        this->store(cg, inst->dst(), dst);
 
-    StringView instruction = "mov";
-    if (data_type != DataType::QWord) {
-        instruction = "movzx";
+        return;
     }
 
-    if (index.is_register()) {
-        Register idx = m_register_map[index.reg()];
-        cg->fwriteln("  {} {}, {} [{} + {} * {}]", instruction, dst.as_qword(), data_type, src.as_qword(), idx.as_qword(), byte_size);
-
-        this->push_reg(idx);
-    } else {
-        cg->fwriteln("  {} {}, {} [{} + {} * {}]", instruction, dst.as_qword(), data_type, src.as_qword(), index.value(), byte_size);
-    }
+    size_t byte_size = element_type_of(type)->size();
+    DataType data_type = data_type_of(byte_size);
 
-    this->push_reg(src);
-    m_register_map[inst->dst()] = dst;
+    this->load_memory(cg, dst, this->element_address(cg, src, index, byte_size, data_type));
+    this->store(cg, inst->dst(), dst);
 }
 
-void x86_64CodeGen::generate(bytecode::SetMember*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::SetMember*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::GetMemberRef* inst) {
-    auto cg = m_current_function;
-
-    Register dst = this->pop_reg();
-    Register src = m_register_map[inst->src()];
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::GetMemberRef* inst) {
+    Register src = this->load(cg, bytecode::Operand(inst->src()), { Register::r10 });
+    Register dst = this->target(cg, inst->dst(), { Register::rax });
 
     bytecode::Operand index = inst->index();
     Type* type = m_state.type(inst->src())->get_pointee_type();
 
-    size_t byte_size = type->size();
-    if (index.is_register()) {
-        Register idx = m_register_map[index.reg()];
-        cg->fwriteln("  lea {}, QWORD [{} + {} * {}]", dst.as_qword(), src.as_qword(), idx.as_qword(), byte_size);
+    if (type->is_struct() || type->is_tuple()) {
+        cg->emit(Opcode::lea, { dst, Operand::mem(src, static_cast<i32>(type->offset_of(index.value()))) });
 
-        this->push_reg(idx);
-    } else {
-        cg->fwriteln("  lea {}, QWORD [{} + {} * {}]", dst.as_qword(), src.as_qword(), index.value(), byte_size);
+        this->store(cg, inst->dst(), dst);
+        return;
     }
 
-    this->push_reg(src);
-    m_register_map[inst->dst()] = dst;
-}
-
-void x86_64CodeGen::generate(bytecode::Alloca*) {}
-
-void x86_64CodeGen::generate(bytecode::Read* inst) {
-    auto cg = m_current_function;
+    size_t byte_size = element_type_of(type)->size();
+    cg->emit(Opcode::lea, { dst, this->element_address(cg, src, index, byte_size, DataType::QWord) });
 
-    Register dst = this->pop_reg();
-    Register src = m_register_map[inst->src()];
-
-    cg->fwriteln("  mov {}, QWORD [{}]", dst.as_qword(), src.as_qword());
-    this->push_reg(src);
-
-    m_register_map[inst->dst()] = dst;
+    this->store(cg, inst->dst(), dst);
 }
 
-void x86_64CodeGen::generate(bytecode::Write* inst) {
-    auto cg = m_current_function;
-
-    Register dst = this->pop_reg();
-    Register src = {};
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Alloca*) {}
 
-    if (inst->src().is_value()) {
-        src = this->pop_reg();
-        cg->fwriteln("  mov {}, {}", src.as_qword(), inst->src().value());
-    } else {
-        src = m_register_map[inst->src().reg()];
-    }
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Read* inst) {
+    Register src = this->load(cg, bytecode::Operand(inst->src()), { Register::r10 });
+    Register dst = this->target(cg, inst->dst(), { Register::rax });
 
-    cg->fwriteln("  mov QWORD [{}], {}", dst.as_qword(), src.as_qword());
-    this->push_reg(src);
+    cg->emit(Opcode::mov, { dst, Operand::mem(src, 0) });
+    this->store(cg, inst->dst(), dst);
+}
 
-    m_register_map[inst->dst()] = dst;
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Write* inst) {
+    Register dst = this->load(cg, bytecode::Operand(inst->dst()), { Register::r10 });
+    cg->emit(Opcode::mov, { Operand::mem(dst, 0), this->source(cg, inst->src(), { Register::r11 }) });
 }
 
-void x86_64CodeGen::generate(bytecode::Jump* inst) {
-    auto cg = m_current_function;
-    cg->fwriteln("  jmp .{}", inst->target()->name());
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Jump* inst) {
+    cg->emit(Opcode::jmp, { Operand::label(inst->target()->name()) });
 }
 
-void x86_64CodeGen::generate(bytecode::JumpIf* inst) {
-    auto cg = m_current_function;
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::JumpIf* inst) {
     auto condition = inst->condition();
 
-    Register reg = {};
-    if (condition.is_value()) {
-        reg = this->pop_reg();
-        cg->fwriteln("  mov {}, {}", reg.as_qword(), condition.value());
-    } else {
-        reg = m_register_map[condition.reg()];
-    }
-
-    auto* block = m_current_block;
+    auto* block = cg->block();
 
     auto* false_target = inst->false_target();
     auto* true_target = inst->true_target();
 
-    ConditionCode cc = ConditionCode::z;
-    if (m_next_cc != ConditionCode::None) {
-        cc = m_next_cc;
-        m_next_cc = ConditionCode::None;
+    // `cc` is the condition under which the true target is taken
+    ConditionCode cc = ConditionCode::nz;
+    if (cg->next_cc() != ConditionCode::None) {
+        cc = cg->next_cc();
+        cg->set_next_cc(ConditionCode::None);
     } else {
-        cg->fwriteln("  test {0}, {0}", reg.as_qword());
+        Register reg = this->load(cg, condition, { Register::r10 });
+        cg->emit(Opcode::test, { reg, reg });
     }
 
     if (block->next() == true_target) {
-        cc = negate(cc);
-        cg->fwriteln("  j{} .{}", cc, false_target->name());
+        cg->emit(Opcode::j, negate(cc), { Operand::label(false_target->name()) });
     } else if (block->next() == false_target) {
-        cg->fwriteln("  j{} .{}", cc, true_target->name());
+        cg->emit(Opcode::j, cc, { Operand::label(true_target->name()) });
     } else {
-        cg->fwriteln("  j{} .{}", cc, false_target->name());
-        cg->fwriteln("  jmp .{}", true_target->name());
+        cg->emit(Opcode::j, cc, { Operand::label(true_target->name()) });
+        cg->emit(Opcode::jmp, { Operand::label(false_target->name()) });
     }
-
-    this->push_reg(reg);
 }
 
-void x86_64CodeGen::generate(bytecode::GetFunction* inst) {
-    auto cg = m_current_function;
-    String name = normalize(inst->function()->qualified_name());
-
-    auto& uses = m_state.register_uses(inst->dst());
-    if (uses.contains<bytecode::Call>()) {
-        m_next_calls.push(inst->function());
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::GetFunction* inst) {
+    if (cg->allocation().direct_calls.contains(inst->dst())) {
         return;
     }
 
-    Register dst = this->pop_reg();
+    auto* function = inst->function();
+
+    String name = normalize(function->qualified_name());
+    Register dst = this->target(cg, inst->dst(), { Register::rax });
+
+    // The address of a function defined elsewhere is only known through its GOT entry
+    if (is_external(function)) {
+        cg->emit(Opcode::mov, { dst, Operand::relative(move(name), true) });
+    } else {
+        cg->emit(Opcode::lea, { dst, Operand::relative(move(name)) });
+    }
 
-    cg->fwriteln("  mov {}, {}", dst.as_qword(), name);
-    m_register_map[inst->dst()] = dst;
+    this->store(cg, inst->dst(), dst);
 }
 
-void x86_64CodeGen::generate(bytecode::Return* inst) {
-    auto cg = m_current_function;
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Return* inst) {
     auto value = inst->value();
 
-    if (!value.has_value()) {
-        cg->writeln("  leave");
-        cg->writeln("  ret");
-    } else if (value->is_register()) {
-        Register reg = m_register_map[value->reg()];
-        if (reg.type == Register::rax) {
-            cg->writeln("  leave");
-            cg->writeln("  ret");
-            
-            this->push_reg(reg);
-            return;
+    if (value.has_value()) {
+        Register reg = this->load(cg, *value, { Register::rax });
+        if (reg.type != Register::rax) {
+            cg->emit(Opcode::mov, { Register { Register::rax }, reg });
         }
-
-        cg->fwriteln("  mov rax, {}", reg.as_qword());
-        cg->writeln("  leave");
-        cg->writeln("  ret");
-    } else {
-        cg->fwriteln("  mov rax, {}", value->value());
-        cg->writeln("  leave");
-        cg->writeln("  ret");
     }
-}
 
-void x86_64CodeGen::generate(bytecode::Call* inst) {
-    auto cg = m_current_function;
+    this->generate_epilogue(cg);
+}
 
-    size_t index = 0;
-    for (auto& operand : inst->arguments()) {
-        Register dst { SYS_V_CALL_REGISTERS[index] };
-        if (operand.is_value()) {
-            cg->fwriteln("  mov {}, {}", dst.as_qword(), operand.value());
-            index++;
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Call* inst) {
+    auto& arguments = inst->arguments();
 
-            continue;
-        }
+    ASSERT(arguments.size() <= SYS_V_CALL_REGISTERS.size(), "TODO: Allow for more arguments");
 
-        Register reg = m_register_map[operand.reg()];
-        if (reg.type == dst.type) {
-            index++;
-            continue;
-        }
+    Vector<Register::Type> saved;
+    auto iterator = cg->allocation().live_across_calls.find(inst);
+    if (iterator != cg->allocation().live_across_calls.end()) {
+        saved = iterator->second;
+    }
 
-        cg->fwriteln("  mov {}, {}", dst.as_qword(), reg.as_qword());
-        index++;
+    auto save_slot = [cg](Register::Type reg) {
+        return Operand::mem(RBP, -static_cast<i32>(cg->allocation().caller_saved_offset(reg)));
+    };
 
-        this->push_reg(reg);
+    for (auto reg : saved) {
+        cg->emit(Opcode::mov, { save_slot(reg), Register { reg } });
     }
 
-    if (!m_next_calls.empty()) {
-        Function* function = m_next_calls.top();
-        m_next_calls.pop();
-
-        String name = normalize(function->qualified_name());
-        cg->fwriteln("  call {}", name);
+    // Arguments might already sit in each other's registers, going through the stack keeps them from being clobbered
+    for (auto& argument : arguments) {
+        cg->emit(Opcode::push, { this->source(cg, argument, { Register::r10 }) });
+    }
 
-        if (m_next_calls.empty()) {
-            this->push_reg({ Register::rax });
-        }
+    Operand callee;
+    auto direct = cg->allocation().direct_calls.find(inst->function());
+    if (direct != cg->allocation().direct_calls.end()) {
+        auto* function = direct->second;
+        callee = Operand::symbol(normalize(function->qualified_name()), is_external(function));
     } else {
-        Register function = m_register_map[inst->function()];
-        cg->fwriteln("  call {}", function.as_qword());
+        // The callee's register may be one of the argument registers, so move it out of the way before the pops
+        Register reg = this->load(cg, bytecode::Operand(inst->function()), { Register::r11 });
+        if (reg.type != Register::r11) {
+            cg->emit(Opcode::mov, { Register { Register::r11 }, reg });
+        }
 
-        this->push_reg(function);
+        callee = Register { Register::r11 };
     }
 
-    Register dst = this->pop_reg();
+    for (size_t index = arguments.size(); index-- > 0;) {
+        cg->emit(Opcode::pop, { Register { SYS_V_CALL_REGISTERS[index] } });
+    }
+
+    cg->emit(Opcode::call, { callee });
 
     Type* return_type = inst->function_type()->return_type();
-    if (dst.type != Register::rax && !return_type->is_void()) {
-        cg->fwriteln("  mov {}, rax", dst.as_qword());
+    if (!return_type->is_void()) {
+        this->store(cg, inst->dst(), { Register::rax });
     }
 
-    m_register_map[inst->dst()] = dst;
+    for (auto reg : saved) {
+        cg->emit(Opcode::mov, { Register { reg }, save_slot(reg) });
+    }
 }
 
-void x86_64CodeGen::generate(bytecode::Cast*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Cast*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::NewArray*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::NewArray*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::NewStruct*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::NewStruct*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::Construct*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Construct*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::NewTuple*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::NewTuple*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::Null*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Null*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::Not*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Not*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::Boolean*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Boolean*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::Memcpy*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Memcpy*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::GetReturn*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::GetReturn*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::NewString* inst) {
-    auto cg = m_current_function;
-    
-    size_t offset = m_strings.size();
-    m_strings.push_back(inst->value());
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Phi*) {
+    ASSERT(false, "Phis should have been lowered by `LowerPhisPass`");
+}
+
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Copy* inst) {
+    Register reg = this->load(cg, inst->src(), this->target(cg, inst->dst(), { Register::rax }));
+    this->store(cg, inst->dst(), reg);
+}
+
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::NewString* inst) {
+    size_t index = cg->add_string(inst->value());
 
-    Register dst = this->pop_reg();
-    cg->fwriteln("  mov {}, __str.{}", dst.as_qword(), offset);
+    Register dst = this->target(cg, inst->dst(), { Register::rax });
+    cg->emit(Opcode::lea, { dst, Operand::relative(cg->string_symbol(index)) });
 
-    m_register_map[inst->dst()] = dst;
+    this->store(cg, inst->dst(), dst);
 }
 
-void x86_64CodeGen::generate(bytecode::Add* inst) {
-    this->generate_binary_op_with_dst(
-        BinaryInstruction::add,
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Add* inst) {
+    this->generate_binary_op(
+        cg,
+        Opcode::add,
         inst->dst(), inst->lhs(), inst->rhs()
     );
 }
 
-void x86_64CodeGen::generate(bytecode::Sub* inst) {
-    this->generate_binary_op_with_dst(
-        BinaryInstruction::sub,
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Sub* inst) {
+    this->generate_binary_op(
+        cg,
+        Opcode::sub,
         inst->dst(), inst->lhs(), inst->rhs()
     );
 }
 
-void x86_64CodeGen::generate(bytecode::Mul*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Mul*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::Div*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Div*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::Mod*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Mod*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::Or*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Or*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::And*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::And*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::LogicalOr*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::LogicalOr*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::LogicalAnd*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::LogicalAnd*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::Xor*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Xor*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::Rsh*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Rsh*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::Lsh*) {
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Lsh*) {
     ASSERT(false, "Not implemented");
 }
 
-void x86_64CodeGen::generate(bytecode::Eq* inst) {
-    this->generate_condition(ConditionCode::e, inst, inst->dst(), inst->lhs(), inst->rhs());
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Eq* inst) {
+    this->generate_condition(cg, ConditionCode::e, inst->dst(), inst->lhs(), inst->rhs());
 }
 
-void x86_64CodeGen::generate(bytecode::Neq* inst) {
-    this->generate_condition(ConditionCode::ne, inst, inst->dst(), inst->lhs(), inst->rhs());
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Neq* inst) {
+    this->generate_condition(cg, ConditionCode::ne, inst->dst(), inst->lhs(), inst->rhs());
 }
 
-void x86_64CodeGen::generate(bytecode::Gt* inst) {
-    this->generate_condition(ConditionCode::g, inst, inst->dst(), inst->lhs(), inst->rhs());
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Gt* inst) {
+    this->generate_condition(cg, ConditionCode::g, inst->dst(), inst->lhs(), inst->rhs());
 }
 
-void x86_64CodeGen::generate(bytecode::Lt* inst) {
-    this->generate_condition(ConditionCode::l, inst, inst->dst(), inst->lhs(), inst->rhs());
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Lt* inst) {
+    this->generate_condition(cg, ConditionCode::l, inst->dst(), inst->lhs(), inst->rhs());
 }
 
-void x86_64CodeGen::generate(bytecode::Gte* inst) {
-    this->generate_condition(ConditionCode::ge, inst, inst->dst(), inst->lhs(), inst->rhs());
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Gte* inst) {
+    this->generate_condition(cg, ConditionCode::ge, inst->dst(), inst->lhs(), inst->rhs());
 }
 
-void x86_64CodeGen::generate(bytecode::Lte* inst) {
-    this->generate_condition(ConditionCode::le, inst, inst->dst(), inst->lhs(), inst->rhs());
+void x86_64CodeGen::generate(CodeGenFunction* cg, bytecode::Lte* inst) {
+    this->generate_condition(cg, ConditionCode::le, inst->dst(), inst->lhs(), inst->rhs());
 }
  
 }
\ No newline at end of file
@@ -6,8 +6,9 @@
 #include <quart/codegen/x86_64/functions.h>
 #include <quart/codegen/x86_64/registers.h>
 #include <quart/codegen/x86_64/cpu.h>
+#include <quart/codegen/x86_64/register_allocator.h>
 
-#include <stack>
+#include <quart/thread_pool.h>
 
 namespace quart::x86_64 {
 
@@ -18,38 +19,58 @@ public:
     ErrorOr<void> generate(CompilerOptions const&) override;
 
 private:
-    void reset_all_registers();
+    ErrorOr<void> write_assembly(ThreadPool&, String const& output);
+    ErrorOr<void> write_object(ThreadPool&, String const& output);
 
-    Register pop_reg();
-    void push_reg(Register);
+    // Everything below only touches the `CodeGenFunction` it is given, which lets functions be generated in parallel.
+    // Global instructions have no function of their own and are generated with `nullptr`.
+    void generate_epilogue(CodeGenFunction*);
 
-    String normalize(String qualified_name);
+    Location const& location_of(CodeGenFunction*, bytecode::Register) const;
 
-    void generate(bytecode::BasicBlock*);
-    void generate(bytecode::Instruction*);
+    // Returns a register holding `operand`, immediates and spilled registers are loaded into `scratch` first
+    Register load(CodeGenFunction*, bytecode::Operand operand, Register scratch);
 
-    Register generate_binary_op(
-        BinaryInstruction instruction,
-        bytecode::Operand lhs,
-        bytecode::Operand rhs
-    );
+    // The register a result should be computed into, `scratch` if `dst` lives on the stack
+    Register target(CodeGenFunction*, bytecode::Register dst, Register scratch) const;
+
+    // Moves `reg` into wherever `dst` lives, if it's not there already
+    void store(CodeGenFunction*, bytecode::Register dst, Register reg);
+
+    // `operand` as an instruction's source, immediates that don't fit in 32 bits are loaded into `scratch`
+    Operand source(CodeGenFunction*, bytecode::Operand operand, Register scratch);
+
+    Operand spill_slot(CodeGenFunction*, u32 slot) const;
+    Operand local(CodeGenFunction*, size_t index) const;
+
+    // Loads `address` into `dst`, zero-extending anything smaller than a qword
+    void load_memory(CodeGenFunction*, Register dst, Operand address);
+
+    // The address of element `index` of an array of `size` byte elements starting at `base`
+    Operand element_address(CodeGenFunction*, Register base, bytecode::Operand index, size_t size, DataType data_type);
 
-    Register generate_binary_op_with_dst(
-        BinaryInstruction instruction,
+    String normalize(StringView qualified_name);
+
+    void generate(CodeGenFunction*, bytecode::BasicBlock*);
+    void generate(CodeGenFunction*, bytecode::Instruction*);
+
+    void generate_binary_op(
+        CodeGenFunction*,
+        Opcode opcode,
         bytecode::Register dst,
         bytecode::Operand lhs,
         bytecode::Operand rhs
     );
 
     void generate_condition(
+        CodeGenFunction*,
         ConditionCode cc,
-        bytecode::Instruction* instruction,
         bytecode::Register dst,
         bytecode::Operand lhs,
         bytecode::Operand rhs
     );
 
-#define Op(x) void generate(bytecode::x*); // NOLINT
+#define Op(x) void generate(CodeGenFunction*, bytecode::x*); // NOLINT
     ENUMERATE_BYTECODE_INSTRUCTIONS(Op)
 #undef Op
 
@@ -59,20 +80,7 @@ private:
     HashMap<Function*, RefPtr<CodeGenFunction>> m_functions;
     Vector<Function*> m_extern_functions;
 
-    RefPtr<CodeGenFunction> m_current_function;
-    bytecode::BasicBlock* m_current_block = nullptr;
-
-    ConditionCode m_next_cc = ConditionCode::None;
-
-    Function* m_next_call = nullptr;
-    std::stack<Function*> m_next_calls;
-
-    std::stack<Register> m_available_registers;
-    std::stack<Register> m_callee_saved_registers;
-
-    HashMap<bytecode::Register, Register> m_register_map;
-
-    Vector<String> m_strings;
+    HashMap<Function*, Allocation> m_allocations;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include <quart/codegen/x86_64/elf.h>
+#include <quart/assert.h>
+
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/BinaryFormat/ELF.h>
+
+namespace quart::x86_64 {
+
+namespace ELF = ::llvm::ELF;
+
+// Everything is written field by field in little-endian, so the layout doesn't depend on the host
+template<typename T>
+static void append(Vector<u8>& buffer, T value) {
+    auto bits = static_cast<u64>(value);
+    for (size_t i = 0; i < sizeof(T); i++) {
+        buffer.push_back(static_cast<u8>(bits >> (i * 8)));
+    }
+}
+
+static void align(Vector<u8>& buffer, size_t alignment) {
+    while (buffer.size() % alignment != 0) {
+        buffer.push_back(0);
+    }
+}
+
+static u32 add_string(String& table, StringView string) {
+    auto offset = static_cast<u32>(table.size());
+
+    table.append(string);
+    table.push_back('\0');
+
+    return offset;
+}
+
+static u32 relocation_type(Relocation::Type type) {
+    switch (type) {
+        case Relocation::Type::PC32: return ELF::R_X86_64_PC32;
+        case Relocation::Type::PLT32: return ELF::R_X86_64_PLT32;
+        case Relocation::Type::GOTPCRELX: return ELF::R_X86_64_REX_GOTPCRELX;
+    }
+
+    return ELF::R_X86_64_NONE;
+}
+
+void ELFObjectWriter::add_symbol(Symbol symbol) {
+    ASSERT(!m_symbol_indices.contains(symbol.name), "Symbol was already added");
+
+    m_symbol_indices[symbol.name] = m_symbols.size();
+    m_symbols.push_back(move(symbol));
+}
+
+void ELFObjectWriter::add_relocation(Relocation relocation) {
+    m_relocations.push_back(move(relocation));
+}
+
+Vector<u8> ELFObjectWriter::write() const {
+    enum SectionIndex : u16 {
+        Null,
+        Text,
+        Rodata,
+        Symtab,
+        Strtab,
+        RelaText,
+        NoteGNUStack,
+        Shstrtab,
+        Count
+    };
+
+    // Local symbols have to come before any global one in the symbol table
+    Vector<Symbol const*> symbols;
+    for (auto& symbol : m_symbols) {
+        if (!symbol.is_global) {
+            symbols.push_back(&symbol);
+        }
+    }
+
+    auto first_global = static_cast<u32>(symbols.size() + 1);
+    for (auto& symbol : m_symbols) {
+        if (symbol.is_global) {
+            symbols.push_back(&symbol);
+        }
+    }
+
+    Vector<Symbol> undefined;
+    Set<String> seen;
+
+    for (auto& relocation : m_relocations) {
+        if (m_symbol_indices.contains(relocation.symbol) || seen.contains(relocation.symbol)) {
+            continue;
+        }
+
+        seen.insert(relocation.symbol);
+        undefined.push_back({ relocation.symbol, Section::Undefined, 0, 0, true, false });
+    }
+
+    for (auto& symbol : undefined) {
+        symbols.push_back(&symbol);
+    }
+
+    HashMap<StringView, u32> indices;
+
+    String strtab(1, '\0');
+    Vector<u8> symtab(sizeof(ELF::Elf64_Sym), 0);
+
+    for (auto [index, symbol] : llvm::enumerate(symbols)) {
+        indices[symbol->name] = index + 1;
+
+        u8 binding = symbol->is_global ? ELF::STB_GLOBAL : ELF::STB_LOCAL;
+        u8 type = ELF::STT_NOTYPE;
+
+        u16 section = ELF::SHN_UNDEF;
+        switch (symbol->section) {
+            case Section::Undefined:
+                break;
+            case Section::Text:
+                section = SectionIndex::Text;
+                type = symbol->is_function ? ELF::STT_FUNC : ELF::STT_NOTYPE;
+
+                break;
+            case Section::Rodata:
+                section = SectionIndex::Rodata;
+                type = ELF::STT_OBJECT;
+
+                break;
+        }
+
+        append<u32>(symtab, add_string(strtab, symbol->name));
+        append<u8>(symtab, (binding << 4) | type);
+        append<u8>(symtab, ELF::STV_DEFAULT);
+        append<u16>(symtab, section);
+        append<u64>(symtab, symbol->value);
+        append<u64>(symtab, symbol->size);
+    }
+
+    Vector<u8> rela;
+    for (auto& relocation : m_relocations) {
+        u64 symbol = indices[relocation.symbol];
+
+        append<u64>(rela, relocation.offset);
+        append<u64>(rela, (symbol << 32) | relocation_type(relocation.type));
+        append<i64>(rela, relocation.addend);
+    }
+
+    struct SectionHeader {
+        u32 name = 0;
+        u32 type = ELF::SHT_NULL;
+        u64 flags = 0;
+        u64 offset = 0;
+        u64 size = 0;
+        u32 link = 0;
+        u32 info = 0;
+        u64 alignment = 0;
+        u64 entry_size = 0;
+    };
+
+    static const Array<StringView, SectionIndex::Count> NAMES = {
+        "", ".text", ".rodata", ".symtab", ".strtab", ".rela.text", ".note.GNU-stack", ".shstrtab"
+    };
+
+    Array<SectionHeader, SectionIndex::Count> headers;
+    Array<Vector<u8> const*, SectionIndex::Count> contents = {};
+
+    String shstrtab(1, '\0');
+    for (u16 index = 1; index < SectionIndex::Count; index++) {
+        headers[index].name = add_string(shstrtab, NAMES[index]);
+    }
+
+    Vector<u8> strtab_bytes(strtab.begin(), strtab.end());
+    Vector<u8> shstrtab_bytes(shstrtab.begin(), shstrtab.end());
+
+    Vector<u8> empty;
+
+    auto define = [&](SectionIndex index, u32 type, u64 flags, Vector<u8> const& data, u64 alignment) -> SectionHeader& {
+        auto& header = headers[index];
+
+        header.type = type;
+        header.flags = flags;
+        header.size = data.size();
+        header.alignment = alignment;
+
+        contents[index] = &data;
+        return header;
+    };
+
+    define(SectionIndex::Text, ELF::SHT_PROGBITS, ELF::SHF_ALLOC | ELF::SHF_EXECINSTR, m_text, 16);
+    define(SectionIndex::Rodata, ELF::SHT_PROGBITS, ELF::SHF_ALLOC, m_rodata, 1);
+
+    auto& symtab_header = define(SectionIndex::Symtab, ELF::SHT_SYMTAB, 0, symtab, 8);
+    symtab_header.link = SectionIndex::Strtab;
+    symtab_header.info = first_global;
+    symtab_header.entry_size = sizeof(ELF::Elf64_Sym);
+
+    define(SectionIndex::Strtab, ELF::SHT_STRTAB, 0, strtab_bytes, 1);
+
+    auto& rela_header = define(SectionIndex::RelaText, ELF::SHT_RELA, ELF::SHF_INFO_LINK, rela, 8);
+    rela_header.link = SectionIndex::Symtab;
+    rela_header.info = SectionIndex::Text;
+    rela_header.entry_size = sizeof(ELF::Elf64_Rela);
+
+    // Without it, linkers assume the object needs an executable stack
+    define(SectionIndex::NoteGNUStack, ELF::SHT_PROGBITS, 0, empty, 1);
+    define(SectionIndex::Shstrtab, ELF::SHT_STRTAB, 0, shstrtab_bytes, 1);
+
+    Vector<u8> output(sizeof(ELF::Elf64_Ehdr), 0);
+    for (u16 index = 1; index < SectionIndex::Count; index++) {
+        auto& section = headers[index];
+
+        align(output, section.alignment);
+        section.offset = output.size();
+
+        output.insert(output.end(), contents[index]->begin(), contents[index]->end());
+    }
+
+    align(output, 8);
+    u64 section_headers = output.size();
+
+    for (auto& section : headers) {
+        append<u32>(output, section.name);
+        append<u32>(output, section.type);
+        append<u64>(output, section.flags);
+        append<u64>(output, 0);
+        append<u64>(output, section.offset);
+        append<u64>(output, section.size);
+        append<u32>(output, section.link);
+        append<u32>(output, section.info);
+        append<u64>(output, section.alignment);
+        append<u64>(output, section.entry_size);
+    }
+
+    Vector<u8> ehdr = { 0x7F, 'E', 'L', 'F', ELF::ELFCLASS64, ELF::ELFDATA2LSB, ELF::EV_CURRENT, ELF::ELFOSABI_NONE };
+    ehdr.resize(ELF::EI_NIDENT, 0);
+
+    append<u16>(ehdr, ELF::ET_REL);
+    append<u16>(ehdr, ELF::EM_X86_64);
+    append<u32>(ehdr, ELF::EV_CURRENT);
+    append<u64>(ehdr, 0);                           // e_entry
+    append<u64>(ehdr, 0);                           // e_phoff
+    append<u64>(ehdr, section_headers);             // e_shoff
+    append<u32>(ehdr, 0);                           // e_flags
+    append<u16>(ehdr, sizeof(ELF::Elf64_Ehdr));
+    append<u16>(ehdr, 0);                           // e_phentsize
+    append<u16>(ehdr, 0);                           // e_phnum
+    append<u16>(ehdr, sizeof(ELF::Elf64_Shdr));
+    append<u16>(ehdr, SectionIndex::Count);
+    append<u16>(ehdr, SectionIndex::Shstrtab);
+
+    std::copy(ehdr.begin(), ehdr.end(), output.begin());
+    return output;
+}
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <quart/common.h>
+#include <quart/codegen/x86_64/assembler.h>
+
+namespace quart::x86_64 {
+
+// Writes an ELF64 relocatable object with a `.text` section, a `.rodata` section and the relocations of `.text`.
+// Symbols are written in the order they were added, which keeps the output the same from one run to another.
+class ELFObjectWriter {
+public:
+    enum class Section : u8 {
+        Undefined,
+        Text,
+        Rodata
+    };
+
+    struct Symbol {
+        String name;
+        Section section = Section::Undefined;
+
+        u64 value = 0;
+        u64 size = 0;
+
+        bool is_global = false;
+        bool is_function = false;
+    };
+
+    ELFObjectWriter() = default;
+
+    void set_text(Vector<u8> text) { m_text = move(text); }
+    void set_rodata(Vector<u8> rodata) { m_rodata = move(rodata); }
+
+    void add_symbol(Symbol symbol);
+
+    // Symbols that are only referenced by relocations are added as undefined globals, to be resolved by the linker
+    void add_relocation(Relocation relocation);
+
+    Vector<u8> write() const;
+
+private:
+    Vector<Symbol> m_symbols;
+    HashMap<String, size_t> m_symbol_indices;
+
+    Vector<Relocation> m_relocations;
+
+    Vector<u8> m_text;
+    Vector<u8> m_rodata;
+};
+
+}
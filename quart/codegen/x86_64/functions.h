@@ -2,6 +2,8 @@
 
 #include <quart/common.h>
 #include <quart/format.h>
+#include <quart/codegen/x86_64/instruction.h>
+#include <quart/codegen/x86_64/register_allocator.h>
 
 namespace quart::x86_64 {
 
@@ -31,11 +33,32 @@ public:
         size_t offset = 0;
     };
 
-    static RefPtr<CodeGenFunction> create(Vector<Local> locals) {
-        return RefPtr<CodeGenFunction>(new CodeGenFunction(move(locals)));
+    static RefPtr<CodeGenFunction> create(String name, Vector<Local> locals) {
+        return RefPtr<CodeGenFunction>(new CodeGenFunction(move(name), move(locals)));
     }
 
-    String const& code() const { return m_code; }
+    String const& name() const { return m_name; }
+
+    Vector<Instruction> const& instructions() const { return m_instructions; }
+
+    Allocation const& allocation() const { return *m_allocation; }
+    void set_allocation(Allocation const* allocation) { m_allocation = allocation; }
+
+    bytecode::BasicBlock* block() const { return m_block; }
+    void set_block(bytecode::BasicBlock* block) { m_block = block; }
+
+    // Set when a comparison is fused into the conditional jump that follows it
+    ConditionCode next_cc() const { return m_next_cc; }
+    void set_next_cc(ConditionCode cc) { m_next_cc = cc; }
+
+    // Strings are named after the function that uses them so that their symbols don't depend on the order functions are generated in
+    Vector<String> const& strings() const { return m_strings; }
+    size_t add_string(String value) {
+        m_strings.push_back(move(value));
+        return m_strings.size() - 1;
+    }
+
+    String string_symbol(size_t index) const { return format("{}.str.{}", m_name, index); }
 
     Vector<Local> const& locals() const { return m_locals; }
     Optional<Local> local(size_t index) {
@@ -48,23 +71,41 @@ public:
 
     void add_local(Local local) { m_locals.push_back(local); }
 
-    void write(StringView code) { m_code.append(code); }
-    void writeln(StringView line) { m_code.append(line); m_code.push_back('\n'); }
+    void emit(Opcode opcode, std::initializer_list<Operand> operands = {}) {
+        m_instructions.emplace_back(opcode, ConditionCode::None, operands);
+    }
 
-    template<typename ...Args>
-    void fwriteln(std::format_string<Args...> fmt, Args... args) {
-        String str = std::format(fmt, std::forward<Args>(args)...);
-        writeln(str);
+    void emit(Opcode opcode, ConditionCode cc, std::initializer_list<Operand> operands) {
+        m_instructions.emplace_back(opcode, cc, operands);
+    }
+
+    void label(String name) { this->emit(Opcode::Label, { Operand::label(move(name)) }); }
+
+    // The function formatted as NASM, only used when emitting assembly
+    String code() const {
+        String code;
+        for (auto& instruction : m_instructions) {
+            code.append(instruction.to_string());
+            code.push_back('\n');
+        }
+
+        return code;
     }
 
 private:
-    CodeGenFunction(Vector<Local> locals) : m_locals(move(locals)) {}
+    CodeGenFunction(String name, Vector<Local> locals) : m_name(move(name)), m_locals(move(locals)) {}
+
+    String m_name;
 
     Vector<Local> m_locals;
+    Vector<Instruction> m_instructions;
+
+    Allocation const* m_allocation = nullptr;
+    bytecode::BasicBlock* m_block = nullptr;
+
+    ConditionCode m_next_cc = ConditionCode::None;
 
-    String m_prologue;
-    String m_code;
-    String m_epilogue;
+    Vector<String> m_strings;
 };
 
 }
\ No newline at end of file
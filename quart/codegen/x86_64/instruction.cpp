@@ -0,0 +1,155 @@
+#include <quart/codegen/x86_64/instruction.h>
+#include <quart/assert.h>
+#include <quart/format.h>
+
+namespace quart::x86_64 {
+
+StringView to_string(Opcode opcode) {
+    switch (opcode) {
+        case Opcode::Label: return "???";
+
+        case Opcode::mov:   return "mov";
+        case Opcode::movzx: return "movzx";
+        case Opcode::lea:   return "lea";
+        case Opcode::add:   return "add";
+        case Opcode::sub:   return "sub";
+        case Opcode::cmp:   return "cmp";
+        case Opcode::imul:  return "imul";
+        case Opcode::test:  return "test";
+        case Opcode::set:   return "set";
+        case Opcode::jmp:   return "jmp";
+        case Opcode::j:     return "j";
+        case Opcode::push:  return "push";
+        case Opcode::pop:   return "pop";
+        case Opcode::call:  return "call";
+        case Opcode::leave: return "leave";
+        case Opcode::ret:   return "ret";
+    }
+
+    return "???";
+}
+
+Operand Operand::imm(i64 value) {
+    Operand operand;
+
+    operand.m_kind = Kind::Immediate;
+    operand.m_value = value;
+
+    return operand;
+}
+
+Operand Operand::mem(Register base, i32 displacement, DataType size) {
+    return mem(base, { Register::None }, 1, displacement, size);
+}
+
+Operand Operand::mem(Register base, Register index, u8 scale, i32 displacement, DataType size) {
+    ASSERT(scale == 1 || scale == 2 || scale == 4 || scale == 8, "Invalid scale");
+    ASSERT(index.type != Register::rsp, "rsp can't be used as an index");
+
+    Operand operand;
+
+    operand.m_kind = Kind::Memory;
+    operand.m_size = size;
+    operand.m_base = base.type;
+    operand.m_index = index.type;
+    operand.m_scale = scale;
+    operand.m_value = displacement;
+
+    return operand;
+}
+
+Operand Operand::relative(String symbol, bool external) {
+    Operand operand;
+
+    operand.m_kind = Kind::Relative;
+    operand.m_name = move(symbol);
+    operand.m_external = external;
+
+    return operand;
+}
+
+Operand Operand::label(String name) {
+    Operand operand;
+
+    operand.m_kind = Kind::Label;
+    operand.m_name = move(name);
+
+    return operand;
+}
+
+Operand Operand::symbol(String name, bool external) {
+    Operand operand;
+
+    operand.m_kind = Kind::Symbol;
+    operand.m_name = move(name);
+    operand.m_external = external;
+
+    return operand;
+}
+
+String Operand::to_string() const {
+    switch (m_kind) {
+        case Kind::None: return {};
+        case Kind::Register:
+            return String(this->reg().as(m_size));
+        case Kind::Immediate:
+            return format("{}", m_value);
+        case Kind::Memory: {
+            String address(this->reg().as_qword());
+            if (m_index != Register::None) {
+                address += format(" + {} * {}", this->index().as_qword(), m_scale);
+            }
+
+            if (m_value < 0) {
+                address += format(" - {}", -m_value);
+            } else if (m_value > 0) {
+                address += format(" + {}", m_value);
+            }
+
+            return format("{} [{}]", m_size, address);
+        }
+        case Kind::Relative:
+            if (m_external) {
+                return format("{} [rel {} wrt ..gotpcrel]", m_size, m_name);
+            }
+
+            return format("{} [rel {}]", m_size, m_name);
+        case Kind::Label:
+            return format(".{}", m_name);
+        case Kind::Symbol:
+            if (m_external) {
+                return format("{} wrt ..plt", m_name);
+            }
+
+            return m_name;
+    }
+
+    return {};
+}
+
+Instruction::Instruction(Opcode opcode, ConditionCode cc, std::initializer_list<Operand> operands) : opcode(opcode), cc(cc) {
+    ASSERT(operands.size() <= this->operands.size(), "Too many operands");
+    for (auto& operand : operands) {
+        this->operands[count++] = operand;
+    }
+}
+
+String Instruction::to_string() const {
+    if (opcode == Opcode::Label) {
+        return format(".{}:", operands[0].name());
+    }
+
+    String line = format("  {}", x86_64::to_string(opcode));
+    if (opcode == Opcode::j || opcode == Opcode::set) {
+        line += x86_64::to_string(cc);
+    }
+
+    for (u8 i = 0; i < count; i++) {
+        line += i == 0 ? " " : ", ";
+        line += operands[i].to_string();
+    }
+
+    return line;
+}
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <quart/common.h>
+#include <quart/codegen/x86_64/cpu.h>
+#include <quart/codegen/x86_64/registers.h>
+
+namespace quart::x86_64 {
+
+enum class Opcode : u8 {
+    Label, // Not an actual instruction, marks where a basic block starts
+
+    mov,
+    movzx,
+    lea,
+    add,
+    sub,
+    cmp,
+    imul,
+    test,
+    set,
+    jmp,
+    j,
+    push,
+    pop,
+    call,
+    leave,
+    ret
+};
+
+StringView to_string(Opcode opcode);
+
+class Operand {
+public:
+    enum class Kind : u8 {
+        None,
+        Register,
+        Immediate,
+        Memory,     // [base + index * scale + displacement]
+        Relative,   // [rip + symbol], or the GOT entry of `symbol` if it's external
+        Label,      // A basic block of the current function
+        Symbol      // A function, called through its PLT entry if it's external
+    };
+
+    Operand() = default;
+    Operand(Register reg, DataType size = DataType::QWord) : m_kind(Kind::Register), m_size(size), m_base(reg.type) {}
+
+    static Operand imm(i64 value);
+
+    static Operand mem(Register base, i32 displacement, DataType size = DataType::QWord);
+    static Operand mem(Register base, Register index, u8 scale, i32 displacement, DataType size = DataType::QWord);
+
+    static Operand relative(String symbol, bool external = false);
+    static Operand label(String name);
+    static Operand symbol(String name, bool external = false);
+
+    Kind kind() const { return m_kind; }
+    DataType size() const { return m_size; }
+
+    bool is_register() const { return m_kind == Kind::Register; }
+    bool is_immediate() const { return m_kind == Kind::Immediate; }
+
+    // Whether this can be used as the r/m operand of an instruction
+    bool is_memory() const { return m_kind == Kind::Memory || m_kind == Kind::Relative; }
+
+    // The register of a register operand or the base of a memory operand
+    Register reg() const { return { m_base }; }
+    Register index() const { return { m_index }; }
+
+    u8 scale() const { return m_scale; }
+
+    i64 value() const { return m_value; }
+    String const& name() const { return m_name; }
+
+    bool is_external() const { return m_external; }
+
+    String to_string() const;
+
+private:
+    Kind m_kind = Kind::None;
+    DataType m_size = DataType::QWord;
+
+    Register::Type m_base = Register::None;
+    Register::Type m_index = Register::None;
+    u8 m_scale = 1;
+
+    // The immediate or the displacement of a memory operand
+    i64 m_value = 0;
+
+    String m_name;
+    bool m_external = false;
+};
+
+// A single machine instruction in the order codegen emits them. These are either printed as NASM or encoded into an object
+// file by the `Assembler`, keeping both outputs in sync.
+struct Instruction {
+    Opcode opcode;
+
+    // Only meaningful for `j` and `set`
+    ConditionCode cc = ConditionCode::None;
+
+    Array<Operand, 3> operands;
+    u8 count = 0;
+
+    Instruction(Opcode opcode, ConditionCode cc, std::initializer_list<Operand> operands);
+
+    Operand const& operand(size_t index) const { return operands[index]; }
+
+    String to_string() const;
+};
+
+}
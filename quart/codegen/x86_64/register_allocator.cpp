@@ -0,0 +1,418 @@
+#include <quart/codegen/x86_64/register_allocator.h>
+#include <quart/bytecode/analysis/cfg.h>
+#include <quart/bytecode/analysis/loops.h>
+#include <quart/bytecode/basic_block.h>
+#include <quart/language/functions.h>
+
+#include <llvm/ADT/BitVector.h>
+
+namespace quart::x86_64 {
+
+static const Vector<Register::Type> SYS_V_CALLEE_SAVED_REGISTERS = {
+    Register::rbx, Register::r12, Register::r13, Register::r14, Register::r15
+};
+
+// Every caller-saved register apart from the scratch ones
+static const Vector<Register::Type> SYS_V_CALLER_SAVED_REGISTERS = {
+    Register::rcx, Register::rdx, Register::rsi, Register::rdi, Register::r8, Register::r9
+};
+
+static bool is_callee_saved(Register::Type reg) {
+    return llvm::is_contained(SYS_V_CALLEE_SAVED_REGISTERS, reg);
+}
+
+static bool is_comparison(bytecode::Instruction* inst) {
+    switch (inst->type()) {
+        case bytecode::Instruction::Eq:
+        case bytecode::Instruction::Neq:
+        case bytecode::Instruction::Gt:
+        case bytecode::Instruction::Lt:
+        case bytecode::Instruction::Gte:
+        case bytecode::Instruction::Lte:
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t Allocation::caller_saved_offset(Register::Type reg) const {
+    auto iterator = std::find(SYS_V_CALLER_SAVED_REGISTERS.begin(), SYS_V_CALLER_SAVED_REGISTERS.end(), reg);
+    ASSERT(iterator != SYS_V_CALLER_SAVED_REGISTERS.end(), "Not an allocatable caller-saved register");
+
+    size_t index = std::distance(SYS_V_CALLER_SAVED_REGISTERS.begin(), iterator);
+    return (locals + spill_slots + callee_saved.size() + index + 1) * 8;
+}
+
+size_t Allocation::frame_size() const {
+    size_t slots = locals + spill_slots + callee_saved.size() + SYS_V_CALLER_SAVED_REGISTERS.size();
+    return (slots * 8 + 15) & ~size_t(15);
+}
+
+Allocation RegisterAllocator::allocate(Function* function) {
+    m_allocation = {};
+
+    m_positions.clear();
+    m_calls.clear();
+    m_intervals.clear();
+
+    m_allocation.locals = function->local_count();
+
+    this->find_special_registers(function);
+    this->number_instructions(function);
+    this->build_intervals(function);
+    this->scan();
+    this->find_live_across_calls();
+
+    return move(m_allocation);
+}
+
+bool RegisterAllocator::is_allocated(bytecode::Register reg) const {
+    return !m_allocation.direct_calls.contains(reg) && !m_allocation.fused_conditions.contains(reg);
+}
+
+void RegisterAllocator::find_special_registers(Function* function) {
+    HashMap<bytecode::Register, Function*> functions;
+
+    HashMap<bytecode::Register, u32> uses;
+    HashMap<bytecode::Register, u32> non_call_uses;
+
+    for (auto* block : function->basic_blocks()) {
+        for (auto& inst : block->instructions()) {
+            if (auto* get_function = inst->as<bytecode::GetFunction>()) {
+                functions[get_function->dst()] = get_function->function();
+            }
+
+            bool is_call = inst->is<bytecode::Call>();
+            inst->visit_operands([&](bytecode::Operand& operand) {
+                if (operand.is_register()) {
+                    uses[operand.reg()]++;
+                }
+            });
+
+            if (is_call) {
+                for (auto& argument : inst->as<bytecode::Call>()->arguments()) {
+                    if (argument.is_register()) {
+                        non_call_uses[argument.reg()]++;
+                    }
+                }
+
+                continue;
+            }
+
+            inst->visit_operands([&](bytecode::Operand& operand) {
+                if (operand.is_register()) {
+                    non_call_uses[operand.reg()]++;
+                }
+            });
+        }
+    }
+
+    for (auto& [reg, target] : functions) {
+        if (!non_call_uses.contains(reg)) {
+            m_allocation.direct_calls[reg] = target;
+        }
+    }
+
+    for (auto* block : function->basic_blocks()) {
+        auto& instructions = block->instructions();
+        for (size_t i = 0; i + 1 < instructions.size(); i++) {
+            auto* inst = instructions[i].get();
+            auto* jump = instructions[i + 1]->as<bytecode::JumpIf>();
+
+            if (!is_comparison(inst) || !jump || !jump->condition().is_register()) {
+                continue;
+            }
+
+            bytecode::Register dst = *inst->result();
+            if (jump->condition().reg() == dst && uses[dst] == 1) {
+                m_allocation.fused_conditions.insert(dst);
+            }
+        }
+    }
+}
+
+void RegisterAllocator::number_instructions(Function* function) {
+    // Positions are spaced out by two so that there's always room in between a use and a definition
+    u32 position = 0;
+    for (auto* block : function->basic_blocks()) {
+        for (auto& inst : block->instructions()) {
+            m_positions[inst.get()] = position;
+            if (inst->is<bytecode::Call>()) {
+                m_calls.emplace_back(inst.get(), position);
+            }
+
+            position += 2;
+        }
+    }
+}
+
+void RegisterAllocator::build_intervals(Function* function) {
+    auto& blocks = function->basic_blocks();
+
+    HashMap<bytecode::BasicBlock*, u32> block_indices;
+    for (auto [index, block] : llvm::enumerate(blocks)) {
+        block_indices[block] = index;
+    }
+
+    HashMap<bytecode::Register, u32> indices;
+    Vector<bytecode::Register> registers;
+
+    auto index_of = [&](bytecode::Register reg) {
+        auto iterator = indices.find(reg);
+        if (iterator != indices.end()) {
+            return iterator->second;
+        }
+
+        u32 index = registers.size();
+
+        indices[reg] = index;
+        registers.push_back(reg);
+
+        return index;
+    };
+
+    for (auto* block : blocks) {
+        for (auto& inst : block->instructions()) {
+            inst->visit_operands([&](bytecode::Operand& operand) {
+                if (operand.is_register() && this->is_allocated(operand.reg())) {
+                    index_of(operand.reg());
+                }
+            });
+
+            auto result = inst->result();
+            if (result.has_value() && this->is_allocated(*result)) {
+                index_of(*result);
+            }
+        }
+    }
+
+    size_t count = blocks.size();
+    size_t size = registers.size();
+
+    Vector<u32> starts(size, UINT32_MAX);
+    Vector<u32> ends(size, 0);
+    Vector<u64> weights(size, 0);
+
+    auto extend = [&starts, &ends](u32 index, u32 position) {
+        starts[index] = std::min(starts[index], position);
+        ends[index] = std::max(ends[index], position);
+    };
+
+    Vector<llvm::BitVector> uses(count, llvm::BitVector(size));
+    Vector<llvm::BitVector> definitions(count, llvm::BitVector(size));
+
+    auto& analysis = function->analysis();
+
+    auto& cfg = analysis.cfg();
+    auto& loops = analysis.loops();
+
+    for (auto [index, block] : llvm::enumerate(blocks)) {
+        // Reads and writes inside of loops run many more times, which makes those registers more costly to spill
+        auto cfg_index = cfg.index_of(block);
+        u64 weight = u64(1) << (3 * std::min(cfg_index.has_value() ? loops.depth(*cfg_index) : 0, 6u));
+
+        for (auto& inst : block->instructions()) {
+            u32 position = m_positions[inst.get()];
+            inst->visit_operands([&](bytecode::Operand& operand) {
+                if (!operand.is_register() || !this->is_allocated(operand.reg())) {
+                    return;
+                }
+
+                u32 reg = indices[operand.reg()];
+                if (!definitions[index].test(reg)) {
+                    uses[index].set(reg);
+                }
+
+                extend(reg, position);
+                weights[reg] += weight;
+            });
+
+            auto result = inst->result();
+            if (result.has_value() && this->is_allocated(*result)) {
+                u32 reg = indices[*result];
+
+                definitions[index].set(reg);
+                extend(reg, position);
+
+                weights[reg] += weight;
+            }
+        }
+    }
+
+    Vector<Vector<u32>> successors(count);
+    for (auto [index, block] : llvm::enumerate(blocks)) {
+        for (auto* successor : bytecode::ControlFlowGraph::successors_of(block)) {
+            auto iterator = block_indices.find(successor);
+            if (iterator != block_indices.end()) {
+                successors[index].push_back(iterator->second);
+            }
+        }
+    }
+
+    Vector<llvm::BitVector> live_in(count, llvm::BitVector(size));
+    Vector<llvm::BitVector> live_out(count, llvm::BitVector(size));
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t index = count; index-- > 0;) {
+            llvm::BitVector out(size);
+            for (u32 successor : successors[index]) {
+                out |= live_in[successor];
+            }
+
+            llvm::BitVector in = out;
+            in.reset(definitions[index]);
+            in |= uses[index];
+
+            if (in != live_in[index] || out != live_out[index]) {
+                live_in[index] = move(in);
+                live_out[index] = move(out);
+
+                changed = true;
+            }
+        }
+    }
+
+    // Intervals are a single range, so a register that's live in or out of a block covers the block's boundary too
+    for (auto [index, block] : llvm::enumerate(blocks)) {
+        auto& instructions = block->instructions();
+        if (instructions.empty()) {
+            continue;
+        }
+
+        u32 first = m_positions[instructions.front().get()];
+        u32 last = m_positions[instructions.back().get()];
+
+        for (u32 reg : live_in[index].set_bits()) {
+            extend(reg, first);
+        }
+
+        for (u32 reg : live_out[index].set_bits()) {
+            extend(reg, last);
+        }
+    }
+
+    for (auto [index, reg] : llvm::enumerate(registers)) {
+        Interval interval = { reg, starts[index], ends[index], weights[index], false };
+
+        auto iterator = std::upper_bound(m_calls.begin(), m_calls.end(), interval.start, [](u32 position, auto& call) {
+            return position < call.second;
+        });
+
+        interval.crosses_call = iterator != m_calls.end() && iterator->second < interval.end;
+        m_intervals.push_back(interval);
+    }
+
+    std::sort(m_intervals.begin(), m_intervals.end(), [](auto& a, auto& b) {
+        return a.start != b.start ? a.start < b.start : a.reg < b.reg;
+    });
+}
+
+void RegisterAllocator::scan() {
+    Array<bool, Register::r15 + 1> available = {};
+    for (auto reg : SYS_V_CALLEE_SAVED_REGISTERS) {
+        available[reg] = true;
+    }
+
+    for (auto reg : SYS_V_CALLER_SAVED_REGISTERS) {
+        available[reg] = true;
+    }
+
+    Array<bool, Register::r15 + 1> used = {};
+
+    // Sorted by increasing end
+    Vector<Interval*> active;
+    auto activate = [&active](Interval* interval) {
+        auto iterator = std::upper_bound(active.begin(), active.end(), interval, [](Interval* a, Interval* b) {
+            return a->end < b->end;
+        });
+
+        active.insert(iterator, interval);
+    };
+
+    auto spill = [this](bytecode::Register reg) {
+        m_allocation.locations[reg] = { Location::Kind::Stack, Register::None, m_allocation.spill_slots++ };
+    };
+
+    for (auto& interval : m_intervals) {
+        // An interval ending where this one starts is an operand of the instruction defining it, keeping the two apart
+        // lets codegen write a result before it's done reading the operands
+        while (!active.empty() && active.front()->end < interval.start) {
+            available[m_allocation.locations[active.front()->reg].reg] = true;
+            active.erase(active.begin());
+        }
+
+        // Values that survive a call are better off in a register the callee has to preserve for us
+        auto& preferred = interval.crosses_call ? SYS_V_CALLEE_SAVED_REGISTERS : SYS_V_CALLER_SAVED_REGISTERS;
+        auto& fallback = interval.crosses_call ? SYS_V_CALLER_SAVED_REGISTERS : SYS_V_CALLEE_SAVED_REGISTERS;
+
+        Register::Type reg = Register::None;
+        for (auto* registers : { &preferred, &fallback }) {
+            auto iterator = std::find_if(registers->begin(), registers->end(), [&available](auto reg) {
+                return available[reg];
+            });
+
+            if (iterator != registers->end()) {
+                reg = *iterator;
+                break;
+            }
+        }
+
+        if (reg != Register::None) {
+            available[reg] = false;
+            used[reg] = true;
+
+            m_allocation.locations[interval.reg] = { Location::Kind::Register, reg, 0 };
+            activate(&interval);
+
+            continue;
+        }
+
+        // The cheapest interval to spill is the one read and written the least, or the one that's live the longest
+        auto is_cheaper = [](Interval const* a, Interval const* b) {
+            return a->weight != b->weight ? a->weight < b->weight : a->end > b->end;
+        };
+
+        auto victim = std::min_element(active.begin(), active.end(), is_cheaper);
+        if (!is_cheaper(*victim, &interval)) {
+            spill(interval.reg);
+            continue;
+        }
+
+        m_allocation.locations[interval.reg] = m_allocation.locations[(*victim)->reg];
+        spill((*victim)->reg);
+
+        active.erase(victim);
+        activate(&interval);
+    }
+
+    for (auto reg : SYS_V_CALLEE_SAVED_REGISTERS) {
+        if (used[reg]) {
+            m_allocation.callee_saved.push_back(reg);
+        }
+    }
+}
+
+void RegisterAllocator::find_live_across_calls() {
+    for (auto& interval : m_intervals) {
+        auto& location = m_allocation.locations[interval.reg];
+        if (!interval.crosses_call || location.is_stack() || is_callee_saved(location.reg)) {
+            continue;
+        }
+
+        auto iterator = std::upper_bound(m_calls.begin(), m_calls.end(), interval.start, [](u32 position, auto& call) {
+            return position < call.second;
+        });
+
+        for (; iterator != m_calls.end() && iterator->second < interval.end; ++iterator) {
+            m_allocation.live_across_calls[iterator->first].push_back(location.reg);
+        }
+    }
+
+    for (auto& [_, registers] : m_allocation.live_across_calls) {
+        std::sort(registers.begin(), registers.end());
+    }
+}
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <quart/common.h>
+#include <quart/bytecode/instruction.h>
+
+#include <quart/codegen/x86_64/registers.h>
+
+namespace quart {
+    class Function;
+}
+
+namespace quart::x86_64 {
+
+// Where a bytecode register lives for the whole function
+struct Location {
+    enum class Kind : u8 {
+        Register,
+        Stack
+    };
+
+    Kind kind = Kind::Register;
+
+    Register::Type reg = Register::None;
+    u32 slot = 0;
+
+    bool is_register() const { return kind == Kind::Register; }
+    bool is_stack() const { return kind == Kind::Stack; }
+};
+
+// The result of allocating registers for a single function, along with the layout of its stack frame:
+//
+//   [rbp - 8 * (1..locals)]       locals
+//   [rbp - ...]                   spill slots
+//   [rbp - ...]                   callee-saved registers used by the function
+//   [rbp - ...]                   caller-saved registers that are live across a call
+struct Allocation {
+    HashMap<bytecode::Register, Location> locations;
+
+    // Callee-saved registers that have to be preserved by the prologue and epilogue
+    Vector<Register::Type> callee_saved;
+
+    // Caller-saved registers holding values that are still needed after each call
+    HashMap<bytecode::Instruction*, Vector<Register::Type>> live_across_calls;
+
+    // Registers that come from a `GetFunction` and are only ever called, these become direct calls and need no location
+    HashMap<bytecode::Register, Function*> direct_calls;
+
+    // Comparisons that are only read by the `JumpIf` right after them, which can branch on the flags directly
+    Set<bytecode::Register> fused_conditions;
+
+    size_t locals = 0;
+    u32 spill_slots = 0;
+
+    size_t spill_offset(u32 slot) const { return (locals + slot + 1) * 8; }
+    size_t callee_saved_offset(size_t index) const { return (locals + spill_slots + index + 1) * 8; }
+    size_t caller_saved_offset(Register::Type) const;
+
+    // Rounded up so that `rsp` stays 16-byte aligned at call sites
+    size_t frame_size() const;
+};
+
+// Linear-scan register allocation (Poletto & Sarkar). Every bytecode register gets a single live interval spanning from
+// its first to its last position in block order, computed through liveness analysis over the function's blocks.
+// Intervals are visited by increasing start, when no register is free the one least used within loops is spilled to the
+// stack.
+// Intervals that are live across a call prefer callee-saved registers, the others prefer caller-saved ones.
+//
+// `rax`, `r10` and `r11` are never handed out, codegen uses them as scratch registers to load spilled values and
+// immediates into.
+class RegisterAllocator {
+public:
+    Allocation allocate(Function*);
+
+private:
+    struct Interval {
+        bytecode::Register reg;
+
+        u32 start = 0;
+        u32 end = 0;
+
+        // Every read and write, weighted by the loop depth of where it happens
+        u64 weight = 0;
+
+        bool crosses_call = false;
+    };
+
+    void find_special_registers(Function*);
+    void number_instructions(Function*);
+    void build_intervals(Function*);
+    void scan();
+    void find_live_across_calls();
+
+    bool is_allocated(bytecode::Register) const;
+
+    Allocation m_allocation;
+
+    HashMap<bytecode::Instruction*, u32> m_positions;
+    Vector<std::pair<bytecode::Instruction*, u32>> m_calls;
+
+    Vector<Interval> m_intervals;
+};
+
+}
@@ -1,4 +1,5 @@
 #include <quart/codegen/x86_64/registers.h>
+#include <quart/assert.h>
 
 namespace quart::x86_64 {
 
@@ -18,6 +19,8 @@ StringView Register::as_qword() const {
         case r13: return "r13";
         case r14: return "r14";
         case r15: return "r15";
+        case rsp: return "rsp";
+        case rbp: return "rbp";
         default:
             return "???";
     }
@@ -39,6 +42,8 @@ StringView Register::as_dword() const {
         case r13: return "r13d";
         case r14: return "r14d";
         case r15: return "r15d";
+        case rsp: return "esp";
+        case rbp: return "ebp";
         default:
             return "???";
     }
@@ -60,6 +65,8 @@ StringView Register::as_word() const {
         case r13: return "r13w";
         case r14: return "r14w";
         case r15: return "r15w";
+        case rsp: return "sp";
+        case rbp: return "bp";
         default:
             return "???";
     }
@@ -81,6 +88,8 @@ StringView Register::as_byte() const {
         case r13: return "r13b";
         case r14: return "r14b";
         case r15: return "r15b";
+        case rsp: return "spl";
+        case rbp: return "bpl";
         default:
             return "???";
     }
@@ -97,4 +106,28 @@ StringView Register::as(DataType data_type) const {
     return "???";
 }
 
+u8 Register::encoding() const {
+    switch (type) {
+        case rax: return 0;
+        case rcx: return 1;
+        case rdx: return 2;
+        case rbx: return 3;
+        case rsp: return 4;
+        case rbp: return 5;
+        case rsi: return 6;
+        case rdi: return 7;
+        case r8:  return 8;
+        case r9:  return 9;
+        case r10: return 10;
+        case r11: return 11;
+        case r12: return 12;
+        case r13: return 13;
+        case r14: return 14;
+        case r15: return 15;
+        default:
+            ASSERT(false, "Invalid register");
+            return 0;
+    }
+}
+
 }
\ No newline at end of file
@@ -21,7 +21,9 @@ struct Register {
         r12,
         r13,
         r14,
-        r15
+        r15,
+        rsp,
+        rbp
     };
 
     Type type;
@@ -32,6 +34,9 @@ struct Register {
     StringView as_dword() const;
     StringView as_word()  const;
     StringView as_byte()  const;
+
+    // The number of the register used in ModR/M, SIB and REX bytes
+    u8 encoding() const;
 };
 
 }
\ No newline at end of file
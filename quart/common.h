@@ -10,6 +10,8 @@
 #include <deque>
 #include <set>
 
+#include <quart/hash_map.h>
+
 #ifndef QUART_PATH
     #define QUART_PATH "lib"
 #endif
@@ -76,8 +78,6 @@ using of_type = std::conjunction<std::is_same<Args, T>...>;
 template<typename T, typename ...Args>
 inline constexpr bool of_type_v = of_type<T, Args...>::value;
 
-template<typename K, typename V> using HashMap = std::map<K, V>;
-
 template<typename T> using Vector = std::vector<T>;
 template<typename T> using Deque = std::deque<T>;
 
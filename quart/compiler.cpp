@@ -2,12 +2,15 @@
 #include <quart/lexer/lexer.h>
 #include <quart/parser/parser.h>
 #include <quart/language/state.h>
+#include <quart/module_loader.h>
 #include <quart/language/symbol.h>
 #include <quart/codegen/codegen.h>
 #include <quart/codegen/llvm/codegen.h>
 #include <quart/target.h>
+#include <quart/bytecode/interpreter.h>
 
 #include <quart/bytecode/passes/eliminate_unreachable_blocks.h>
+#include <quart/bytecode/passes/inliner.h>
 
 #include <llvm/Passes/PassBuilder.h>
 #include <llvm/Support/Program.h>
@@ -91,8 +94,7 @@ void Compiler::dump() const {
     return;
 }
 
-Vector<String> Compiler::get_linker_arguments() const {
-    String object = m_options.file.with_extension("o");
+Vector<String> Compiler::get_linker_arguments(Vector<String> const& objects) const {
     Vector<String> args = {
         m_options.linker,
         "-o", m_options.output,
@@ -110,7 +112,10 @@ Vector<String> Compiler::get_linker_arguments() const {
         }
     }
 
-    args.push_back(object);
+    for (auto& object : objects) {
+        args.push_back(object);
+    }
+
     for (auto& file : m_options.object_files) {
         args.push_back(file);
     }
@@ -131,7 +136,23 @@ Vector<String> Compiler::get_linker_arguments() const {
 }
 
 void Compiler::run_bytecode_passes(State& state) const {
-    auto passes = bytecode::PassManager::create_default();
+    // The inliner changes every function at once, so they're all dumped before it runs
+    if (m_options.dump_bytecode) {
+        for (auto& [_, function] : state.functions()) {
+            if (function->is_decl()) {
+                continue;
+            }
+
+            outln("; before passes");
+            function->dump();
+            outln();
+        }
+    }
+
+    bytecode::Inliner inliner(state);
+    inliner.run(state.functions());
+
+    auto passes = bytecode::PassManager::create_default(state);
     for (auto& [_, function] : state.functions()) {
         if (function->is_decl()) {
             continue;
@@ -139,32 +160,67 @@ void Compiler::run_bytecode_passes(State& state) const {
 
         passes.run(function.get());
 
-        if constexpr (DEBUG) {
+        if (DEBUG || m_options.dump_bytecode) {
+            outln("; after passes");
             function->dump();
             outln();
         }
     }
 }
 
-int Compiler::compile() const {
-    String target = m_options.has_target() ? Target::normalize(m_options.target) : ::llvm::sys::getDefaultTargetTriple();
-    Target::set_build_target(target);
+int Compiler::generate_bytecode(State& state) const {
+    auto& loader = state.module_loader();
 
-    auto source_code = SourceCode::from_path(m_options.file);
+    if (!m_options.cache_dir.empty()) {
+        loader.set_cache(ModuleCache::create(m_options.cache_dir));
+    }
 
-    Lexer lexer(source_code);
-    Vector<Token> tokens = TRY(lexer.lex());
+    if (m_options.lazy_function_bodies) {
+        state.set_lazy_function_bodies(true);
+        loader.set_lazy_function_bodies(true);
+    }
 
-    Parser parser(move(tokens));
-    ExprList<> ast = TRY(parser.parse());
+    ParsedModule parsed = TRY(loader.parse(m_options.file));
 
-    State state;
-    for (auto& expr : ast) {
+    // Parse every module the program imports on the side while the main module is being generated
+    loader.prefetch(parsed.ast);
+
+    for (auto& expr : parsed.ast) {
         TRY(expr->generate(state));
     }
 
+    TRY(state.generate_deferred_functions());
+    return 0;
+}
+
+int Compiler::compile() const {
+    // Code compiled by the JIT runs inside this process so it always targets the host
+    bool host = !m_options.has_target() || m_options.jit;
+
+    String target = host ? ::llvm::sys::getDefaultTargetTriple() : Target::normalize(m_options.target);
+    Target::set_build_target(target);
+
+    State state;
+    if (int code = this->generate_bytecode(state)) {
+        return code;
+    }
+
     this->run_bytecode_passes(state);
 
+    if (m_options.jit) {
+        llvm::LLVMCodeGen codegen(state, m_options.file.filename());
+        auto result = codegen.run(m_options);
+
+        if (result.is_err()) {
+            auto& err = result.error();
+            errln("\x1b[1;37mquart: \x1b[1;31merror: \x1b[0m{}", err.message());
+
+            return 1;
+        }
+
+        return result.value();
+    }
+
 #if 0
     llvm::LLVMCodeGen codegen(state, m_options.file.filename());
     auto result = codegen.generate(m_options);
@@ -176,7 +232,7 @@ int Compiler::compile() const {
         return 1;
     }
 
-    Vector<String> arguments = this->get_linker_arguments();
+    Vector<String> arguments = this->get_linker_arguments(codegen.objects());
     String command = ::llvm::join(arguments, " ");
 
     int retcode = std::system(command.c_str());
@@ -191,7 +247,47 @@ int Compiler::compile() const {
         return 1;
     }
 
+    if (m_options.format != OutputFormat::Executable && m_options.format != OutputFormat::SharedLibrary) {
+        return 0;
+    }
+
+    Vector<String> arguments = this->get_linker_arguments(codegen->objects());
+    String command = ::llvm::join(arguments, " ");
+
+    return std::system(command.c_str());
 #endif
+}
+
+int Compiler::run() const {
+    // The interpreter shares memory with native code it calls into, so it can only ever run for the host
+    Target::set_build_target(::llvm::sys::getDefaultTargetTriple());
+
+    State state;
+    if (int code = this->generate_bytecode(state)) {
+        return code;
+    }
+
+    auto iterator = state.functions().find(Identifier(m_options.entry));
+    if (iterator == state.functions().end()) {
+        errln("\x1b[1;37mquart: \x1b[1;31merror: \x1b[0mEntry point '{}' is not defined", m_options.entry);
+        return 1;
+    }
+
+    Function* entry = iterator->second.get();
+    if (!entry->parameters().empty()) {
+        errln("\x1b[1;37mquart: \x1b[1;31merror: \x1b[0mEntry point '{}' can't take any arguments when running in the interpreter", m_options.entry);
+        return 1;
+    }
+
+    bytecode::Interpreter interpreter(state, bytecode::ExecutionMode::Program);
+    for (auto& name : m_options.library_names) {
+        TRY(interpreter.load_library(name, m_options.library_paths));
+    }
+
+    Constant* result = TRY(interpreter.call(entry->span(), entry, {}));
+    if (result && isa<ConstantInt>(result)) {
+        return static_cast<int>(cast_unchecked<ConstantInt>(result)->value());
+    }
 
     return 0;
 }
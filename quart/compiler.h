@@ -81,12 +81,27 @@ struct CompilerOptions {
 
     String linker = "cc";
 
+    // Where parsed modules get cached, caching is disabled if empty
+    String cache_dir;
+
     OutputFormat format = OutputFormat::Executable;
     OptimizationOptions opts;
 
     bool verbose = false;
     bool no_libc = false;
 
+    // Compile the program in memory with the LLVM backend and run it instead of writing any output
+    bool jit = false;
+
+    // Only parse and generate the bodies of functions that are referenced somewhere
+    bool lazy_function_bodies = false;
+
+    // Print every function's bytecode before and after the bytecode passes run
+    bool dump_bytecode = false;
+
+    // Threads used for code generation, zero uses one per hardware thread. The output is the same for any count.
+    size_t threads = 0;
+
     Vector<String> object_files;
     Vector<Extra> extras;
 
@@ -184,13 +199,19 @@ public:
         m_options.extras.emplace_back(name, "");
     }
 
-    Vector<String> get_linker_arguments() const;
+    Vector<String> get_linker_arguments(Vector<String> const& objects) const;
 
     void dump() const;
 
     int compile() const;
 
+    // Runs the program in the bytecode interpreter instead of building it, returns the exit code of the entry point
+    int run() const;
+
 private:
+    // Parses the input file and generates bytecode for it and everything it imports, returns non-zero on failure
+    int generate_bytecode(State&) const;
+
     void run_bytecode_passes(State&) const;
 
     CompilerOptions m_options;
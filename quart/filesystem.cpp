@@ -340,6 +340,60 @@ Path Path::with_extension() const {
     return remove_extension(m_name);
 }
 
+OwnPtr<MappedFile> MappedFile::create(const Path& path) {
+#if _WIN32 || _WIN64
+    return nullptr;
+#else
+    String name = path;
+
+    int fd = ::open(name.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat buffer = {};
+    if (::fstat(fd, &buffer) < 0 || !S_ISREG(buffer.st_mode)) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    size_t size = buffer.st_size;
+    size_t page_size = ::sysconf(_SC_PAGESIZE);
+
+    // Reserve enough zeroed pages to hold the file plus at least one trailing NUL byte and then map the file over
+    // the start of that region. Mapping the file on its own would fault on reads past its end whenever
+    // its size happens to be a multiple of the page size.
+    size_t length = (size / page_size + 1) * page_size;
+
+    void* base = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    if (size > 0) {
+        void* mapping = ::mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::munmap(base, length);
+            ::close(fd);
+
+            return nullptr;
+        }
+
+        ::madvise(base, size, MADV_SEQUENTIAL);
+    }
+
+    ::close(fd);
+    return OwnPtr<MappedFile>(new MappedFile(base, size, length));
+#endif
+}
+
+MappedFile::~MappedFile() {
+#if !(_WIN32 || _WIN64)
+    ::munmap(m_base, m_length);
+#endif
+}
+
 bool exists(const String& path) {
     struct stat buffer = {};
     return ::stat(path.c_str(), &buffer) == 0;
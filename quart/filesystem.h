@@ -23,6 +23,8 @@
 #else
     #include <unistd.h>
     #include <dirent.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
 #endif
 
 #ifndef S_ISREG 
@@ -99,6 +101,31 @@ private:
     String m_name;
 };
 
+// A read-only view of a regular file's contents, backed by a private memory mapping.
+// The contents are always followed by at least one NUL byte, so the mapping can be consumed
+// the same way as a null-terminated string.
+class MappedFile {
+public:
+    NO_COPY(MappedFile)
+    NO_MOVE(MappedFile)
+
+    ~MappedFile();
+
+    // Returns nullptr if the file can't be mapped (e.g. pipes, character devices or unsupported platforms).
+    static OwnPtr<MappedFile> create(const Path& path);
+
+    StringView data() const { return { static_cast<char const*>(m_base), m_size }; }
+    size_t size() const { return m_size; }
+
+private:
+    MappedFile(void* base, size_t size, size_t length) : m_base(base), m_size(size), m_length(length) {}
+
+    void* m_base;
+
+    size_t m_size;   // Size of the file
+    size_t m_length; // Size of the whole mapping
+};
+
 bool exists(const String& path);
 bool isdir(const String& path);
 
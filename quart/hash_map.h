@@ -0,0 +1,677 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#endif
+
+// Included by `common.h`, so this only relies on the standard library.
+
+namespace quart {
+
+namespace detail {
+
+constexpr uint64_t HASH_SEED = 0x9e3779b97f4a7c15;
+constexpr uint64_t HASH_MULTIPLIER = 0xbf58476d1ce4e5b9;
+
+// Multiplies both halves into a 128-bit product and folds it back down, every input bit ends up affecting every output bit
+inline uint64_t fold_multiply(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t low = a * b;
+    uint64_t high = (a >> 32) * (b >> 32) + (((a & 0xffffffff) * (b >> 32) + (a >> 32) * (b & 0xffffffff)) >> 32);
+
+    return low ^ high;
+#endif
+}
+
+inline uint64_t read_u64(unsigned char const* data) {
+    uint64_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+
+    return value;
+}
+
+inline uint64_t read_u32(unsigned char const* data) {
+    uint32_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+
+    return value;
+}
+
+}
+
+inline uint64_t hash_integer(uint64_t value) {
+    return detail::fold_multiply(value ^ detail::HASH_SEED, detail::HASH_MULTIPLIER);
+}
+
+inline uint64_t hash_combine(uint64_t seed, uint64_t value) {
+    return detail::fold_multiply(seed ^ value, detail::HASH_MULTIPLIER);
+}
+
+inline uint64_t hash_bytes(void const* bytes, size_t size) {
+    auto* data = static_cast<unsigned char const*>(bytes);
+    uint64_t seed = detail::HASH_SEED ^ size;
+
+    size_t remaining = size;
+    while (remaining > 16) {
+        seed = detail::fold_multiply(detail::read_u64(data) ^ detail::HASH_MULTIPLIER, detail::read_u64(data + 8) ^ seed);
+
+        data += 16;
+        remaining -= 16;
+    }
+
+    // The last (up to) 16 bytes are read as two possibly overlapping words
+    uint64_t a = 0, b = 0;
+    if (remaining >= 8) {
+        a = detail::read_u64(data);
+        b = detail::read_u64(data + remaining - 8);
+    } else if (remaining >= 4) {
+        a = detail::read_u32(data);
+        b = detail::read_u32(data + remaining - 4);
+    } else if (remaining > 0) {
+        a = (static_cast<uint64_t>(data[0]) << 16) | (static_cast<uint64_t>(data[remaining / 2]) << 8) | data[remaining - 1];
+    }
+
+    return detail::fold_multiply(detail::fold_multiply(a ^ detail::HASH_MULTIPLIER, b ^ seed), size ^ detail::HASH_SEED);
+}
+
+// The hash `HashMap` uses by default. Types other than the ones specialized below can provide a `u64 hash() const` member.
+template<typename T>
+struct Hash;
+
+template<typename T> requires(std::is_integral_v<T> || std::is_enum_v<T>)
+struct Hash<T> {
+    uint64_t operator()(T value) const { return hash_integer(static_cast<uint64_t>(value)); }
+};
+
+template<typename T> requires(std::is_floating_point_v<T>)
+struct Hash<T> {
+    uint64_t operator()(T value) const {
+        // 0.0 and -0.0 compare equal so they have to hash the same as well
+        if (value == 0) {
+            return hash_integer(0);
+        }
+
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(value));
+
+        return hash_integer(bits);
+    }
+};
+
+template<typename T>
+struct Hash<T*> {
+    uint64_t operator()(T const* value) const { return hash_integer(reinterpret_cast<uintptr_t>(value)); }
+};
+
+template<>
+struct Hash<std::string_view> {
+    uint64_t operator()(std::string_view value) const { return hash_bytes(value.data(), value.size()); }
+};
+
+template<>
+struct Hash<std::string> {
+    uint64_t operator()(std::string const& value) const { return hash_bytes(value.data(), value.size()); }
+};
+
+template<typename F, typename S>
+struct Hash<std::pair<F, S>> {
+    uint64_t operator()(std::pair<F, S> const& value) const {
+        return hash_combine(Hash<F>()(value.first), Hash<S>()(value.second));
+    }
+};
+
+template<typename T>
+struct Hash<std::vector<T>> {
+    uint64_t operator()(std::vector<T> const& values) const {
+        uint64_t hash = hash_integer(values.size());
+        for (auto& value : values) {
+            hash = hash_combine(hash, Hash<T>()(value));
+        }
+
+        return hash;
+    }
+};
+
+template<typename T> requires requires(T const& value) { { value.hash() } -> std::convertible_to<uint64_t>; }
+struct Hash<T> {
+    uint64_t operator()(T const& value) const { return value.hash(); }
+};
+
+// An open addressing hash map in the style of Swiss tables. The table itself only holds a control byte per slot
+// (empty, deleted or 7 bits of the hash) and an index into a list of entries, lookups compare a whole group of control
+// bytes at once and only touch entries whose bits match.
+//
+// Unlike most hash maps this one behaves like `std::map` in the ways the compiler relies on:
+//  - Entries are never moved once inserted, references to keys and values stay valid until the entry is erased.
+//  - Iteration visits entries in insertion order, so output that's produced by iterating a map is deterministic
+//    and doesn't depend on hashes or addresses.
+template<typename K, typename V, typename H = Hash<K>, typename E = std::equal_to<K>>
+class HashMap {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K const, V>;
+
+    using size_type = size_t;
+
+    template<bool IsConst>
+    class Iterator {
+    public:
+        using Map = std::conditional_t<IsConst, HashMap const, HashMap>;
+        using Value = std::conditional_t<IsConst, typename HashMap::value_type const, typename HashMap::value_type>;
+
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = Value;
+        using pointer = Value*;
+        using reference = Value&;
+
+        Iterator() = default;
+        Iterator(Map* map, size_t index) : m_map(map), m_index(index) {
+            this->skip_erased();
+        }
+
+        template<bool C = IsConst> requires(C)
+        Iterator(Iterator<false> const& other) : m_map(other.map()), m_index(other.index()) {}
+
+        Value& operator*() const { return *m_map->m_entries[m_index]; }
+        Value* operator->() const { return m_map->m_entries[m_index]; }
+
+        Iterator& operator++() {
+            m_index++;
+            this->skip_erased();
+
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator copy = *this;
+            ++(*this);
+
+            return copy;
+        }
+
+        template<bool C>
+        bool operator==(Iterator<C> const& other) const { return m_index == other.index(); }
+
+        Map* map() const { return m_map; }
+        size_t index() const { return m_index; }
+
+    private:
+        void skip_erased() {
+            while (m_index < m_map->m_entries.size() && !m_map->m_entries[m_index]) {
+                m_index++;
+            }
+        }
+
+        Map* m_map = nullptr;
+        size_t m_index = 0;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    HashMap() = default;
+
+    HashMap(std::initializer_list<value_type> values) {
+        this->reserve(values.size());
+        for (auto& value : values) {
+            this->insert(value);
+        }
+    }
+
+    template<typename It>
+    HashMap(It begin, It end) {
+        for (; begin != end; ++begin) {
+            this->insert(*begin);
+        }
+    }
+
+    HashMap(HashMap const& other) {
+        this->reserve(other.size());
+        for (auto& value : other) {
+            this->insert(value);
+        }
+    }
+
+    HashMap(HashMap&& other) noexcept { this->swap(other); }
+
+    HashMap& operator=(HashMap const& other) {
+        if (this != &other) {
+            HashMap copy(other);
+            this->swap(copy);
+        }
+
+        return *this;
+    }
+
+    HashMap& operator=(HashMap&& other) noexcept {
+        if (this != &other) {
+            HashMap moved(std::move(other));
+            this->swap(moved);
+        }
+
+        return *this;
+    }
+
+    ~HashMap() { this->destroy_entries(); }
+
+    void swap(HashMap& other) noexcept {
+        std::swap(m_control, other.m_control);
+        std::swap(m_slots, other.m_slots);
+        std::swap(m_capacity, other.m_capacity);
+        std::swap(m_size, other.m_size);
+        std::swap(m_tombstones, other.m_tombstones);
+        std::swap(m_entries, other.m_entries);
+        std::swap(m_chunks, other.m_chunks);
+        std::swap(m_chunk_used, other.m_chunk_used);
+        std::swap(m_chunk_capacity, other.m_chunk_capacity);
+        std::swap(m_free, other.m_free);
+    }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    iterator begin() { return { this, 0 }; }
+    iterator end() { return { this, m_entries.size() }; }
+
+    const_iterator begin() const { return { this, 0 }; }
+    const_iterator end() const { return { this, m_entries.size() }; }
+
+    const_iterator cbegin() const { return this->begin(); }
+    const_iterator cend() const { return this->end(); }
+
+    void clear() {
+        HashMap empty;
+        this->swap(empty);
+    }
+
+    void reserve(size_t count) {
+        size_t capacity = capacity_for(count);
+        if (capacity > m_capacity) {
+            this->rehash(capacity);
+        }
+    }
+
+    iterator find(K const& key) {
+        size_t slot = this->find_slot(key);
+        return slot == NOT_FOUND ? this->end() : iterator(this, m_slots[slot]);
+    }
+
+    const_iterator find(K const& key) const {
+        size_t slot = this->find_slot(key);
+        return slot == NOT_FOUND ? this->end() : const_iterator(this, m_slots[slot]);
+    }
+
+    bool contains(K const& key) const { return this->find_slot(key) != NOT_FOUND; }
+    size_t count(K const& key) const { return this->contains(key) ? 1 : 0; }
+
+    // Like with `std::map`, looking up a key that isn't in the map is a fatal error
+    V& at(K const& key) {
+        size_t slot = this->find_slot(key);
+        if (slot == NOT_FOUND) {
+            std::abort();
+        }
+
+        return m_entries[m_slots[slot]]->second;
+    }
+
+    V const& at(K const& key) const {
+        return const_cast<HashMap*>(this)->at(key);
+    }
+
+    V& operator[](K const& key) { return this->try_emplace(key).first->second; }
+    V& operator[](K&& key) { return this->try_emplace(std::move(key)).first->second; }
+
+    std::pair<iterator, bool> insert(value_type const& value) { return this->try_emplace(value.first, value.second); }
+    std::pair<iterator, bool> insert(value_type&& value) { return this->try_emplace(value.first, std::move(value.second)); }
+
+    template<typename It>
+    void insert(It begin, It end) {
+        for (; begin != end; ++begin) {
+            this->insert(*begin);
+        }
+    }
+
+    template<typename Key, typename M>
+    std::pair<iterator, bool> insert_or_assign(Key&& key, M&& value) {
+        auto result = this->try_emplace(std::forward<Key>(key), std::forward<M>(value));
+        if (!result.second) {
+            result.first->second = std::forward<M>(value);
+        }
+
+        return result;
+    }
+
+    template<typename Key, typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+        uint64_t hash = H()(key);
+
+        auto [slot, found] = this->find_or_prepare_insert(key, hash);
+        if (found) {
+            return { iterator(this, m_slots[slot]), false };
+        }
+
+        value_type* entry = this->allocate_entry();
+        new (entry) value_type(
+            std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...)
+        );
+
+        return { this->insert_at(slot, hash, entry), true };
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        value_type* entry = this->allocate_entry();
+        new (entry) value_type(std::forward<Args>(args)...);
+
+        uint64_t hash = H()(entry->first);
+
+        auto [slot, found] = this->find_or_prepare_insert(entry->first, hash);
+        if (found) {
+            this->free_entry(entry);
+            return { iterator(this, m_slots[slot]), false };
+        }
+
+        return { this->insert_at(slot, hash, entry), true };
+    }
+
+    size_t erase(K const& key) {
+        size_t slot = this->find_slot(key);
+        if (slot == NOT_FOUND) {
+            return 0;
+        }
+
+        this->erase_slot(slot);
+        return 1;
+    }
+
+    iterator erase(const_iterator position) {
+        size_t index = position.index();
+        this->erase_slot(this->find_slot(m_entries[index]->first));
+
+        return iterator(this, index + 1);
+    }
+
+private:
+    static constexpr size_t GROUP_WIDTH = 16;
+    static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+    static constexpr uint8_t EMPTY = 0x80;
+    static constexpr uint8_t DELETED = 0xFE;
+
+    // A bitmask with one bit per slot of a group of `GROUP_WIDTH` control bytes
+    class Group {
+    public:
+        explicit Group(uint8_t const* control) {
+#if defined(__SSE2__) || defined(_M_X64)
+            m_control = _mm_loadu_si128(reinterpret_cast<__m128i const*>(control));
+#else
+            std::memcpy(m_control, control, GROUP_WIDTH);
+#endif
+        }
+
+        uint32_t match(uint8_t byte) const {
+#if defined(__SSE2__) || defined(_M_X64)
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(m_control, _mm_set1_epi8(static_cast<char>(byte)))));
+#else
+            uint32_t mask = 0;
+            for (size_t i = 0; i < GROUP_WIDTH; i++) {
+                mask |= static_cast<uint32_t>(m_control[i] == byte) << i;
+            }
+
+            return mask;
+#endif
+        }
+
+        uint32_t match_empty() const { return this->match(EMPTY); }
+
+        // Both empty and deleted slots have their top bit set while full ones don't
+        uint32_t match_empty_or_deleted() const {
+#if defined(__SSE2__) || defined(_M_X64)
+            return static_cast<uint32_t>(_mm_movemask_epi8(m_control));
+#else
+            uint32_t mask = 0;
+            for (size_t i = 0; i < GROUP_WIDTH; i++) {
+                mask |= static_cast<uint32_t>(m_control[i] >> 7) << i;
+            }
+
+            return mask;
+#endif
+        }
+
+    private:
+#if defined(__SSE2__) || defined(_M_X64)
+        __m128i m_control;
+#else
+        uint8_t m_control[GROUP_WIDTH];
+#endif
+    };
+
+    static uint8_t h2(uint64_t hash) { return static_cast<uint8_t>(hash & 0x7F); }
+
+    static size_t lowest_bit(uint32_t mask) { return static_cast<size_t>(std::countr_zero(mask)); }
+
+    // The table is kept at most 7/8 full so probing always runs into an empty slot eventually
+    static size_t max_load(size_t capacity) { return capacity - capacity / 8; }
+
+    static size_t capacity_for(size_t count) {
+        size_t capacity = GROUP_WIDTH;
+        while (max_load(capacity) < count) {
+            capacity *= 2;
+        }
+
+        return capacity;
+    }
+
+    size_t group_mask() const { return m_capacity / GROUP_WIDTH - 1; }
+
+    // Groups are probed triangularly (+1, +2, +3, ...), which visits every group once the group count is a power of two
+    size_t find_slot(K const& key) const {
+        if (!m_size) {
+            return NOT_FOUND;
+        }
+
+        uint64_t hash = H()(key);
+        size_t group = (hash >> 7) & this->group_mask();
+
+        for (size_t step = 1; ; step++) {
+            size_t base = group * GROUP_WIDTH;
+            Group control(m_control.get() + base);
+
+            for (uint32_t mask = control.match(h2(hash)); mask; mask &= mask - 1) {
+                size_t slot = base + lowest_bit(mask);
+                if (E()(m_entries[m_slots[slot]]->first, key)) {
+                    return slot;
+                }
+            }
+
+            if (control.match_empty()) {
+                return NOT_FOUND;
+            }
+
+            group = (group + step) & this->group_mask();
+        }
+    }
+
+    // Returns the slot holding `key` and true, or the slot `key` should be inserted at and false
+    std::pair<size_t, bool> find_or_prepare_insert(K const& key, uint64_t hash) {
+        if (!m_capacity) {
+            this->rehash(GROUP_WIDTH);
+        }
+
+        size_t group = (hash >> 7) & this->group_mask();
+        size_t target = NOT_FOUND;
+
+        for (size_t step = 1; ; step++) {
+            size_t base = group * GROUP_WIDTH;
+            Group control(m_control.get() + base);
+
+            for (uint32_t mask = control.match(h2(hash)); mask; mask &= mask - 1) {
+                size_t slot = base + lowest_bit(mask);
+                if (E()(m_entries[m_slots[slot]]->first, key)) {
+                    return { slot, true };
+                }
+            }
+
+            if (target == NOT_FOUND) {
+                uint32_t mask = control.match_empty_or_deleted();
+                if (mask) {
+                    target = base + lowest_bit(mask);
+                }
+            }
+
+            if (control.match_empty()) {
+                break;
+            }
+
+            group = (group + step) & this->group_mask();
+        }
+
+        if (m_size + m_tombstones + 1 <= max_load(m_capacity) || m_control[target] == DELETED) {
+            return { target, false };
+        }
+
+        // Growing only makes sense if the map is actually full, otherwise clearing out the tombstones is enough
+        this->rehash(m_size + 1 > max_load(m_capacity) / 2 ? m_capacity * 2 : m_capacity);
+        return { this->find_empty_slot(hash), false };
+    }
+
+    size_t find_empty_slot(uint64_t hash) const {
+        size_t group = (hash >> 7) & this->group_mask();
+        for (size_t step = 1; ; step++) {
+            size_t base = group * GROUP_WIDTH;
+
+            uint32_t mask = Group(m_control.get() + base).match_empty_or_deleted();
+            if (mask) {
+                return base + lowest_bit(mask);
+            }
+
+            group = (group + step) & this->group_mask();
+        }
+    }
+
+    iterator insert_at(size_t slot, uint64_t hash, value_type* entry) {
+        if (m_control[slot] == DELETED) {
+            m_tombstones--;
+        }
+
+        size_t index = m_entries.size();
+        m_entries.push_back(entry);
+
+        m_control[slot] = h2(hash);
+        m_slots[slot] = static_cast<uint32_t>(index);
+
+        m_size++;
+        return iterator(this, index);
+    }
+
+    void erase_slot(size_t slot) {
+        size_t index = m_slots[slot];
+
+        this->free_entry(m_entries[index]);
+        m_entries[index] = nullptr;
+
+        m_control[slot] = DELETED;
+
+        m_size--;
+        m_tombstones++;
+    }
+
+    // Rebuilds the table with `capacity` slots, dropping erased entries from the entry list on the way
+    void rehash(size_t capacity) {
+        size_t live = 0;
+        for (auto* entry : m_entries) {
+            if (entry) {
+                m_entries[live++] = entry;
+            }
+        }
+
+        m_entries.resize(live);
+
+        m_control = std::make_unique<uint8_t[]>(capacity);
+        m_slots = std::make_unique<uint32_t[]>(capacity);
+
+        std::memset(m_control.get(), EMPTY, capacity);
+
+        m_capacity = capacity;
+        m_tombstones = 0;
+
+        for (size_t index = 0; index < m_entries.size(); index++) {
+            uint64_t hash = H()(m_entries[index]->first);
+            size_t slot = this->find_empty_slot(hash);
+
+            m_control[slot] = h2(hash);
+            m_slots[slot] = static_cast<uint32_t>(index);
+        }
+    }
+
+    // Entries live in chunks that double in size, so they never move and small maps don't allocate much
+    value_type* allocate_entry() {
+        if (!m_free.empty()) {
+            value_type* entry = m_free.back();
+            m_free.pop_back();
+
+            return entry;
+        }
+
+        if (m_chunk_used == m_chunk_capacity) {
+            m_chunk_capacity = m_chunk_capacity ? m_chunk_capacity * 2 : 4;
+            m_chunks.push_back(std::make_unique<Storage[]>(m_chunk_capacity));
+
+            m_chunk_used = 0;
+        }
+
+        return reinterpret_cast<value_type*>(&m_chunks.back()[m_chunk_used++]);
+    }
+
+    void free_entry(value_type* entry) {
+        entry->~value_type();
+        m_free.push_back(entry);
+    }
+
+    void destroy_entries() {
+        for (auto* entry : m_entries) {
+            if (entry) {
+                entry->~value_type();
+            }
+        }
+    }
+
+    struct Storage {
+        alignas(value_type) unsigned char bytes[sizeof(value_type)];
+    };
+
+    std::unique_ptr<uint8_t[]> m_control;
+    std::unique_ptr<uint32_t[]> m_slots;
+
+    size_t m_capacity = 0;
+    size_t m_size = 0;
+    size_t m_tombstones = 0;
+
+    std::vector<value_type*> m_entries;
+
+    std::vector<std::unique_ptr<Storage[]>> m_chunks;
+    size_t m_chunk_used = 0;
+    size_t m_chunk_capacity = 0;
+
+    std::vector<value_type*> m_free;
+};
+
+}
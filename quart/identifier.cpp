@@ -0,0 +1,178 @@
+#include <quart/identifier.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+namespace quart {
+
+// Modules are lexed in parallel, so the table is split into shards that are locked independently
+static constexpr size_t SHARD_COUNT = 16;
+
+// Strings are looked up by id without locking, so the id -> string table grows in chunks that never move
+static constexpr size_t CHUNK_SIZE = 1 << 14;
+static constexpr size_t MAX_CHUNKS = 1 << 14;
+
+static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+class Interner {
+public:
+    NO_COPY(Interner)
+    NO_MOVE(Interner)
+
+    static Interner& instance() {
+        static Interner interner;
+        return interner;
+    }
+
+    ~Interner() {
+        for (auto& chunk : m_chunks) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    u32 intern(StringView value) {
+        if (value.empty()) {
+            return 0;
+        }
+
+        Shard& shard = this->shard_for(value);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        if (auto iterator = shard.ids.find(value); iterator != shard.ids.end()) {
+            return iterator->second;
+        }
+
+        StringView stored = shard.store(value);
+        u32 id = m_next_id.fetch_add(1, std::memory_order_relaxed);
+
+        this->entry(id) = stored;
+        shard.ids[stored] = id;
+
+        return id;
+    }
+
+    Optional<u32> find(StringView value) {
+        if (value.empty()) {
+            return 0;
+        }
+
+        Shard& shard = this->shard_for(value);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto iterator = shard.ids.find(value);
+        if (iterator == shard.ids.end()) {
+            return {};
+        }
+
+        return iterator->second;
+    }
+
+    u32 join(u32 prefix, u32 name) {
+        u64 key = (static_cast<u64>(prefix) << 32) | name;
+        std::lock_guard<std::mutex> lock(m_joined_mutex);
+
+        if (auto iterator = m_joined.find(key); iterator != m_joined.end()) {
+            return iterator->second;
+        }
+
+        u32 id = this->intern(std::format("{}::{}", this->str(prefix), this->str(name)));
+        m_joined[key] = id;
+
+        return id;
+    }
+
+    StringView str(u32 id) const {
+        StringView* chunk = m_chunks[id / CHUNK_SIZE].load(std::memory_order_acquire);
+        return chunk[id % CHUNK_SIZE];
+    }
+
+private:
+    struct Shard {
+        std::mutex mutex;
+        HashMap<StringView, u32> ids;
+
+        Vector<OwnPtr<char[]>> blocks;
+        char* cursor = nullptr;
+        size_t remaining = 0;
+
+        StringView store(StringView value) {
+            if (value.size() > remaining) {
+                size_t size = std::max(value.size(), BLOCK_SIZE);
+                blocks.push_back(OwnPtr<char[]>(new char[size]));
+
+                cursor = blocks.back().get();
+                remaining = size;
+            }
+
+            std::memcpy(cursor, value.data(), value.size());
+            StringView stored = { cursor, value.size() };
+
+            cursor += value.size();
+            remaining -= value.size();
+
+            return stored;
+        }
+    };
+
+    Interner() {
+        this->entry(0) = {};
+    }
+
+    Shard& shard_for(StringView value) {
+        // The shard uses the top bits so that it doesn't correlate with the slot the shard's own map picks
+        return m_shards[Hash<StringView>()(value) >> 60];
+    }
+
+    StringView& entry(u32 id) {
+        if (id / CHUNK_SIZE >= MAX_CHUNKS) {
+            std::abort();
+        }
+
+        auto& slot = m_chunks[id / CHUNK_SIZE];
+        StringView* chunk = slot.load(std::memory_order_acquire);
+        if (!chunk) {
+            auto* allocated = new StringView[CHUNK_SIZE];
+            if (slot.compare_exchange_strong(chunk, allocated, std::memory_order_acq_rel)) {
+                chunk = allocated;
+            } else {
+                delete[] allocated;
+            }
+        }
+
+        return chunk[id % CHUNK_SIZE];
+    }
+
+    Array<Shard, SHARD_COUNT> m_shards;
+    std::atomic<u32> m_next_id = 1;
+
+    Array<std::atomic<StringView*>, MAX_CHUNKS> m_chunks = {};
+
+    std::mutex m_joined_mutex;
+    HashMap<u64, u32> m_joined;
+};
+
+static_assert(SHARD_COUNT == 16, "`shard_for` takes the top 4 bits of the hash");
+
+Identifier::Identifier(StringView value) : m_id(Interner::instance().intern(value)) {}
+
+Optional<Identifier> Identifier::find(StringView value) {
+    auto id = Interner::instance().find(value);
+    if (!id.has_value()) {
+        return {};
+    }
+
+    return Identifier(*id);
+}
+
+Identifier Identifier::join(Identifier prefix, Identifier name) {
+    return Identifier(Interner::instance().join(prefix.m_id, name.m_id));
+}
+
+StringView Identifier::str() const {
+    return Interner::instance().str(m_id);
+}
+
+}
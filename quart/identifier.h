@@ -0,0 +1,58 @@
+#pragma once
+
+#include <quart/common.h>
+
+#include <format>
+
+namespace quart {
+
+// A name interned into a process wide table, stored as a 32-bit index into it. Two identifiers are equal exactly when
+// their spellings are, so comparing and hashing them never has to look at the characters. The lexer interns every
+// identifier token, names then travel through the AST, scopes and symbols as identifiers.
+//
+// Interning is thread safe and the interned strings live until the process exits, so `str()` can be called from
+// any thread without locking.
+class Identifier {
+public:
+    Identifier() = default;
+    explicit Identifier(StringView value);
+
+    // Returns the identifier for `value` only if it has been interned before, without adding it to the table.
+    // Nothing can be declared under a name that was never interned, so lookups can use this to bail out early.
+    static Optional<Identifier> find(StringView value);
+
+    // Interns `<prefix>::<name>`, the result is cached so building the same qualified name again doesn't touch any strings
+    static Identifier join(Identifier prefix, Identifier name);
+
+    u32 id() const { return m_id; }
+
+    StringView str() const;
+    operator StringView() const { return this->str(); }
+
+    bool empty() const { return m_id == 0; }
+
+    bool operator==(Identifier const&) const = default;
+    bool operator==(StringView value) const { return this->str() == value; }
+
+    u64 hash() const { return hash_integer(m_id); }
+
+private:
+    explicit Identifier(u32 id) : m_id(id) {}
+
+    // 0 is reserved for the empty string
+    u32 m_id = 0;
+};
+
+}
+
+template<>
+struct std::formatter<quart::Identifier> {
+    constexpr auto parse(std::format_parse_context& ctx) {
+        return ctx.begin();
+    }
+
+    template<typename FormatContext>
+    auto format(const quart::Identifier& identifier, FormatContext& ctx) const {
+        return std::format_to(ctx.out(), "{}", identifier.str());
+    }
+};
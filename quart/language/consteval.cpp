@@ -1,28 +1,26 @@
 #include <quart/language/consteval.h>
 #include <quart/language/state.h>
-#include <quart/temporary_change.h>
+#include <quart/bytecode/interpreter.h>
 
 #include <cmath>
 
 // These are expressions that are always not constant no matter what
-// NOTE: Call, Return, EmptyConstructor, Cast and Ternary could be implemented in the future.
+// NOTE: Calls and casts are compiled to bytecode and run by the interpreter instead.
+// NOTE: `break` and `continue` are generated along with the loop they're in, which runs as a whole.
 #define ENUMERATE_NON_CONSTANT_EXPR(Op)         \
     Op(ExternBlock)                             \
     Op(Assignment)                              \
     Op(TupleAssignment)                         \
     Op(Const)                                   \
     Op(Reference)                               \
-    Op(Call)                                    \
     Op(Return)                                  \
     Op(FunctionDecl)                            \
     Op(Function)                                \
     Op(Defer)                                   \
     Op(Struct)                                  \
-    Op(Cast)                                    \
     Op(Using)                                   \
     Op(Enum)                                    \
     Op(Import)                                  \
-    Op(Ternary)                                 \
     Op(ArrayFill)                               \
     Op(TypeAlias)                               \
     Op(StaticAssert)                            \
@@ -32,11 +30,15 @@
     Op(Trait)                                   \
     Op(ImplTrait)                               \
     Op(Match)                                   \
-    Op(RangeFor)
+    Op(RangeFor)                                \
+    Op(Break)                                   \
+    Op(Continue)
 
 namespace quart {
 
-static constexpr size_t MAX_LOOP_COUNT = 1'000'000;
+ConstantEvaluator::ConstantEvaluator(State& state) : m_state(state) {}
+
+ConstantEvaluator::~ConstantEvaluator() = default;
 
 template<typename T>
 Optional<T> ConstantEvaluator::evaluate_binary_operation(BinaryOp op, T lhs, T rhs) const {
@@ -179,6 +181,102 @@ ErrorOr<Constant*> ConstantEvaluator::evaluate(ast::Expr const& expr) {
     ENUMERATE_NON_CONSTANT_EXPR(Op)
 #undef Op
 
+ErrorOr<Function*> ConstantEvaluator::generate_function(
+    Span span, Type* return_type, ::llvm::function_ref<ErrorOr<void>(Function*)> generate
+) {
+    if (!m_interpreter) {
+        m_interpreter = make<bytecode::Interpreter>(m_state);
+    }
+
+    // Anything declared while generating the body goes into a scope of its own instead of the enclosing one
+    auto scope = Scope::create(Identifier("consteval"), ScopeType::Function, m_state.scope());
+
+    auto* underlying_type = FunctionType::get(m_state.context(), return_type, {}, false);
+    auto function = Function::create(
+        span, Identifier("consteval"), {}, underlying_type, scope, LinkageSpecifier::None, nullptr, false
+    );
+
+    function->set_module(m_state.module());
+    m_functions.push_back(function);
+
+    auto* previous_function = m_state.function();
+    auto* previous_block = m_state.current_block();
+    auto previous_scope = m_state.scope();
+
+    auto* entry_block = m_state.create_block();
+
+    function->set_entry_block(entry_block);
+    function->set_is_decl(false);
+
+    m_state.switch_to(entry_block);
+    m_state.set_current_function(function.get());
+    m_state.set_current_scope(scope);
+
+    auto generated = generate(function.get());
+    if (!generated.is_err()) {
+        generated = function->finalize_body(m_state);
+    }
+
+    m_state.switch_to(previous_block);
+    m_state.set_current_function(previous_function);
+    m_state.set_current_scope(previous_scope);
+
+    TRY(generated);
+    return function.get();
+}
+
+ErrorOr<Constant*> ConstantEvaluator::interpret(ast::Expr const& expr) {
+    Type* type = TRY(m_state.type_checker().type_check(expr));
+    auto* function = TRY(this->generate_function(expr.span(), type, [&](Function* function) -> ErrorOr<void> {
+        auto option = TRY(expr.generate(m_state, {}));
+        if (type->is_void()) {
+            m_state.emit<bytecode::Return>();
+            return {};
+        } else if (!option.has_value()) {
+            return err(expr.span(), "Expected an expression");
+        }
+
+        bytecode::Operand operand = *option;
+        if (!function->is_struct_return()) {
+            operand = TRY(m_state.type_check_and_cast(expr.span(), operand, type, "Cannot convert a value of type '{}' to '{}'"));
+            m_state.emit<bytecode::Return>(operand);
+
+            return {};
+        }
+
+        // Calls returning structs give back a pointer to the memory the result was written to
+        if (!operand.is_register() || m_state.type(operand) != type->get_pointer_to()) {
+            return err(expr.span(), "Expression of type '{}' can't be evaluated at compile time", type->str());
+        }
+
+        auto return_register = m_state.allocate_register();
+        m_state.emit<bytecode::GetReturn>(return_register);
+
+        m_state.set_register_state(return_register, type->get_pointer_to());
+
+        m_state.emit<bytecode::Memcpy>(return_register, operand.reg(), type->size());
+        m_state.emit<bytecode::Return>();
+
+        return {};
+    }));
+
+    return m_interpreter->call(expr.span(), function, {});
+}
+
+ErrorOr<void> ConstantEvaluator::execute(Span span, ::llvm::function_ref<ErrorOr<void>()> generate) {
+    bool previous = m_state.in_consteval_block();
+    m_state.set_in_consteval_block(true);
+
+    auto generated = this->generate_function(span, m_state.context().void_type(), [&](Function*) {
+        return generate();
+    });
+
+    m_state.set_in_consteval_block(previous);
+
+    auto* function = TRY(generated);
+    return m_interpreter->call_and_commit_globals(span, function);
+}
+
 bool ConstantEvaluator::is_constant_expression(ast::BlockExpr const& expr) const {
     for (auto const& e : expr.block()) {
         if (!this->is_constant_expression(*e)) {
@@ -477,64 +575,70 @@ bool ConstantEvaluator::is_constant_expression(ast::WhileExpr const& expr) const
     return this->is_constant_expression(expr.condition()) && this->is_constant_expression(expr.body());
 }
 
+// Loops don't produce a value, they're run for what they assign to constants. How long they can run for is bounded
+// by the interpreter's step budget.
 ErrorOr<Constant*> ConstantEvaluator::evaluate(ast::WhileExpr const& expr) {
-    Constant* condition = TRY(this->evaluate(expr.condition()));
-    if (!isa<ConstantInt>(condition)) {
-        return err(expr.condition().span(), "Expected an integer");
-    }
+    TRY(this->execute(expr.span(), [&]() -> ErrorOr<void> {
+        TRY(expr.generate(m_state, {}));
+        return {};
+    }));
 
-    auto* integer = cast_unchecked<ConstantInt>(condition);
-    u64 value = integer->value();
+    return nullptr;
+}
 
-    TemporaryChange<bool> change(m_in_loop, true);
-    size_t i = 0;
+bool ConstantEvaluator::is_constant_expression(ast::ForExpr const& expr) const {
+    return this->is_constant_expression(expr.iterable()) && this->is_constant_expression(expr.body());
+}
 
-    while (value) {
-        TRY(this->evaluate(expr.body()));
+ErrorOr<Constant*> ConstantEvaluator::evaluate(ast::ForExpr const& expr) {
+    TRY(this->execute(expr.span(), [&]() -> ErrorOr<void> {
+        TRY(expr.generate(m_state, {}));
+        return {};
+    }));
 
-        if (m_should_break) {
-            m_should_break = false;
-            break;
-        }
+    return nullptr;
+}
 
-        Constant* condition = TRY(this->evaluate(expr.condition()));
-        value = cast_unchecked<ConstantInt>(condition)->value();
 
-        i++;
-        if (i >= MAX_LOOP_COUNT) {
-            return err(expr.span(), "Max iteration count exceeded for constant loops");
+bool ConstantEvaluator::is_constant_expression(ast::CallExpr const& expr) const {
+    for (auto const& argument : expr.args()) {
+        if (!this->is_constant_expression(*argument)) {
+            return false;
         }
     }
 
-    return nullptr;
+    return true;
 }
 
-bool ConstantEvaluator::is_constant_expression(ast::ForExpr const& expr) const {
-    return this->is_constant_expression(expr.iterable()) && this->is_constant_expression(expr.body());
+ErrorOr<Constant*> ConstantEvaluator::evaluate(ast::CallExpr const& expr) {
+    return this->interpret(expr);
 }
 
-ErrorOr<Constant*> ConstantEvaluator::evaluate(ast::ForExpr const&) {
-    ASSERT(false, "Not implemented");
-    return nullptr;
+bool ConstantEvaluator::is_constant_expression(ast::CastExpr const& expr) const {
+    return this->is_constant_expression(expr.value());
 }
 
-bool ConstantEvaluator::is_constant_expression(ast::BreakExpr const&) const {
-    return m_in_loop;
+ErrorOr<Constant*> ConstantEvaluator::evaluate(ast::CastExpr const& expr) {
+    return this->interpret(expr);
 }
 
-ErrorOr<Constant*> ConstantEvaluator::evaluate(ast::BreakExpr const&) {
-    m_should_break = true;
-    return nullptr;
+bool ConstantEvaluator::is_constant_expression(ast::TernaryExpr const& expr) const {
+    return this->is_constant_expression(expr.condition())
+        && this->is_constant_expression(expr.true_expr())
+        && this->is_constant_expression(expr.false_expr());
 }
 
-bool ConstantEvaluator::is_constant_expression(ast::ContinueExpr const&) const {
-    // TODO: Maybe if we are inside a constantly evaluated loop, this should be true?
-    return false;
-}
+ErrorOr<Constant*> ConstantEvaluator::evaluate(ast::TernaryExpr const& expr) {
+    Constant* condition = TRY(this->evaluate(expr.condition()));
+    if (!isa<ConstantInt>(condition)) {
+        return err(expr.condition().span(), "Expected an integer");
+    }
 
-ErrorOr<Constant*> ConstantEvaluator::evaluate(ast::ContinueExpr const&) {
-    ASSERT(false, "Not implemented");
-    return nullptr;
+    if (cast_unchecked<ConstantInt>(condition)->value()) {
+        return this->evaluate(expr.true_expr());
+    }
+
+    return this->evaluate(expr.false_expr());
 }
 
 bool ConstantEvaluator::is_constant_expression(ast::SizeofExpr const&) const {
@@ -632,8 +736,16 @@ bool ConstantEvaluator::is_constant_expression(ast::ConstEvalExpr const&) const
     return true;
 }
 
-ErrorOr<Constant*> ConstantEvaluator::evaluate(ast::ConstEvalExpr const&) {
-    return {};
+ErrorOr<Constant*> ConstantEvaluator::evaluate(ast::ConstEvalExpr const& expr) {
+    TRY(this->execute(expr.span(), [&]() -> ErrorOr<void> {
+        for (auto& e : expr.body()) {
+            TRY(e->generate(m_state, {}));
+        }
+
+        return {};
+    }));
+
+    return nullptr;
 }
 
 }
\ No newline at end of file
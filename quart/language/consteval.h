@@ -6,13 +6,21 @@
 
 #include <quart/parser/ast.h>
 
+#include <llvm/ADT/STLFunctionalExtras.h>
+
 namespace quart {
 
 class State;
+class Function;
+
+namespace bytecode {
+    class Interpreter;
+}
 
 class ConstantEvaluator {
 public:
-    ConstantEvaluator(State& state) : m_state(state) {}
+    ConstantEvaluator(State& state);
+    ~ConstantEvaluator();
 
     bool is_constant_expression(ast::Expr const& expr) const;
     ErrorOr<Constant*> evaluate(ast::Expr const& expr);
@@ -34,11 +42,23 @@ private:
 
     Constant* evaluate_binary_operation(BinaryOp op, Constant* lhs, Constant* rhs) const;
 
+    // Creates a function returning `return_type` and lets `generate` emit its body with it as the current function
+    ErrorOr<Function*> generate_function(
+        Span span, Type* return_type, ::llvm::function_ref<ErrorOr<void>(Function*)> generate
+    );
+
+    // Generates bytecode for `expr` into a function of its own and runs it in the interpreter
+    ErrorOr<Constant*> interpret(ast::Expr const& expr);
+
+    // Runs the statements emitted by `generate` in the interpreter, whatever they assign to constants is kept
+    ErrorOr<void> execute(Span span, ::llvm::function_ref<ErrorOr<void>()> generate);
+
     State& m_state; // NOLINT
 
-    bool m_in_loop = false;
-    bool m_should_break = false;
-    bool m_should_continue = false;
+    // The interpreter keys its caches on the function, so these have to outlive it
+    Vector<RefPtr<Function>> m_functions;
+
+    OwnPtr<bytecode::Interpreter> m_interpreter;
 };
 
 }
\ No newline at end of file
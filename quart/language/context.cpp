@@ -1,6 +1,8 @@
 #include <quart/language/context.h>
 
-#define CREATE_TYPE(storage, Type, key, ...) ({                         \
+#include <algorithm>
+
+#define CREATE_CONSTANT(storage, Type, key, ...) ({                     \
     auto iterator = storage.find(key);                                  \
     if (iterator != storage.end()) {                                    \
         return static_cast<Type*>(&*iterator->second);                  \
@@ -10,21 +12,85 @@
     t;                                                                  \
 })                                                                      \
 
-#define CREATE_CONSTANT CREATE_TYPE
-
 // NOLINTBEGIN(cppcoreguidelines-owning-memory, cppcoreguidelines-avoid-magic-numbers)
 
 namespace quart {
 
+TypeKey::TypeKey(
+    TypeKind kind, Type* type, u64 value, std::span<Type* const> types
+) : m_kind(kind), m_type(type), m_value(value), m_types(types) {
+    u64 hash = hash_combine(hash_integer(static_cast<u64>(kind)), Hash<Type*>()(type));
+    hash = hash_combine(hash, hash_integer(value));
+
+    for (Type* element : types) {
+        hash = hash_combine(hash, Hash<Type*>()(element));
+    }
+
+    m_hash = hash;
+}
+
+bool TypeKey::operator==(TypeKey const& other) const {
+    if (m_hash != other.m_hash || m_kind != other.m_kind || m_type != other.m_type || m_value != other.m_value) {
+        return false;
+    }
+
+    return std::equal(m_types.begin(), m_types.end(), other.m_types.begin(), other.m_types.end());
+}
+
+// The components a stored key has to point into, see `TypeKey`
+static std::span<Type* const> components_of(Type* type) {
+    switch (type->kind()) {
+        case TypeKind::Tuple:
+            return type->get_tuple_types();
+        case TypeKind::Function:
+            return type->get_function_params();
+        default:
+            return {};
+    }
+}
+
 Context::Context() : 
     m_void_type(this, TypeKind::Void), m_f32(this, TypeKind::Float), m_f64(this, TypeKind::Double),
     m_i1(this, 1, true), m_i8(this, 8, true), m_i16(this, 16, true), m_i32(this, 32, true), m_i64(this, 64, true),
-    m_u8(this, 8, false), m_u16(this, 16, false), m_u32(this, 32, false), m_u64(this, 64, false) {}
+    m_u8(this, 8, false), m_u16(this, 16, false), m_u32(this, 32, false), m_u64(this, 64, false),
+    m_data_layout(Target::build()), m_arena(ast::Arena::create()) {}
 
 OwnPtr<Context> Context::create() {
     return OwnPtr<Context>(new Context);
 }
 
+template<typename T, typename... Args>
+T* Context::allocate_type(Args&&... args) {
+    void* memory = m_arena->allocate(sizeof(T), alignof(T));
+    return m_arena->adopt(new (memory) T(this, std::forward<Args>(args)...));
+}
+
+template<typename T, typename... Args>
+T* Context::create_type(TypeKey const& key, Args&&... args) {
+    auto iterator = m_types.find(key);
+    if (iterator != m_types.end()) {
+        return static_cast<T*>(iterator->second);
+    }
+
+    T* type = this->allocate_type<T>(std::forward<Args>(args)...);
+    m_types.try_emplace(key.rebind(components_of(type)), type);
+
+    return type;
+}
+
+template<typename T, typename... Args>
+T* Context::create_nominal_type(HashMap<String, T*>& types, const String& name, Args&&... args) {
+    auto iterator = types.find(name);
+    if (iterator != types.end()) {
+        return iterator->second;
+    }
+
+    T* type = this->allocate_type<T>(name, std::forward<Args>(args)...);
+    types[name] = type;
+
+    return type;
+}
+
 IntType* Context::create_int_type(::u32 bits, bool is_signed) {
     switch (bits) {
         case 1:
@@ -40,48 +106,45 @@ IntType* Context::create_int_type(::u32 bits, bool is_signed) {
         default: break;
     }
 
-    auto key = std::make_pair(bits, is_signed);
-    return CREATE_TYPE(m_integer_types, IntType, key, bits, is_signed);
-}
-
-StructType* Context::create_struct_type(const String& name, const Vector<Type*>& fields) {
-    return CREATE_TYPE(m_struct_types, StructType, name, name, fields, nullptr);
+    TypeKey key(TypeKind::Int, nullptr, (static_cast<::u64>(bits) << 1) | is_signed);
+    return this->create_type<IntType>(key, bits, is_signed);
 }
 
 ArrayType* Context::create_array_type(Type* element, size_t size) {
-    auto key = std::make_pair(element, size);
-    return CREATE_TYPE(m_array_types, ArrayType, key, element, size);
-}
-
-EnumType* Context::create_enum_type(const String& name, Type* inner) {
-    return CREATE_TYPE(m_enum_types, EnumType, name, name, inner);
+    return this->create_type<ArrayType>(TypeKey(TypeKind::Array, element, size), element, size);
 }
 
 TupleType* Context::create_tuple_type(const Vector<Type*>& elements) {
-    return CREATE_TYPE(m_tuple_types, TupleType, elements, elements);
+    return this->create_type<TupleType>(TypeKey(TypeKind::Tuple, nullptr, 0, elements), elements);
 }
 
 PointerType* Context::create_pointer_type(Type* pointee, bool is_mutable) {
-    auto key = std::make_pair(pointee, is_mutable);
-    return CREATE_TYPE(m_pointer_types, PointerType, key, pointee, is_mutable);
+    return this->create_type<PointerType>(TypeKey(TypeKind::Pointer, pointee, is_mutable), pointee, is_mutable);
 }
 
 ReferenceType* Context::create_reference_type(Type* inner, bool is_mutable) {
-    auto key = std::make_pair(inner, is_mutable);
-    return CREATE_TYPE(m_reference_types, ReferenceType, key, inner, is_mutable);
+    return this->create_type<ReferenceType>(TypeKey(TypeKind::Reference, inner, is_mutable), inner, is_mutable);
 }
 
 FunctionType* Context::create_function_type(Type* return_type, const Vector<Type*>& parameters, bool is_var_arg) {
-    auto key = std::make_pair(return_type, std::make_pair(parameters, is_var_arg));
-    return CREATE_TYPE(m_function_types, FunctionType, key, return_type, parameters, is_var_arg);
+    TypeKey key(TypeKind::Function, return_type, is_var_arg, parameters);
+    return this->create_type<FunctionType>(key, return_type, parameters, is_var_arg);
+}
+
+StructType* Context::create_struct_type(const String& name, const Vector<Type*>& fields) {
+    return this->create_nominal_type(m_struct_types, name, fields, nullptr);
+}
+
+EnumType* Context::create_enum_type(const String& name, Type* inner) {
+    return this->create_nominal_type(m_enum_types, name, inner);
 }
 
 TraitType* Context::create_trait_type(const String& name) {
-    return CREATE_TYPE(m_trait_types, TraitType, name, name);
+    return this->create_nominal_type(m_trait_types, name);
 }
 
 EmptyType* Context::create_empty_type(const String& name) {
-    return CREATE_TYPE(m_empty_types, EmptyType, name, name);
+    return this->create_nominal_type(m_empty_types, name);
 }
 
 ConstantInt* Context::create_int_constant(::u64 value, Type* type) {
@@ -3,22 +3,49 @@
 #include <quart/common.h>
 #include <quart/language/types.h>
 #include <quart/language/constants.h>
+#include <quart/language/data_layout.h>
+#include <quart/parser/arena.h>
+
+#include <span>
 
 namespace quart {
 
-using IntTypeStorageKey = Pair<u32, bool>;
-using TupleTypeStorageKey = Vector<Type*>;
-using PointerTypeStorageKey = Pair<Type*, bool>;
-using ArrayTypeStorageKey = Pair<Type*, size_t>;
-using FunctionTypeStorageKey = Pair<Type*, Pair<Vector<Type*>, bool>>;
+// Describes a structural type by its kind and components so that it can be looked up without constructing it.
+// The hash is computed once when the key is created. Keys used for lookups point into the caller's arguments,
+// the ones stored in the table point into the type they describe.
+class TypeKey {
+public:
+    TypeKey(TypeKind kind, Type* type, u64 value, std::span<Type* const> types = {});
+
+    // The same key but pointing at `types`, which has to compare equal to the current ones
+    TypeKey rebind(std::span<Type* const> types) const {
+        TypeKey key = *this;
+        key.m_types = types;
+
+        return key;
+    }
+
+    bool operator==(TypeKey const& other) const;
+
+    u64 hash() const { return m_hash; }
+
+private:
+    TypeKind m_kind;
+
+    Type* m_type;
+    u64 m_value;
+    std::span<Type* const> m_types;
+
+    u64 m_hash;
+};
 
 template<typename T> requires(std::is_base_of_v<Constant, T>)
 using ConstantMap = HashMap<Pair<Type*, typename T::value_type>, OwnPtr<T>>;
 
+// Owns every type and constant. Structural types are hash-consed, so two types are the same exactly when their
+// pointers are equal and constructing one that already exists is a single hash lookup.
 class Context {
 public:
-    template<typename K, typename V> using TypeMap = std::map<K, V>;
-
     static OwnPtr<Context> create();
 
     IntType* create_int_type(u32 bits, bool is_signed);
@@ -58,6 +85,8 @@ public:
 
     PointerType* cstr();
 
+    DataLayout const& data_layout() const { return m_data_layout; }
+
 private:
     Context();
 
@@ -66,21 +95,27 @@ private:
     IntType m_i1, m_i8, m_i16, m_i32, m_i64;
     IntType m_u8, m_u16, m_u32, m_u64;
 
-    HashMap<String, OwnPtr<StructType>> m_struct_types;
-    HashMap<String, OwnPtr<EnumType>> m_enum_types;
+    template<typename T, typename... Args>
+    T* create_type(TypeKey const& key, Args&&... args);
+
+    template<typename T, typename... Args>
+    T* create_nominal_type(HashMap<String, T*>& types, const String& name, Args&&... args);
 
-    TypeMap<IntTypeStorageKey, OwnPtr<IntType>> m_integer_types;
+    template<typename T, typename... Args>
+    T* allocate_type(Args&&... args);
 
-    TypeMap<PointerTypeStorageKey, OwnPtr<PointerType>> m_pointer_types;
-    TypeMap<PointerTypeStorageKey, OwnPtr<ReferenceType>> m_reference_types;
+    DataLayout m_data_layout;
 
-    TypeMap<ArrayTypeStorageKey, OwnPtr<ArrayType>> m_array_types;
-    TypeMap<TupleTypeStorageKey, OwnPtr<TupleType>> m_tuple_types;
+    OwnPtr<ast::Arena> m_arena;
 
-    TypeMap<FunctionTypeStorageKey, OwnPtr<FunctionType>> m_function_types;
+    // Integer, pointer, reference, array, tuple and function types
+    HashMap<TypeKey, Type*> m_types;
 
-    TypeMap<String, OwnPtr<TraitType>> m_trait_types;
-    TypeMap<String, OwnPtr<EmptyType>> m_empty_types;
+    // Nominal types, looked up by name
+    HashMap<String, StructType*> m_struct_types;
+    HashMap<String, EnumType*> m_enum_types;
+    HashMap<String, TraitType*> m_trait_types;
+    HashMap<String, EmptyType*> m_empty_types;
 
     ConstantMap<ConstantInt> m_int_constants;
     ConstantMap<ConstantFloat> m_float_constants;
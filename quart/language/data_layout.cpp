@@ -0,0 +1,96 @@
+#include <quart/language/data_layout.h>
+#include <quart/casting.h>
+#include <quart/assert.h>
+
+#include <bit>
+
+namespace quart {
+
+static size_t align_to(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+DataLayout::DataLayout(Target const& target) {
+    auto& triple = target.triple();
+
+    m_pointer_size = target.is_32bit() ? 4 : 8;
+
+    // The i386 System V ABI only aligns 8 byte scalars to 4 bytes, everything else aligns them naturally
+    if (triple.getArch() == ::llvm::Triple::x86 && !triple.isOSWindows()) {
+        m_max_scalar_alignment = 4;
+    } else {
+        m_max_scalar_alignment = 8;
+    }
+}
+
+TypeLayout const& DataLayout::layout_of(Type const* type) const {
+    if (!type->m_layout) {
+        type->m_layout = make<TypeLayout>(this->compute(type));
+    }
+
+    return *type->m_layout;
+}
+
+size_t DataLayout::offset_of(Type const* type, size_t index) const {
+    auto& layout = this->layout_of(type);
+    ASSERT(index < layout.offsets.size(), "Field index out of range");
+
+    return layout.offsets[index];
+}
+
+TypeLayout DataLayout::scalar(size_t size) const {
+    return { size, std::min(size, m_max_scalar_alignment), {} };
+}
+
+TypeLayout DataLayout::compute_aggregate(Vector<Type*> const& fields, bool is_packed) const {
+    TypeLayout layout;
+    layout.offsets.reserve(fields.size());
+
+    for (auto& field : fields) {
+        auto& field_layout = this->layout_of(field);
+        if (!is_packed) {
+            layout.size = align_to(layout.size, field_layout.alignment);
+            layout.alignment = std::max(layout.alignment, field_layout.alignment);
+        }
+
+        layout.offsets.push_back(layout.size);
+        layout.size += field_layout.size;
+    }
+
+    // Padding at the end keeps every element of an array of these aligned
+    layout.size = align_to(layout.size, layout.alignment);
+    return layout;
+}
+
+TypeLayout DataLayout::compute(Type const* type) const {
+    switch (type->kind()) {
+        case TypeKind::Float:
+            return this->scalar(4);
+        case TypeKind::Double:
+            return this->scalar(8);
+        case TypeKind::Int: {
+            // Integers are stored in the smallest power of two number of bytes that fits them, so `i1` takes a byte
+            size_t bytes = (type->get_int_bit_width() + 7) / 8;
+            return this->scalar(std::bit_ceil(std::max<size_t>(bytes, 1)));
+        }
+        case TypeKind::Pointer:
+        case TypeKind::Reference:
+            return { m_pointer_size, m_pointer_size, {} };
+        case TypeKind::Enum:
+            return this->layout_of(type->get_inner_enum_type());
+        case TypeKind::Array: {
+            auto& element = this->layout_of(type->get_array_element_type());
+            return { element.size * type->get_array_size(), element.alignment, {} };
+        }
+        case TypeKind::Struct: {
+            const auto* structure = cast_unchecked<StructType>(type);
+            return this->compute_aggregate(structure->fields(), structure->is_packed());
+        }
+        case TypeKind::Tuple:
+            return this->compute_aggregate(type->get_tuple_types(), false);
+        default:
+            return {};
+    }
+}
+
+}
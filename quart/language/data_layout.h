@@ -0,0 +1,36 @@
+#pragma once
+
+#include <quart/common.h>
+#include <quart/language/types.h>
+#include <quart/target.h>
+
+namespace quart {
+
+// Computes the size, alignment and field offsets of types the same way the target's C ABI lays them out.
+// A type's layout is computed the first time it's asked for and cached on the type itself, so nested aggregates
+// are only ever walked once.
+class DataLayout {
+public:
+    explicit DataLayout(Target const& target);
+
+    size_t pointer_size() const { return m_pointer_size; }
+
+    TypeLayout const& layout_of(Type const* type) const;
+
+    size_t size_of(Type const* type) const { return this->layout_of(type).size; }
+    size_t alignment_of(Type const* type) const { return this->layout_of(type).alignment; }
+
+    // The byte offset of the field or element at `index` of a struct or tuple type
+    size_t offset_of(Type const* type, size_t index) const;
+
+private:
+    TypeLayout compute(Type const* type) const;
+    TypeLayout compute_aggregate(Vector<Type*> const& fields, bool is_packed) const;
+
+    TypeLayout scalar(size_t size) const;
+
+    size_t m_pointer_size;
+    size_t m_max_scalar_alignment;
+};
+
+}
@@ -2,8 +2,8 @@
 
 namespace quart {
 
-RefPtr<Enum> Enum::create(String name, quart::Type* underlying_type, RefPtr<Scope> scope) {
-    return RefPtr<Enum>(new Enum(move(name), underlying_type, move(scope)));
+RefPtr<Enum> Enum::create(Identifier name, quart::Type* underlying_type, RefPtr<Scope> scope) {
+    return RefPtr<Enum>(new Enum(name, underlying_type, move(scope)));
 }
     
 }
@@ -15,15 +15,15 @@ class Enum : public Symbol {
 public:
     static bool classof(Symbol const* symbol) { return symbol->type() == Symbol::TypeAlias; }
 
-    static RefPtr<Enum> create(String name, quart::Type* underlying_type, RefPtr<Scope>);
+    static RefPtr<Enum> create(Identifier name, quart::Type* underlying_type, RefPtr<Scope>);
 
     quart::Type* underlying_type() const { return m_underlying_type; }
     RefPtr<Scope> scope() const { return m_scope; }
 
 private:
     Enum(
-        String name, quart::Type* underlying_type, RefPtr<Scope> scope
-    ) : Symbol(move(name), Symbol::Enum, false), m_underlying_type(underlying_type), m_scope(move(scope)) {}
+        Identifier name, quart::Type* underlying_type, RefPtr<Scope> scope
+    ) : Symbol(name, Symbol::Enum, false), m_underlying_type(underlying_type), m_scope(move(scope)) {}
 
 
     quart::Type* m_underlying_type;
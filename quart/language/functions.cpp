@@ -9,7 +9,7 @@ namespace quart {
 
 RefPtr<Function> Function::create(
     Span span,
-    String name,
+    Identifier name,
     Vector<FunctionParameter> parameters,
     FunctionType* underlying_type, 
     RefPtr<Scope> scope,
@@ -18,12 +18,12 @@ RefPtr<Function> Function::create(
     bool is_public,
     bool is_async
 ) {
-    return RefPtr<Function>(new Function(span, move(name), move(parameters), underlying_type, move(scope), linkage_specifier, move(link_info), is_public, is_async));
+    return RefPtr<Function>(new Function(span, name, move(parameters), underlying_type, move(scope), linkage_specifier, move(link_info), is_public, is_async));
 }
 
 void Function::set_qualified_name() {
     if (m_link_info && !m_link_info->name.empty()) {
-        m_qualified_name = m_link_info->name;
+        m_qualified_name = Identifier(m_link_info->name);
     } else if (m_linkage_specifier == LinkageSpecifier::C) {
         m_qualified_name = name();
     } else {
@@ -95,11 +95,11 @@ ErrorOr<RefPtr<Function>> Function::specialize(State& state, Vector<FunctionPara
         return it->second;
     }
 
-    String name = format(
+    Identifier name(format(
         "{}<{}>",
         this->name(),
         format_range(parameters, [](auto& param) { return param.type->str(); })
-    );
+    ));
 
     auto scope = Scope::create(name, ScopeType::Function, m_scope->parent());
     auto underlying_type = FunctionType::get(
@@ -123,6 +123,7 @@ ErrorOr<RefPtr<Function>> Function::specialize(State& state, Vector<FunctionPara
 
     function->set_local_parameters();
     function->set_is_decl(false);
+    function->set_inline_hint(m_inline_hint);
 
     m_specializations.insert_or_assign(key, function);
     
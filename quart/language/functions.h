@@ -2,6 +2,7 @@
 
 #include <quart/language/types.h>
 #include <quart/bytecode/basic_block.h>
+#include <quart/bytecode/analysis/function_analysis.h>
 #include <quart/language/symbol.h>
 #include <quart/parser/ast.h>
 #include <quart/common.h>
@@ -22,7 +23,7 @@ struct FunctionParameter {
         Byval    = 1 << 4
     };
 
-    String name;
+    Identifier name;
     Type* type;
 
     u8 flags;
@@ -51,15 +52,26 @@ struct SpecializedFunctionKey {
     auto operator<=>(SpecializedFunctionKey const& other) const {
         return parameters <=> other.parameters;
     }
+
+    bool operator==(SpecializedFunctionKey const& other) const = default;
+
+    u64 hash() const { return Hash<Vector<Type*>>()(parameters); }
 };
 
 class Function : public Symbol {
 public:
+    // Set through `![inline]` and `![noinline]`, otherwise the inliner decides based on the size of the function
+    enum class InlineHint : u8 {
+        None,
+        Always,
+        Never
+    };
+
     static bool classof(const Symbol* symbol) { return symbol->type() == Symbol::Function; }
 
     static RefPtr<Function> create(
         Span,
-        String name, 
+        Identifier name, 
         Vector<FunctionParameter> parameters, 
         FunctionType* underlying_type,
         RefPtr<Scope>,
@@ -79,7 +91,7 @@ public:
     Type* return_type() const { return m_underlying_type->return_type(); }
     Vector<FunctionParameter> const& parameters() const { return m_parameters; }
 
-    String const& qualified_name() const { return m_qualified_name; }
+    Identifier qualified_name() const { return m_qualified_name; }
 
     RefPtr<Scope> scope() const { return m_scope; }
 
@@ -90,6 +102,8 @@ public:
     bool is_variadic() const { return m_underlying_type->is_function_var_arg(); }
     bool used() const { return m_used; }
 
+    InlineHint inline_hint() const { return m_inline_hint; }
+
     bool should_eliminate() const {
         return !is_main() && !used();
     }
@@ -173,19 +187,53 @@ public:
         m_basic_blocks.push_back(block);
     }
 
+    void insert_block_after(bytecode::BasicBlock* after, bytecode::BasicBlock* block) {
+        auto iterator = std::find(m_basic_blocks.begin(), m_basic_blocks.end(), after);
+        if (iterator == m_basic_blocks.end()) {
+            return this->insert_block(block);
+        }
+
+        block->set_next(after->next());
+        block->set_parent(this);
+
+        after->set_next(block);
+        m_basic_blocks.insert(std::next(iterator), block);
+    }
+
     void remove_block(bytecode::BasicBlock* block) {
         if (block->parent() != this) {
             return;
         }
 
-        auto iterator = std::remove(m_basic_blocks.begin(), m_basic_blocks.end(), block);
-        m_basic_blocks.erase(iterator, m_basic_blocks.end());
+        auto iterator = std::find(m_basic_blocks.begin(), m_basic_blocks.end(), block);
+        if (iterator == m_basic_blocks.end()) {
+            return;
+        }
+
+        // Backends rely on `next()` to know which block gets placed right after another
+        if (iterator != m_basic_blocks.begin()) {
+            (*std::prev(iterator))->set_next(block->next());
+        }
+
+        m_basic_blocks.erase(iterator);
+    }
+
+    // Cached control flow analyses of this function's blocks, computed on first use
+    bytecode::FunctionAnalysis& analysis() {
+        if (!m_analysis) {
+            m_analysis = make<bytecode::FunctionAnalysis>(this);
+        }
+
+        return *m_analysis;
     }
 
+    void invalidate_analysis() { m_analysis = nullptr; }
+
     void set_current_loop(Loop loop) { m_loop = loop; }
 
     void set_is_decl(bool is_decl) { m_is_decl = is_decl; }
     void set_used(bool used) { m_used = used; }
+    void set_inline_hint(InlineHint hint) { m_inline_hint = hint; }
 
     void dump() const;
 
@@ -199,7 +247,7 @@ private:
 
     Function(
         Span span,
-        String name,
+        Identifier name,
         Vector<FunctionParameter> parameters,
         FunctionType* underlying_type,
         RefPtr<Scope> scope,
@@ -207,7 +255,7 @@ private:
         RefPtr<LinkInfo> link_info,
         bool is_public,
         bool is_async
-    ) : Symbol(move(name), Symbol::Function, is_public), m_span(span),
+    ) : Symbol(name, Symbol::Function, is_public), m_span(span),
         m_linkage_specifier(linkage_specifier), m_underlying_type(underlying_type), m_parameters(move(parameters)), 
         m_link_info(move(link_info)), m_scope(move(scope)), m_is_async(is_async) {
 
@@ -219,7 +267,7 @@ private:
     LinkageSpecifier m_linkage_specifier;
 
     FunctionType* m_underlying_type;
-    String m_qualified_name;
+    Identifier m_qualified_name;
 
     Vector<FunctionParameter> m_parameters;
 
@@ -231,6 +279,8 @@ private:
     bytecode::BasicBlock* m_return_block = nullptr;
     Vector<bytecode::BasicBlock*> m_basic_blocks;
 
+    OwnPtr<bytecode::FunctionAnalysis> m_analysis;
+
     HashMap<SpecializedFunctionKey, RefPtr<Function>> m_specializations;
 
     ast::Expr* m_body = nullptr;
@@ -248,6 +298,8 @@ private:
     bool m_is_async = false;
     bool m_is_decl = true;
     bool m_used = false;
+
+    InlineHint m_inline_hint = InlineHint::None;
 };
 
 }
\ No newline at end of file
@@ -119,9 +119,9 @@ ErrorOr<RefPtr<Scope>> Impl::make(State& state, Type* type) {
         return { nullptr };
     }
 
-    auto scope = Scope::create(format("<{}>", type->str()), ScopeType::Impl, m_scope->parent());
+    auto scope = Scope::create(Identifier(format("<{}>", type->str())), ScopeType::Impl, m_scope->parent());
     for (auto& [name, ty] : args) {
-        scope->add_symbol(TypeAlias::create(name, ty, false)); 
+        scope->add_symbol(TypeAlias::create(Identifier(name), ty, false));
     }
 
     auto current_block = state.current_block();
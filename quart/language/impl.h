@@ -11,7 +11,7 @@ public:
         return OwnPtr<Impl>(new Impl(underlying_type, move(scope)));
     }
 
-    static OwnPtr<Impl> create(Type* underlying_type, RefPtr<Scope> scope, ast::BlockExpr* body, Set<String> parameters) {
+    static OwnPtr<Impl> create(Type* underlying_type, RefPtr<Scope> scope, ast::BlockExpr* body, Vector<Identifier> parameters) {
         return OwnPtr<Impl>(new Impl(underlying_type, move(scope), body, move(parameters)));
     }
 
@@ -30,7 +30,7 @@ private:
     ) : m_underlying_type(underlying_type), m_scope(move(scope)) {}
 
     Impl(
-        Type* underlying_type, RefPtr<Scope> scope, ast::BlockExpr* body, Set<String> parameters
+        Type* underlying_type, RefPtr<Scope> scope, ast::BlockExpr* body, Vector<Identifier> parameters
     ) : m_underlying_type(underlying_type), m_scope(move(scope)), m_body(body), m_generic_parameters(move(parameters)) {}
 
     Type* m_underlying_type = nullptr;
@@ -38,7 +38,7 @@ private:
 
     HashMap<Type*, RefPtr<Scope>> m_impls;
     ast::BlockExpr* m_body = nullptr;
-    Set<String> m_generic_parameters;
+    Vector<Identifier> m_generic_parameters;
 };
 
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <quart/filesystem.h>
 #include <quart/language/symbol.h>
+#include <quart/parser/arena.h>
 
 #include <memory>
 
@@ -18,11 +19,11 @@ public:
         Importing
     };
 
-    static RefPtr<Module> create(String name, String qualified_name, fs::Path path, RefPtr<Scope> scope, RefPtr<Module> parent = nullptr) {
-        return RefPtr<Module>(new Module(move(name), move(qualified_name), move(path), move(scope), move(parent)));
+    static RefPtr<Module> create(Identifier name, Identifier qualified_name, fs::Path path, RefPtr<Scope> scope, RefPtr<Module> parent = nullptr) {
+        return RefPtr<Module>(new Module(name, qualified_name, move(path), move(scope), move(parent)));
     }
 
-    String const& qualified_name() const { return m_qualified_name; }
+    Identifier qualified_name() const { return m_qualified_name; }
     fs::Path const& path() const { return m_path; }
 
     RefPtr<Scope> scope() const { return m_scope; }
@@ -34,15 +35,19 @@ public:
 
     bool is_submodule() const { return m_parent != nullptr; }
 
+    // Functions, structs and impls keep pointers into the module's AST, so it has to live as long as the module does
+    void set_arena(OwnPtr<ast::Arena> arena) { m_arena = move(arena); }
+
 private:
-    Module(String name, String qualified_name, fs::Path path, RefPtr<Scope> scope, RefPtr<Module> parent);
+    Module(Identifier name, Identifier qualified_name, fs::Path path, RefPtr<Scope> scope, RefPtr<Module> parent);
 
-    String m_qualified_name;
+    Identifier m_qualified_name;
 
     fs::Path m_path;
     RefPtr<Scope> m_scope;
 
     RefPtr<Module> m_parent;
+    OwnPtr<ast::Arena> m_arena;
 
     State m_state = State::Importing;
 };
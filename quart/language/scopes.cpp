@@ -2,8 +2,21 @@
 
 namespace quart {
 
-RefPtr<Scope> Scope::create(String name, ScopeType type, RefPtr<Scope> parent) {
-    auto scope = RefPtr<Scope>(new Scope(move(name), type, move(parent)));
+// Every time a name is declared or removed in any scope its generation is bumped, which invalidates whatever
+// `Scope::resolve` cached for that name. Scopes never change their parent, so a cached entry whose name hasn't been
+// touched since still points at the right symbol. Indexed by `Identifier::id()`.
+static Vector<u32> s_generations;
+
+static u32& generation_of(Identifier name) {
+    if (name.id() >= s_generations.size()) {
+        s_generations.resize(name.id() + 1);
+    }
+
+    return s_generations[name.id()];
+}
+
+RefPtr<Scope> Scope::create(Identifier name, ScopeType type, RefPtr<Scope> parent) {
+    auto scope = RefPtr<Scope>(new Scope(name, type, move(parent)));
     if (scope->parent()) {
         scope->parent()->m_children.push_back(scope);
     }
@@ -11,8 +24,8 @@ RefPtr<Scope> Scope::create(String name, ScopeType type, RefPtr<Scope> parent) {
     return scope;
 }
 
-RefPtr<Scope> Scope::clone(String name) {
-    auto scope = Scope::create(move(name), m_type, m_parent);
+RefPtr<Scope> Scope::clone(Identifier name) {
+    auto scope = Scope::create(name, m_type, m_parent);
     for (auto& [symbol_name, symbol] : m_symbols) {
         scope->m_symbols[symbol_name] = symbol;
     }
@@ -20,17 +33,45 @@ RefPtr<Scope> Scope::clone(String name) {
     return scope;
 }
 
-Symbol* Scope::resolve(const String& name) {
-    auto iterator = m_symbols.find(name);
-    if (iterator == m_symbols.end()) {
-        if (!m_parent) {
-            return nullptr;
+Symbol* Scope::resolve(Identifier name) {
+    if (auto iterator = m_symbols.find(name); iterator != m_symbols.end()) {
+        return iterator->second.get();
+    }
+
+    if (!m_parent) {
+        return nullptr;
+    }
+
+    u32 generation = generation_of(name);
+    if (auto iterator = m_resolved.find(name); iterator != m_resolved.end() && iterator->second.generation == generation) {
+        return iterator->second.symbol;
+    }
+
+    for (Scope* scope = m_parent.get(); scope; scope = scope->m_parent.get()) {
+        auto iterator = scope->m_symbols.find(name);
+        if (iterator == scope->m_symbols.end()) {
+            continue;
         }
 
-        return m_parent->resolve(name);
+        Symbol* symbol = iterator->second.get();
+        m_resolved[name] = { symbol, generation };
+
+        return symbol;
     }
 
-    return iterator->second.get();
+    return nullptr;
+}
+
+void Scope::add_symbol(RefPtr<Symbol> symbol) {
+    Identifier name = symbol->name();
+
+    generation_of(name)++;
+    m_symbols[name] = move(symbol);
+}
+
+void Scope::remove_symbol(Identifier name) {
+    generation_of(name)++;
+    m_symbols.erase(name);
 }
 
 void Scope::finalize(bool) {}
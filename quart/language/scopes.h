@@ -31,11 +31,11 @@ enum class ScopeType : u8 {
 
 class Scope {
 public:
-    static RefPtr<Scope> create(String name, ScopeType type, RefPtr<Scope> parent = nullptr);
+    static RefPtr<Scope> create(Identifier name, ScopeType type, RefPtr<Scope> parent = nullptr);
 
-    RefPtr<Scope> clone(String name);
+    RefPtr<Scope> clone(Identifier name);
 
-    String const& name() const { return m_name; }
+    Identifier name() const { return m_name; }
     ScopeType type() const { return m_type; }
 
     RefPtr<Scope> parent() const { return m_parent; }
@@ -44,10 +44,18 @@ public:
     Module* module() const { return m_module; }
     void set_module(Module* module) { m_module = module; }
 
-    HashMap<String, RefPtr<Symbol>> const& symbols() const { return m_symbols; }
+    HashMap<Identifier, RefPtr<Symbol>> const& symbols() const { return m_symbols; }
 
-    Symbol* resolve(const String& name);
-    template<typename T> T* resolve(const String& name) {
+    // Names found in a parent scope are cached in the scope the lookup started from, see `Scope::resolve`
+    Symbol* resolve(Identifier name);
+
+    // For names that don't come from the source, a name that was never interned can't have been declared anywhere
+    Symbol* resolve(StringView name) {
+        auto identifier = Identifier::find(name);
+        return identifier.has_value() ? this->resolve(*identifier) : nullptr;
+    }
+
+    template<typename T, typename Name> T* resolve(Name const& name) {
         auto* symbol = this->resolve(name);
         if (!symbol) {
             return nullptr;
@@ -56,25 +64,29 @@ public:
         return cast<T>(symbol);
     }
 
-    void add_symbol(RefPtr<Symbol> symbol) {
-        m_symbols[symbol->name()] = move(symbol);
-    }
-
-    void remove_symbol(const String& name) { m_symbols.erase(name); }
+    void add_symbol(RefPtr<Symbol> symbol);
+    void remove_symbol(Identifier name);
 
     void finalize(bool eliminate_dead_functions = true);
 
 private:
-    Scope(String name, ScopeType type, RefPtr<Scope> parent) : m_name(move(name)), m_type(type), m_parent(move(parent)) {}
+    Scope(Identifier name, ScopeType type, RefPtr<Scope> parent) : m_name(name), m_type(type), m_parent(move(parent)) {}
 
-    String m_name;
+    Identifier m_name;
     ScopeType m_type;
 
     RefPtr<Scope> m_parent;
     Vector<RefPtr<Scope>> m_children;
 
-    HashMap<String, RefPtr<Symbol>> m_symbols;
-    
+    HashMap<Identifier, RefPtr<Symbol>> m_symbols;
+
+    struct CachedSymbol {
+        Symbol* symbol;
+        u32 generation;
+    };
+
+    HashMap<Identifier, CachedSymbol> m_resolved;
+
     Module* m_module = nullptr;
 };
 
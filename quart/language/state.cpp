@@ -1,5 +1,6 @@
 #include <quart/language/state.h>
 #include <quart/parser/parser.h>
+#include <quart/module_loader.h>
 #include <quart/casting.h>
 
 namespace quart {
@@ -7,8 +8,11 @@ namespace quart {
 State::State() : m_constant_evaluator(*this), m_type_checker(*this) {
     m_context = Context::create();
     m_current_scope = m_global_scope = Scope::create({}, ScopeType::Global, nullptr);
+    m_module_loader = make<ModuleLoader>();
 }
 
+State::~State() = default;
+
 void State::dump() const {}
 
 bytecode::Register State::allocate_register() {
@@ -38,7 +42,7 @@ Type* State::type(bytecode::Operand const& operand) const {
     return operand.value_type();
 }
 
-bool State::has_global_function(const String& name) const {
+bool State::has_global_function(Identifier name) const {
     return m_all_functions.contains(name);
 }
 
@@ -46,7 +50,7 @@ void State::add_global_function(RefPtr<Function> function) {
     m_all_functions[function->qualified_name()] = function;
 }
 
-Function const* State::get_global_function(const String& name) const {
+Function const* State::get_global_function(Identifier name) const {
     auto iterator = m_all_functions.find(name);
     if (iterator != m_all_functions.end()) {
         return iterator->second.get();
@@ -55,6 +59,47 @@ Function const* State::get_global_function(const String& name) const {
     return nullptr;
 }
 
+void State::defer_function_body(Function* function, ast::FunctionExpr const& expr) {
+    m_deferred_functions[function] = { &expr, m_current_module, m_current_struct, m_self_type };
+}
+
+void State::reference_function(Function* function) {
+    if (m_deferred_functions.empty()) {
+        return;
+    }
+
+    auto iterator = m_deferred_functions.find(function);
+    if (iterator == m_deferred_functions.end()) {
+        return;
+    }
+
+    m_referenced_functions.emplace_back(function, iterator->second);
+    m_deferred_functions.erase(iterator);
+}
+
+ErrorOr<void> State::generate_deferred_functions() {
+    auto* previous_module = m_current_module;
+    auto* previous_struct = m_current_struct;
+    auto* previous_self_type = m_self_type;
+
+    while (!m_referenced_functions.empty()) {
+        auto [function, deferred] = m_referenced_functions.back();
+        m_referenced_functions.pop_back();
+
+        m_current_module = deferred.module;
+        m_current_struct = deferred.structure;
+        m_self_type = deferred.self_type;
+
+        TRY(deferred.expr->generate_body(*this, function));
+    }
+
+    m_current_module = previous_module;
+    m_current_struct = previous_struct;
+    m_self_type = previous_self_type;
+
+    return {};
+}
+
 void State::add_impl(OwnPtr<Impl> impl) {
     if (impl->is_generic()) {
         m_generic_impls.push_back(move(impl));
@@ -68,11 +113,11 @@ bool State::has_impl(Type* type) {
     return m_impls.contains(type);
 }
 
-bool State::has_global_module(const String& name) const {
+bool State::has_global_module(Identifier name) const {
     return m_modules.contains(name);
 }
 
-RefPtr<Module> State::get_global_module(const String& name) const {
+RefPtr<Module> State::get_global_module(Identifier name) const {
     if (auto iterator = m_modules.find(name); iterator != m_modules.end()) {
         return iterator->second;
     }
@@ -84,7 +129,7 @@ void State::add_global_module(RefPtr<Module> module) {
     m_modules[module->qualified_name()] = move(module);
 }
 
-ErrorOr<RefPtr<Scope>> State::resolve_scope(Span span, Scope& current_scope, const String& name) {
+ErrorOr<RefPtr<Scope>> State::resolve_scope(Span span, Scope& current_scope, Identifier name) {
     auto* symbol = current_scope.resolve(name);
     if (!symbol) {
         return err(span, "namespace '{}' not found", name);
@@ -113,10 +158,10 @@ ErrorOr<RefPtr<Scope>> State::resolve_scope_path(Span span, const Path& path, bo
             return err(span, "Generic arguments are not allowed in this context");
         }
 
-        auto& name = segment.name();
+        StringView name = segment.name();
 
         Span segment_span = { span.start(), span.start() + name.size(), span.source_code_index() };
-        scope = TRY(this->resolve_scope(segment_span, *scope, name));
+        scope = TRY(this->resolve_scope(segment_span, *scope, segment.name()));
 
         span.set_start(segment_span.end() + 2);
     }
@@ -142,7 +187,7 @@ ErrorOr<Symbol*> State::access_symbol(Span span, const Path& path) {
 ErrorOr<bytecode::Register> State::resolve_reference(
     Scope& scope,
     Span span,
-    const String& name,
+    Identifier name,
     bool is_mutable,
     Optional<bytecode::Register> dst,
     bool override_mutability
@@ -169,13 +214,14 @@ ErrorOr<bytecode::Register> State::resolve_reference(
                 emit<bytecode::GetLocalRef>(reg, variable->index());
             }
 
-            if (!variable->is_mutable() && is_mutable) {
+            bool is_assignable = variable->is_mutable() || (m_in_consteval_block && variable->is_constant());
+            if (!is_assignable && is_mutable) {
                 return err(ErrorType::MutabilityMismatch, span, "Cannot take a mutable reference to an immutable variable");
             }
 
             Type* type = variable->value_type();
             if (override_mutability) {
-                this->set_register_state(reg, type->get_reference_to(variable->is_mutable()));
+                this->set_register_state(reg, type->get_reference_to(is_assignable));
             } else {
                 this->set_register_state(reg, type->get_reference_to(is_mutable));
             }
@@ -415,6 +461,7 @@ ErrorOr<bytecode::Register> State::generate_attribute_access(
             return err(parent.span(), "Method '{}' requires a mutable reference to self but self is immutable", method->name());
         }
 
+        this->reference_function(method);
         emit<bytecode::GetFunction>(*dst, method);
         this->set_register_state(*dst, method->underlying_type()->get_pointer_to(), method);
 
@@ -633,8 +680,8 @@ ErrorOr<size_t> State::size_of(ast::Expr const& expr) {
     return {};
 }
 
-HashMap<String, Type*> State::get_struct_generic_impl_arguments(Struct* structure, TraitType* type) const {
-    HashMap<String, Type*> arguments;
+HashMap<Identifier, Type*> State::get_struct_generic_impl_arguments(Struct* structure, TraitType* type) const {
+    HashMap<Identifier, Type*> arguments;
 
     auto trait = this->get_trait(type);
     for (auto& impl : structure->impls()) {
@@ -9,6 +9,8 @@
 
 namespace quart {
 
+class ModuleLoader;
+
 struct RegisterState {
     enum Flags {
         None,
@@ -22,10 +24,19 @@ struct RegisterState {
     u8 flags = 0;
 };
 
+// A function whose body is only generated once something references it, along with what was in effect where it was defined
+struct DeferredFunction {
+    ast::FunctionExpr const* expr;
+
+    Module* module;
+    Struct* structure;
+    Type* self_type;
+};
+
 class State {
 public:
     State();
-    ~State() = default;
+    ~State();
 
     NO_MOVE(State)
     NO_COPY(State)
@@ -58,7 +69,7 @@ public:
     
     Type* self_type() const { return m_self_type; }
 
-    HashMap<String, RefPtr<Function>> const& functions() const { return m_all_functions; }
+    HashMap<Identifier, RefPtr<Function>> const& functions() const { return m_all_functions; }
 
     HashMap<Type*, OwnPtr<Impl>> const& impls() const { return m_impls; }
     Vector<OwnPtr<Impl>> const& generic_impls() const { return m_generic_impls; }
@@ -77,7 +88,7 @@ public:
     void set_self_type(Type* type) { m_self_type = type; }
     void set_type_context(Type* type) { m_type_context = type; }
     
-    ErrorOr<RefPtr<Scope>> resolve_scope(Span, Scope& current_scope, const String& name);
+    ErrorOr<RefPtr<Scope>> resolve_scope(Span, Scope& current_scope, Identifier name);
     ErrorOr<RefPtr<Scope>> resolve_scope_path(Span, const Path&, bool allow_generic_arguments = false);
 
     ErrorOr<Symbol*> access_symbol(Span, const Path&);
@@ -112,12 +123,30 @@ public:
         m_globals.push_back(move(variable));
     }
 
-    bool has_global_function(const String& name) const;
+    bool has_global_function(Identifier name) const;
     void add_global_function(RefPtr<Function> function);
-    Function const* get_global_function(const String& name) const;
+    Function const* get_global_function(Identifier name) const;
+
+    bool has_global_module(Identifier name) const;
+    RefPtr<Module> get_global_module(Identifier name) const;
+
+    ModuleLoader& module_loader() { return *m_module_loader; }
 
-    bool has_global_module(const String& name) const;
-    RefPtr<Module> get_global_module(const String& name) const;
+    // Defers generating the bodies of functions until they're referenced and drops the ones that never are
+    bool lazy_function_bodies() const { return m_lazy_function_bodies; }
+    void set_lazy_function_bodies(bool value) { m_lazy_function_bodies = value; }
+
+    // `consteval` blocks are generated like a function body, but unlike one they're allowed to assign to constants
+    bool in_consteval_block() const { return m_in_consteval_block; }
+    void set_in_consteval_block(bool value) { m_in_consteval_block = value; }
+
+    void defer_function_body(Function*, ast::FunctionExpr const&);
+
+    // Must be called for every function that gets referenced, queues its body for generation if it was deferred
+    void reference_function(Function*);
+
+    // Generates the bodies of referenced functions until no deferred function is referenced anymore
+    ErrorOr<void> generate_deferred_functions();
 
     void add_global_module(RefPtr<Module> module);
 
@@ -146,7 +175,7 @@ public:
 
     ErrorOr<bytecode::Register> resolve_reference(
         Scope&, Span,
-        const String& name,
+        Identifier name,
         bool is_mutable,
         Optional<bytecode::Register> dst = {},
         bool override_mutability = false
@@ -171,13 +200,13 @@ public:
         Optional<bytecode::Register> dst = {}
     );
 
-    fs::Path search_import_paths(const String& name);
+    static fs::Path search_import_paths(const String& name);
 
     Type* get_type_from_builtin(ast::BuiltinType);
 
     ErrorOr<size_t> size_of(ast::Expr const&);
 
-    HashMap<String, Type*> get_struct_generic_impl_arguments(Struct* structure, TraitType* trait) const;
+    HashMap<Identifier, Type*> get_struct_generic_impl_arguments(Struct* structure, TraitType* trait) const;
 
 private:
     bytecode::Generator m_generator;
@@ -201,9 +230,16 @@ private:
 
     Type* m_self_type = nullptr;
 
-    HashMap<String, RefPtr<Function>> m_all_functions;
+    HashMap<Identifier, RefPtr<Function>> m_all_functions;
+
+    bool m_lazy_function_bodies = false;
+    bool m_in_consteval_block = false;
+
+    HashMap<Function*, DeferredFunction> m_deferred_functions;
+    Vector<std::pair<Function*, DeferredFunction>> m_referenced_functions;
 
-    HashMap<String, RefPtr<Module>> m_modules;
+    HashMap<Identifier, RefPtr<Module>> m_modules;
+    OwnPtr<ModuleLoader> m_module_loader;
 
     Vector<RefPtr<Variable>> m_globals;
 
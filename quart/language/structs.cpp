@@ -10,11 +10,11 @@ StructField const* Struct::find(const String& name) const {
     return it == m_fields.end() ? nullptr : &it->second;
 }
 
-bool Struct::has_method(const String& name) const {
+bool Struct::has_method(Identifier name) const {
     return m_scope->resolve<quart::Function>(name) != nullptr;
 }
 
-Function const* Struct::get_method(const String& name) const {
+Function const* Struct::get_method(Identifier name) const {
     return m_scope->resolve<quart::Function>(name);
 }
 
@@ -45,19 +45,19 @@ class Struct : public Symbol {
 public:
     static bool classof(const Symbol* symbol) { return symbol->type() == Symbol::Struct; }
 
-    static RefPtr<Struct> create(String name, StructType* underlying_type, RefPtr<Scope> parent, bool is_public) {
-        return RefPtr<Struct>(new Struct(move(name), underlying_type, move(parent), is_public));
+    static RefPtr<Struct> create(Identifier name, StructType* underlying_type, RefPtr<Scope> parent, bool is_public) {
+        return RefPtr<Struct>(new Struct(name, underlying_type, move(parent), is_public));
     }
 
-    static RefPtr<Struct> create(String name, StructType* underlying_type, HashMap<String, StructField> fields, RefPtr<Scope> scope, bool is_public) {
-        return RefPtr<Struct>(new Struct(move(name), underlying_type, move(fields), move(scope), is_public));
+    static RefPtr<Struct> create(Identifier name, StructType* underlying_type, HashMap<String, StructField> fields, RefPtr<Scope> scope, bool is_public) {
+        return RefPtr<Struct>(new Struct(name, underlying_type, move(fields), move(scope), is_public));
     }
 
-    static RefPtr<Struct> create(String name, StructType* underlying_type, RefPtr<Scope> scope, Vector<GenericTypeParameter> generic_parameters, bool is_public) {
-        return RefPtr<Struct>(new Struct(move(name), underlying_type, move(scope), move(generic_parameters), is_public));
+    static RefPtr<Struct> create(Identifier name, StructType* underlying_type, RefPtr<Scope> scope, Vector<GenericTypeParameter> generic_parameters, bool is_public) {
+        return RefPtr<Struct>(new Struct(name, underlying_type, move(scope), move(generic_parameters), is_public));
     }
 
-    String const& qualified_name() const { return m_qualified_name; }
+    Identifier qualified_name() const { return m_qualified_name; }
     StructType* underlying_type() const { return m_underlying_type; }
     RefPtr<Scope> scope() const { return m_scope; }
     bool opaque() const { return m_opaque; }
@@ -73,8 +73,8 @@ public:
 
     StructField const* find(const String& name) const;
 
-    bool has_method(const String& name) const;
-    class Function const* get_method(const String& name) const;
+    bool has_method(Identifier name) const;
+    class Function const* get_method(Identifier name) const;
 
     Vector<TraitType*> const& impls() const { return m_impl_traits; }
     void add_impl_trait(TraitType* trait) { m_impl_traits.push_back(trait); }
@@ -87,35 +87,35 @@ private:
     void set_qualified_name(RefPtr<Scope> = nullptr);
 
     Struct(
-        String name,
+        Identifier name,
         StructType* underlying_type,
         RefPtr<Scope> parent,
         bool is_public
-    ) : Symbol(move(name), Symbol::Struct, is_public), m_underlying_type(underlying_type), m_opaque(true) {
+    ) : Symbol(name, Symbol::Struct, is_public), m_underlying_type(underlying_type), m_opaque(true) {
         this->set_qualified_name(move(parent));
     }
 
     Struct(
-        String name,
+        Identifier name,
         StructType* underlying_type,
         HashMap<String, StructField> fields,
         RefPtr<Scope> scope,
         bool is_public
-    ) : Symbol(move(name), Symbol::Struct, is_public), m_underlying_type(underlying_type), m_opaque(false), m_fields(move(fields)), m_scope(move(scope)) {
+    ) : Symbol(name, Symbol::Struct, is_public), m_underlying_type(underlying_type), m_opaque(false), m_fields(move(fields)), m_scope(move(scope)) {
         this->set_qualified_name();
     }
 
     Struct(
-        String name,
+        Identifier name,
         StructType* underlying_type,
         RefPtr<Scope> scope,
         Vector<GenericTypeParameter> generic_parameters,
         bool is_public
-    ) : Symbol(move(name), Symbol::Struct, is_public), m_underlying_type(underlying_type), m_opaque(false), m_scope(move(scope)), m_generic_parameters(move(generic_parameters)) {
+    ) : Symbol(name, Symbol::Struct, is_public), m_underlying_type(underlying_type), m_opaque(false), m_scope(move(scope)), m_generic_parameters(move(generic_parameters)) {
         this->set_qualified_name();
     }
     
-    String m_qualified_name;
+    Identifier m_qualified_name;
 
     StructType* m_underlying_type;
 
@@ -19,22 +19,28 @@ StringView Symbol::str() const {
     return {};
 }
 
-String Symbol::parse_qualified_name(const String& name, RefPtr<Scope> scope) {
-    Vector<String> parts;
+Identifier Symbol::parse_qualified_name(Identifier name, RefPtr<Scope> scope) {
+    Vector<Identifier> parts;
     parts.push_back(name);
 
     for (; scope; scope = scope->parent()) {
         if (scope->type() == ScopeType::Global) {
             break;
         } else if (scope->type() == ScopeType::Module) {
-            class Module* module = scope->module();
-            parts.push_back(module->qualified_name());
+            // A module's qualified name already includes every module it's nested in
+            parts.push_back(scope->module()->qualified_name());
+            break;
         } else {
             parts.push_back(scope->name());
         }
     }
 
-    return llvm::join(parts.rbegin(), parts.rend(), "::");
+    Identifier qualified_name = parts.back();
+    for (auto iterator = std::next(parts.rbegin()); iterator != parts.rend(); ++iterator) {
+        qualified_name = Identifier::join(qualified_name, *iterator);
+    }
+
+    return qualified_name;
 }
 
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <quart/common.h>
+#include <quart/identifier.h>
 
 #include <llvm/Support/FormatVariadic.h>
 
@@ -24,12 +25,12 @@ public:
         Trait
     };
 
-    static String parse_qualified_name(const String& name, RefPtr<Scope>);
+    static Identifier parse_qualified_name(Identifier name, RefPtr<Scope>);
 
-    Symbol(String name, SymbolType type, bool is_public) : m_name(move(name)), m_type(type), m_is_public(is_public) {}
+    Symbol(Identifier name, SymbolType type, bool is_public) : m_name(name), m_type(type), m_is_public(is_public) {}
     virtual ~Symbol() = default;
 
-    String const& name() const { return m_name; }
+    Identifier name() const { return m_name; }
     SymbolType type() const { return m_type; }
 
     StringView str() const;
@@ -54,7 +55,7 @@ public:
     void set_module(class Module* module) { m_module = module; }
 
 private:
-    String m_name;
+    Identifier m_name;
     SymbolType m_type;
 
     bool m_is_public = false;
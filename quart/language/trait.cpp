@@ -4,7 +4,7 @@
 
 namespace quart {
 
-Function const* Trait::get_method(const String& name) const {
+Function const* Trait::get_method(Identifier name) const {
     return m_scope->resolve<quart::Function>(name);
 }
 
@@ -17,7 +17,7 @@ ErrorOr<Trait::GenericTraitScope> Trait::create_scope(State& state, const Vector
         return GenericTraitScope { iterator->second.scope, type };
     }
 
-    auto scope = m_scope->clone(name);
+    auto scope = m_scope->clone(Identifier(name));
     size_t index = 0;
 
     for (auto& [name, _] : m_generic_parameters) {
@@ -19,14 +19,14 @@ public:
 
     static bool classof(const Symbol* symbol) { return symbol->type() == Symbol::Trait; }
 
-    static RefPtr<Trait> create(String name, TraitType* type, RefPtr<Scope> scope) {
-        return RefPtr<Trait>(new Trait(move(name), type, move(scope)));
+    static RefPtr<Trait> create(Identifier name, TraitType* type, RefPtr<Scope> scope) {
+        return RefPtr<Trait>(new Trait(name, type, move(scope)));
     }
 
     TraitType* underlying_type() const { return m_underlying_type; }
 
     RefPtr<Scope> scope() const { return m_scope; }
-    HashMap<String, Span> const& generic_parameters() const { return m_generic_parameters; }
+    HashMap<Identifier, Span> const& generic_parameters() const { return m_generic_parameters; }
 
     RefPtr<Scope> resolve_scope(TraitType* type) {
         auto iterator = m_scopes.find(type);
@@ -40,9 +40,9 @@ public:
     Vector<ast::FunctionExpr const*> const& predefined_functions() const { return m_predefined_functions; }
     void add_predefined_function(ast::FunctionExpr const* function) { m_predefined_functions.push_back(function); }
 
-    class Function const* get_method(const String& name) const;
+    class Function const* get_method(Identifier name) const;
 
-    void add_generic_parameter(String name, Span span) { m_generic_parameters.insert({ move(name), span }); }
+    void add_generic_parameter(Identifier name, Span span) { m_generic_parameters.insert({ name, span }); }
     bool has_generic_parameters() const { return !m_generic_parameters.empty(); }
 
     HashMap<Type*, GenericTrait>& scopes() { return m_scopes; }
@@ -54,13 +54,13 @@ public:
 
 private:
     Trait(
-        String name, TraitType* type, RefPtr<Scope> scope
-    ) : Symbol(move(name), Symbol::Trait, false), m_underlying_type(type), m_scope(move(scope)) {}
+        Identifier name, TraitType* type, RefPtr<Scope> scope
+    ) : Symbol(name, Symbol::Trait, false), m_underlying_type(type), m_scope(move(scope)) {}
 
     TraitType* m_underlying_type;
 
     RefPtr<Scope> m_scope;
-    HashMap<String, Span> m_generic_parameters;
+    HashMap<Identifier, Span> m_generic_parameters;
 
     Vector<ast::FunctionExpr const*> m_predefined_functions;
 
@@ -13,12 +13,12 @@ class TypeAlias : public Symbol {
 public:
     static bool classof(Symbol const* symbol) { return symbol->type() == Symbol::TypeAlias; }
 
-    static RefPtr<TypeAlias> create(String name, Type* type, bool is_public) {
-        return RefPtr<TypeAlias>(new TypeAlias(move(name), type, is_public));
+    static RefPtr<TypeAlias> create(Identifier name, Type* type, bool is_public) {
+        return RefPtr<TypeAlias>(new TypeAlias(name, type, is_public));
     }
 
-    static RefPtr<TypeAlias> create(String name, Vector<GenericTypeParameter> parameters, ast::TypeExpr* expr, bool is_public) {
-        return RefPtr<TypeAlias>(new TypeAlias(move(name), move(parameters), expr, is_public));
+    static RefPtr<TypeAlias> create(Identifier name, Vector<GenericTypeParameter> parameters, ast::TypeExpr* expr, bool is_public) {
+        return RefPtr<TypeAlias>(new TypeAlias(name, move(parameters), expr, is_public));
     }
 
     Type* underlying_type() const { return m_underlying_type; }
@@ -36,10 +36,10 @@ public:
     ErrorOr<Type*> evaluate(State&, const Vector<Type*>& args);
 
 private:
-    TypeAlias(String name, Type* type, bool is_public) : Symbol(move(name), Symbol::TypeAlias, is_public), m_underlying_type(type) {}
+    TypeAlias(Identifier name, Type* type, bool is_public) : Symbol(name, Symbol::TypeAlias, is_public), m_underlying_type(type) {}
     TypeAlias(
-        String name, Vector<GenericTypeParameter> parameters, ast::TypeExpr* expr, bool is_public
-    ) : Symbol(move(name), Symbol::TypeAlias, is_public), m_parameters(move(parameters)), m_expr(expr) {}
+        Identifier name, Vector<GenericTypeParameter> parameters, ast::TypeExpr* expr, bool is_public
+    ) : Symbol(name, Symbol::TypeAlias, is_public), m_parameters(move(parameters)), m_expr(expr) {}
 
     Type* m_underlying_type = nullptr;
 
@@ -4,7 +4,7 @@
 
 namespace quart {
 
-ErrorOr<Type*> TypeChecker::resolve_reference(Scope& scope, Span span, const String& name, bool is_mutable) {
+ErrorOr<Type*> TypeChecker::resolve_reference(Scope& scope, Span span, Identifier name, bool is_mutable) {
     auto* symbol = scope.resolve(name);
     if (!symbol) {
         return err(span, "Unknown identifier '{}'", name);
@@ -691,7 +691,8 @@ ErrorOr<Type*> TypeChecker::type_check(ast::FunctionExpr const& expr) {
     m_state.set_current_function(function);
     m_state.set_current_scope(function->scope());
 
-    TRY(this->type_check(expr.body()));
+    auto* body = TRY(expr.parse_body());
+    TRY(this->type_check(*body));
 
     // TODO: Ensure all code paths return
 
@@ -741,7 +742,7 @@ ErrorOr<Type*> TypeChecker::type_check(ast::ContinueExpr const&) {
 ErrorOr<Type*> TypeChecker::type_check(ast::StructExpr const& expr) {
     if (expr.is_opaque()) {
         auto* type = StructType::get(
-            m_state.context(), Symbol::parse_qualified_name(expr.name(), m_state.scope()), {}
+            m_state.context(), String(Symbol::parse_qualified_name(expr.name(), m_state.scope())), {}
         );
 
         auto structure = Struct::create(expr.name(), type, m_state.scope(), expr.is_public());
@@ -751,7 +752,9 @@ ErrorOr<Type*> TypeChecker::type_check(ast::StructExpr const& expr) {
         return {};
     }
 
-    auto* type = StructType::get(m_state.context(), Symbol::parse_qualified_name(expr.name(), m_state.scope()), {});
+    auto* type = StructType::get(m_state.context(), String(Symbol::parse_qualified_name(expr.name(), m_state.scope())), {});
+    type->set_packed(expr.attributes().has(Attribute::Packed));
+
     auto scope = Scope::create(expr.name(), ScopeType::Struct, m_state.scope());
 
     auto structure = Struct::create(expr.name(), type, {}, scope, expr.is_public());
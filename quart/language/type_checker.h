@@ -19,7 +19,7 @@ public:
 
 private:
 
-    ErrorOr<Type*> resolve_reference(Scope& scope, Span span, const String& name, bool is_mutable);
+    ErrorOr<Type*> resolve_reference(Scope& scope, Span span, Identifier name, bool is_mutable);
     ErrorOr<Type*> resolve_reference(ast::Expr const& expr, bool is_mutable = false);
 
     ErrorOr<Type*> type_check_attribute_access(ast::AttributeExpr const& expr, bool as_reference, bool as_mutable);
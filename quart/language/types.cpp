@@ -1,5 +1,6 @@
 #include <quart/language/types.h>
 #include <quart/language/context.h>
+#include <quart/language/data_layout.h>
 #include <quart/language/structs.h>
 #include <quart/format.h>
 #include <quart/casting.h>
@@ -148,7 +149,7 @@ Type* Type::get_struct_field_at(size_t index) const {
     return cast<StructType>(this)->get_field_at(index);
 }
 
-String const& Type::get_struct_name() const {
+StringView Type::get_struct_name() const {
     auto* type = cast<StructType>(this);
     auto* decl = type->decl();
 
@@ -227,7 +228,7 @@ String Type::str() const {
             return format("{}{}", is_unsigned ? "u" : "i", bits);
         }
         case TypeKind::Enum: return this->get_enum_name();
-        case TypeKind::Struct: return this->get_struct_name();
+        case TypeKind::Struct: return String(this->get_struct_name());
         case TypeKind::Array: {
             String element = this->get_array_element_type()->str();
             size_t size = this->get_array_size();
@@ -303,7 +304,7 @@ llvm::Type* Type::to_llvm_type(llvm::LLVMContext& context) const {
                 fields.push_back(field->to_llvm_type(context));
             }
 
-            return llvm::StructType::get(context, fields);
+            return llvm::StructType::get(context, fields, type->is_packed());
         }
         case TypeKind::Array: {
             const auto* type = cast_unchecked<ArrayType>(this);
@@ -348,42 +349,12 @@ llvm::Type* Type::to_llvm_type(llvm::LLVMContext& context) const {
     }
 }
 
-size_t Type::size() const {
-    switch (this->kind()) {
-        case TypeKind::Float:
-            return 4;
-        case TypeKind::Double:
-            return 8;
-        case TypeKind::Int:
-            return this->get_int_bit_width() / 8;
-        case TypeKind::Enum:
-            return this->get_inner_enum_type()->size();
-        case TypeKind::Struct: {
-            size_t size = 0;
-            for (auto& field : this->get_struct_fields()) {
-                size += field->size();
-            }
-
-            return size;
-        }
-        case TypeKind::Array: {
-            return this->get_array_element_type()->size() * this->get_array_size();
-        }
-        case TypeKind::Tuple: {
-            size_t size = 0;
-            for (auto& type : this->get_tuple_types()) {
-                size += type->size();
-            }
-
-            return size;
-        }
-        case TypeKind::Pointer:
-        case TypeKind::Reference: // FIXME: Use Target::word_size()
-            return 8;
-        default: break;
-    }
+TypeLayout const& Type::layout() const {
+    return m_context->data_layout().layout_of(this);
+}
 
-    return 0;
+size_t Type::offset_of(size_t index) const {
+    return m_context->data_layout().offset_of(this, index);
 }
 
 IntType* IntType::get(Context& context, u32 bit_width, bool is_unsigned) {
@@ -426,10 +397,17 @@ EmptyType* EmptyType::get(Context& context, const String& name) {
     return context.create_empty_type(name);
 }
 
+// Layouts of other aggregates containing this struct are cached as well, so the fields can't change once it has been laid out
 void StructType::set_fields(const Vector<Type*>& fields) {
+    ASSERT(!m_layout, "Struct fields can't change after its layout has been computed");
     m_fields = fields;
 }
 
+void StructType::set_packed(bool is_packed) {
+    ASSERT(!m_layout, "Struct can't be packed after its layout has been computed");
+    m_is_packed = is_packed;
+}
+
 PointerType* PointerType::as_const() {
     if (!this->is_mutable()) {
         return this;
@@ -12,10 +12,20 @@ class Struct;
 class Function;
 
 class Context;
+class DataLayout;
 
 class PointerType;
 class ReferenceType;
 
+// Computed by `DataLayout`, see `Type::layout()`
+struct TypeLayout {
+    size_t size = 0;
+    size_t alignment = 1;
+
+    // Byte offsets of the fields of a struct or the elements of a tuple
+    Vector<size_t> offsets;
+};
+
 enum class TypeKind : u8 {
     Void,
     Int,
@@ -83,7 +93,7 @@ public:
 
     Vector<Type*> const& get_struct_fields() const;
     Type* get_struct_field_at(size_t index) const;
-    String const& get_struct_name() const;
+    StringView get_struct_name() const;
 
     Type* get_array_element_type() const;
     size_t get_array_size() const;
@@ -104,7 +114,14 @@ public:
 
     String const& get_empty_name() const;
 
-    size_t size() const;
+    // The layout the target's data layout gives this type, computed once and cached on the type
+    TypeLayout const& layout() const;
+
+    size_t size() const { return this->layout().size; }
+    size_t alignment() const { return this->layout().alignment; }
+
+    // The byte offset of the field or element at `index` of a struct or tuple
+    size_t offset_of(size_t index) const;
 
     String str() const;
 
@@ -113,10 +130,14 @@ public:
     llvm::Type* to_llvm_type(llvm::LLVMContext&) const;
 
     friend Context;
+    friend DataLayout;
 protected:
     Type(Context* context, TypeKind kind) : m_context(context), m_kind(kind) {}
     
     Context* m_context; // NOLINT
+
+    // Has to be reset whenever anything that affects the layout changes
+    mutable OwnPtr<TypeLayout> m_layout; // NOLINT
 private:
     TypeKind m_kind;
 };
@@ -169,9 +190,13 @@ public:
         return m_fields[index];
     }
 
+    bool is_packed() const { return m_is_packed; }
+
     void set_fields(const Vector<Type*>& fields);
     void set_decl(Struct* decl) { m_decl = decl; }
 
+    void set_packed(bool is_packed);
+
     friend Context;
 private:
     StructType(
@@ -185,6 +210,7 @@ private:
     Vector<Type*> m_fields;
 
     Struct* m_decl;
+    bool m_is_packed = false;
 };
 
 class ArrayType : public Type {
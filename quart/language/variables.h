@@ -25,8 +25,8 @@ public:
         Global    = 1 << 6
     };
 
-    static RefPtr<Variable> create(String name, size_t index, Type* type, u8 flags = None) {
-        return RefPtr<Variable>(new Variable(move(name), index, type, flags));
+    static RefPtr<Variable> create(Identifier name, size_t index, Type* type, u8 flags = None) {
+        return RefPtr<Variable>(new Variable(name, index, type, flags));
     }
 
     u8 flags() const { return m_flags; }
@@ -50,8 +50,8 @@ public:
 
 private:
     Variable(
-        String name, size_t index, Type* type, u8 flags = None
-    ) : Symbol(move(name), Symbol::Variable, flags & Public), m_index(index), m_type(type), m_flags(flags) {}
+        Identifier name, size_t index, Type* type, u8 flags = None
+    ) : Symbol(name, Symbol::Variable, flags & Public), m_index(index), m_type(type), m_flags(flags) {}
 
     void set_used(bool used) { m_flags = used ? m_flags | Used : m_flags & ~Used; }
     void set_mutated(bool mutated) { m_flags = mutated ? m_flags | Mutated : m_flags & ~Mutated; }
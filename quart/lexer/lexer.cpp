@@ -1,10 +1,11 @@
 #include <quart/lexer/lexer.h>
+#include <quart/scan.h>
 
 #include <cctype>
 
 namespace quart {
 
-static const std::map<char, TokenKind> SINGLE_CHAR_TOKENS = {
+static const HashMap<char, TokenKind> SINGLE_CHAR_TOKENS = {
     {'~', TokenKind::BinaryNot},
     {'(', TokenKind::LParen},
     {')', TokenKind::RParen},
@@ -57,50 +58,59 @@ bool Lexer::is_valid_identifier(char c) {
     return std::isalnum(c) || c == '_';
 }
 
-size_t Lexer::lex_while(String& buffer, const std::function<bool(char)>& predicate) {
-    size_t n = 0;
+StringView Lexer::lex_while(const std::function<bool(char)>& predicate) {
+    size_t start = m_offset - 1;
     while (predicate(m_current)) {
-        buffer.push_back(m_current);
         this->next();
-
-        n++;
     }
 
-    return n;
+    return m_code.substr(start, m_offset - 1 - start);
 }
 
 Token Lexer::lex_identifier(bool allow_keywords) {
-    String value;
     size_t start = m_offset;
+    size_t end = scan::skip_identifier(m_code, start - 1);
 
-    this->lex_while(
-        value,
-        [this](char c) { return this->is_valid_identifier(c); }
-    );
+    this->seek(end);
+    StringView value = m_code.substr(start - 1, end - start + 1);
 
     Span span = { start, m_offset, m_source_code->index() };
     if (is_keyword(value) && allow_keywords) {
-        return Token { get_keyword_kind(value), move(value), span };
+        return Token { get_keyword_kind(value), value, span };
     }
 
-    return Token { TokenKind::Identifier, move(value), span };
+    return Token { Identifier(value), value, span };
 }
 
 ErrorOr<Token> Lexer::lex_string() {
-    String value;
     size_t start = m_offset;
 
     if (m_current == '\'') {
         char c = TRY(this->espace_next());
         this->skip(2);
 
-        value.push_back(c);
-        return Token { TokenKind::Char, move(value), { start, m_offset, m_source_code->index() } };
+        // Unescaped characters can point straight into the source code
+        StringView value = m_code.substr(start, 1);
+        if (value[0] == '\\') {
+            value = m_source_code->own(String(1, c));
+        }
+
+        return Token { TokenKind::Char, value, { start, m_offset, m_source_code->index() } };
     }
 
+    // Only strings that contain escape sequences need a separate buffer, everything else is a view into the source code
+    Optional<String> escaped;
+
     char next = this->next();
     while (next && next != '"') {
-        value.push_back(TRY(this->escape(m_current)));
+        if (m_current == '\\' && !escaped.has_value()) {
+            escaped = String(m_code.substr(start, m_offset - 1 - start));
+        }
+
+        if (escaped.has_value()) {
+            escaped->push_back(TRY(this->escape(m_current)));
+        }
+
         next = this->next();
     }
 
@@ -108,31 +118,37 @@ ErrorOr<Token> Lexer::lex_string() {
         return err({ m_offset, m_offset, m_source_code->index() }, "Expected end of string");
     }
 
+    StringView value = m_code.substr(start, m_offset - 1 - start);
+    if (escaped.has_value()) {
+        value = m_source_code->own(move(*escaped));
+    }
+
     this->next();
-    return Token { TokenKind::String, move(value), { start, m_offset, m_source_code->index() } };
+    return Token { TokenKind::String, value, { start, m_offset, m_source_code->index() } };
 }
 
 ErrorOr<Token> Lexer::lex_number() {
-    String value;
     size_t start = m_offset;
 
-    value.push_back(m_current);
+    char first = m_current;
+    char last = m_current;
 
     char next = this->next();
+
     bool is_float = false;
+    bool has_separators = false;
 
-    if (value == "0") {
+    if (first == '0') {
         if (next == 'x' || next == 'b') {
-            value.push_back(next);
             this->next();
 
             if (next == 'x') {
-                this->lex_while(value, isxdigit);
+                this->lex_while(isxdigit);
             } else {
-                this->lex_while(value, [](char c) { return c == '0' || c == '1'; });
+                this->lex_while([](char c) { return c == '0' || c == '1'; });
             }
 
-            return Token { TokenKind::Integer, move(value), { start, m_offset, m_source_code->index() } };
+            return Token { TokenKind::Integer, m_code.substr(start - 1, m_offset - start), { start, m_offset, m_source_code->index() } };
         }
     
         if (m_current != '.') {
@@ -140,7 +156,7 @@ ErrorOr<Token> Lexer::lex_number() {
                 return err({ start, m_offset, m_source_code->index() }, "Leading zeros on integer literals are not allowed");
             }
 
-            return Token { TokenKind::Integer, move(value), { start, m_offset, m_source_code->index() } };
+            return Token { TokenKind::Integer, m_code.substr(start - 1, 1), { start, m_offset, m_source_code->index() } };
         }
 
         is_float = true;
@@ -148,7 +164,7 @@ ErrorOr<Token> Lexer::lex_number() {
 
         if (m_current == '.') {
             this->rewind(2);
-            return Token { TokenKind::Integer, move(value), { start, m_offset, m_source_code->index() } };
+            return Token { TokenKind::Integer, m_code.substr(start - 1, 1), { start, m_offset, m_source_code->index() } };
         }
     }
 
@@ -164,26 +180,34 @@ ErrorOr<Token> Lexer::lex_number() {
                 return err({ start, m_offset, m_source_code->index() }, "Invalid integer literal");
             }
 
+            has_separators = true;
             next = this->next();
+
             continue;
         }
 
-        value.push_back(next);
+        last = next;
         next = this->next();
     }
 
-    if (value.back() == '.' && m_current == '.') {
+    if (last == '.' && m_current == '.') {
         this->rewind(2);
-        value.pop_back();
-
         is_float = false;
     }
 
+    StringView value = m_code.substr(start - 1, m_offset - start);
+    if (has_separators) {
+        String digits;
+        std::ranges::copy_if(value, std::back_inserter(digits), [](char c) { return c != '_'; });
+
+        value = m_source_code->own(move(digits));
+    }
+
     Span span = { start, m_offset, m_source_code->index() };
     if (is_float) {
-        return Token { TokenKind::Float, move(value), span }; 
+        return Token { TokenKind::Float, value, span }; 
     } else {
-        return Token { TokenKind::Integer, move(value), span }; 
+        return Token { TokenKind::Integer, value, span }; 
     }
 }
 
@@ -194,12 +218,9 @@ Optional<Token> Lexer::expect(char prev, ExpectedToken expected) {
 
     auto _ = this->next(); // FIXME: Handle the Error
 
-    String value;
-
-    value.push_back(prev);
-    value.push_back(expected.c);
-
-    return Token { expected.kind, move(value), { m_offset, m_offset, m_source_code->index() } };
+    // Both characters are behind us now, `m_current` being the one after them
+    StringView value = m_code.substr(m_offset - 3, 2);
+    return Token { expected.kind, value, { m_offset, m_offset, m_source_code->index() } };
 }
 
 ErrorOr<Token> Lexer::once() {
@@ -211,10 +232,9 @@ ErrorOr<Token> Lexer::once() {
         return this->lex_identifier();
     } else if (SINGLE_CHAR_TOKENS.find(m_current) != SINGLE_CHAR_TOKENS.end()) {
         TokenKind kind = SINGLE_CHAR_TOKENS.at(m_current);
-        char c = m_current;
         
         this->next();
-        return Token { kind, String(1, c), { start, start, m_source_code->index() } };
+        return Token { kind, m_code.substr(start - 1, 1), { start, start, m_source_code->index() } };
     }
 
     switch (m_current) {
@@ -349,36 +369,28 @@ ErrorOr<Token> Lexer::once() {
 
 void Lexer::single_line_comment() {
     this->skip(2);
-    while (m_current != '\n' && m_current != '\0') {
-        this->next();
-    }
+    this->seek(scan::find_line_end(m_code, m_offset - 1));
 }
 
 void Lexer::multi_line_comment() {
     this->skip(2);
-    while (true) {
-        if (m_current == '\0') {
-            break;
-        }
-
-        if (m_current == '*' && this->peek() == '/') {
-            this->skip(2);
-            break;
-        }
 
-        this->next();
+    size_t end = scan::find_comment_end(m_code, m_offset - 1);
+    if (end < m_code.size() && m_code[end] == '*') {
+        end += 2;
     }
+
+    this->seek(end);
 }
 
-ErrorOr<Vector<Token>> Lexer::lex() {
-    Vector<Token> tokens;
+ErrorOr<Token> Lexer::next_token() {
     while (!m_eof) {
         if (m_current == '\0') {
             break;
         }
 
         if (std::isspace(m_current)) {
-            this->next();
+            this->seek(scan::skip_whitespace(m_code, m_offset - 1));
             continue;
         }
         
@@ -392,11 +404,22 @@ ErrorOr<Vector<Token>> Lexer::lex() {
             }
         }
 
-        tokens.push_back(TRY(this->once()));
+        return this->once();
     }
 
-    Token eof = { TokenKind::EOS, {}, { m_offset, m_offset, m_source_code->index() } };
-    tokens.push_back(eof);
+    return Token { TokenKind::EOS, {}, { m_offset, m_offset, m_source_code->index() } };
+}
+
+ErrorOr<Vector<Token>> Lexer::lex() {
+    Vector<Token> tokens;
+    while (true) {
+        Token token = TRY(this->next_token());
+        tokens.push_back(token);
+
+        if (token.is(TokenKind::EOS)) {
+            break;
+        }
+    }
 
     return tokens;
 }
@@ -413,6 +436,12 @@ char Lexer::next() {
     return m_current;
 }
 
+void Lexer::seek(size_t index) {
+    // `m_offset` always points one past the current character
+    m_offset = index;
+    this->next();
+}
+
 void Lexer::skip(size_t n) {
     for (size_t i = 0; i < n; i++) {
         this->next();
@@ -32,6 +32,9 @@ public:
     char peek(u32 offset = 0);
     char rewind(u32 offset = 1);
 
+    // Moves the lexer so that the character at `index` becomes the current one
+    void seek(size_t index);
+
     Optional<Token> expect(char prev, ExpectedToken);
 
     template<typename ...Args> requires(of_type_v<ExpectedToken, Args...>)
@@ -44,10 +47,8 @@ public:
         return option.value();
     }
 
-    size_t lex_while(
-        String& buffer,
-        const std::function<bool(char)>& predicate
-    );
+    // Consumes characters while `predicate` holds and returns a view of them into the source code
+    StringView lex_while(const std::function<bool(char)>& predicate);
 
     ErrorOr<char> escape(char current);
     ErrorOr<char> espace_next();
@@ -62,6 +63,10 @@ public:
     void multi_line_comment();
 
     ErrorOr<Token> once();
+
+    // Skips whitespace and comments and lexes the next token, returns an EOS token once the end of the source code is reached
+    ErrorOr<Token> next_token();
+
     ErrorOr<Vector<Token>> lex();
 
 private:
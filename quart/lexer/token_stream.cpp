@@ -0,0 +1,49 @@
+#include <quart/lexer/token_stream.h>
+#include <quart/assert.h>
+
+namespace quart {
+
+TokenStream::TokenStream(Lexer lexer) : m_lexer(move(lexer)) {
+    this->fill(0);
+}
+
+void TokenStream::fill(size_t offset) const {
+    ASSERT(offset <= MAX_LOOKAHEAD, "Lookahead is larger than the token window");
+
+    while (!m_finished && m_end <= m_position + offset) {
+        auto result = m_lexer.next_token();
+        if (result.is_err()) {
+            Span span = result.error().span();
+
+            m_error = result.release_error();
+            at(m_end) = Token { TokenKind::EOS, {}, span };
+        } else {
+            at(m_end) = result.release_value();
+        }
+
+        m_finished = at(m_end).is(TokenKind::EOS);
+        m_end++;
+    }
+}
+
+Token const& TokenStream::peek(size_t offset) const {
+    this->fill(offset);
+    return at(std::min(m_position + offset, m_end - 1));
+}
+
+Token const& TokenStream::previous() const {
+    if (m_position == 0) {
+        return at(0);
+    }
+
+    return at(m_position - 1);
+}
+
+void TokenStream::advance() {
+    this->fill(1);
+    if (m_position + 1 < m_end) {
+        m_position++;
+    }
+}
+
+}
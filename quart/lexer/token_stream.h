@@ -0,0 +1,43 @@
+#pragma once
+
+#include <quart/lexer/lexer.h>
+
+namespace quart {
+
+// Pulls tokens out of a `Lexer` on demand, keeping only a small window of them around.
+// The window holds the previous token, the current one and up to `MAX_LOOKAHEAD` tokens after it,
+// so memory usage doesn't depend on the size of the source code being parsed.
+class TokenStream {
+public:
+    static constexpr size_t WINDOW_SIZE = 8; // Must be a power of two
+    static constexpr size_t MAX_LOOKAHEAD = WINDOW_SIZE - 2;
+
+    TokenStream(Lexer lexer);
+
+    // Returns the token `offset` tokens after the current one, or the EOS token if the stream ends before that.
+    Token const& peek(size_t offset = 0) const;
+
+    // Returns the token before the current one or the first token if there's none.
+    Token const& previous() const;
+
+    void advance();
+
+    // The first error produced by the lexer. Once the lexer fails, the stream ends with an EOS token at the error location.
+    Optional<Error> const& error() const { return m_error; }
+
+private:
+    void fill(size_t offset) const;
+
+    Token& at(size_t index) const { return m_window[index & (WINDOW_SIZE - 1)]; }
+
+    mutable Lexer m_lexer;
+    mutable Array<Token, WINDOW_SIZE> m_window;
+
+    size_t m_position = 0;     // Absolute index of the current token
+    mutable size_t m_end = 0;  // Absolute index one past the last token pulled out of the lexer
+
+    mutable bool m_finished = false;
+    mutable Optional<Error> m_error;
+};
+
+}
@@ -1,11 +1,11 @@
 #pragma once
 
 #include <quart/source_code.h>
+#include <quart/identifier.h>
 
 #include <vector>
 #include <iostream>
 #include <string>
-#include <map>
 #include <algorithm>
 
 #define ENUMERATE_BINARY_OPS(OP) \
@@ -196,10 +196,17 @@ StringView token_kind_to_str(TokenKind);
 class Token {
 public:
     Token() = default;
-    Token(TokenKind kind, String value, Span span) : m_kind(kind), m_value(move(value)), m_span(span) {}
+    Token(TokenKind kind, StringView value, Span span) : m_kind(kind), m_value(value), m_span(span) {}
+    Token(Identifier identifier, StringView value, Span span) : m_kind(TokenKind::Identifier), m_identifier(identifier), m_value(value), m_span(span) {}
 
     TokenKind kind() const { return m_kind; }
-    String const& value() const { return m_value; }
+
+    // Points either into the source code buffer or into the owning `SourceCode`'s string table
+    // for values that had to be rewritten by the lexer (escape sequences, digit separators).
+    StringView value() const { return m_value; }
+
+    // The interned `value()` of identifier tokens, empty for every other kind
+    Identifier identifier() const { return m_identifier; }
 
     Span span() const { return m_span; }
 
@@ -218,12 +225,14 @@ public:
 
 private:
     TokenKind m_kind = TokenKind::None;
-    String m_value;
+    Identifier m_identifier;
+
+    StringView m_value;
 
     Span m_span;
 };
 
-static const std::map<StringView, TokenKind> KEYWORDS = {
+static const HashMap<StringView, TokenKind> KEYWORDS = {
     { "extern", TokenKind::Extern },
     { "func", TokenKind::Func },
     { "return", TokenKind::Return },
@@ -264,7 +273,7 @@ static const std::map<StringView, TokenKind> KEYWORDS = {
     { "async", TokenKind::Async }
 };
 
-static const std::map<TokenKind, u8> PRECEDENCES = {
+static const HashMap<TokenKind, u8> PRECEDENCES = {
     { TokenKind::Assign, 5 },
     { TokenKind::LogicalAnd, 10 },
     { TokenKind::LogicalOr, 10 },
@@ -290,7 +299,7 @@ static const std::map<TokenKind, u8> PRECEDENCES = {
     { TokenKind::Mul, 40 } 
 };
 
-static const std::map<TokenKind, UnaryOp> UNARY_OPS = {
+static const HashMap<TokenKind, UnaryOp> UNARY_OPS = {
     { TokenKind::Not, UnaryOp::Not   },
     { TokenKind::Add, UnaryOp::Add   },
     { TokenKind::Sub, UnaryOp::Neg   },
@@ -301,7 +310,7 @@ static const std::map<TokenKind, UnaryOp> UNARY_OPS = {
     { TokenKind::BinaryNot, UnaryOp::BinaryNeg }
 };
 
-static const std::map<TokenKind, BinaryOp> BINARY_OPS = {
+static const HashMap<TokenKind, BinaryOp> BINARY_OPS = {
     { TokenKind::Add, BinaryOp::Add },
     { TokenKind::Sub, BinaryOp::Sub },
     { TokenKind::Mul, BinaryOp::Mul },
@@ -327,7 +336,7 @@ static const std::map<TokenKind, BinaryOp> BINARY_OPS = {
     { TokenKind::IDiv, BinaryOp::Div }
 };
 
-static const std::map<TokenKind, BinaryOp> INPLACE_OPERATORS {
+static const HashMap<TokenKind, BinaryOp> INPLACE_OPERATORS {
     { TokenKind::IAdd, BinaryOp::Add },
     { TokenKind::ISub, BinaryOp::Sub },
     { TokenKind::IMul, BinaryOp::Mul },
@@ -35,6 +35,7 @@ int main(int argc, char** argv) {
         .library_names = args.library_names,
         .library_paths = args.library_paths,
         .imports = {},
+        .cache_dir = args.cache_dir,
         .format = args.format,
         .opts = OptimizationOptions {
             .level = args.optimization_level,
@@ -42,11 +43,19 @@ int main(int argc, char** argv) {
         },
         .verbose = args.verbose,
         .no_libc = args.no_libc,
+        .jit = args.jit,
+        .lazy_function_bodies = args.lazy_function_bodies,
+        .dump_bytecode = args.dump_bytecode,
+        .threads = args.threads,
         .object_files = {},
         .extras = {}
     };
 
     Compiler compiler(move(options));
+    if (args.run) {
+        return compiler.run();
+    }
+
     if (args.verbose) {
         compiler.dump();
     }
@@ -0,0 +1,135 @@
+#include <quart/module_cache.h>
+#include <quart/parser/serialization.h>
+#include <quart/target.h>
+
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/xxhash.h>
+
+#include <cstdio>
+#include <thread>
+
+namespace quart {
+
+struct CacheHeader {
+    u32 magic;
+    u32 version;
+
+    u64 fingerprint;
+    u64 source_hash;
+    u64 payload_hash;
+};
+
+// Identifies the running compiler binary and the build target, either of them changing invalidates every entry.
+static u64 compiler_fingerprint() {
+    String fingerprint = std::format("{}:{}", ast::SERIALIZATION_FORMAT_VERSION, Target::build().triple().str());
+
+#if !(_WIN32 || _WIN64)
+    int err = 0;
+    struct stat buffer = fs::Path("/proc/self/exe").stat(err);
+
+    if (!err) {
+        fingerprint.append(std::format(":{}:{}", buffer.st_size, buffer.st_mtime));
+    }
+#endif
+
+    return ModuleCache::hash(fingerprint);
+}
+
+OwnPtr<ModuleCache> ModuleCache::create(fs::Path directory) {
+    if (llvm::sys::fs::create_directories(String(directory))) {
+        return nullptr;
+    }
+
+    return OwnPtr<ModuleCache>(new ModuleCache(move(directory), compiler_fingerprint()));
+}
+
+fs::Path ModuleCache::default_directory() {
+    fs::Path directory = fs::Path::from_env("XDG_CACHE_HOME");
+    if (!directory.empty()) {
+        return directory / "quart";
+    }
+
+    directory = fs::Path::from_env("HOME");
+    if (directory.empty()) {
+        return {};
+    }
+
+    return directory / ".cache" / "quart";
+}
+
+u64 ModuleCache::hash(StringView code) {
+    return llvm::xxh3_64bits(code);
+}
+
+fs::Path ModuleCache::path_for(u64 hash) const {
+    return m_directory / std::format("{:016x}.qast", hash ^ m_fingerprint);
+}
+
+Optional<ParsedModule> ModuleCache::load(SourceCode const& source_code, u64 hash) const {
+    auto file = fs::MappedFile::create(this->path_for(hash));
+    if (!file || file->size() < sizeof(CacheHeader)) {
+        return {};
+    }
+
+    StringView data = file->data();
+
+    CacheHeader header = {};
+    std::memcpy(&header, data.data(), sizeof(CacheHeader));
+
+    if (header.magic != MAGIC || header.version != ast::SERIALIZATION_FORMAT_VERSION) {
+        return {};
+    } else if (header.fingerprint != m_fingerprint || header.source_hash != hash) {
+        return {};
+    }
+
+    StringView payload = data.substr(sizeof(CacheHeader));
+    if (ModuleCache::hash(payload) != header.payload_hash) {
+        return {};
+    }
+
+    auto arena = ast::Arena::create();
+    auto ast = ast::deserialize(payload, *arena, source_code.index());
+
+    if (!ast.has_value()) {
+        return {};
+    }
+
+    return ParsedModule { move(arena), move(*ast) };
+}
+
+void ModuleCache::store(u64 hash, ExprList<> const& ast) const {
+    String payload = ast::serialize(ast);
+    CacheHeader header = {
+        .magic = MAGIC,
+        .version = ast::SERIALIZATION_FORMAT_VERSION,
+        .fingerprint = m_fingerprint,
+        .source_hash = hash,
+        .payload_hash = ModuleCache::hash(payload)
+    };
+
+    String path = this->path_for(hash);
+
+    // Write to a temporary file first and then move it into place, so concurrent compilers never see a partial entry
+    String temporary = std::format(
+        "{}.{}.{}.tmp", path, llvm::sys::Process::getProcessId(), std::hash<std::thread::id>()(std::this_thread::get_id())
+    );
+    {
+        std::ofstream stream(temporary, std::ios::binary);
+        stream.write(reinterpret_cast<char const*>(&header), sizeof(CacheHeader));
+        stream.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+
+        if (!stream) {
+            stream.close();
+            std::remove(temporary.c_str());
+
+            return;
+        }
+    }
+
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+    }
+}
+
+}
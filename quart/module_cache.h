@@ -0,0 +1,34 @@
+#pragma once
+
+#include <quart/parser/parser.h>
+
+namespace quart {
+
+// Stores serialized ASTs on disk so modules whose source didn't change since the last compile don't have to be
+// lexed and parsed again. Entries are keyed by a hash of the source code and are only valid for the same compiler
+// binary and build target, since both the encoding and what the parser produces depend on them.
+class ModuleCache {
+public:
+    static constexpr u32 MAGIC = 0x54534151; // "QAST"
+
+    // Returns nullptr if `directory` doesn't exist and can't be created
+    static OwnPtr<ModuleCache> create(fs::Path directory);
+
+    // `$XDG_CACHE_HOME/quart` or `~/.cache/quart`, empty if neither variable is set
+    static fs::Path default_directory();
+
+    static u64 hash(StringView code);
+
+    Optional<ParsedModule> load(SourceCode const& source_code, u64 hash) const;
+    void store(u64 hash, ExprList<> const& ast) const;
+
+private:
+    ModuleCache(fs::Path directory, u64 fingerprint) : m_directory(move(directory)), m_fingerprint(fingerprint) {}
+
+    fs::Path path_for(u64 hash) const;
+
+    fs::Path m_directory;
+    u64 m_fingerprint;
+};
+
+}
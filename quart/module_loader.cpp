@@ -0,0 +1,156 @@
+#include <quart/module_loader.h>
+#include <quart/language/state.h>
+#include <quart/casting.h>
+
+namespace quart {
+
+ModuleLoader::~ModuleLoader() {
+    // Tasks that are still running write into `m_entries`
+    if (m_pool) {
+        m_pool->wait();
+    }
+}
+
+// Mirrors the lookup done by `ImportExpr::generate`
+fs::Path ModuleLoader::resolve(ast::ImportExpr const& expr) {
+    auto& path = expr.path();
+
+    String fullpath = {};
+    for (auto& segment : path.segments()) {
+        if (segment.has_generic_arguments()) {
+            return {};
+        }
+
+        fullpath.append(segment.name());
+        fs::Path dir(fullpath);
+
+        if (!dir.exists()) {
+            dir = State::search_import_paths(fullpath);
+            if (dir.empty()) {
+                return {};
+            }
+
+            fullpath = fullpath.substr(0, fullpath.size() - segment.name().str().size()) + String(dir);
+        }
+
+        if (!dir.is_dir()) {
+            return {};
+        }
+
+        fullpath.push_back('/');
+    }
+
+    fs::Path file = fs::Path(fullpath + String(path.name()) + FILE_EXTENSION);
+    if (file.exists()) {
+        return file;
+    }
+
+    fs::Path dir = file.with_extension();
+    if (!dir.exists()) {
+        dir = State::search_import_paths(dir);
+        if (dir.empty()) {
+            return {};
+        }
+    }
+
+    if (!dir.is_dir()) {
+        return {};
+    }
+
+    file = dir.join("module.qr");
+    return file.exists() ? file : fs::Path();
+}
+
+ErrorOr<ParsedModule> ModuleLoader::parse(fs::Path const& path) {
+    auto source_code = SourceCode::from_path(path);
+
+    u64 hash = 0;
+    if (m_cache) {
+        hash = ModuleCache::hash(source_code->code());
+        if (auto cached = m_cache->load(*source_code, hash)) {
+            return move(*cached);
+        }
+    }
+
+    Lexer lexer(source_code);
+    Parser parser(move(lexer));
+
+    parser.set_lazy_function_bodies(m_lazy_function_bodies);
+
+    auto parsed = TRY(parser.parse());
+    if (m_cache) {
+        m_cache->store(hash, parsed.ast);
+    }
+
+    return parsed;
+}
+
+void ModuleLoader::prefetch(ExprList<> const& ast) {
+    for (auto& expr : ast) {
+        if (auto* import = cast<ast::ImportExpr>(expr)) {
+            fs::Path path = ModuleLoader::resolve(*import);
+            if (!path.empty()) {
+                this->submit(move(path));
+            }
+        } else if (auto* module = cast<ast::ModuleExpr>(expr)) {
+            this->prefetch(module->body());
+        }
+    }
+}
+
+void ModuleLoader::submit(fs::Path path) {
+    String key = path.resolve();
+    if (key.empty()) {
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        if (!m_entries.try_emplace(key).second) {
+            return;
+        }
+
+        if (!m_pool) {
+            m_pool = make<ThreadPool>();
+        }
+    }
+
+    m_pool->submit([this, key = move(key), path = move(path)] {
+        auto result = this->parse(path);
+
+        // Queue up the imports before publishing the result, the AST must not be touched once `load` can hand it out
+        if (result.is_ok()) {
+            this->prefetch(result.value().ast);
+        }
+
+        {
+            std::lock_guard lock(m_mutex);
+            auto& entry = m_entries[key];
+
+            entry.result = move(result);
+            entry.is_done = true;
+        }
+
+        m_done.notify_all();
+    });
+}
+
+ErrorOr<ParsedModule> ModuleLoader::load(fs::Path const& path) {
+    String key = path.resolve();
+
+    std::unique_lock lock(m_mutex);
+
+    auto iterator = m_entries.find(key);
+    if (key.empty() || iterator == m_entries.end() || iterator->second.is_taken) {
+        lock.unlock();
+        return this->parse(path);
+    }
+
+    auto& entry = iterator->second;
+    m_done.wait(lock, [&entry] { return entry.is_done; });
+
+    entry.is_taken = true;
+    return move(*entry.result);
+}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <quart/parser/parser.h>
+#include <quart/module_cache.h>
+#include <quart/thread_pool.h>
+
+namespace quart {
+
+// Reads, lexes and parses modules ahead of time. Given the AST of the main module, `prefetch` walks its imports
+// and parses every reachable module on a thread pool while the caller moves on to semantic analysis,
+// which still visits the modules one at a time in dependency order and picks up the results through `load`.
+class ModuleLoader {
+public:
+    NO_COPY(ModuleLoader)
+    NO_MOVE(ModuleLoader)
+
+    ModuleLoader() = default;
+    ~ModuleLoader();
+
+    // Returns the path of the file `expr` refers to or an empty path if it can't be found
+    static fs::Path resolve(ast::ImportExpr const& expr);
+
+    // Modules are looked up in `cache` before being parsed and stored in it afterwards
+    void set_cache(OwnPtr<ModuleCache> cache) { m_cache = move(cache); }
+
+    // Has to be set before anything gets parsed, see `Parser::set_lazy_function_bodies`
+    void set_lazy_function_bodies(bool value) { m_lazy_function_bodies = value; }
+
+    ErrorOr<ParsedModule> parse(fs::Path const& path);
+
+    void prefetch(ExprList<> const& ast);
+
+    // Returns the parsed module at `path`, waiting for it if it's still being parsed or parsing it
+    // on the calling thread if it was never prefetched.
+    ErrorOr<ParsedModule> load(fs::Path const& path);
+
+private:
+    struct Entry {
+        bool is_done = false;
+        bool is_taken = false;
+
+        Optional<ErrorOr<ParsedModule>> result;
+    };
+
+    void submit(fs::Path path);
+
+    OwnPtr<ModuleCache> m_cache;
+    bool m_lazy_function_bodies = false;
+
+    // Created on first use so compiling a program without imports doesn't spin up any threads
+    OwnPtr<ThreadPool> m_pool;
+
+    std::mutex m_mutex;
+    std::condition_variable m_done;
+
+    HashMap<String, Entry> m_entries;
+};
+
+}
@@ -0,0 +1,71 @@
+#include <quart/parser/arena.h>
+#include <quart/assert.h>
+
+#include <cstdlib>
+
+namespace quart::ast {
+
+static thread_local Arena* s_current_arena = nullptr;
+
+Arena* Arena::current() {
+    return s_current_arena;
+}
+
+Arena::Scope::Scope(Arena& arena) : m_previous(s_current_arena) {
+    s_current_arena = &arena;
+}
+
+Arena::Scope::~Scope() {
+    s_current_arena = m_previous;
+}
+
+Arena::~Arena() {
+    for (Finalizer* finalizer = m_finalizers; finalizer; finalizer = finalizer->next) {
+        finalizer->destroy(finalizer->object);
+    }
+
+    Chunk* chunk = m_chunks;
+    while (chunk) {
+        Chunk* next = chunk->next;
+        std::free(chunk);
+
+        chunk = next;
+    }
+}
+
+void* Arena::allocate_slow(size_t size, size_t alignment) {
+    // Allocations that wouldn't leave much room in a regular chunk get one of their own
+    size_t capacity = std::max(CHUNK_SIZE, size + alignment + sizeof(Chunk));
+
+    auto* chunk = static_cast<Chunk*>(std::malloc(capacity));
+    ASSERT(chunk, "Out of memory");
+
+    chunk->next = m_chunks;
+    m_chunks = chunk;
+
+    m_bytes_allocated += capacity;
+
+    char* start = reinterpret_cast<char*>(chunk + 1);
+    char* ptr = align(start, alignment);
+
+    // Keep bumping from whichever chunk has more space left
+    char* end = reinterpret_cast<char*>(chunk) + capacity;
+    if (end - (ptr + size) > m_end - m_ptr) {
+        m_ptr = ptr + size;
+        m_end = end;
+    }
+
+    return ptr;
+}
+
+void Arena::add_finalizer(void* object, void (*destroy)(void*)) {
+    auto* finalizer = static_cast<Finalizer*>(this->allocate(sizeof(Finalizer), alignof(Finalizer)));
+
+    finalizer->next = m_finalizers;
+    finalizer->object = object;
+    finalizer->destroy = destroy;
+
+    m_finalizers = finalizer;
+}
+
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <quart/common.h>
+
+namespace quart::ast {
+
+// Nodes are owned by their arena, dropping a pointer to one never frees it.
+struct ArenaDeleter {
+    template<typename T>
+    void operator()(T*) const {}
+};
+
+template<typename T> using ArenaPtr = std::unique_ptr<T, ArenaDeleter>;
+
+// A bump allocator that owns every AST node of a single module. Nodes are never freed individually,
+// the whole tree goes away at once when the arena is destroyed.
+class Arena {
+public:
+    NO_COPY(Arena)
+    NO_MOVE(Arena)
+
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    ~Arena();
+
+    static OwnPtr<Arena> create() { return OwnPtr<Arena>(new Arena()); }
+
+    // The arena lists created on the current thread allocate from. See `ArenaAllocator`.
+    static Arena* current();
+
+    // Makes `arena` the current one for as long as the scope is alive.
+    class Scope {
+    public:
+        NO_COPY(Scope)
+        NO_MOVE(Scope)
+
+        Scope(Arena& arena);
+        ~Scope();
+
+    private:
+        Arena* m_previous;
+    };
+
+    void* allocate(size_t size, size_t alignment) {
+        char* ptr = align(m_ptr, alignment);
+        if (ptr && static_cast<size_t>(m_end - ptr) >= size) {
+            m_ptr = ptr + size;
+            return ptr;
+        }
+
+        return this->allocate_slow(size, alignment);
+    }
+
+    template<typename T, typename... Args>
+    T* allocate(Args&&... args) {
+        T* object = new (this->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        return this->adopt(object);
+    }
+
+    // Makes the arena run the destructor of an object that was constructed in memory it handed out.
+    // Meant for types whose constructors `allocate<T>` can't reach.
+    template<typename T>
+    T* adopt(T* object) {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            this->add_finalizer(object, [](void* object) { static_cast<T*>(object)->~T(); });
+        }
+
+        return object;
+    }
+
+    template<typename T, typename... Args>
+    ArenaPtr<T> make(Args&&... args) {
+        return ArenaPtr<T>(this->allocate<T>(std::forward<Args>(args)...));
+    }
+
+    size_t bytes_allocated() const { return m_bytes_allocated; }
+
+private:
+    Arena() = default;
+
+    struct Chunk {
+        Chunk* next;
+    };
+
+    // Destructors of non-trivial objects, run in reverse allocation order when the arena is destroyed.
+    // Children are arena allocated too, so every destructor only has to release what the node itself owns.
+    struct Finalizer {
+        Finalizer* next;
+
+        void* object;
+        void (*destroy)(void*);
+    };
+
+    static char* align(char* ptr, size_t alignment) {
+        return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(ptr) + alignment - 1) & ~(alignment - 1));
+    }
+
+    void add_finalizer(void* object, void (*destroy)(void*));
+    void* allocate_slow(size_t size, size_t alignment);
+
+    Chunk* m_chunks = nullptr;
+    Finalizer* m_finalizers = nullptr;
+
+    char* m_ptr = nullptr;
+    char* m_end = nullptr;
+
+    size_t m_bytes_allocated = 0;
+};
+
+// Allocates from the arena that was current when the allocator was created, or from the heap if there was none.
+// Memory handed out by an arena is released with it, so `deallocate` is a no-op in that case.
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() : m_arena(Arena::current()) {}
+    ArenaAllocator(Arena* arena) : m_arena(arena) {}
+
+    template<typename U>
+    ArenaAllocator(ArenaAllocator<U> const& other) : m_arena(other.arena()) {}
+
+    Arena* arena() const { return m_arena; }
+
+    T* allocate(size_t n) {
+        if (!m_arena) {
+            return std::allocator<T>().allocate(n);
+        }
+
+        return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        if (!m_arena) {
+            std::allocator<T>().deallocate(ptr, n);
+        }
+    }
+
+    ArenaAllocator select_on_container_copy_construction() const { return {}; }
+
+    template<typename U>
+    bool operator==(ArenaAllocator<U> const& other) const { return m_arena == other.arena(); }
+
+private:
+    Arena* m_arena;
+};
+
+template<typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}
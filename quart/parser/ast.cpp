@@ -7,6 +7,6 @@ PathSegment::~PathSegment() = default;
 PathSegment::PathSegment(PathSegment&&) noexcept = default;
 PathSegment& PathSegment::operator=(PathSegment&&) noexcept = default;
 
-PathSegment::PathSegment(String name, Vector<OwnPtr<ast::TypeExpr>> arguments) : m_name(move(name)), m_arguments(move(arguments)) {}
+PathSegment::PathSegment(Identifier name, ExprList<ast::TypeExpr> arguments) : m_name(name), m_arguments(move(arguments)) {}
 
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <quart/lexer/tokens.h>
+#include <quart/parser/arena.h>
 #include <quart/attributes/attributes.h>
 
 #include <quart/errors.h>
@@ -71,7 +72,7 @@ namespace ast {
     class Expr;
 }
 
-template<class T = ast::Expr> using ExprList = Vector<OwnPtr<T>>;
+template<class T = ast::Expr> using ExprList = ast::ArenaVector<ast::ArenaPtr<T>>;
 
 class [[nodiscard]] BytecodeResult : public ErrorOr<Optional<bytecode::Operand>> {
 public:
@@ -96,16 +97,16 @@ public:
     PathSegment(PathSegment&&) noexcept;
     PathSegment& operator=(PathSegment&&) noexcept;
 
-    PathSegment(String name, Vector<OwnPtr<ast::TypeExpr>> arguments);
+    PathSegment(Identifier name, ExprList<ast::TypeExpr> arguments);
 
-    String const& name() const { return m_name; }
-    Vector<OwnPtr<ast::TypeExpr>> const& arguments() const { return m_arguments; }
+    Identifier name() const { return m_name; }
+    ExprList<ast::TypeExpr> const& arguments() const { return m_arguments; }
 
     bool has_generic_arguments() const { return !m_arguments.empty(); }
 
 private:
-    String m_name;
-    Vector<OwnPtr<ast::TypeExpr>> m_arguments;
+    Identifier m_name;
+    ExprList<ast::TypeExpr> m_arguments;
 };
 
 struct Path {
@@ -118,9 +119,13 @@ public:
 
     bool has_segments() const { return !m_segments.empty(); }
 
-    String const& name() const { return m_last.name(); }
+    Identifier name() const { return m_last.name(); }
 
     String format() const;
+
+    // The same as `format()` but interned
+    Identifier qualified_name() const;
+
     void rearrange();
 
     void push(PathSegment segment) {
@@ -266,17 +271,17 @@ private:
 };
 
 struct Ident {
-    String value;
+    Identifier value;
     bool is_mutable;
 
     Span span;
 };
 
 struct Parameter {
-    String name;
+    Identifier name;
 
-    OwnPtr<TypeExpr> type;
-    OwnPtr<Expr> default_value;
+    ArenaPtr<TypeExpr> type;
+    ArenaPtr<Expr> default_value;
 
     u8 flags;
 
@@ -290,7 +295,7 @@ struct FunctionParameters {
 
 struct StructField {
     String name;
-    OwnPtr<TypeExpr> type;
+    ArenaPtr<TypeExpr> type;
 
     u32 index;
     u8 flags;
@@ -298,21 +303,21 @@ struct StructField {
 
 struct ConstructorArgument {
     String name;
-    OwnPtr<Expr> value;
+    ArenaPtr<Expr> value;
 
     Span span;
 };
 
 struct EnumField {
     String name;
-    OwnPtr<Expr> value;
+    ArenaPtr<Expr> value;
 };
 
 struct GenericParameter {
-    String name;
+    Identifier name;
 
     ExprList<TypeExpr> constraints;
-    OwnPtr<TypeExpr> default_type;
+    ArenaPtr<TypeExpr> default_type;
 
     Span span;
 };
@@ -321,13 +326,13 @@ struct MatchPattern {
     bool is_wildcard = false;
     bool is_conditional = false;
 
-    Vector<OwnPtr<Expr>> values; // A | B | C
+    ExprList<Expr> values; // A | B | C
     Span span;
 };
 
 struct MatchArm {
     MatchPattern pattern;
-    OwnPtr<Expr> body;
+    ArenaPtr<Expr> body;
 
     size_t index;
     
@@ -424,13 +429,13 @@ private:
 
 class IntegerTypeExpr : public TypeExprBase<TypeKind::Integer> {
 public:
-    IntegerTypeExpr(Span span, OwnPtr<Expr> size) : TypeExprBase(span), m_size(move(size)) {}
+    IntegerTypeExpr(Span span, ArenaPtr<Expr> size) : TypeExprBase(span), m_size(move(size)) {}
     ErrorOr<Type*> evaluate(State&) const override;
 
     Expr const& size() const { return *m_size; }
 
 private:
-    OwnPtr<Expr> m_size;
+    ArenaPtr<Expr> m_size;
 };
 
 class NamedTypeExpr : public TypeExprBase<TypeKind::Named> {
@@ -457,47 +462,47 @@ private:
 
 class ArrayTypeExpr : public TypeExprBase<TypeKind::Array> {
 public:
-    ArrayTypeExpr(Span span, OwnPtr<TypeExpr> type, OwnPtr<Expr> size) : TypeExprBase(span), m_type(move(type)), m_size(move(size)) {}
+    ArrayTypeExpr(Span span, ArenaPtr<TypeExpr> type, ArenaPtr<Expr> size) : TypeExprBase(span), m_type(move(type)), m_size(move(size)) {}
     ErrorOr<Type*> evaluate(State&) const override;
 
     TypeExpr const& type() const { return *m_type; }
     Expr const& size() const { return *m_size; }
 
 private:
-    OwnPtr<TypeExpr> m_type;
-    OwnPtr<Expr> m_size;
+    ArenaPtr<TypeExpr> m_type;
+    ArenaPtr<Expr> m_size;
 };
 
 class PointerTypeExpr : public TypeExprBase<TypeKind::Pointer> {
 public:
-    PointerTypeExpr(Span span, OwnPtr<TypeExpr> pointee, bool is_mutable) : TypeExprBase(span), m_pointee(move(pointee)), m_is_mutable(is_mutable) {}
+    PointerTypeExpr(Span span, ArenaPtr<TypeExpr> pointee, bool is_mutable) : TypeExprBase(span), m_pointee(move(pointee)), m_is_mutable(is_mutable) {}
     ErrorOr<Type*> evaluate(State&) const override;
 
     TypeExpr const& pointee() const { return *m_pointee; }
     bool is_mutable() const { return m_is_mutable; }
 
 private:
-    OwnPtr<TypeExpr> m_pointee;
+    ArenaPtr<TypeExpr> m_pointee;
     bool m_is_mutable;
 };
 
 class ReferenceTypeExpr : public TypeExprBase<TypeKind::Reference> {
 public:
-    ReferenceTypeExpr(Span span, OwnPtr<TypeExpr> type, bool is_mutable) : TypeExprBase(span), m_type(move(type)), m_is_mutable(is_mutable) {}
+    ReferenceTypeExpr(Span span, ArenaPtr<TypeExpr> type, bool is_mutable) : TypeExprBase(span), m_type(move(type)), m_is_mutable(is_mutable) {}
     ErrorOr<Type*> evaluate(State&) const override;
 
     TypeExpr const& type() const { return *m_type; }
     bool is_mutable() const { return m_is_mutable; }
 
 private:
-    OwnPtr<TypeExpr> m_type;
+    ArenaPtr<TypeExpr> m_type;
     bool m_is_mutable;
 };
 
 class FunctionTypeExpr : public TypeExprBase<TypeKind::Function> {
 public:
     FunctionTypeExpr(
-        Span span, ExprList<TypeExpr> parameters, OwnPtr<TypeExpr> return_type
+        Span span, ExprList<TypeExpr> parameters, ArenaPtr<TypeExpr> return_type
     ) : TypeExprBase(span), m_parameters(move(parameters)), m_return_type(move(return_type)) {}
 
     ErrorOr<Type*> evaluate(State&) const override;
@@ -507,13 +512,13 @@ public:
 
 private:
     ExprList<TypeExpr> m_parameters;
-    OwnPtr<TypeExpr> m_return_type;
+    ArenaPtr<TypeExpr> m_return_type;
 };
 
 class GenericTypeExpr : public TypeExprBase<TypeKind::Generic> {
 public:
     GenericTypeExpr(
-        Span span, OwnPtr<NamedTypeExpr> parent, ExprList<TypeExpr> args
+        Span span, ArenaPtr<NamedTypeExpr> parent, ExprList<TypeExpr> args
     ) : TypeExprBase(span), m_parent(move(parent)), m_args(move(args)) {}
 
     ErrorOr<Type*> evaluate(State&) const override;
@@ -522,7 +527,7 @@ public:
     ExprList<TypeExpr> const& args() const { return m_args; }
 
 private:
-    OwnPtr<NamedTypeExpr> m_parent;
+    ArenaPtr<NamedTypeExpr> m_parent;
     ExprList<TypeExpr> m_args;
 };
 
@@ -588,13 +593,13 @@ private:
 
 class IdentifierExpr : public ExprBase<ExprKind::Identifier> {
 public:
-    IdentifierExpr(Span span, String name) : ExprBase(span), m_name(move(name)) {}
+    IdentifierExpr(Span span, Identifier name) : ExprBase(span), m_name(name) {}
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
-    String const& name() const { return m_name; }
+    Identifier name() const { return m_name; }
 
 private:
-    String m_name;
+    Identifier m_name;
 };
 
 class AssignmentExpr : public ExprBase<ExprKind::Assignment> {
@@ -602,8 +607,8 @@ public:
     AssignmentExpr(
         Span span,
         Ident identifier,
-        OwnPtr<TypeExpr> type,
-        OwnPtr<Expr> value,
+        ArenaPtr<TypeExpr> type,
+        ArenaPtr<Expr> value,
         bool is_public
     ) : ExprBase(span), m_identifier(move(identifier)), m_type(move(type)), m_value(move(value)), m_is_public(is_public) {}
     
@@ -618,8 +623,8 @@ public:
 
 private:
     Ident m_identifier;
-    OwnPtr<TypeExpr> m_type;
-    OwnPtr<Expr> m_value;
+    ArenaPtr<TypeExpr> m_type;
+    ArenaPtr<Expr> m_value;
 
     bool m_is_public;
 };
@@ -629,8 +634,8 @@ public:
     TupleAssignmentExpr(
         Span span, 
         Vector<Ident> identifiers, 
-        OwnPtr<TypeExpr> type, 
-        OwnPtr<Expr> value
+        ArenaPtr<TypeExpr> type, 
+        ArenaPtr<Expr> value
     ) : ExprBase(span), m_identifiers(move(identifiers)), m_type(move(type)), m_value(move(value)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -642,19 +647,19 @@ public:
 
 private:
     Vector<Ident> m_identifiers;
-    OwnPtr<TypeExpr> m_type;
-    OwnPtr<Expr> m_value;
+    ArenaPtr<TypeExpr> m_type;
+    ArenaPtr<Expr> m_value;
 };
 
 class ConstExpr : public ExprBase<ExprKind::Const> {
 public:
     ConstExpr(
-        Span span, String name, OwnPtr<TypeExpr> type, OwnPtr<Expr> value, bool is_public
-    ) : ExprBase(span), m_name(move(name)), m_type(move(type)), m_value(move(value)), m_is_public(is_public) {}
+        Span span, Identifier name, ArenaPtr<TypeExpr> type, ArenaPtr<Expr> value, bool is_public
+    ) : ExprBase(span), m_name(name), m_type(move(type)), m_value(move(value)), m_is_public(is_public) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
-    String const& name() const { return m_name; }
+    Identifier name() const { return m_name; }
 
     const TypeExpr* type() const { return m_type.get(); }
     Expr const& value() const { return *m_value; }
@@ -662,9 +667,9 @@ public:
     bool is_public() const { return m_is_public; }
 
 private:
-    String m_name;
-    OwnPtr<TypeExpr> m_type;
-    OwnPtr<Expr> m_value;
+    Identifier m_name;
+    ArenaPtr<TypeExpr> m_type;
+    ArenaPtr<Expr> m_value;
 
     bool m_is_public;
 };
@@ -682,7 +687,7 @@ private:
 
 class UnaryOpExpr : public ExprBase<ExprKind::UnaryOp> {
 public:
-    UnaryOpExpr(Span span, OwnPtr<Expr> value, UnaryOp op) : ExprBase(span), m_value(move(value)), m_op(op) {}
+    UnaryOpExpr(Span span, ArenaPtr<Expr> value, UnaryOp op) : ExprBase(span), m_value(move(value)), m_op(op) {}
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
     Expr const& value() const { return *m_value; }
@@ -690,14 +695,14 @@ public:
     UnaryOp op() const { return m_op; }
 
 private:
-    OwnPtr<Expr> m_value;
+    ArenaPtr<Expr> m_value;
     UnaryOp m_op;
 };
 
 class ReferenceExpr : public ExprBase<ExprKind::Reference> {
 public:
     ReferenceExpr(
-        Span span, OwnPtr<Expr> value, bool is_mutable
+        Span span, ArenaPtr<Expr> value, bool is_mutable
     ) : ExprBase(span), m_value(move(value)), m_is_mutable(is_mutable) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -706,14 +711,14 @@ public:
     bool is_mutable() const { return m_is_mutable; }
 
 private:
-    OwnPtr<Expr> m_value;
+    ArenaPtr<Expr> m_value;
     bool m_is_mutable;
 };
 
 class BinaryOpExpr : public ExprBase<ExprKind::BinaryOp> {
 public:
     BinaryOpExpr(
-        Span span, BinaryOp op, OwnPtr<Expr> lhs, OwnPtr<Expr> rhs
+        Span span, BinaryOp op, ArenaPtr<Expr> lhs, ArenaPtr<Expr> rhs
     ) : ExprBase(span), m_lhs(move(lhs)), m_rhs(move(rhs)), m_op(op) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -724,15 +729,15 @@ public:
     BinaryOp op() const { return m_op; }
 
 private:
-    OwnPtr<Expr> m_lhs;
-    OwnPtr<Expr> m_rhs;
+    ArenaPtr<Expr> m_lhs;
+    ArenaPtr<Expr> m_rhs;
     BinaryOp m_op;
 };
 
 class InplaceBinaryOpExpr : public ExprBase<ExprKind::InplaceBinaryOp> {
 public:
     InplaceBinaryOpExpr(
-        Span span, BinaryOp op, OwnPtr<Expr> lhs, OwnPtr<Expr> rhs
+        Span span, BinaryOp op, ArenaPtr<Expr> lhs, ArenaPtr<Expr> rhs
     ) : ExprBase(span), m_lhs(move(lhs)), m_rhs(move(rhs)), m_op(op) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -743,8 +748,8 @@ public:
     BinaryOp op() const { return m_op; }
 
 private:
-    OwnPtr<Expr> m_lhs;
-    OwnPtr<Expr> m_rhs;
+    ArenaPtr<Expr> m_lhs;
+    ArenaPtr<Expr> m_rhs;
     BinaryOp m_op;
 };
 
@@ -752,9 +757,9 @@ class CallExpr : public ExprBase<ExprKind::Call> {
 public:
     CallExpr(
         Span span,
-        OwnPtr<ast::Expr> callee,
+        ArenaPtr<ast::Expr> callee,
         ExprList<Expr> args,
-        HashMap<String, OwnPtr<Expr>> kwargs
+        HashMap<String, ArenaPtr<Expr>> kwargs
     ) : ExprBase(span), m_callee(move(callee)), m_args(move(args)), m_kwargs(move(kwargs)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -762,43 +767,43 @@ public:
     Expr const& callee() const { return *m_callee; }
 
     const ExprList<Expr>& args() const { return m_args; }
-    const HashMap<String, OwnPtr<Expr>>& kwargs() const { return m_kwargs; }
+    const HashMap<String, ArenaPtr<Expr>>& kwargs() const { return m_kwargs; }
 
 private:
-    OwnPtr<Expr> m_callee;
+    ArenaPtr<Expr> m_callee;
 
     ExprList<Expr> m_args;
-    HashMap<String, OwnPtr<Expr>> m_kwargs;
+    HashMap<String, ArenaPtr<Expr>> m_kwargs;
 };
 
 class ReturnExpr : public ExprBase<ExprKind::Return> {
 public:
-    ReturnExpr(Span span, OwnPtr<Expr> value) : ExprBase(span), m_value(move(value)) {}
+    ReturnExpr(Span span, ArenaPtr<Expr> value) : ExprBase(span), m_value(move(value)) {}
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
     Expr const* value() const { return m_value.get(); }
 
 private:
-    OwnPtr<Expr> m_value;
+    ArenaPtr<Expr> m_value;
 };
 
 class FunctionDeclExpr : public ExprBase<ExprKind::FunctionDecl> {
 public:
     FunctionDeclExpr(
         Span span,
-        String name,
+        Identifier name,
         Vector<Parameter> parameters,
-        OwnPtr<TypeExpr> return_type,
+        ArenaPtr<TypeExpr> return_type,
         LinkageSpecifier linkage,
         bool is_c_variadic,
         bool is_public,
         bool is_async
-    ) : ExprBase(span), m_name(move(name)), m_parameters(move(parameters)), m_return_type(move(return_type)),
+    ) : ExprBase(span), m_name(name), m_parameters(move(parameters)), m_return_type(move(return_type)),
         m_is_c_variadic(is_c_variadic), m_is_public(is_public), m_is_async(is_async), m_linkage(linkage) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
-    String const& name() const { return m_name; }
+    Identifier name() const { return m_name; }
     const Vector<Parameter>& parameters() const { return m_parameters; }
 
     const TypeExpr* return_type() const { return m_return_type.get(); }
@@ -810,9 +815,9 @@ public:
     LinkageSpecifier linkage() const { return m_linkage; }
 
 private:
-    String m_name;
+    Identifier m_name;
     Vector<Parameter> m_parameters;
-    OwnPtr<TypeExpr> m_return_type;
+    ArenaPtr<TypeExpr> m_return_type;
 
     bool m_is_c_variadic = false;
     bool m_is_public = false;
@@ -821,37 +826,60 @@ private:
     LinkageSpecifier m_linkage;
 };
 
+// A function body the parser only brace matched over. It gets parsed into `arena` the first time it's needed.
+struct LazyFunctionBody {
+    Span span; // From the opening brace up to and including the closing one
+    Arena* arena;
+
+    bool self_allowed;
+};
+
 class FunctionExpr : public ExprBase<ExprKind::Function> {
 public:
     FunctionExpr(
-        Span span, OwnPtr<FunctionDeclExpr> decl, OwnPtr<BlockExpr> body
+        Span span, ArenaPtr<FunctionDeclExpr> decl, ArenaPtr<BlockExpr> body
     ) : ExprBase(span), m_decl(move(decl)), m_body(move(body)) {}
 
+    FunctionExpr(
+        Span span, ArenaPtr<FunctionDeclExpr> decl, LazyFunctionBody lazy_body
+    ) : ExprBase(span), m_decl(move(decl)), m_lazy_body(lazy_body) {}
+
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
+    BytecodeResult generate_body(State&, Function*) const;
 
     const FunctionDeclExpr& decl() const { return *m_decl; }
+
+    // Only valid once the body was parsed, see `parse_body`
     const BlockExpr& body() const { return *m_body; }
 
+    bool has_body() const { return m_body != nullptr; }
+    Optional<LazyFunctionBody> const& lazy_body() const { return m_lazy_body; }
+
+    // Parses the body if the parser skipped over it and returns it
+    ErrorOr<BlockExpr*> parse_body() const;
+
 private:
-    OwnPtr<FunctionDeclExpr> m_decl;
-    OwnPtr<BlockExpr> m_body;
+    ArenaPtr<FunctionDeclExpr> m_decl;
+
+    mutable ArenaPtr<BlockExpr> m_body;
+    Optional<LazyFunctionBody> m_lazy_body;
 };
 
 class DeferExpr : public ExprBase<ExprKind::Defer> {
 public:
-    DeferExpr(Span span, OwnPtr<Expr> expr) : ExprBase(span), m_expr(move(expr)) {}
+    DeferExpr(Span span, ArenaPtr<Expr> expr) : ExprBase(span), m_expr(move(expr)) {}
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
     Expr const& expr() const { return *m_expr; }
 
 public:
-    OwnPtr<Expr> m_expr;
+    ArenaPtr<Expr> m_expr;
 };
 
 class IfExpr : public ExprBase<ExprKind::If> {
 public:
     IfExpr(
-        Span span, OwnPtr<Expr> condition, OwnPtr<Expr> body, OwnPtr<Expr> else_body
+        Span span, ArenaPtr<Expr> condition, ArenaPtr<Expr> body, ArenaPtr<Expr> else_body
     ) : ExprBase(span), m_condition(move(condition)), m_body(move(body)), m_else_body(move(else_body)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -861,15 +889,15 @@ public:
     const Expr* else_body() const { return m_else_body.get(); }
 
 private:
-    OwnPtr<Expr> m_condition;
-    OwnPtr<Expr> m_body;
-    OwnPtr<Expr> m_else_body;
+    ArenaPtr<Expr> m_condition;
+    ArenaPtr<Expr> m_body;
+    ArenaPtr<Expr> m_else_body;
 };
 
 class WhileExpr : public ExprBase<ExprKind::While> {
 public:
     WhileExpr(
-        Span span, OwnPtr<Expr> condition, OwnPtr<BlockExpr> body
+        Span span, ArenaPtr<Expr> condition, ArenaPtr<BlockExpr> body
     ) : ExprBase(span), m_condition(move(condition)), m_body(move(body)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -878,8 +906,8 @@ public:
     const BlockExpr& body() const { return *m_body; }
 
 private:
-    OwnPtr<Expr> m_condition;
-    OwnPtr<BlockExpr> m_body;
+    ArenaPtr<Expr> m_condition;
+    ArenaPtr<BlockExpr> m_body;
 };
 
 class BreakExpr : public ExprBase<ExprKind::Break> {
@@ -898,39 +926,39 @@ class StructExpr : public ExprBase<ExprKind::Struct> {
 public:
     StructExpr(
         Span span, 
-        String name,
+        Identifier name,
         bool opaque,
         Vector<GenericParameter> parameters,
         Vector<StructField> fields, 
-        Vector<OwnPtr<Expr>> members,
+        ExprList<Expr> members,
         bool is_public
-    ) : ExprBase(span), m_name(move(name)), m_opaque(opaque), m_parameters(move(parameters)), m_fields(move(fields)), m_members(move(members)), m_is_public(is_public) {}
+    ) : ExprBase(span), m_name(name), m_opaque(opaque), m_parameters(move(parameters)), m_fields(move(fields)), m_members(move(members)), m_is_public(is_public) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
-    String const& name() const { return m_name; }
+    Identifier name() const { return m_name; }
 
     bool is_opaque() const { return m_opaque; }
     bool is_public() const { return m_is_public; }
 
     const Vector<GenericParameter>& parameters() const { return m_parameters; }
     const Vector<StructField>& fields() const { return m_fields; }
-    const Vector<OwnPtr<Expr>>& members() const { return m_members; }
+    const ExprList<Expr>& members() const { return m_members; }
 
 private:
-    String m_name;
+    Identifier m_name;
     bool m_opaque;
     
     Vector<GenericParameter> m_parameters;
     Vector<StructField> m_fields;
-    Vector<OwnPtr<Expr>> m_members;
+    ExprList<Expr> m_members;
 
     bool m_is_public;
 };
 
 class ConstructorExpr : public ExprBase<ExprKind::Constructor> {
 public:
-    ConstructorExpr(Span span, OwnPtr<Expr> parent, Vector<ConstructorArgument> arguments) :
+    ConstructorExpr(Span span, ArenaPtr<Expr> parent, Vector<ConstructorArgument> arguments) :
         ExprBase(span), m_parent(move(parent)), m_arguments(move(arguments)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -939,14 +967,14 @@ public:
     Vector<ConstructorArgument> const& arguments() const { return m_arguments; }
 
 private:
-    OwnPtr<Expr> m_parent;
+    ArenaPtr<Expr> m_parent;
     Vector<ConstructorArgument> m_arguments;
 };
 
 class AttributeExpr : public ExprBase<ExprKind::Attribute> {
 public:
     AttributeExpr(
-        Span span, OwnPtr<Expr> parent, String attribute
+        Span span, ArenaPtr<Expr> parent, String attribute
     ) : ExprBase(span), m_parent(move(parent)), m_attribute(move(attribute)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -955,14 +983,14 @@ public:
     String const& attribute() const { return m_attribute; }
 
 private:
-    OwnPtr<Expr> m_parent;
+    ArenaPtr<Expr> m_parent;
     String m_attribute;
 };
 
 class IndexExpr : public ExprBase<ExprKind::Index> {
 public:
     IndexExpr(
-        Span span, OwnPtr<Expr> value, OwnPtr<Expr> index
+        Span span, ArenaPtr<Expr> value, ArenaPtr<Expr> index
     ) : ExprBase(span), m_value(move(value)), m_index(move(index)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -971,14 +999,14 @@ public:
     Expr const& index() const { return *m_index; }
 
 private:
-    OwnPtr<Expr> m_value;
-    OwnPtr<Expr> m_index;
+    ArenaPtr<Expr> m_value;
+    ArenaPtr<Expr> m_index;
 };
 
 class CastExpr : public ExprBase<ExprKind::Cast> {
 public:
     CastExpr(
-        Span span, OwnPtr<Expr> value, OwnPtr<TypeExpr> to
+        Span span, ArenaPtr<Expr> value, ArenaPtr<TypeExpr> to
     ) : ExprBase(span), m_value(move(value)), m_to(move(to)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -987,25 +1015,25 @@ public:
     const TypeExpr& to() const { return *m_to; }
 
 private:
-    OwnPtr<Expr> m_value;
-    OwnPtr<TypeExpr> m_to;
+    ArenaPtr<Expr> m_value;
+    ArenaPtr<TypeExpr> m_to;
 };
 
 class SizeofExpr : public ExprBase<ExprKind::Sizeof> {
 public:
-    SizeofExpr(Span span, OwnPtr<Expr> value) : ExprBase(span), m_value(move(value)) {}
+    SizeofExpr(Span span, ArenaPtr<Expr> value) : ExprBase(span), m_value(move(value)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
     Expr const& value() const { return *m_value; }
 
 private:
-    OwnPtr<Expr> m_value;
+    ArenaPtr<Expr> m_value;
 };
 
 class OffsetofExpr : public ExprBase<ExprKind::Offsetof> {
 public:
-    OffsetofExpr(Span span, OwnPtr<Expr> value, String field) : ExprBase(span), m_value(move(value)), m_field(move(field)) {}
+    OffsetofExpr(Span span, ArenaPtr<Expr> value, String field) : ExprBase(span), m_value(move(value)), m_field(move(field)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
@@ -1013,7 +1041,7 @@ public:
     String const& field() const { return m_field; }
 
 private:
-    OwnPtr<Expr> m_value;
+    ArenaPtr<Expr> m_value;
     String m_field;
 };
 
@@ -1030,16 +1058,16 @@ private:
 
 class UsingExpr : public ExprBase<ExprKind::Using> {
 public:
-    UsingExpr(Span span, Path path, Vector<String> symbols) : ExprBase(span), m_path(move(path)), m_symbols(move(symbols)) {}
+    UsingExpr(Span span, Path path, Vector<Identifier> symbols) : ExprBase(span), m_path(move(path)), m_symbols(move(symbols)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
     Path const& path() const { return m_path; }
-    Vector<String> const& symbols() const { return m_symbols; }
+    Vector<Identifier> const& symbols() const { return m_symbols; }
 
 private:
     Path m_path;
-    Vector<String> m_symbols;
+    Vector<Identifier> m_symbols;
 };
 
 class TupleExpr : public ExprBase<ExprKind::Tuple> {
@@ -1057,26 +1085,26 @@ private:
 class EnumExpr : public ExprBase<ExprKind::Enum> {
 public:
     EnumExpr(
-        Span span, String name, OwnPtr<TypeExpr> type, Vector<EnumField> fields
-    ) : ExprBase(span), m_name(move(name)), m_type(move(type)), m_fields(move(fields)) {}
+        Span span, Identifier name, ArenaPtr<TypeExpr> type, Vector<EnumField> fields
+    ) : ExprBase(span), m_name(name), m_type(move(type)), m_fields(move(fields)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
-    String const& name() const { return m_name; }
+    Identifier name() const { return m_name; }
     TypeExpr const& type() const { return *m_type; }
 
     Vector<EnumField> const& fields() const { return m_fields; }
 
 private:
-    String m_name;
-    OwnPtr<TypeExpr> m_type;
+    Identifier m_name;
+    ArenaPtr<TypeExpr> m_type;
     Vector<EnumField> m_fields;
 };
 
 class ImportExpr : public ExprBase<ExprKind::Import> {
 public:
     ImportExpr(
-        Span span, Path path, bool is_wildcard, bool is_relative, Vector<String> symbols
+        Span span, Path path, bool is_wildcard, bool is_relative, Vector<Identifier> symbols
     ) : ExprBase(span), m_path(move(path)), m_is_wildcard(is_wildcard), m_is_relative(is_relative), m_symbols(move(symbols)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -1086,7 +1114,7 @@ public:
     bool is_wildcard() const { return m_is_wildcard; }
     bool is_relative() const { return m_is_relative; }
 
-    Vector<String> const& symbols() const { return m_symbols; }
+    Vector<Identifier> const& symbols() const { return m_symbols; }
 
 private:
     Path m_path;
@@ -1094,27 +1122,27 @@ private:
     bool m_is_wildcard;
     bool m_is_relative;
 
-    Vector<String> m_symbols;
+    Vector<Identifier> m_symbols;
 };
 
 class ModuleExpr : public ExprBase<ExprKind::Module> {
 public:
-    ModuleExpr(Span span, String name, ExprList<Expr> body) : ExprBase(span), m_name(move(name)), m_body(move(body)) {}
+    ModuleExpr(Span span, Identifier name, ExprList<Expr> body) : ExprBase(span), m_name(name), m_body(move(body)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
-    String const& name() const { return m_name; }
+    Identifier name() const { return m_name; }
     ExprList<Expr> const& body() const { return m_body; }
 
 private:
-    String m_name;
+    Identifier m_name;
     ExprList<Expr> m_body;
 };
 
 class TernaryExpr : public ExprBase<ExprKind::Ternary> {
 public:
     TernaryExpr(
-        Span span, OwnPtr<Expr> condition, OwnPtr<Expr> true_expr, OwnPtr<Expr> false_expr
+        Span span, ArenaPtr<Expr> condition, ArenaPtr<Expr> true_expr, ArenaPtr<Expr> false_expr
     ) : ExprBase(span), m_condition(move(condition)), m_true_expr(move(true_expr)), m_false_expr(move(false_expr)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -1124,15 +1152,15 @@ public:
     Expr const& false_expr() const { return *m_false_expr; }
 
 private:
-    OwnPtr<Expr> m_condition;
-    OwnPtr<Expr> m_true_expr;
-    OwnPtr<Expr> m_false_expr;
+    ArenaPtr<Expr> m_condition;
+    ArenaPtr<Expr> m_true_expr;
+    ArenaPtr<Expr> m_false_expr;
 };
 
 class ForExpr : public ExprBase<ExprKind::For> {
 public:
     ForExpr(
-        Span span, Ident identifier, OwnPtr<Expr> iterable, OwnPtr<Expr> body
+        Span span, Ident identifier, ArenaPtr<Expr> iterable, ArenaPtr<Expr> body
     ) : ExprBase(span), m_identifier(move(identifier)), m_iterable(move(iterable)), m_body(move(body)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -1144,14 +1172,14 @@ public:
 
 private:
     Ident m_identifier;
-    OwnPtr<Expr> m_iterable;
-    OwnPtr<Expr> m_body;
+    ArenaPtr<Expr> m_iterable;
+    ArenaPtr<Expr> m_body;
 };
 
 class RangeForExpr : public ExprBase<ExprKind::RangeFor> {
 public:
     RangeForExpr(
-        Span span, Ident identifier, bool inclusive, OwnPtr<Expr> start, OwnPtr<Expr> end, OwnPtr<Expr> body
+        Span span, Ident identifier, bool inclusive, ArenaPtr<Expr> start, ArenaPtr<Expr> end, ArenaPtr<Expr> body
     ) : ExprBase(span), m_identifier(move(identifier)), m_inclusive(inclusive), m_start(move(start)), m_end(move(end)), m_body(move(body)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -1168,15 +1196,15 @@ private:
     Ident m_identifier;
     bool m_inclusive;
 
-    OwnPtr<Expr> m_start;
-    OwnPtr<Expr> m_end;
-    OwnPtr<Expr> m_body;
+    ArenaPtr<Expr> m_start;
+    ArenaPtr<Expr> m_end;
+    ArenaPtr<Expr> m_body;
 
 };
 
 class ArrayFillExpr : public ExprBase<ExprKind::ArrayFill> {
 public:
-    ArrayFillExpr(Span span, OwnPtr<Expr> value, OwnPtr<Expr> count) : ExprBase(span), m_value(move(value)), m_count(move(count)) {}
+    ArrayFillExpr(Span span, ArenaPtr<Expr> value, ArenaPtr<Expr> count) : ExprBase(span), m_value(move(value)), m_count(move(count)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
@@ -1184,19 +1212,19 @@ public:
     Expr const& count() const { return *m_count; }
 
 private:
-    OwnPtr<Expr> m_value;
-    OwnPtr<Expr> m_count;
+    ArenaPtr<Expr> m_value;
+    ArenaPtr<Expr> m_count;
 };
 
 class TypeAliasExpr : public ExprBase<ExprKind::TypeAlias> {
 public:
     TypeAliasExpr(
-        Span span, String name, OwnPtr<TypeExpr> type, Vector<GenericParameter> parameters, bool is_public
-    ) : ExprBase(span), m_name(move(name)), m_type(move(type)), m_parameters(move(parameters)), m_is_public(is_public) {}
+        Span span, Identifier name, ArenaPtr<TypeExpr> type, Vector<GenericParameter> parameters, bool is_public
+    ) : ExprBase(span), m_name(name), m_type(move(type)), m_parameters(move(parameters)), m_is_public(is_public) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
-    String const& name() const { return m_name; }
+    Identifier name() const { return m_name; }
     Vector<GenericParameter> const& parameters() const { return m_parameters; }
 
     TypeExpr const& type() const { return *m_type; }
@@ -1204,8 +1232,8 @@ public:
     bool is_public() const { return m_is_public; }
 
 private:
-    String m_name;
-    OwnPtr<TypeExpr> m_type;
+    Identifier m_name;
+    ArenaPtr<TypeExpr> m_type;
 
     Vector<GenericParameter> m_parameters;
 
@@ -1214,7 +1242,7 @@ private:
 
 class StaticAssertExpr : public ExprBase<ExprKind::StaticAssert> {
 public:
-    StaticAssertExpr(Span span, OwnPtr<Expr> condition, String message) : ExprBase(span), m_condition(move(condition)), m_message(move(message)) {}
+    StaticAssertExpr(Span span, ArenaPtr<Expr> condition, String message) : ExprBase(span), m_condition(move(condition)), m_message(move(message)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
@@ -1222,26 +1250,26 @@ public:
     String const& message() const { return m_message; }
 
 private:
-    OwnPtr<Expr> m_condition;
+    ArenaPtr<Expr> m_condition;
     String m_message;
 };
 
 class MaybeExpr : public ExprBase<ExprKind::Maybe> {
 public:
-    MaybeExpr(Span span, OwnPtr<Expr> value) : ExprBase(span), m_value(move(value)) {}
+    MaybeExpr(Span span, ArenaPtr<Expr> value) : ExprBase(span), m_value(move(value)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
     Expr const& value() const { return *m_value; }
 
 private:
-    OwnPtr<Expr> m_value;
+    ArenaPtr<Expr> m_value;
 };
 
 class ImplExpr : public ExprBase<ExprKind::Impl> {
 public:
     ImplExpr(
-        Span span, OwnPtr<TypeExpr> type, OwnPtr<BlockExpr> body, Vector<GenericParameter> parameters
+        Span span, ArenaPtr<TypeExpr> type, ArenaPtr<BlockExpr> body, Vector<GenericParameter> parameters
     ) : ExprBase(span), m_type(move(type)), m_body(move(body)), m_parameters(move(parameters)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
@@ -1251,8 +1279,8 @@ public:
     Vector<GenericParameter> const& parameters() const { return m_parameters; }
 
 private:
-    OwnPtr<TypeExpr> m_type;
-    OwnPtr<BlockExpr> m_body;
+    ArenaPtr<TypeExpr> m_type;
+    ArenaPtr<BlockExpr> m_body;
     
     Vector<GenericParameter> m_parameters;
 };
@@ -1260,17 +1288,17 @@ private:
 class TraitExpr : public ExprBase<ExprKind::Trait> {
 public:
     TraitExpr(
-        Span span, String name, ExprList<> body, Vector<GenericParameter> parameters
-    ) : ExprBase(span), m_name(move(name)), m_body(move(body)), m_parameters(move(parameters)) {}
+        Span span, Identifier name, ExprList<> body, Vector<GenericParameter> parameters
+    ) : ExprBase(span), m_name(name), m_body(move(body)), m_parameters(move(parameters)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
-    String const& name() const { return m_name; }
+    Identifier name() const { return m_name; }
     ExprList<> const& body() const { return m_body; }
     Vector<GenericParameter> const& parameters() const { return m_parameters; }
 
 private:
-    String m_name;
+    Identifier m_name;
     ExprList<> m_body;
 
     Vector<GenericParameter> m_parameters;
@@ -1280,8 +1308,8 @@ class ImplTraitExpr : public ExprBase<ExprKind::ImplTrait> {
 public:
     ImplTraitExpr(
         Span span,
-        OwnPtr<TypeExpr> trait,
-        OwnPtr<TypeExpr> type,
+        ArenaPtr<TypeExpr> trait,
+        ArenaPtr<TypeExpr> type,
         ExprList<> body
     ) : ExprBase(span), m_trait(move(trait)), m_type(move(type)), m_body(move(body)) {}
 
@@ -1292,15 +1320,15 @@ public:
     ExprList<> const& body() const { return m_body; }
 
 private:
-    OwnPtr<TypeExpr> m_trait;
+    ArenaPtr<TypeExpr> m_trait;
 
-    OwnPtr<TypeExpr> m_type;
+    ArenaPtr<TypeExpr> m_type;
     ExprList<> m_body;
 };
 
 class MatchExpr : public ExprBase<ExprKind::Match> {
 public:
-    MatchExpr(Span span, OwnPtr<Expr> value, Vector<MatchArm> arms) : ExprBase(span), m_value(move(value)), m_arms(move(arms)) {}
+    MatchExpr(Span span, ArenaPtr<Expr> value, Vector<MatchArm> arms) : ExprBase(span), m_value(move(value)), m_arms(move(arms)) {}
 
     BytecodeResult generate(State&, Optional<bytecode::Register> dst = {}) const override;
 
@@ -1308,7 +1336,7 @@ public:
     Vector<MatchArm> const& arms() const { return m_arms; }
 
 private:
-    OwnPtr<Expr> m_value;
+    ArenaPtr<Expr> m_value;
     Vector<MatchArm> m_arms;
 };
 
@@ -1330,7 +1358,7 @@ private:
     Value m_value;
 };
 
-class ConstEvalExpr : public ExprBase<ExprKind::Bool> {
+class ConstEvalExpr : public ExprBase<ExprKind::ConstEval> {
 public:
     ConstEvalExpr(Span span, ExprList<> body) : ExprBase(span), m_body(move(body)) {}
 
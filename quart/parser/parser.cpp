@@ -11,7 +11,7 @@
 #define BOOL_EXPR(name) {                                   \
     Span span = m_current.span();                           \
     this->next();                                           \
-    expr = make<ast::BoolExpr>(span, ast::BoolExpr::name);  \
+    expr = m_arena->make<ast::BoolExpr>(span, ast::BoolExpr::name);  \
     break; }
 
 namespace quart {
@@ -23,7 +23,7 @@ constexpr int BINARY_BASE = 2;
 String Path::format() const {
     String fmt = {};
     if (m_segments.empty()) {
-        return name();
+        return String(name());
     }
 
     for (auto& segment : m_segments) {
@@ -35,6 +35,19 @@ String Path::format() const {
     return fmt;
 }
 
+Identifier Path::qualified_name() const {
+    if (m_segments.empty()) {
+        return name();
+    }
+
+    Identifier qualified_name = m_segments.front().name();
+    for (auto iterator = std::next(m_segments.begin()); iterator != m_segments.end(); ++iterator) {
+        qualified_name = Identifier::join(qualified_name, iterator->name());
+    }
+
+    return Identifier::join(qualified_name, name());
+}
+
 void Path::rearrange() {
     if (m_segments.empty()) {
         return;
@@ -44,7 +57,7 @@ void Path::rearrange() {
     m_last = move(m_segments.back());
 
     m_segments.pop_back();
-    m_segments.push_back(move(segment));
+    m_segments.push_front(move(segment));
 }
 
 static const HashMap<StringView, ast::IntegerSuffix> INTEGER_SUFFIXES = {
@@ -57,7 +70,11 @@ static const HashMap<StringView, ast::IntegerSuffix> INTEGER_SUFFIXES = {
     { "isize", { ast::BuiltinType::isize } }
 };
 
-Parser::Parser(Vector<Token> tokens) : m_tokens(move(tokens)), m_current(m_tokens.front()) {
+Parser::Parser(Lexer lexer) : m_owned_arena(ast::Arena::create()), m_arena(m_owned_arena.get()), m_tokens(move(lexer)), m_current(m_tokens.peek()) {
+    Attributes::init(*this);
+}
+
+Parser::Parser(Lexer lexer, ast::Arena& arena) : m_arena(&arena), m_tokens(move(lexer)), m_current(m_tokens.peek()) {
     Attributes::init(*this);
 }
 
@@ -66,13 +83,8 @@ void Parser::set_attributes(HashMap<StringView, AttributeFunc> attributes) {
 }
 
 Token Parser::next() {
-    m_offset++;
-
-    if (m_offset >= m_tokens.size()) {
-        m_current = m_tokens.back(); // EOF
-    } else {
-        m_current = m_tokens[m_offset];
-    }
+    m_tokens.advance();
+    m_current = m_tokens.peek();
 
     return m_current;
 }
@@ -84,27 +96,11 @@ void Parser::skip(size_t n) {
 }
 
 Token const& Parser::peek(size_t offset) const {
-    if (m_offset >= m_tokens.size()) {
-        return m_tokens.back(); // EOF
-    }
-
-    return m_tokens[m_offset + offset];
-}
-
-Token& Parser::peek(size_t offset) {
-    if (m_offset >= m_tokens.size()) {
-        return m_tokens.back(); // EOF
-    }
-
-    return m_tokens[m_offset + offset];
+    return m_tokens.peek(offset);
 }
 
 Token const& Parser::back() {
-    if (m_offset == 0 || m_offset > m_tokens.size()) {
-        return m_tokens.front();
-    }
-
-    return m_tokens[m_offset - 1];
+    return m_tokens.previous();
 }
 
 ErrorOr<Token> Parser::expect(TokenKind kind, StringView value) {
@@ -173,7 +169,7 @@ ParseResult<ast::TypeExpr> Parser::parse_type(bool allow_generic_arguments) {
             this->next();
             bool is_mutable = this->try_expect(TokenKind::Mut).has_value();
 
-            return { make<ast::ReferenceTypeExpr>(m_current.span(), TRY(this->parse_type()), is_mutable) };
+            return { m_arena->make<ast::ReferenceTypeExpr>(m_current.span(), TRY(this->parse_type()), is_mutable) };
         }
         case TokenKind::Mul: {
             this->next();
@@ -184,7 +180,7 @@ ParseResult<ast::TypeExpr> Parser::parse_type(bool allow_generic_arguments) {
                 return err(type->span(), "Cannot create a pointer type to a reference");
             }
 
-            return { make<ast::PointerTypeExpr>(m_current.span(), move(type), is_mutable) };
+            return { m_arena->make<ast::PointerTypeExpr>(m_current.span(), move(type), is_mutable) };
         }
         case TokenKind::LParen: {
             this->next();
@@ -205,7 +201,7 @@ ParseResult<ast::TypeExpr> Parser::parse_type(bool allow_generic_arguments) {
             Span end = TRY(this->expect(TokenKind::RParen)).span();
             Span span { start, end };
 
-            return { make<ast::TupleTypeExpr>(span, move(elements)) };
+            return { m_arena->make<ast::TupleTypeExpr>(span, move(elements)) };
         }
         case TokenKind::LBracket: {
             this->next();
@@ -217,37 +213,37 @@ ParseResult<ast::TypeExpr> Parser::parse_type(bool allow_generic_arguments) {
             Span end = TRY(this->expect(TokenKind::RBracket)).span();
             Span span { start, end };
 
-            return { make<ast::ArrayTypeExpr>(span, move(type), move(size)) };
+            return { m_arena->make<ast::ArrayTypeExpr>(span, move(type), move(size)) };
         }
         case TokenKind::Identifier: {
-            String name = m_current.value();
+            Token token = m_current;
             this->next();
 
-            if (name == "int") {
+            if (token.value() == "int") {
                 TRY(this->expect(TokenKind::LParen));
                 auto size = TRY(this->expr(false));
 
                 Span end = TRY(this->expect(TokenKind::RParen)).span();
                 Span span { start, end };
 
-                return { make<ast::IntegerTypeExpr>(span, move(size)) };
+                return { m_arena->make<ast::IntegerTypeExpr>(span, move(size)) };
             }
 
-            auto iterator = STR_TO_TYPE.find(name);
+            auto iterator = STR_TO_TYPE.find(token.value());
             if (iterator != STR_TO_TYPE.end()) {
                 Span span { start, m_current.span() };
-                return { make<ast::BuiltinTypeExpr>(span, iterator->second) };
+                return { m_arena->make<ast::BuiltinTypeExpr>(span, iterator->second) };
             }
 
-            Path path = TRY(this->parse_path(name, {}, false, false));
+            Path path = TRY(this->parse_path(token.identifier(), {}, false, false));
             Span span { start, m_current.span() };
 
-            auto type = make<ast::NamedTypeExpr>(span, move(path));
+            auto type = m_arena->make<ast::NamedTypeExpr>(span, move(path));
             if (m_current.is(TokenKind::Lt) && allow_generic_arguments) {
                 auto args = TRY(this->parse_generic_arguments());
                 span = { start, back().span() };
 
-                return { make<ast::GenericTypeExpr>(span, move(type), move(args)) };
+                return { m_arena->make<ast::GenericTypeExpr>(span, move(type), move(args)) };
             }
 
             return { move(type) };
@@ -267,7 +263,7 @@ ParseResult<ast::TypeExpr> Parser::parse_type(bool allow_generic_arguments) {
             }
 
             Span end = TRY(this->expect(TokenKind::RParen)).span();
-            OwnPtr<ast::TypeExpr> return_type = nullptr;
+            ast::ArenaPtr<ast::TypeExpr> return_type = nullptr;
 
             if (m_current.is(TokenKind::Arrow)) {
                 end = this->next().span();
@@ -275,7 +271,7 @@ ParseResult<ast::TypeExpr> Parser::parse_type(bool allow_generic_arguments) {
             }
 
             Span span { start, end };
-            return { make<ast::FunctionTypeExpr>(span, move(params), move(return_type)) };
+            return { m_arena->make<ast::FunctionTypeExpr>(span, move(params), move(return_type)) };
         }
         default:
             return err(m_current.span(), "Expected type");
@@ -307,7 +303,7 @@ ErrorOr<ExprBlock> Parser::parse_expr_block() {
 
 ParseResult<ast::BlockExpr> Parser::parse_block() {
     auto [block, span] = TRY(this->parse_expr_block());
-    return { make<ast::BlockExpr>(span, move(block)) };
+    return { m_arena->make<ast::BlockExpr>(span, move(block)) };
 }
 
 ErrorOr<Vector<ast::GenericParameter>> Parser::parse_generic_parameters() {
@@ -317,11 +313,11 @@ ErrorOr<Vector<ast::GenericParameter>> Parser::parse_generic_parameters() {
     while (!m_current.is(TokenKind::Gt)) {
         Token token = TRY(this->expect(TokenKind::Identifier));
 
-        String name = token.value();
+        Identifier name = token.identifier();
         Span span = token.span();
 
         ExprList<ast::TypeExpr> constraints;
-        OwnPtr<ast::TypeExpr> default_type = nullptr;
+        ast::ArenaPtr<ast::TypeExpr> default_type = nullptr;
 
         if (m_current.is(TokenKind::Colon)) {
             this->next();
@@ -384,7 +380,7 @@ ParseResult<ast::TypeAliasExpr> Parser::parse_type_alias(bool is_public) {
     Span span = m_current.span();
     Vector<ast::GenericParameter> parameters;
 
-    String name = TRY(this->expect(TokenKind::Identifier)).value();
+    Identifier name = TRY(this->expect(TokenKind::Identifier)).identifier();
     if (m_current.is(TokenKind::Lt)) {
         parameters = TRY(this->parse_generic_parameters());
     }
@@ -394,7 +390,7 @@ ParseResult<ast::TypeAliasExpr> Parser::parse_type_alias(bool is_public) {
     auto type = TRY(this->parse_type());
     TRY(this->expect(TokenKind::SemiColon));
 
-    return { make<ast::TypeAliasExpr>(span, move(name), move(type), move(parameters), is_public) };
+    return { m_arena->make<ast::TypeAliasExpr>(span, name, move(type), move(parameters), is_public) };
 }
 
 ErrorOr<ast::FunctionParameters> Parser::parse_function_parameters() {
@@ -413,7 +409,7 @@ ErrorOr<ast::FunctionParameters> Parser::parse_function_parameters() {
         u8 flags = 0;
         Span span = m_current.span();
 
-        String name;
+        Identifier name;
         switch (m_current.kind()) {
             case TokenKind::Ellipsis: {
                 is_c_variadic = true;
@@ -427,18 +423,18 @@ ErrorOr<ast::FunctionParameters> Parser::parse_function_parameters() {
 
                 Token token = TRY(this->expect(TokenKind::Identifier));
 
-                name = token.value();
+                name = token.identifier();
                 span = Span { span, token.span() };
             } break;
             case TokenKind::Identifier: {
-                name = m_current.value();
+                name = m_current.identifier();
                 this->next();
             } break;
             default:
                 ASSERT(false, "Unreachable");
         }
 
-        OwnPtr<ast::TypeExpr> type = nullptr;
+        ast::ArenaPtr<ast::TypeExpr> type = nullptr;
         
         // FIXME: A function only has one `self` parameter
         if (name == "self" && m_self_allowed) {
@@ -448,7 +444,7 @@ ErrorOr<ast::FunctionParameters> Parser::parse_function_parameters() {
             type = TRY(this->parse_type());
         }
 
-        OwnPtr<ast::Expr> default_value = nullptr;
+        ast::ArenaPtr<ast::Expr> default_value = nullptr;
         if (m_current.is(TokenKind::Assign)) {
             has_default_values = true;
             this->next();
@@ -460,7 +456,7 @@ ErrorOr<ast::FunctionParameters> Parser::parse_function_parameters() {
             }
         }
 
-        params.push_back({ move(name), move(type), move(default_value), flags, span });
+        params.push_back({ name, move(type), move(default_value), flags, span });
         if (is_c_variadic) {
             break;
         }
@@ -479,13 +475,13 @@ end:
 
 ParseResult<ast::FunctionDeclExpr> Parser::parse_function_decl(LinkageSpecifier linkage, bool with_name, bool is_public, bool is_async) {
     Span start = m_current.span();
-    String name = "<anonymous>";
+    Identifier name("<anonymous>");
 
     Span span;
     if (with_name) {
         Token token = TRY(this->expect(TokenKind::Identifier, "function name"));
         
-        name = token.value();
+        name = token.identifier();
         span = token.span();
         
         TRY(this->expect(TokenKind::LParen));
@@ -494,7 +490,7 @@ ParseResult<ast::FunctionDeclExpr> Parser::parse_function_decl(LinkageSpecifier
     auto [params, is_c_variadic] = TRY(this->parse_function_parameters());
 
     Span end = m_current.span();
-    OwnPtr<ast::TypeExpr> return_type = nullptr;
+    ast::ArenaPtr<ast::TypeExpr> return_type = nullptr;
 
     if (m_current.is(TokenKind::Arrow)) {
         end = this->next().span();
@@ -505,7 +501,7 @@ ParseResult<ast::FunctionDeclExpr> Parser::parse_function_decl(LinkageSpecifier
         span = { start, end };
     }
 
-    return { make<ast::FunctionDeclExpr>(span, move(name), move(params), move(return_type), linkage, is_c_variadic, is_public, is_async) };
+    return { m_arena->make<ast::FunctionDeclExpr>(span, name, move(params), move(return_type), linkage, is_c_variadic, is_public, is_async) };
 }
 
 ParseResult<ast::Expr> Parser::parse_function(LinkageSpecifier linkage, bool is_public, bool is_async) {
@@ -515,20 +511,88 @@ ParseResult<ast::Expr> Parser::parse_function(LinkageSpecifier linkage, bool is_
         return { move(decl) };
     }
     
+    if (m_lazy_function_bodies) {
+        Span span = TRY(this->skip_function_body());
+        ast::LazyFunctionBody body = { span, m_arena, m_self_allowed };
+
+        return { m_arena->make<ast::FunctionExpr>(decl->span(), move(decl), body) };
+    }
+
     TRY(this->expect(TokenKind::LBrace));
     m_in_function = true;
 
     auto body = TRY(this->parse_block());
     m_in_function = false;
 
-    return { make<ast::FunctionExpr>(decl->span(), move(decl), move(body)) };
+    return { m_arena->make<ast::FunctionExpr>(decl->span(), move(decl), move(body)) };
+}
+
+ErrorOr<Span> Parser::skip_function_body() {
+    Span start = TRY(this->expect(TokenKind::LBrace)).span();
+    size_t depth = 1;
+
+    while (true) {
+        switch (m_current.kind()) {
+            case TokenKind::LBrace:
+                depth++;
+                break;
+            case TokenKind::RBrace:
+                depth--;
+                break;
+            case TokenKind::EOS:
+                return err(m_current.span(), "Expected '}}'");
+            default:
+                break;
+        }
+
+        if (!depth) {
+            break;
+        }
+
+        this->next();
+    }
+
+    Span end = m_current.span();
+    this->next();
+
+    return Span { start, end };
+}
+
+ParseResult<ast::BlockExpr> Parser::parse_function_body(ast::LazyFunctionBody const& body) {
+    Lexer lexer(SourceCode::lookup(body.span.source_code_index()));
+
+    // Spans start one past the first character of their token
+    lexer.seek(body.span.start() - 1);
+
+    Parser parser(move(lexer), *body.arena);
+    ast::Arena::Scope scope(*body.arena);
+
+    parser.m_in_function = true;
+    parser.m_self_allowed = body.self_allowed;
+
+    TRY(parser.expect(TokenKind::LBrace));
+    auto result = parser.parse_block();
+
+    if (parser.m_tokens.error().has_value()) {
+        return *parser.m_tokens.error();
+    }
+
+    return result;
+}
+
+ErrorOr<ast::BlockExpr*> ast::FunctionExpr::parse_body() const {
+    if (!m_body) {
+        m_body = TRY(Parser::parse_function_body(*m_lazy_body));
+    }
+
+    return m_body.get();
 }
 
 ParseResult<ast::IfExpr> Parser::parse_if() {
     Span start = m_current.span();
     auto condition = TRY(this->expr(false));
 
-    OwnPtr<ast::Expr> body;
+    ast::ArenaPtr<ast::Expr> body;
     if (!m_current.is(TokenKind::LBrace)) {
         body = TRY(this->statement());
     } else {
@@ -537,7 +601,7 @@ ParseResult<ast::IfExpr> Parser::parse_if() {
     }
 
     Span end = body->span();
-    OwnPtr<ast::Expr> else_body = nullptr;
+    ast::ArenaPtr<ast::Expr> else_body = nullptr;
     if (m_current.is(TokenKind::Else)) {
         this->next();
         if (!m_current.is(TokenKind::LBrace)) {
@@ -551,7 +615,7 @@ ParseResult<ast::IfExpr> Parser::parse_if() {
     }
 
     Span span { start, end };
-    return { make<ast::IfExpr>(span, move(condition), move(body), move(else_body)) };
+    return { m_arena->make<ast::IfExpr>(span, move(condition), move(body), move(else_body)) };
 }
 
 ParseResult<ast::Expr> Parser::parse_for() {
@@ -572,7 +636,7 @@ ParseResult<ast::Expr> Parser::parse_for() {
             inclusive = true;
         }
 
-        OwnPtr<ast::Expr> end = nullptr;
+        ast::ArenaPtr<ast::Expr> end = nullptr;
         if (!m_current.is(TokenKind::LBrace) || inclusive) {
             end = TRY(this->expr(false));
         }
@@ -582,7 +646,7 @@ ParseResult<ast::Expr> Parser::parse_for() {
         auto body = TRY(this->parse_block());
         m_in_loop = has_outer_loop;
 
-        return { make<ast::RangeForExpr>(ident.span, move(ident), inclusive, move(expr), move(end), move(body)) };
+        return { m_arena->make<ast::RangeForExpr>(ident.span, move(ident), inclusive, move(expr), move(end), move(body)) };
     }
 
     TRY(this->expect(TokenKind::LBrace));
@@ -590,14 +654,14 @@ ParseResult<ast::Expr> Parser::parse_for() {
     auto body = TRY(this->parse_block());
     m_in_loop = has_outer_loop;
 
-    return { make<ast::ForExpr>(ident.span, move(ident), move(expr), move(body)) };
+    return { m_arena->make<ast::ForExpr>(ident.span, move(ident), move(expr), move(body)) };
 }
 
 ParseResult<ast::StructExpr> Parser::parse_struct(bool is_public) {
     Span start = m_current.span();
     Token token = TRY(this->expect(TokenKind::Identifier, "struct name"));
     
-    String name = token.value();
+    Identifier name = token.identifier();
     Span end = token.span();
 
     Vector<ast::GenericParameter> parameters;
@@ -608,7 +672,7 @@ ParseResult<ast::StructExpr> Parser::parse_struct(bool is_public) {
         this->next();
         Span span { start, m_current.span() };
 
-        return { make<ast::StructExpr>(span, move(name), true, move(parameters), move(fields), move(members), is_public) };
+        return { m_arena->make<ast::StructExpr>(span, name, true, move(parameters), move(fields), move(members), is_public) };
     }
 
     if (m_current.is(TokenKind::Lt)) {
@@ -655,7 +719,7 @@ ParseResult<ast::StructExpr> Parser::parse_struct(bool is_public) {
                 members.push_back(TRY(this->parse_type_alias(is_field_public)));
             } break;
             case TokenKind::Identifier: {
-                String name = m_current.value();
+                String name(m_current.value());
                 this->next();
 
                 TRY(this->expect(TokenKind::Colon));
@@ -680,20 +744,20 @@ ParseResult<ast::StructExpr> Parser::parse_struct(bool is_public) {
     m_in_struct = false;
 
     Span span { start, end };
-    return { make<ast::StructExpr>(span, move(name), false, move(parameters), move(fields), move(members), is_public) };   
+    return { m_arena->make<ast::StructExpr>(span, name, false, move(parameters), move(fields), move(members), is_public) };   
 }
 
 ErrorOr<ast::Ident> Parser::parse_identifier() {
     bool is_mutable = this->try_expect(TokenKind::Mut).has_value();
     Token token = TRY(this->expect(TokenKind::Identifier, "identifier"));
 
-    return ast::Ident { token.value(), is_mutable, token.span() };
+    return ast::Ident { token.identifier(), is_mutable, token.span() };
 }
 
 ParseResult<ast::Expr> Parser::parse_single_variable_definition(bool is_const, bool is_public) {
     Span span = m_current.span();
 
-    OwnPtr<ast::TypeExpr> type = nullptr;
+    ast::ArenaPtr<ast::TypeExpr> type = nullptr;
     ast::Ident ident = TRY(this->parse_identifier());
 
     if (is_const && ident.is_mutable) {
@@ -705,7 +769,7 @@ ParseResult<ast::Expr> Parser::parse_single_variable_definition(bool is_const, b
         type = TRY(this->parse_type());
     }
 
-    OwnPtr<ast::Expr> expr = nullptr;
+    ast::ArenaPtr<ast::Expr> expr = nullptr;
     Span end = {};
 
     if (!m_current.is(TokenKind::Assign)) {
@@ -727,16 +791,16 @@ ParseResult<ast::Expr> Parser::parse_single_variable_definition(bool is_const, b
             return err(m_current.span(), "Constants must have an initializer");
         }
 
-        return { make<ast::ConstExpr>(span, move(ident.value), move(type), move(expr), is_public) };
+        return { m_arena->make<ast::ConstExpr>(span, move(ident.value), move(type), move(expr), is_public) };
     }
 
-    return { make<ast::AssignmentExpr>(span, move(ident), move(type), move(expr), is_public) };
+    return { m_arena->make<ast::AssignmentExpr>(span, move(ident), move(type), move(expr), is_public) };
 }
 
 ParseResult<ast::Expr> Parser::parse_tuple_variable_definition() {
     Span span = m_current.span();
 
-    OwnPtr<ast::TypeExpr> type = nullptr;
+    ast::ArenaPtr<ast::TypeExpr> type = nullptr;
     Vector<ast::Ident> idents;
 
     bool all_mutable = this->try_expect(TokenKind::Mut).has_value();
@@ -764,7 +828,7 @@ ParseResult<ast::Expr> Parser::parse_tuple_variable_definition() {
         type = TRY(this->parse_type());
     }
 
-    OwnPtr<ast::Expr> expr = nullptr;
+    ast::ArenaPtr<ast::Expr> expr = nullptr;
     Span end = {};
 
     if (!m_current.is(TokenKind::Assign)) {
@@ -781,7 +845,7 @@ ParseResult<ast::Expr> Parser::parse_tuple_variable_definition() {
         end = expr->span();
     }
 
-    return { make<ast::TupleAssignmentExpr>(span, move(idents), move(type), move(expr)) };
+    return { m_arena->make<ast::TupleAssignmentExpr>(span, move(idents), move(type), move(expr)) };
 }
 
 ParseResult<ast::Expr> Parser::parse_variable_definition(bool allow_tuple, bool is_const, bool is_public) {
@@ -793,7 +857,7 @@ ParseResult<ast::Expr> Parser::parse_variable_definition(bool allow_tuple, bool
 }
 
 ParseResult<ast::Expr> Parser::parse_extern(LinkageSpecifier linkage, bool is_public) {
-    OwnPtr<ast::Expr> definition;
+    ast::ArenaPtr<ast::Expr> definition;
     
     ast::Attributes attrs = TRY(this->parse_attributes());
 
@@ -851,7 +915,7 @@ ParseResult<ast::Expr> Parser::parse_extern_block(bool is_public) {
         Span end = TRY(this->expect(TokenKind::RBrace)).span();
         Span span = { start, end };
 
-        return { make<ast::ExternBlockExpr>(span, move(definitions)) };
+        return { m_arena->make<ast::ExternBlockExpr>(span, move(definitions)) };
     }
 
     return this->parse_extern(linkage, is_public);
@@ -859,9 +923,9 @@ ParseResult<ast::Expr> Parser::parse_extern_block(bool is_public) {
 
 ParseResult<ast::EnumExpr> Parser::parse_enum() {
     Span start = m_current.span();
-    String name = TRY(this->expect(TokenKind::Identifier, "enum name")).value();
+    Identifier name = TRY(this->expect(TokenKind::Identifier, "enum name")).identifier();
 
-    OwnPtr<ast::TypeExpr> type = nullptr;
+    ast::ArenaPtr<ast::TypeExpr> type = nullptr;
     if (m_current.is(TokenKind::Colon)) {
         this->next(); 
         type = TRY(this->parse_type());
@@ -871,8 +935,8 @@ ParseResult<ast::EnumExpr> Parser::parse_enum() {
 
     Vector<ast::EnumField> fields;
     while (!m_current.is(TokenKind::RBrace)) {
-        String field = TRY(this->expect(TokenKind::Identifier, "enum field name")).value();
-        OwnPtr<ast::Expr> value = nullptr;
+        String field(TRY(this->expect(TokenKind::Identifier, "enum field name")).value());
+        ast::ArenaPtr<ast::Expr> value = nullptr;
 
         if (m_current.is(TokenKind::Assign)) {
             this->next();
@@ -890,12 +954,12 @@ ParseResult<ast::EnumExpr> Parser::parse_enum() {
     Span end = TRY(this->expect(TokenKind::RBrace)).span();
     Span span { start, end };
 
-    return { make<ast::EnumExpr>(span, move(name), move(type), move(fields)) };
+    return { m_arena->make<ast::EnumExpr>(span, name, move(type), move(fields)) };
 }
 
 ParseResult<ast::Expr> Parser::parse_anonymous_function() {
     auto [params, _] = TRY(this->parse_function_parameters());
-    OwnPtr<ast::TypeExpr> return_type = nullptr;
+    ast::ArenaPtr<ast::TypeExpr> return_type = nullptr;
 
     if (m_current.is(TokenKind::Colon)) {
         this->next();
@@ -911,21 +975,21 @@ ParseResult<ast::Expr> Parser::parse_anonymous_function() {
     Span end = params.back().span;
 
     Span span = { start, end };
-    auto decl = make<ast::FunctionDeclExpr>(
-        span, "<anonymous>", move(params), move(return_type), LinkageSpecifier::None, false, true, false
+    auto decl = m_arena->make<ast::FunctionDeclExpr>(
+        span, Identifier("<anonymous>"), move(params), move(return_type), LinkageSpecifier::None, false, true, false
     );
 
-    return { make<ast::FunctionExpr>(span, move(decl), make<ast::BlockExpr>(span, move(body))) };
+    return { m_arena->make<ast::FunctionExpr>(span, move(decl), m_arena->make<ast::BlockExpr>(span, move(body))) };
 }
 
-ParseResult<ast::CallExpr> Parser::parse_call(OwnPtr<ast::Expr> callee) {
+ParseResult<ast::CallExpr> Parser::parse_call(ast::ArenaPtr<ast::Expr> callee) {
     ExprList<> args;
-    HashMap<String, OwnPtr<ast::Expr>> kwargs;
+    HashMap<String, ast::ArenaPtr<ast::Expr>> kwargs;
 
     bool has_kwargs = false;
     while (!m_current.is(TokenKind::RParen)) {
         if (m_current.is(TokenKind::Identifier) && this->peek().is(TokenKind::Colon)) {
-            String name = m_current.value();
+            String name(m_current.value());
             this->skip(2);
 
             auto expr = TRY(this->expr(false));
@@ -949,7 +1013,7 @@ ParseResult<ast::CallExpr> Parser::parse_call(OwnPtr<ast::Expr> callee) {
     TRY(this->expect(TokenKind::RParen));
     Span span = { callee->span(), m_current.span() };
 
-    return { make<ast::CallExpr>(span, move(callee), move(args), move(kwargs)) };
+    return { m_arena->make<ast::CallExpr>(span, move(callee), move(args), move(kwargs)) };
 }
 
 ParseResult<ast::MatchExpr> Parser::parse_match() {
@@ -1017,7 +1081,7 @@ ParseResult<ast::MatchExpr> Parser::parse_match() {
     }
 
     TRY(this->expect(TokenKind::RBrace));
-    return { make<ast::MatchExpr>(value->span(), move(value), move(arms)) };
+    return { m_arena->make<ast::MatchExpr>(value->span(), move(value), move(arms)) };
 }
 
 ParseResult<ast::Expr> Parser::parse_impl() {
@@ -1029,7 +1093,7 @@ ParseResult<ast::Expr> Parser::parse_impl() {
     }
 
     auto type = TRY(this->parse_type());
-    OwnPtr<ast::TypeExpr> trait = nullptr;
+    ast::ArenaPtr<ast::TypeExpr> trait = nullptr;
 
     if (m_current.is(TokenKind::For)) {
         if (!parameters.empty()) {
@@ -1069,11 +1133,11 @@ ParseResult<ast::Expr> Parser::parse_impl() {
     span = type->span();
 
     if (trait) {
-        return { make<ast::ImplTraitExpr>(span, move(trait), move(type), move(body)) };
+        return { m_arena->make<ast::ImplTraitExpr>(span, move(trait), move(type), move(body)) };
     }
 
-    auto block = make<ast::BlockExpr>(span, move(body));
-    return { make<ast::ImplExpr>(span, move(type), move(block), move(parameters)) };
+    auto block = m_arena->make<ast::BlockExpr>(span, move(body));
+    return { m_arena->make<ast::ImplExpr>(span, move(type), move(block), move(parameters)) };
 }
 
 ParseResult<ast::TraitExpr> Parser::parse_trait() {
@@ -1084,7 +1148,7 @@ ParseResult<ast::TraitExpr> Parser::parse_trait() {
         parameters = TRY(this->parse_generic_parameters());
     }
 
-    String name = token.value();
+    Identifier name = token.identifier();
     Span span = token.span();
 
     ExprList<> body;
@@ -1108,7 +1172,7 @@ ParseResult<ast::TraitExpr> Parser::parse_trait() {
     }
 
     TRY(this->expect(TokenKind::RBrace));
-    return { make<ast::TraitExpr>(span, move(name), move(body), move(parameters)) };
+    return { m_arena->make<ast::TraitExpr>(span, name, move(body), move(parameters)) };
 }
  
 ParseResult<ast::Expr> Parser::parse_pub() {
@@ -1154,17 +1218,17 @@ ParseResult<ast::Expr> Parser::parse_async() {
     return this->parse_function(LinkageSpecifier::None, false, true);
 }
 
-ErrorOr<Path> Parser::parse_path(Optional<String> name, ExprList<ast::TypeExpr> arguments, bool ignore_last, bool allow_generic_arguments) {
+ErrorOr<Path> Parser::parse_path(Optional<Identifier> name, ExprList<ast::TypeExpr> arguments, bool ignore_last, bool allow_generic_arguments) {
     PathSegment segment = {};
     if (!name.has_value()) {
-        String name = TRY(this->expect(TokenKind::Identifier)).value();
+        Identifier name = TRY(this->expect(TokenKind::Identifier)).identifier();
         ExprList<ast::TypeExpr> arguments;
 
         if (m_current.is(TokenKind::Lt) && allow_generic_arguments) {
             arguments = TRY(this->parse_generic_arguments());
         }
 
-        segment = { move(name), move(arguments) };
+        segment = { name, move(arguments) };
     } else {
         ExprList<ast::TypeExpr> args;
         if (arguments.empty() && m_current.is(TokenKind::Lt) && allow_generic_arguments) {
@@ -1173,7 +1237,7 @@ ErrorOr<Path> Parser::parse_path(Optional<String> name, ExprList<ast::TypeExpr>
             args = move(arguments);
         }
 
-        segment = { move(name.value()), move(args) };
+        segment = { *name, move(args) };
     }
 
     Path path { move(segment), {} };
@@ -1192,15 +1256,27 @@ ErrorOr<Path> Parser::parse_path(Optional<String> name, ExprList<ast::TypeExpr>
             arguments = TRY(this->parse_generic_arguments());
         }
 
-        path.push({ option->value(), move(arguments) });
+        path.push({ option->identifier(), move(arguments) });
     }
     
     path.rearrange();
     return path;
 }
 
-ErrorOr<ExprList<>> Parser::parse() {
-    return this->statements();
+ErrorOr<ParsedModule> Parser::parse() {
+    ast::Arena::Scope scope(*m_arena);
+    auto result = this->statements();
+
+    // A lexer error ends the token stream early so whatever the parser reported is only a consequence of it
+    if (m_tokens.error().has_value()) {
+        return *m_tokens.error();
+    }
+
+    if (result.is_err()) {
+        return result.release_error();
+    }
+
+    return ParsedModule { move(m_owned_arena), result.release_value() };
 }
 
 ErrorOr<ExprList<>> Parser::statements() {
@@ -1241,7 +1317,7 @@ ParseResult<ast::Expr> Parser::statement() {
             Span start = m_current.span();
             this->next();
 
-            OwnPtr<ast::Expr> expr = nullptr;
+            ast::ArenaPtr<ast::Expr> expr = nullptr;
             if (!m_current.is(TokenKind::SemiColon)) {
                 expr = TRY(this->expr(false));
             }
@@ -1249,7 +1325,7 @@ ParseResult<ast::Expr> Parser::statement() {
             Span end = TRY(this->expect(TokenKind::SemiColon)).span();
             Span span = { start, end };
 
-            return { make<ast::ReturnExpr>(span, move(expr)) };
+            return { m_arena->make<ast::ReturnExpr>(span, move(expr)) };
         } 
         case TokenKind::If: {
             this->next();
@@ -1286,7 +1362,7 @@ ParseResult<ast::Expr> Parser::statement() {
             m_in_loop = has_outer_loop;
             Span span = { start, condition->span() };
 
-            return { make<ast::WhileExpr>(span, move(condition), move(body)) };
+            return { m_arena->make<ast::WhileExpr>(span, move(condition), move(body)) };
         }
         case TokenKind::Break: {
             if (!m_in_loop) {
@@ -1297,7 +1373,7 @@ ParseResult<ast::Expr> Parser::statement() {
             this->next();
 
             TRY(this->expect(TokenKind::SemiColon));
-            return { make<ast::BreakExpr>(span) };
+            return { m_arena->make<ast::BreakExpr>(span) };
         } 
         case TokenKind::Continue: {
             if (!m_in_loop) {
@@ -1308,22 +1384,20 @@ ParseResult<ast::Expr> Parser::statement() {
             this->next();
 
             TRY(this->expect(TokenKind::SemiColon));
-            return { make<ast::ContinueExpr>(span) };
+            return { m_arena->make<ast::ContinueExpr>(span) };
         } 
         case TokenKind::Using: {
             Span start = m_current.span();
             this->next();
 
-            Vector<String> symbols;
+            Vector<Identifier> symbols;
 
             if (!m_current.is(TokenKind::LParen)) {
-                String symbol = TRY(this->expect(TokenKind::Identifier)).value();
-                symbols.push_back(move(symbol));
+                symbols.push_back(TRY(this->expect(TokenKind::Identifier)).identifier());
             } else {
                 this->next();
                 while (!m_current.is(TokenKind::RParen)) {
-                    String symbol = TRY(this->expect(TokenKind::Identifier)).value();
-                    symbols.push_back(move(symbol));
+                    symbols.push_back(TRY(this->expect(TokenKind::Identifier)).identifier());
 
                     if (!m_current.is(TokenKind::Comma)) {
                         break;
@@ -1343,7 +1417,7 @@ ParseResult<ast::Expr> Parser::statement() {
             Path path = TRY(this->parse_path());
 
             Span span = start; // FIXME:
-            return { make<ast::UsingExpr>(span, move(path), move(symbols)) };
+            return { m_arena->make<ast::UsingExpr>(span, move(path), move(symbols)) };
         } 
         case TokenKind::Defer: {
             if (!m_in_function) {
@@ -1354,7 +1428,7 @@ ParseResult<ast::Expr> Parser::statement() {
             this->next();
 
             auto expr = TRY(this->expr());
-            return { make<ast::DeferExpr>(span, move(expr)) };
+            return { m_arena->make<ast::DeferExpr>(span, move(expr)) };
         } 
         case TokenKind::Enum: {
             this->next();
@@ -1373,15 +1447,14 @@ ParseResult<ast::Expr> Parser::statement() {
             Path path = TRY(this->parse_path({}, {}, true));
             bool is_wildcard = false;
 
-            Vector<String> symbols;
+            Vector<Identifier> symbols;
             if (m_current.is(TokenKind::Mul)) {
                 is_wildcard = true;
                 this->next();
             } else if (m_current.is(TokenKind::LBrace)) {
                 this->next();
                 while (!m_current.is(TokenKind::RBrace)) {
-                    String symbol = TRY(this->expect(TokenKind::Identifier)).value();
-                    symbols.push_back(move(symbol));
+                    symbols.push_back(TRY(this->expect(TokenKind::Identifier)).identifier());
 
                     if (!m_current.is(TokenKind::Comma)) {
                         break;
@@ -1397,20 +1470,20 @@ ParseResult<ast::Expr> Parser::statement() {
             Span span = { start, end };
             
             // FIXME: Rather than an ImportExpr, we should just resolve the everything here and return ModuleExpr
-            return { make<ast::ImportExpr>(span, move(path), is_wildcard, is_relative, move(symbols)) };
+            return { m_arena->make<ast::ImportExpr>(span, move(path), is_wildcard, is_relative, move(symbols)) };
         }
         case TokenKind::Module: {
             this->next();
 
             Token token = TRY(this->expect(TokenKind::Identifier));
 
-            String name = token.value();
+            Identifier name = token.identifier();
             Span span = token.span();
 
             TRY(this->expect(TokenKind::LBrace));
             auto [body, _] = TRY(this->parse_expr_block());
 
-            return { make<ast::ModuleExpr>(span, move(name), move(body)) };
+            return { m_arena->make<ast::ModuleExpr>(span, name, move(body)) };
         }
         case TokenKind::For: {
             this->next();
@@ -1430,7 +1503,7 @@ ParseResult<ast::Expr> Parser::statement() {
             }
 
             TRY(this->expect_and(TokenKind::RParen, TokenKind::SemiColon));
-            return { make<ast::StaticAssertExpr>(span, move(expr), move(message)) };
+            return { m_arena->make<ast::StaticAssertExpr>(span, move(expr), move(message)) };
         }
         case TokenKind::Impl: {
             this->next();
@@ -1453,7 +1526,7 @@ ParseResult<ast::Expr> Parser::statement() {
             TRY(this->expect(TokenKind::LBrace));
 
             auto [body, span] = TRY(this->parse_expr_block());
-            return { make<ast::ConstEvalExpr>(span, move(body)) };
+            return { m_arena->make<ast::ConstEvalExpr>(span, move(body)) };
         };
         case TokenKind::SemiColon:
             this->next();
@@ -1500,7 +1573,7 @@ ParseResult<ast::Expr> Parser::expr(bool enforce_semicolon) {
     return expr;
 }
 
-ParseResult<ast::Expr> Parser::binary(i32 prec, OwnPtr<ast::Expr> left) {
+ParseResult<ast::Expr> Parser::binary(i32 prec, ast::ArenaPtr<ast::Expr> left) {
     while (true) {
         i8 precedence = m_current.precedence();
         if (precedence < prec) {
@@ -1520,16 +1593,16 @@ ParseResult<ast::Expr> Parser::binary(i32 prec, OwnPtr<ast::Expr> left) {
        
         Span span = { left->span(), right->span() };
         if (INPLACE_OPERATORS.find(kind) != INPLACE_OPERATORS.end()) {
-            left = make<ast::InplaceBinaryOpExpr>(span, op, move(left), move(right));
+            left = m_arena->make<ast::InplaceBinaryOpExpr>(span, op, move(left), move(right));
         } else {
-            left = make<ast::BinaryOpExpr>(span, op, move(left), move(right));
+            left = m_arena->make<ast::BinaryOpExpr>(span, op, move(left), move(right));
         }
     }
 }
 
 ParseResult<ast::Expr> Parser::unary() {
     auto iterator = UNARY_OPS.find(m_current.kind());
-    OwnPtr<ast::Expr> expr = nullptr;
+    ast::ArenaPtr<ast::Expr> expr = nullptr;
 
     if (iterator == UNARY_OPS.end()) {
         expr = TRY(this->call());
@@ -1542,7 +1615,7 @@ ParseResult<ast::Expr> Parser::unary() {
         auto value = TRY(this->call());
 
         Span span = Span { start, value->span() };
-        expr = make<ast::ReferenceExpr>(span, move(value), is_mutable);
+        expr = m_arena->make<ast::ReferenceExpr>(span, move(value), is_mutable);
     } else {
         Span start = m_current.span();
 
@@ -1552,7 +1625,7 @@ ParseResult<ast::Expr> Parser::unary() {
         auto value = TRY(this->call());
 
         Span span = Span { start, value->span() };
-        expr = make<ast::UnaryOpExpr>(span, move(value), op);
+        expr = m_arena->make<ast::UnaryOpExpr>(span, move(value), op);
     }
 
     switch (m_current.kind()) {
@@ -1561,7 +1634,7 @@ ParseResult<ast::Expr> Parser::unary() {
             auto type = TRY(this->parse_type());
 
             Span span = { expr->span(), type->span() };
-            return { make<ast::CastExpr>(span, move(expr), move(type)) };
+            return { m_arena->make<ast::CastExpr>(span, move(expr), move(type)) };
         }
         case TokenKind::If: {
             this->next();
@@ -1573,7 +1646,7 @@ ParseResult<ast::Expr> Parser::unary() {
             auto else_expr = TRY(this->expr(false));
 
             Span span = { expr->span(), else_expr->span() };
-            return { make<ast::TernaryExpr>(span, move(condition), move(expr), move(else_expr)) };
+            return { m_arena->make<ast::TernaryExpr>(span, move(condition), move(expr), move(else_expr)) };
         }
         default:
             return expr;
@@ -1593,7 +1666,7 @@ ParseResult<ast::Expr> Parser::call() {
         UnaryOp op = m_current.kind() == TokenKind::Inc ? UnaryOp::Inc : UnaryOp::Dec;
         Span span = { start, m_current.span() };
 
-        expr = make<ast::UnaryOpExpr>(span, move(expr), op);
+        expr = m_arena->make<ast::UnaryOpExpr>(span, move(expr), op);
         this->next();
     } else if (this->is_upcoming_constructor(*expr)) {
         this->next();
@@ -1604,7 +1677,7 @@ ParseResult<ast::Expr> Parser::call() {
             TRY(this->expect(TokenKind::Colon));
 
             auto value = TRY(this->expr(false));
-            arguments.push_back({ token.value(), move(value), token.span() });
+            arguments.push_back({ String(token.value()), move(value), token.span() });
 
             if (!m_current.is(TokenKind::Comma)) {
                 break;
@@ -1614,7 +1687,7 @@ ParseResult<ast::Expr> Parser::call() {
         }
 
         TRY(this->expect(TokenKind::RBrace));
-        expr = make<ast::ConstructorExpr>(expr->span(), move(expr), move(arguments));
+        expr = m_arena->make<ast::ConstructorExpr>(expr->span(), move(expr), move(arguments));
     }
 
 
@@ -1629,15 +1702,15 @@ ParseResult<ast::Expr> Parser::call() {
     return expr;
 }
 
-ParseResult<ast::Expr> Parser::attribute(OwnPtr<ast::Expr> expr) {
+ParseResult<ast::Expr> Parser::attribute(ast::ArenaPtr<ast::Expr> expr) {
     while (m_current.is(TokenKind::Dot)) {
         this->next();
         Token token = TRY(this->expect(TokenKind::Identifier));
 
-        String value = token.value();
+        String value(token.value());
         Span span = { expr->span(), token.span() };
 
-        expr = make<ast::AttributeExpr>(span, move(expr), value);
+        expr = m_arena->make<ast::AttributeExpr>(span, move(expr), value);
 
         if (m_current.is(TokenKind::LParen)) {
             this->next();
@@ -1652,7 +1725,7 @@ ParseResult<ast::Expr> Parser::attribute(OwnPtr<ast::Expr> expr) {
     return expr;
 }
 
-ParseResult<ast::Expr> Parser::index(OwnPtr<ast::Expr> expr) {
+ParseResult<ast::Expr> Parser::index(ast::ArenaPtr<ast::Expr> expr) {
     while (m_current.is(TokenKind::LBracket)) {
         this->next();
         auto index = TRY(this->expr(false));
@@ -1660,7 +1733,7 @@ ParseResult<ast::Expr> Parser::index(OwnPtr<ast::Expr> expr) {
         TRY(this->expect(TokenKind::RBracket));
         Span span = { expr->span(), m_current.span() };
 
-        expr = make<ast::IndexExpr>(span, move(expr), move(index));
+        expr = m_arena->make<ast::IndexExpr>(span, move(expr), move(index));
     }
 
     if (m_current.is(TokenKind::Dot)) {
@@ -1671,12 +1744,12 @@ ParseResult<ast::Expr> Parser::index(OwnPtr<ast::Expr> expr) {
 }
 
 ParseResult<ast::Expr> Parser::primary() {
-    OwnPtr<ast::Expr> expr = nullptr;
+    ast::ArenaPtr<ast::Expr> expr = nullptr;
     Span start = m_current.span();
 
     switch (m_current.kind()) {
         case TokenKind::Integer: {
-            String value = m_current.value();
+            String value(m_current.value());
             this->next();
 
             ast::IntegerSuffix suffix;
@@ -1699,14 +1772,14 @@ ParseResult<ast::Expr> Parser::primary() {
             }
 
             u64 result = std::strtoull(value.c_str(), nullptr, base);
-            return { make<ast::IntegerExpr>(start, result, suffix) };
+            return { m_arena->make<ast::IntegerExpr>(start, result, suffix) };
         }
         case TokenKind::Char: {
-            String value = m_current.value();
+            String value(m_current.value());
             this->next();
 
             ast::IntegerSuffix suffix { ast::BuiltinType::i8 };
-            return { make<ast::IntegerExpr>(start, value[0], suffix) };
+            return { m_arena->make<ast::IntegerExpr>(start, value[0], suffix) };
         }
         case TokenKind::Float: {
             double result = 0.0;
@@ -1720,13 +1793,13 @@ ParseResult<ast::Expr> Parser::primary() {
                 is_double = true;
             }
 
-            return { make<ast::FloatExpr>(start, result, is_double) };
+            return { m_arena->make<ast::FloatExpr>(start, result, is_double) };
         }
         case TokenKind::String: {
-            String value = m_current.value();
+            String value(m_current.value());
             this->next();
 
-            expr = make<ast::StringExpr>(start, value);
+            expr = m_arena->make<ast::StringExpr>(start, value);
             break;
         }
         
@@ -1735,16 +1808,16 @@ ParseResult<ast::Expr> Parser::primary() {
         case TokenKind::Null: BOOL_EXPR(Null);
 
         case TokenKind::Identifier: {
-            String name = m_current.value();
+            Identifier name = m_current.identifier();
             this->next();
 
             if (m_current.is(TokenKind::DoubleColon)) {
                 Path path = TRY(this->parse_path(name));
                 Span span { start, m_current.span() };
 
-                expr = make<ast::PathExpr>(span, move(path));
+                expr = m_arena->make<ast::PathExpr>(span, move(path));
             } else {
-                expr = make<ast::IdentifierExpr>(start, name);
+                expr = m_arena->make<ast::IdentifierExpr>(start, name);
             }
 
             break;
@@ -1753,12 +1826,12 @@ ParseResult<ast::Expr> Parser::primary() {
             this->next();
             
             TRY(this->expect(TokenKind::LParen));
-            OwnPtr<ast::Expr> expr = TRY(this->expr(false));
+            ast::ArenaPtr<ast::Expr> expr = TRY(this->expr(false));
 
             TRY(this->expect(TokenKind::RParen));
 
             // TODO: sizeof for types
-            return { make<ast::SizeofExpr>(start, move(expr)) };
+            return { m_arena->make<ast::SizeofExpr>(start, move(expr)) };
         }
         case TokenKind::Offsetof: {
             this->next();
@@ -1767,9 +1840,9 @@ ParseResult<ast::Expr> Parser::primary() {
             auto value = TRY(this->expr(false));
 
             TRY(this->expect(TokenKind::Comma));
-            String field = TRY(this->expect(TokenKind::Identifier)).value();
+            String field(TRY(this->expect(TokenKind::Identifier)).value());
 
-            return { make<ast::OffsetofExpr>(start, move(value), field) };
+            return { m_arena->make<ast::OffsetofExpr>(start, move(value), field) };
         }
         case TokenKind::Match: {
             this->next();
@@ -1802,7 +1875,7 @@ ParseResult<ast::Expr> Parser::primary() {
                 Span end = TRY(this->expect(TokenKind::RParen)).span();
                 Span span = { start, end };
 
-                expr = make<ast::TupleExpr>(span, move(elements));
+                expr = m_arena->make<ast::TupleExpr>(span, move(elements));
             } else {
                 TRY(this->expect(TokenKind::RParen));
             }
@@ -1821,7 +1894,7 @@ ParseResult<ast::Expr> Parser::primary() {
                     TRY(this->expect(TokenKind::RBracket));
                     Span span = { start, m_current.span() };
 
-                    return { make<ast::ArrayFillExpr>(span, move(element), move(size)) };
+                    return { m_arena->make<ast::ArrayFillExpr>(span, move(element), move(size)) };
                 }
 
                 elements.push_back(move(element));
@@ -1844,7 +1917,7 @@ ParseResult<ast::Expr> Parser::primary() {
             Span end = TRY(this->expect(TokenKind::RBracket)).span();
             Span span = { start, end };
 
-            expr = make<ast::ArrayExpr>(span, move(elements));
+            expr = m_arena->make<ast::ArrayExpr>(span, move(elements));
             break;
         }
         case TokenKind::LBrace: {
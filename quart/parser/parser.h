@@ -1,19 +1,19 @@
 #pragma once
 
 #include <quart/lexer/tokens.h>
+#include <quart/lexer/token_stream.h>
 #include <quart/parser/ast.h>
 
-#include <map>
 
 namespace quart {
 
 template<typename T>
-class ParseResult : public ErrorOr<OwnPtr<T>> {
+class ParseResult : public ErrorOr<ast::ArenaPtr<T>> {
 public:
     ParseResult() = default;
 
-    ParseResult(OwnPtr<T> value) : ErrorOr<OwnPtr<T>>(move(value)) {}
-    ParseResult(Error error) : ErrorOr<OwnPtr<T>>(move(error)) {}
+    ParseResult(ast::ArenaPtr<T> value) : ErrorOr<ast::ArenaPtr<T>>(move(value)) {}
+    ParseResult(Error error) : ErrorOr<ast::ArenaPtr<T>>(move(error)) {}
 
     template<typename U> requires(std::is_base_of_v<T, U>)
     ParseResult(ParseResult<U> other) {
@@ -25,6 +25,13 @@ public:
     }
 };
 
+// The top-level expressions of a module along with the arena that owns them.
+// Nothing in `ast` can be used once this is destroyed.
+struct ParsedModule {
+    OwnPtr<ast::Arena> arena;
+    ExprList<> ast;
+};
+
 struct ExprBlock {
     ExprList<> block;
     Span span;
@@ -43,18 +50,23 @@ public:
 
     using AttributeFunc = ErrorOr<Attribute>(*)(Parser &);
     
-    Parser(Vector<Token> tokens);
+    Parser(Lexer lexer);
+
+    // Allocates nodes in `arena` instead of an arena of its own. `parse` can't be used on such a parser.
+    Parser(Lexer lexer, ast::Arena& arena);
 
     void set_attributes(HashMap<StringView, AttributeFunc> attributes);
 
+    // Skips over the bodies of functions and only parses them when they're first needed, see `ast::FunctionExpr::parse_body`
+    void set_lazy_function_bodies(bool value) { m_lazy_function_bodies = value; }
+
     Token next();
     void skip(size_t n = 1);
 
     Token const& back();
-    Token rewind(size_t n = 1);
 
+    // `offset` can't be larger than `TokenStream::MAX_LOOKAHEAD`
     Token const& peek(size_t offset = 1) const;
-    Token& peek(size_t offset = 1);
 
     [[nodiscard]] ErrorOr<Token> expect(TokenKind, StringView value = {});
     [[nodiscard]] Optional<Token> try_expect(TokenKind);
@@ -97,6 +109,10 @@ public:
         LinkageSpecifier linkage = LinkageSpecifier::None, bool is_public = false, bool is_async = false
     );
 
+    // Brace matches from the opening brace of a function body to its closing one without parsing anything in between
+    ErrorOr<Span> skip_function_body();
+    static ParseResult<ast::BlockExpr> parse_function_body(ast::LazyFunctionBody const&);
+
     ErrorOr<Vector<ast::GenericParameter>> parse_generic_parameters();
     ErrorOr<ExprList<ast::TypeExpr>> parse_generic_arguments();
 
@@ -129,37 +145,39 @@ public:
     ParseResult<ast::Expr> parse_pub();
     ParseResult<ast::Expr> parse_async();
 
-    ParseResult<ast::CallExpr> parse_call(OwnPtr<ast::Expr> callee);
+    ParseResult<ast::CallExpr> parse_call(ast::ArenaPtr<ast::Expr> callee);
 
-    // Parses `foo::bar::baz` into a deque of strings
+    // Parses `foo::bar::baz` into a deque of identifiers
     [[nodiscard]] ErrorOr<Path> parse_path(
-        Optional<String> name = {},
+        Optional<Identifier> name = {},
         ExprList<ast::TypeExpr> arguments = {},
         bool ignore_last = false,
         bool allow_generic_arguments = true
     );
 
-    ParseResult<ast::Expr> parse_immediate_binary_op(OwnPtr<ast::Expr> right, OwnPtr<ast::Expr> left, TokenKind op);
-    ParseResult<ast::Expr> parse_immediate_unary_op(OwnPtr<ast::Expr> expr, TokenKind op);
+    ParseResult<ast::Expr> parse_immediate_binary_op(ast::ArenaPtr<ast::Expr> right, ast::ArenaPtr<ast::Expr> left, TokenKind op);
+    ParseResult<ast::Expr> parse_immediate_unary_op(ast::ArenaPtr<ast::Expr> expr, TokenKind op);
 
     ErrorOr<ast::Attributes> parse_attributes();
 
-    ErrorOr<ExprList<>> parse();
+    // Hands the arena over to the returned module, so this can only be called once
+    ErrorOr<ParsedModule> parse();
     ErrorOr<ExprList<>> statements();
 
     ParseResult<ast::Expr> statement();
     ParseResult<ast::Expr> expr(bool enforce_semicolon = true);
-    ParseResult<ast::Expr> binary(i32 prec, OwnPtr<ast::Expr> left);
+    ParseResult<ast::Expr> binary(i32 prec, ast::ArenaPtr<ast::Expr> left);
     ParseResult<ast::Expr> unary();
     ParseResult<ast::Expr> call();
-    ParseResult<ast::Expr> attribute(OwnPtr<ast::Expr> expr);
-    ParseResult<ast::Expr> index(OwnPtr<ast::Expr> expr);
+    ParseResult<ast::Expr> attribute(ast::ArenaPtr<ast::Expr> expr);
+    ParseResult<ast::Expr> index(ast::ArenaPtr<ast::Expr> expr);
     ParseResult<ast::Expr> primary();
 
 private:
-    Vector<Token> m_tokens;
+    OwnPtr<ast::Arena> m_owned_arena;
+    ast::Arena* m_arena;
 
-    size_t m_offset = 0;
+    TokenStream m_tokens;
     Token m_current;
 
     bool m_in_function = false;
@@ -167,10 +185,12 @@ private:
     bool m_in_struct = false;
     bool m_self_allowed = false;
 
+    bool m_lazy_function_bodies = false;
+
     HashMap<StringView, AttributeFunc> m_attributes;
 };
 
-static const std::map<StringView, ast::BuiltinType> STR_TO_TYPE = {
+static const HashMap<StringView, ast::BuiltinType> STR_TO_TYPE = {
     { "void", ast::BuiltinType::Void },
     { "bool", ast::BuiltinType::Bool },
     { "i8", ast::BuiltinType::i8 },
@@ -0,0 +1,1221 @@
+#include <quart/parser/serialization.h>
+
+#include <cstring>
+
+namespace quart::ast {
+
+namespace {
+
+class Writer {
+public:
+    String take() { return move(m_buffer); }
+
+    void write_u8(u8 value) { m_buffer.push_back(static_cast<char>(value)); }
+    void write_bool(bool value) { this->write_u8(value); }
+
+    template<typename E> requires(std::is_enum_v<E>)
+    void write_enum(E value) { this->write_u8(static_cast<u8>(value)); }
+
+    void write_varint(u64 value) {
+        while (value >= 0x80) {
+            this->write_u8(static_cast<u8>(value) | 0x80);
+            value >>= 7;
+        }
+
+        this->write_u8(static_cast<u8>(value));
+    }
+
+    void write_f64(f64 value) {
+        u64 bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        for (size_t i = 0; i < sizeof(bits); i++) {
+            this->write_u8(static_cast<u8>(bits >> (i * 8)));
+        }
+    }
+
+    void write_string(StringView value) {
+        this->write_varint(value.size());
+        m_buffer.append(value);
+    }
+
+    void write_identifiers(Vector<Identifier> const& values) {
+        this->write_varint(values.size());
+        for (auto& value : values) {
+            this->write_string(value);
+        }
+    }
+
+    void write_span(Span span) {
+        this->write_varint(span.start());
+        this->write_varint(span.end());
+    }
+
+    void write_ident(Ident const& ident) {
+        this->write_string(ident.value);
+        this->write_bool(ident.is_mutable);
+        this->write_span(ident.span);
+    }
+
+    void write_path(Path const& path) {
+        this->write_segment(path.last());
+
+        this->write_varint(path.segments().size());
+        for (auto& segment : path.segments()) {
+            this->write_segment(segment);
+        }
+    }
+
+    void write_segment(PathSegment const& segment) {
+        this->write_string(segment.name());
+        this->write(segment.arguments());
+    }
+
+    void write_attributes(Attributes const& attributes) {
+        this->write_varint(attributes.value().size());
+        for (auto& [type, attribute] : attributes) {
+            this->write_enum(type);
+            if (type != Attribute::Link) {
+                continue;
+            }
+
+            auto info = attribute.value<RefPtr<LinkInfo>>();
+
+            this->write_string(info->name);
+            this->write_string(info->arch);
+            this->write_string(info->section);
+            this->write_string(info->platform);
+        }
+    }
+
+    void write_generic_parameters(Vector<GenericParameter> const& parameters) {
+        this->write_varint(parameters.size());
+        for (auto& parameter : parameters) {
+            this->write_string(parameter.name);
+            this->write(parameter.constraints);
+            this->write(parameter.default_type.get());
+            this->write_span(parameter.span);
+        }
+    }
+
+    template<typename T>
+    void write(ExprList<T> const& list) {
+        this->write_varint(list.size());
+        for (auto& expr : list) {
+            this->write(expr.get());
+        }
+    }
+
+    void write(TypeExpr const* type);
+    void write(Expr const* expr);
+
+private:
+    void write_fields(Expr const& expr);
+
+    String m_buffer;
+};
+
+void Writer::write(TypeExpr const* type) {
+    if (!type) {
+        this->write_u8(0);
+        return;
+    }
+
+    this->write_u8(static_cast<u8>(type->kind()) + 1);
+    this->write_span(type->span());
+
+    switch (type->kind()) {
+        case TypeKind::Builtin:
+            this->write_enum(type->as<BuiltinTypeExpr>()->value());
+            break;
+        case TypeKind::Integer:
+            this->write(&type->as<IntegerTypeExpr>()->size());
+            break;
+        case TypeKind::Named:
+            this->write_path(type->as<NamedTypeExpr>()->path());
+            break;
+        case TypeKind::Tuple:
+            this->write(type->as<TupleTypeExpr>()->types());
+            break;
+        case TypeKind::Array: {
+            auto* array = type->as<ArrayTypeExpr>();
+
+            this->write(&array->type());
+            this->write(&array->size());
+
+            break;
+        }
+        case TypeKind::Pointer: {
+            auto* pointer = type->as<PointerTypeExpr>();
+
+            this->write(&pointer->pointee());
+            this->write_bool(pointer->is_mutable());
+
+            break;
+        }
+        case TypeKind::Reference: {
+            auto* reference = type->as<ReferenceTypeExpr>();
+
+            this->write(&reference->type());
+            this->write_bool(reference->is_mutable());
+
+            break;
+        }
+        case TypeKind::Function: {
+            auto* function = type->as<FunctionTypeExpr>();
+
+            this->write(function->parameters());
+            this->write(function->return_type());
+
+            break;
+        }
+        case TypeKind::Generic: {
+            auto* generic = type->as<GenericTypeExpr>();
+
+            this->write(&generic->parent());
+            this->write(generic->args());
+
+            break;
+        }
+    }
+}
+
+void Writer::write(Expr const* expr) {
+    if (!expr) {
+        this->write_u8(0);
+        return;
+    }
+
+    this->write_u8(static_cast<u8>(expr->kind()) + 1);
+    this->write_span(expr->span());
+    this->write_attributes(expr->attributes());
+
+    this->write_fields(*expr);
+}
+
+void Writer::write_fields(Expr const& expr) {
+    switch (expr.kind()) {
+        case ExprKind::Block:
+            this->write(static_cast<BlockExpr const&>(expr).block());
+            break;
+        case ExprKind::ExternBlock:
+            this->write(static_cast<ExternBlockExpr const&>(expr).block());
+            break;
+        case ExprKind::Integer: {
+            auto& integer = static_cast<IntegerExpr const&>(expr);
+
+            this->write_varint(integer.value());
+            this->write_enum(integer.suffix().type);
+
+            break;
+        }
+        case ExprKind::Float: {
+            auto& value = static_cast<FloatExpr const&>(expr);
+
+            this->write_f64(value.value());
+            this->write_bool(value.is_double());
+
+            break;
+        }
+        case ExprKind::String:
+            this->write_string(static_cast<StringExpr const&>(expr).value());
+            break;
+        case ExprKind::Identifier:
+            this->write_string(static_cast<IdentifierExpr const&>(expr).name());
+            break;
+        case ExprKind::Assignment: {
+            auto& assignment = static_cast<AssignmentExpr const&>(expr);
+
+            this->write_ident(assignment.identifier());
+            this->write(assignment.type());
+            this->write(assignment.value());
+            this->write_bool(assignment.is_public());
+
+            break;
+        }
+        case ExprKind::TupleAssignment: {
+            auto& assignment = static_cast<TupleAssignmentExpr const&>(expr);
+
+            this->write_varint(assignment.identifiers().size());
+            for (auto& identifier : assignment.identifiers()) {
+                this->write_ident(identifier);
+            }
+
+            this->write(assignment.type());
+            this->write(assignment.value());
+
+            break;
+        }
+        case ExprKind::Const: {
+            auto& constant = static_cast<ConstExpr const&>(expr);
+
+            this->write_string(constant.name());
+            this->write(constant.type());
+            this->write(&constant.value());
+            this->write_bool(constant.is_public());
+
+            break;
+        }
+        case ExprKind::Array:
+            this->write(static_cast<ArrayExpr const&>(expr).elements());
+            break;
+        case ExprKind::UnaryOp: {
+            auto& unary = static_cast<UnaryOpExpr const&>(expr);
+
+            this->write(&unary.value());
+            this->write_enum(unary.op());
+
+            break;
+        }
+        case ExprKind::Reference: {
+            auto& reference = static_cast<ReferenceExpr const&>(expr);
+
+            this->write(&reference.value());
+            this->write_bool(reference.is_mutable());
+
+            break;
+        }
+        case ExprKind::BinaryOp: {
+            auto& binary = static_cast<BinaryOpExpr const&>(expr);
+
+            this->write_enum(binary.op());
+            this->write(&binary.lhs());
+            this->write(&binary.rhs());
+
+            break;
+        }
+        case ExprKind::InplaceBinaryOp: {
+            auto& binary = static_cast<InplaceBinaryOpExpr const&>(expr);
+
+            this->write_enum(binary.op());
+            this->write(&binary.lhs());
+            this->write(&binary.rhs());
+
+            break;
+        }
+        case ExprKind::Call: {
+            auto& call = static_cast<CallExpr const&>(expr);
+
+            this->write(&call.callee());
+            this->write(call.args());
+
+            this->write_varint(call.kwargs().size());
+            for (auto& [name, value] : call.kwargs()) {
+                this->write_string(name);
+                this->write(value.get());
+            }
+
+            break;
+        }
+        case ExprKind::Return:
+            this->write(static_cast<ReturnExpr const&>(expr).value());
+            break;
+        case ExprKind::FunctionDecl: {
+            auto& decl = static_cast<FunctionDeclExpr const&>(expr);
+
+            this->write_string(decl.name());
+
+            this->write_varint(decl.parameters().size());
+            for (auto& parameter : decl.parameters()) {
+                this->write_string(parameter.name);
+                this->write(parameter.type.get());
+                this->write(parameter.default_value.get());
+                this->write_u8(parameter.flags);
+                this->write_span(parameter.span);
+            }
+
+            this->write(decl.return_type());
+            this->write_enum(decl.linkage());
+            this->write_bool(decl.is_c_variadic());
+            this->write_bool(decl.is_public());
+            this->write_bool(decl.is_async());
+
+            break;
+        }
+        case ExprKind::Function: {
+            auto& function = static_cast<FunctionExpr const&>(expr);
+
+            this->write(&function.decl());
+            this->write_bool(!function.has_body());
+
+            // Skipped bodies stay skipped, the source code they point into is the same one the entry was made from
+            if (function.has_body()) {
+                this->write(&function.body());
+            } else {
+                this->write_span(function.lazy_body()->span);
+                this->write_bool(function.lazy_body()->self_allowed);
+            }
+
+            break;
+        }
+        case ExprKind::Defer:
+            this->write(&static_cast<DeferExpr const&>(expr).expr());
+            break;
+        case ExprKind::If: {
+            auto& if_expr = static_cast<IfExpr const&>(expr);
+
+            this->write(&if_expr.condition());
+            this->write(&if_expr.body());
+            this->write(if_expr.else_body());
+
+            break;
+        }
+        case ExprKind::While: {
+            auto& while_expr = static_cast<WhileExpr const&>(expr);
+
+            this->write(&while_expr.condition());
+            this->write(&while_expr.body());
+
+            break;
+        }
+        case ExprKind::For: {
+            auto& for_expr = static_cast<ForExpr const&>(expr);
+
+            this->write_ident(for_expr.identifier());
+            this->write(&for_expr.iterable());
+            this->write(&for_expr.body());
+
+            break;
+        }
+        case ExprKind::Break:
+        case ExprKind::Continue:
+            break;
+        case ExprKind::Struct: {
+            auto& structure = static_cast<StructExpr const&>(expr);
+
+            this->write_string(structure.name());
+            this->write_bool(structure.is_opaque());
+            this->write_generic_parameters(structure.parameters());
+
+            this->write_varint(structure.fields().size());
+            for (auto& field : structure.fields()) {
+                this->write_string(field.name);
+                this->write(field.type.get());
+                this->write_varint(field.index);
+                this->write_u8(field.flags);
+            }
+
+            this->write(structure.members());
+            this->write_bool(structure.is_public());
+
+            break;
+        }
+        case ExprKind::Constructor: {
+            auto& constructor = static_cast<ConstructorExpr const&>(expr);
+
+            this->write(&constructor.parent());
+
+            this->write_varint(constructor.arguments().size());
+            for (auto& argument : constructor.arguments()) {
+                this->write_string(argument.name);
+                this->write(argument.value.get());
+                this->write_span(argument.span);
+            }
+
+            break;
+        }
+        case ExprKind::Attribute: {
+            auto& attribute = static_cast<AttributeExpr const&>(expr);
+
+            this->write(&attribute.parent());
+            this->write_string(attribute.attribute());
+
+            break;
+        }
+        case ExprKind::Index: {
+            auto& index = static_cast<IndexExpr const&>(expr);
+
+            this->write(&index.value());
+            this->write(&index.index());
+
+            break;
+        }
+        case ExprKind::Cast: {
+            auto& cast = static_cast<CastExpr const&>(expr);
+
+            this->write(&cast.value());
+            this->write(&cast.to());
+
+            break;
+        }
+        case ExprKind::Sizeof:
+            this->write(&static_cast<SizeofExpr const&>(expr).value());
+            break;
+        case ExprKind::Offsetof: {
+            auto& offset = static_cast<OffsetofExpr const&>(expr);
+
+            this->write(&offset.value());
+            this->write_string(offset.field());
+
+            break;
+        }
+        case ExprKind::Path:
+            this->write_path(static_cast<PathExpr const&>(expr).path());
+            break;
+        case ExprKind::Using: {
+            auto& using_expr = static_cast<UsingExpr const&>(expr);
+
+            this->write_path(using_expr.path());
+            this->write_identifiers(using_expr.symbols());
+
+            break;
+        }
+        case ExprKind::Tuple:
+            this->write(static_cast<TupleExpr const&>(expr).elements());
+            break;
+        case ExprKind::Enum: {
+            auto& enumeration = static_cast<EnumExpr const&>(expr);
+
+            this->write_string(enumeration.name());
+            this->write(&enumeration.type());
+
+            this->write_varint(enumeration.fields().size());
+            for (auto& field : enumeration.fields()) {
+                this->write_string(field.name);
+                this->write(field.value.get());
+            }
+
+            break;
+        }
+        case ExprKind::Import: {
+            auto& import = static_cast<ImportExpr const&>(expr);
+
+            this->write_path(import.path());
+            this->write_bool(import.is_wildcard());
+            this->write_bool(import.is_relative());
+            this->write_identifiers(import.symbols());
+
+            break;
+        }
+        case ExprKind::Ternary: {
+            auto& ternary = static_cast<TernaryExpr const&>(expr);
+
+            this->write(&ternary.condition());
+            this->write(&ternary.true_expr());
+            this->write(&ternary.false_expr());
+
+            break;
+        }
+        case ExprKind::ArrayFill: {
+            auto& fill = static_cast<ArrayFillExpr const&>(expr);
+
+            this->write(&fill.value());
+            this->write(&fill.count());
+
+            break;
+        }
+        case ExprKind::TypeAlias: {
+            auto& alias = static_cast<TypeAliasExpr const&>(expr);
+
+            this->write_string(alias.name());
+            this->write(&alias.type());
+            this->write_generic_parameters(alias.parameters());
+            this->write_bool(alias.is_public());
+
+            break;
+        }
+        case ExprKind::StaticAssert: {
+            auto& assertion = static_cast<StaticAssertExpr const&>(expr);
+
+            this->write(&assertion.condition());
+            this->write_string(assertion.message());
+
+            break;
+        }
+        case ExprKind::Maybe:
+            this->write(&static_cast<MaybeExpr const&>(expr).value());
+            break;
+        case ExprKind::Module: {
+            auto& module = static_cast<ModuleExpr const&>(expr);
+
+            this->write_string(module.name());
+            this->write(module.body());
+
+            break;
+        }
+        case ExprKind::Impl: {
+            auto& impl = static_cast<ImplExpr const&>(expr);
+
+            this->write(&impl.type());
+            this->write(&impl.body());
+            this->write_generic_parameters(impl.parameters());
+
+            break;
+        }
+        case ExprKind::Trait: {
+            auto& trait = static_cast<TraitExpr const&>(expr);
+
+            this->write_string(trait.name());
+            this->write(trait.body());
+            this->write_generic_parameters(trait.parameters());
+
+            break;
+        }
+        case ExprKind::ImplTrait: {
+            auto& impl = static_cast<ImplTraitExpr const&>(expr);
+
+            this->write(&impl.trait());
+            this->write(&impl.type());
+            this->write(impl.body());
+
+            break;
+        }
+        case ExprKind::Match: {
+            auto& match = static_cast<MatchExpr const&>(expr);
+
+            this->write(&match.value());
+
+            this->write_varint(match.arms().size());
+            for (auto& arm : match.arms()) {
+                this->write_bool(arm.pattern.is_wildcard);
+                this->write_bool(arm.pattern.is_conditional);
+                this->write(arm.pattern.values);
+                this->write_span(arm.pattern.span);
+
+                this->write(arm.body.get());
+                this->write_varint(arm.index);
+            }
+
+            break;
+        }
+        case ExprKind::RangeFor: {
+            auto& range = static_cast<RangeForExpr const&>(expr);
+
+            this->write_ident(range.identifier());
+            this->write_bool(range.inclusive());
+            this->write(&range.start());
+            this->write(&range.end());
+            this->write(&range.body());
+
+            break;
+        }
+        case ExprKind::Bool:
+            this->write_enum(static_cast<BoolExpr const&>(expr).value());
+            break;
+        case ExprKind::ConstEval:
+            this->write(static_cast<ConstEvalExpr const&>(expr).body());
+            break;
+    }
+}
+
+class Reader {
+public:
+    Reader(StringView data, Arena& arena, u16 source_code_index) : m_data(data), m_arena(arena), m_source_code_index(source_code_index) {}
+
+    bool failed() const { return m_failed; }
+    bool at_end() const { return m_offset == m_data.size(); }
+
+    u8 read_u8() {
+        if (m_offset >= m_data.size()) {
+            m_failed = true;
+            return 0;
+        }
+
+        return static_cast<u8>(m_data[m_offset++]);
+    }
+
+    bool read_bool() { return this->read_u8() != 0; }
+
+    template<typename E> requires(std::is_enum_v<E>)
+    E read_enum() { return static_cast<E>(this->read_u8()); }
+
+    u64 read_varint() {
+        u64 value = 0;
+        for (u32 shift = 0; shift < 64; shift += 7) {
+            u8 byte = this->read_u8();
+            value |= static_cast<u64>(byte & 0x7F) << shift;
+
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+
+        m_failed = true;
+        return 0;
+    }
+
+    // Every element takes up at least a byte, so a count larger than what's left can only come from bad data
+    size_t read_count() {
+        u64 count = this->read_varint();
+        if (count > m_data.size() - m_offset) {
+            m_failed = true;
+            return 0;
+        }
+
+        return count;
+    }
+
+    f64 read_f64() {
+        u64 bits = 0;
+        for (size_t i = 0; i < sizeof(bits); i++) {
+            bits |= static_cast<u64>(this->read_u8()) << (i * 8);
+        }
+
+        f64 value = 0;
+        std::memcpy(&value, &bits, sizeof(value));
+
+        return value;
+    }
+
+    String read_string() {
+        size_t size = this->read_count();
+        String value(m_data.substr(m_offset, size));
+
+        m_offset += size;
+        return value;
+    }
+
+    // Interns straight from the payload without going through a `String`
+    Identifier read_identifier() {
+        size_t size = this->read_count();
+        Identifier value(m_data.substr(m_offset, size));
+
+        m_offset += size;
+        return value;
+    }
+
+    Vector<Identifier> read_identifiers() {
+        Vector<Identifier> values(this->read_count());
+        for (auto& value : values) {
+            value = this->read_identifier();
+        }
+
+        return values;
+    }
+
+    Span read_span() {
+        size_t start = this->read_varint();
+        size_t end = this->read_varint();
+
+        return { start, end, m_source_code_index };
+    }
+
+    Ident read_ident() {
+        Identifier value = this->read_identifier();
+        bool is_mutable = this->read_bool();
+
+        return { value, is_mutable, this->read_span() };
+    }
+
+    PathSegment read_segment() {
+        Identifier name = this->read_identifier();
+        return { name, this->read_list<TypeExpr>() };
+    }
+
+    Path read_path() {
+        PathSegment last = this->read_segment();
+
+        Deque<PathSegment> segments;
+        for (size_t i = this->read_count(); i > 0; i--) {
+            segments.push_back(this->read_segment());
+        }
+
+        return { move(last), move(segments) };
+    }
+
+    Attributes read_attributes() {
+        Attributes attributes;
+        for (size_t i = this->read_count(); i > 0; i--) {
+            auto type = this->read_enum<Attribute::Type>();
+            if (type != Attribute::Link) {
+                attributes.insert(Attribute(type));
+                continue;
+            }
+
+            auto info = make_ref<LinkInfo>();
+
+            info->name = this->read_string();
+            info->arch = this->read_string();
+            info->section = this->read_string();
+            info->platform = this->read_string();
+
+            attributes.insert(Attribute(type, info));
+        }
+
+        return attributes;
+    }
+
+    Vector<GenericParameter> read_generic_parameters() {
+        Vector<GenericParameter> parameters;
+        for (size_t i = this->read_count(); i > 0 && !m_failed; i--) {
+            GenericParameter parameter;
+
+            parameter.name = this->read_identifier();
+            parameter.constraints = this->read_list<TypeExpr>();
+            parameter.default_type = this->read_type();
+            parameter.span = this->read_span();
+
+            parameters.push_back(move(parameter));
+        }
+
+        return parameters;
+    }
+
+    template<typename T>
+    ExprList<T> read_list() {
+        ExprList<T> list;
+        for (size_t i = this->read_count(); i > 0 && !m_failed; i--) {
+            if constexpr (std::is_same_v<T, TypeExpr>) {
+                list.push_back(this->read_type());
+            } else {
+                list.push_back(this->read_expr());
+            }
+        }
+
+        return list;
+    }
+
+    ArenaPtr<TypeExpr> read_type();
+    ArenaPtr<Expr> read_expr();
+
+    // Reads a node that can't be null and has to be of the given type
+    template<typename T> requires(std::is_base_of_v<TypeExpr, T> || std::is_base_of_v<Expr, T>)
+    ArenaPtr<T> read_required() {
+        if constexpr (std::is_base_of_v<TypeExpr, T>) {
+            auto type = this->read_type();
+            if (!type || !is<T>(type.get())) {
+                m_failed = true;
+                return nullptr;
+            }
+
+            return ArenaPtr<T>(static_cast<T*>(type.release()));
+        } else {
+            auto expr = this->read_expr();
+            if (!expr || !is<T>(expr.get())) {
+                m_failed = true;
+                return nullptr;
+            }
+
+            return ArenaPtr<T>(static_cast<T*>(expr.release()));
+        }
+    }
+
+private:
+    template<typename T, typename Base>
+    static bool is(Base const* node) {
+        if constexpr (std::is_same_v<T, Base>) {
+            return true;
+        } else {
+            return T::classof(node);
+        }
+    }
+
+    ArenaPtr<Expr> read_fields(ExprKind kind, Span span);
+
+    template<typename T, typename... Args>
+    ArenaPtr<T> make(Args&&... args) {
+        if (m_failed) {
+            return nullptr;
+        }
+
+        return m_arena.make<T>(std::forward<Args>(args)...);
+    }
+
+    StringView m_data;
+    size_t m_offset = 0;
+
+    Arena& m_arena;
+    u16 m_source_code_index;
+
+    bool m_failed = false;
+};
+
+ArenaPtr<TypeExpr> Reader::read_type() {
+    u8 tag = this->read_u8();
+    if (!tag || m_failed) {
+        return nullptr;
+    }
+
+    auto kind = static_cast<TypeKind>(tag - 1);
+    Span span = this->read_span();
+
+    switch (kind) {
+        case TypeKind::Builtin:
+            return this->make<BuiltinTypeExpr>(span, this->read_enum<BuiltinType>());
+        case TypeKind::Integer:
+            return this->make<IntegerTypeExpr>(span, this->read_required<Expr>());
+        case TypeKind::Named:
+            return this->make<NamedTypeExpr>(span, this->read_path());
+        case TypeKind::Tuple:
+            return this->make<TupleTypeExpr>(span, this->read_list<TypeExpr>());
+        case TypeKind::Array: {
+            auto type = this->read_required<TypeExpr>();
+            return this->make<ArrayTypeExpr>(span, move(type), this->read_required<Expr>());
+        }
+        case TypeKind::Pointer: {
+            auto pointee = this->read_required<TypeExpr>();
+            return this->make<PointerTypeExpr>(span, move(pointee), this->read_bool());
+        }
+        case TypeKind::Reference: {
+            auto type = this->read_required<TypeExpr>();
+            return this->make<ReferenceTypeExpr>(span, move(type), this->read_bool());
+        }
+        case TypeKind::Function: {
+            auto parameters = this->read_list<TypeExpr>();
+            return this->make<FunctionTypeExpr>(span, move(parameters), this->read_type());
+        }
+        case TypeKind::Generic: {
+            auto parent = this->read_required<NamedTypeExpr>();
+            return this->make<GenericTypeExpr>(span, move(parent), this->read_list<TypeExpr>());
+        }
+    }
+
+    m_failed = true;
+    return nullptr;
+}
+
+ArenaPtr<Expr> Reader::read_expr() {
+    u8 tag = this->read_u8();
+    if (!tag || m_failed) {
+        return nullptr;
+    }
+
+    if (tag - 1 > static_cast<u8>(ExprKind::ConstEval)) {
+        m_failed = true;
+        return nullptr;
+    }
+
+    auto kind = static_cast<ExprKind>(tag - 1);
+
+    Span span = this->read_span();
+    Attributes attributes = this->read_attributes();
+
+    auto expr = this->read_fields(kind, span);
+    if (!expr) {
+        m_failed = true;
+        return nullptr;
+    }
+
+    expr->attributes().insert(move(attributes));
+    return expr;
+}
+
+// Arguments are read into locals first since the evaluation order of function arguments is unspecified
+ArenaPtr<Expr> Reader::read_fields(ExprKind kind, Span span) {
+    switch (kind) {
+        case ExprKind::Block:
+            return this->make<BlockExpr>(span, this->read_list<Expr>());
+        case ExprKind::ExternBlock:
+            return this->make<ExternBlockExpr>(span, this->read_list<Expr>());
+        case ExprKind::Integer: {
+            u64 value = this->read_varint();
+            return this->make<IntegerExpr>(span, value, IntegerSuffix { this->read_enum<BuiltinType>() });
+        }
+        case ExprKind::Float: {
+            f64 value = this->read_f64();
+            return this->make<FloatExpr>(span, value, this->read_bool());
+        }
+        case ExprKind::String:
+            return this->make<StringExpr>(span, this->read_string());
+        case ExprKind::Identifier:
+            return this->make<IdentifierExpr>(span, this->read_identifier());
+        case ExprKind::Assignment: {
+            Ident identifier = this->read_ident();
+            auto type = this->read_type();
+            auto value = this->read_expr();
+
+            return this->make<AssignmentExpr>(span, move(identifier), move(type), move(value), this->read_bool());
+        }
+        case ExprKind::TupleAssignment: {
+            Vector<Ident> identifiers(this->read_count());
+            for (auto& identifier : identifiers) {
+                identifier = this->read_ident();
+            }
+
+            auto type = this->read_type();
+            return this->make<TupleAssignmentExpr>(span, move(identifiers), move(type), this->read_expr());
+        }
+        case ExprKind::Const: {
+            Identifier name = this->read_identifier();
+            auto type = this->read_type();
+            auto value = this->read_required<Expr>();
+
+            return this->make<ConstExpr>(span, name, move(type), move(value), this->read_bool());
+        }
+        case ExprKind::Array:
+            return this->make<ArrayExpr>(span, this->read_list<Expr>());
+        case ExprKind::UnaryOp: {
+            auto value = this->read_required<Expr>();
+            return this->make<UnaryOpExpr>(span, move(value), this->read_enum<UnaryOp>());
+        }
+        case ExprKind::Reference: {
+            auto value = this->read_required<Expr>();
+            return this->make<ReferenceExpr>(span, move(value), this->read_bool());
+        }
+        case ExprKind::BinaryOp: {
+            auto op = this->read_enum<BinaryOp>();
+            auto lhs = this->read_required<Expr>();
+
+            return this->make<BinaryOpExpr>(span, op, move(lhs), this->read_required<Expr>());
+        }
+        case ExprKind::InplaceBinaryOp: {
+            auto op = this->read_enum<BinaryOp>();
+            auto lhs = this->read_required<Expr>();
+
+            return this->make<InplaceBinaryOpExpr>(span, op, move(lhs), this->read_required<Expr>());
+        }
+        case ExprKind::Call: {
+            auto callee = this->read_required<Expr>();
+            auto args = this->read_list<Expr>();
+
+            HashMap<String, ArenaPtr<Expr>> kwargs;
+            for (size_t i = this->read_count(); i > 0 && !m_failed; i--) {
+                String name = this->read_string();
+                kwargs[move(name)] = this->read_required<Expr>();
+            }
+
+            return this->make<CallExpr>(span, move(callee), move(args), move(kwargs));
+        }
+        case ExprKind::Return:
+            return this->make<ReturnExpr>(span, this->read_expr());
+        case ExprKind::FunctionDecl: {
+            Identifier name = this->read_identifier();
+
+            Vector<Parameter> parameters;
+            for (size_t i = this->read_count(); i > 0 && !m_failed; i--) {
+                Parameter parameter;
+
+                parameter.name = this->read_identifier();
+                parameter.type = this->read_type();
+                parameter.default_value = this->read_expr();
+                parameter.flags = this->read_u8();
+                parameter.span = this->read_span();
+
+                parameters.push_back(move(parameter));
+            }
+
+            auto return_type = this->read_type();
+            auto linkage = this->read_enum<LinkageSpecifier>();
+
+            bool is_c_variadic = this->read_bool();
+            bool is_public = this->read_bool();
+            bool is_async = this->read_bool();
+
+            return this->make<FunctionDeclExpr>(
+                span, name, move(parameters), move(return_type), linkage, is_c_variadic, is_public, is_async
+            );
+        }
+        case ExprKind::Function: {
+            auto decl = this->read_required<FunctionDeclExpr>();
+            if (this->read_bool()) {
+                Span body_span = this->read_span();
+                LazyFunctionBody body = { body_span, &m_arena, this->read_bool() };
+
+                return this->make<FunctionExpr>(span, move(decl), body);
+            }
+
+            return this->make<FunctionExpr>(span, move(decl), this->read_required<BlockExpr>());
+        }
+        case ExprKind::Defer:
+            return this->make<DeferExpr>(span, this->read_required<Expr>());
+        case ExprKind::If: {
+            auto condition = this->read_required<Expr>();
+            auto body = this->read_required<Expr>();
+
+            return this->make<IfExpr>(span, move(condition), move(body), this->read_expr());
+        }
+        case ExprKind::While: {
+            auto condition = this->read_required<Expr>();
+            return this->make<WhileExpr>(span, move(condition), this->read_required<BlockExpr>());
+        }
+        case ExprKind::For: {
+            Ident identifier = this->read_ident();
+            auto iterable = this->read_required<Expr>();
+
+            return this->make<ForExpr>(span, move(identifier), move(iterable), this->read_required<Expr>());
+        }
+        case ExprKind::Break:
+            return this->make<BreakExpr>(span);
+        case ExprKind::Continue:
+            return this->make<ContinueExpr>(span);
+        case ExprKind::Struct: {
+            Identifier name = this->read_identifier();
+            bool opaque = this->read_bool();
+            auto parameters = this->read_generic_parameters();
+
+            Vector<StructField> fields;
+            for (size_t i = this->read_count(); i > 0 && !m_failed; i--) {
+                StructField field;
+
+                field.name = this->read_string();
+                field.type = this->read_required<TypeExpr>();
+                field.index = this->read_varint();
+                field.flags = this->read_u8();
+
+                fields.push_back(move(field));
+            }
+
+            auto members = this->read_list<Expr>();
+            return this->make<StructExpr>(span, name, opaque, move(parameters), move(fields), move(members), this->read_bool());
+        }
+        case ExprKind::Constructor: {
+            auto parent = this->read_required<Expr>();
+
+            Vector<ConstructorArgument> arguments;
+            for (size_t i = this->read_count(); i > 0 && !m_failed; i--) {
+                ConstructorArgument argument;
+
+                argument.name = this->read_string();
+                argument.value = this->read_required<Expr>();
+                argument.span = this->read_span();
+
+                arguments.push_back(move(argument));
+            }
+
+            return this->make<ConstructorExpr>(span, move(parent), move(arguments));
+        }
+        case ExprKind::Attribute: {
+            auto parent = this->read_required<Expr>();
+            return this->make<AttributeExpr>(span, move(parent), this->read_string());
+        }
+        case ExprKind::Index: {
+            auto value = this->read_required<Expr>();
+            return this->make<IndexExpr>(span, move(value), this->read_required<Expr>());
+        }
+        case ExprKind::Cast: {
+            auto value = this->read_required<Expr>();
+            return this->make<CastExpr>(span, move(value), this->read_required<TypeExpr>());
+        }
+        case ExprKind::Sizeof:
+            return this->make<SizeofExpr>(span, this->read_required<Expr>());
+        case ExprKind::Offsetof: {
+            auto value = this->read_required<Expr>();
+            return this->make<OffsetofExpr>(span, move(value), this->read_string());
+        }
+        case ExprKind::Path:
+            return this->make<PathExpr>(span, this->read_path());
+        case ExprKind::Using: {
+            Path path = this->read_path();
+            return this->make<UsingExpr>(span, move(path), this->read_identifiers());
+        }
+        case ExprKind::Tuple:
+            return this->make<TupleExpr>(span, this->read_list<Expr>());
+        case ExprKind::Enum: {
+            Identifier name = this->read_identifier();
+            auto type = this->read_required<TypeExpr>();
+
+            Vector<EnumField> fields;
+            for (size_t i = this->read_count(); i > 0 && !m_failed; i--) {
+                EnumField field;
+
+                field.name = this->read_string();
+                field.value = this->read_expr();
+
+                fields.push_back(move(field));
+            }
+
+            return this->make<EnumExpr>(span, name, move(type), move(fields));
+        }
+        case ExprKind::Import: {
+            Path path = this->read_path();
+
+            bool is_wildcard = this->read_bool();
+            bool is_relative = this->read_bool();
+
+            return this->make<ImportExpr>(span, move(path), is_wildcard, is_relative, this->read_identifiers());
+        }
+        case ExprKind::Ternary: {
+            auto condition = this->read_required<Expr>();
+            auto true_expr = this->read_required<Expr>();
+
+            return this->make<TernaryExpr>(span, move(condition), move(true_expr), this->read_required<Expr>());
+        }
+        case ExprKind::ArrayFill: {
+            auto value = this->read_required<Expr>();
+            return this->make<ArrayFillExpr>(span, move(value), this->read_required<Expr>());
+        }
+        case ExprKind::TypeAlias: {
+            Identifier name = this->read_identifier();
+            auto type = this->read_required<TypeExpr>();
+            auto parameters = this->read_generic_parameters();
+
+            return this->make<TypeAliasExpr>(span, name, move(type), move(parameters), this->read_bool());
+        }
+        case ExprKind::StaticAssert: {
+            auto condition = this->read_required<Expr>();
+            return this->make<StaticAssertExpr>(span, move(condition), this->read_string());
+        }
+        case ExprKind::Maybe:
+            return this->make<MaybeExpr>(span, this->read_required<Expr>());
+        case ExprKind::Module: {
+            Identifier name = this->read_identifier();
+            return this->make<ModuleExpr>(span, name, this->read_list<Expr>());
+        }
+        case ExprKind::Impl: {
+            auto type = this->read_required<TypeExpr>();
+            auto body = this->read_required<BlockExpr>();
+
+            return this->make<ImplExpr>(span, move(type), move(body), this->read_generic_parameters());
+        }
+        case ExprKind::Trait: {
+            Identifier name = this->read_identifier();
+            auto body = this->read_list<Expr>();
+
+            return this->make<TraitExpr>(span, name, move(body), this->read_generic_parameters());
+        }
+        case ExprKind::ImplTrait: {
+            auto trait = this->read_required<TypeExpr>();
+            auto type = this->read_required<TypeExpr>();
+
+            return this->make<ImplTraitExpr>(span, move(trait), move(type), this->read_list<Expr>());
+        }
+        case ExprKind::Match: {
+            auto value = this->read_required<Expr>();
+
+            Vector<MatchArm> arms;
+            for (size_t i = this->read_count(); i > 0 && !m_failed; i--) {
+                MatchArm arm;
+
+                arm.pattern.is_wildcard = this->read_bool();
+                arm.pattern.is_conditional = this->read_bool();
+                arm.pattern.values = this->read_list<Expr>();
+                arm.pattern.span = this->read_span();
+
+                arm.body = this->read_required<Expr>();
+                arm.index = this->read_varint();
+
+                arms.push_back(move(arm));
+            }
+
+            return this->make<MatchExpr>(span, move(value), move(arms));
+        }
+        case ExprKind::RangeFor: {
+            Ident identifier = this->read_ident();
+            bool inclusive = this->read_bool();
+
+            auto start = this->read_required<Expr>();
+            auto end = this->read_required<Expr>();
+
+            return this->make<RangeForExpr>(span, move(identifier), inclusive, move(start), move(end), this->read_required<Expr>());
+        }
+        case ExprKind::Bool:
+            return this->make<BoolExpr>(span, static_cast<BoolExpr::Value>(this->read_u8()));
+        case ExprKind::ConstEval:
+            return this->make<ConstEvalExpr>(span, this->read_list<Expr>());
+    }
+
+    return nullptr;
+}
+
+}
+
+String serialize(ExprList<> const& ast) {
+    Writer writer;
+    writer.write(ast);
+
+    return writer.take();
+}
+
+Optional<ExprList<>> deserialize(StringView data, Arena& arena, u16 source_code_index) {
+    Arena::Scope scope(arena);
+    Reader reader(data, arena, source_code_index);
+
+    auto ast = reader.read_list<Expr>();
+    if (reader.failed() || !reader.at_end()) {
+        return {};
+    }
+
+    return ast;
+}
+
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <quart/parser/ast.h>
+
+namespace quart::ast {
+
+// A compact binary encoding of a module's AST, used by `ModuleCache` to skip lexing and parsing of modules
+// that haven't changed. Bump this whenever the encoding or any of the AST nodes change.
+constexpr u32 SERIALIZATION_FORMAT_VERSION = 4;
+
+String serialize(ExprList<> const& ast);
+
+// Rebuilds an AST produced by `serialize` inside `arena`. Every span is pointed at `source_code_index`.
+// Returns an empty optional if `data` is truncated or otherwise malformed.
+Optional<ExprList<>> deserialize(StringView data, Arena& arena, u16 source_code_index);
+
+}
@@ -0,0 +1,264 @@
+#include <quart/scan.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+    #define QUART_SCAN_X86 1
+    #include <immintrin.h>
+#endif
+
+namespace quart::scan {
+
+namespace {
+
+enum class CharClass : u8 {
+    NonWhitespace,
+    NonIdentifier,
+    LineEnd,
+    CommentEnd
+};
+
+bool is_whitespace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+bool is_identifier(char c) {
+    char lower = static_cast<char>(c | 0x20);
+    return (c >= '0' && c <= '9') || (lower >= 'a' && lower <= 'z') || c == '_';
+}
+
+bool matches(char c, CharClass cls) {
+    switch (cls) {
+        case CharClass::NonWhitespace: return !is_whitespace(c);
+        case CharClass::NonIdentifier: return !is_identifier(c);
+        case CharClass::LineEnd: return c == '\n' || c == '\0';
+        case CharClass::CommentEnd: return c == '*' || c == '\0';
+    }
+
+    return false;
+}
+
+size_t find_first_scalar(StringView code, size_t offset, CharClass cls) {
+    for (size_t i = offset; i < code.size(); i++) {
+        if (matches(code[i], cls)) {
+            return i;
+        }
+    }
+
+    return code.size();
+}
+
+void find_newlines_scalar(StringView code, size_t offset, Vector<size_t>& offsets) {
+    for (size_t i = offset; i < code.size(); i++) {
+        if (code[i] == '\n') {
+            offsets.push_back(i + 1);
+        }
+    }
+}
+
+#ifdef QUART_SCAN_X86
+
+// Sets every byte in `value` that lies within [lo, hi] (compared as unsigned) to 0xFF
+__m128i sse2_in_range(__m128i value, char lo, char hi) {
+    __m128i shifted = _mm_sub_epi8(value, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(static_cast<char>(hi - lo))), shifted);
+}
+
+u32 sse2_match(__m128i value, CharClass cls) {
+    switch (cls) {
+        case CharClass::NonWhitespace: {
+            __m128i whitespace = _mm_or_si128(_mm_cmpeq_epi8(value, _mm_set1_epi8(' ')), sse2_in_range(value, '\t', '\r'));
+            return ~static_cast<u32>(_mm_movemask_epi8(whitespace)) & 0xFFFF;
+        }
+        case CharClass::NonIdentifier: {
+            __m128i lower = _mm_or_si128(value, _mm_set1_epi8(0x20));
+            __m128i identifier = _mm_or_si128(
+                _mm_or_si128(sse2_in_range(value, '0', '9'), sse2_in_range(lower, 'a', 'z')),
+                _mm_cmpeq_epi8(value, _mm_set1_epi8('_'))
+            );
+
+            return ~static_cast<u32>(_mm_movemask_epi8(identifier)) & 0xFFFF;
+        }
+        case CharClass::LineEnd:
+            return _mm_movemask_epi8(_mm_or_si128(
+                _mm_cmpeq_epi8(value, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(value, _mm_setzero_si128())
+            ));
+        case CharClass::CommentEnd:
+            return _mm_movemask_epi8(_mm_or_si128(
+                _mm_cmpeq_epi8(value, _mm_set1_epi8('*')), _mm_cmpeq_epi8(value, _mm_setzero_si128())
+            ));
+    }
+
+    return 0;
+}
+
+size_t find_first_sse2(StringView code, size_t offset, CharClass cls) {
+    constexpr size_t WIDTH = sizeof(__m128i);
+
+    size_t i = offset;
+    for (; i + WIDTH <= code.size(); i += WIDTH) {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<__m128i const*>(code.data() + i));
+
+        u32 mask = sse2_match(value, cls);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    return find_first_scalar(code, i, cls);
+}
+
+void find_newlines_sse2(StringView code, size_t offset, Vector<size_t>& offsets) {
+    constexpr size_t WIDTH = sizeof(__m128i);
+
+    size_t i = offset;
+    for (; i + WIDTH <= code.size(); i += WIDTH) {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<__m128i const*>(code.data() + i));
+        u32 mask = _mm_movemask_epi8(_mm_cmpeq_epi8(value, _mm_set1_epi8('\n')));
+
+        while (mask) {
+            offsets.push_back(i + __builtin_ctz(mask) + 1);
+            mask &= mask - 1;
+        }
+    }
+
+    find_newlines_scalar(code, i, offsets);
+}
+
+__attribute__((target("avx2")))
+__m256i avx2_in_range(__m256i value, char lo, char hi) {
+    __m256i shifted = _mm256_sub_epi8(value, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(static_cast<char>(hi - lo))), shifted);
+}
+
+__attribute__((target("avx2")))
+u32 avx2_match(__m256i value, CharClass cls) {
+    switch (cls) {
+        case CharClass::NonWhitespace: {
+            __m256i whitespace = _mm256_or_si256(
+                _mm256_cmpeq_epi8(value, _mm256_set1_epi8(' ')), avx2_in_range(value, '\t', '\r')
+            );
+
+            return ~static_cast<u32>(_mm256_movemask_epi8(whitespace));
+        }
+        case CharClass::NonIdentifier: {
+            __m256i lower = _mm256_or_si256(value, _mm256_set1_epi8(0x20));
+            __m256i identifier = _mm256_or_si256(
+                _mm256_or_si256(avx2_in_range(value, '0', '9'), avx2_in_range(lower, 'a', 'z')),
+                _mm256_cmpeq_epi8(value, _mm256_set1_epi8('_'))
+            );
+
+            return ~static_cast<u32>(_mm256_movemask_epi8(identifier));
+        }
+        case CharClass::LineEnd:
+            return _mm256_movemask_epi8(_mm256_or_si256(
+                _mm256_cmpeq_epi8(value, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(value, _mm256_setzero_si256())
+            ));
+        case CharClass::CommentEnd:
+            return _mm256_movemask_epi8(_mm256_or_si256(
+                _mm256_cmpeq_epi8(value, _mm256_set1_epi8('*')), _mm256_cmpeq_epi8(value, _mm256_setzero_si256())
+            ));
+    }
+
+    return 0;
+}
+
+__attribute__((target("avx2")))
+size_t find_first_avx2(StringView code, size_t offset, CharClass cls) {
+    constexpr size_t WIDTH = sizeof(__m256i);
+
+    size_t i = offset;
+    for (; i + WIDTH <= code.size(); i += WIDTH) {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(code.data() + i));
+
+        u32 mask = avx2_match(value, cls);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    // The remaining tail is shorter than a single AVX2 register but may still fit an SSE2 one
+    return find_first_sse2(code, i, cls);
+}
+
+__attribute__((target("avx2")))
+void find_newlines_avx2(StringView code, size_t offset, Vector<size_t>& offsets) {
+    constexpr size_t WIDTH = sizeof(__m256i);
+
+    size_t i = offset;
+    for (; i + WIDTH <= code.size(); i += WIDTH) {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(code.data() + i));
+        u32 mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(value, _mm256_set1_epi8('\n')));
+
+        while (mask) {
+            offsets.push_back(i + __builtin_ctz(mask) + 1);
+            mask &= mask - 1;
+        }
+    }
+
+    find_newlines_sse2(code, i, offsets);
+}
+
+#endif
+
+struct Implementation {
+    InstructionSet instruction_set;
+
+    size_t (*find_first)(StringView, size_t, CharClass);
+    void (*find_newlines)(StringView, size_t, Vector<size_t>&);
+};
+
+Implementation select_implementation() {
+#ifdef QUART_SCAN_X86
+    if (__builtin_cpu_supports("avx2")) {
+        return { InstructionSet::AVX2, find_first_avx2, find_newlines_avx2 };
+    }
+
+    // SSE2 is part of the x86-64 baseline so there's no need to check for it
+    return { InstructionSet::SSE2, find_first_sse2, find_newlines_sse2 };
+#else
+    return { InstructionSet::Scalar, find_first_scalar, find_newlines_scalar };
+#endif
+}
+
+Implementation const& implementation() {
+    static const Implementation implementation = select_implementation();
+    return implementation;
+}
+
+}
+
+InstructionSet instruction_set() {
+    return implementation().instruction_set;
+}
+
+void find_newlines(StringView code, Vector<size_t>& offsets) {
+    implementation().find_newlines(code, 0, offsets);
+}
+
+size_t skip_whitespace(StringView code, size_t offset) {
+    return implementation().find_first(code, offset, CharClass::NonWhitespace);
+}
+
+size_t skip_identifier(StringView code, size_t offset) {
+    return implementation().find_first(code, offset, CharClass::NonIdentifier);
+}
+
+size_t find_line_end(StringView code, size_t offset) {
+    return implementation().find_first(code, offset, CharClass::LineEnd);
+}
+
+size_t find_comment_end(StringView code, size_t offset) {
+    while (true) {
+        size_t index = implementation().find_first(code, offset, CharClass::CommentEnd);
+        if (index >= code.size() || code[index] == '\0') {
+            return index;
+        }
+
+        if (index + 1 < code.size() && code[index + 1] == '/') {
+            return index;
+        }
+
+        offset = index + 1;
+    }
+}
+
+}
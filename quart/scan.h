@@ -0,0 +1,36 @@
+#pragma once
+
+#include <quart/common.h>
+
+// Vectorized helpers for scanning source code. Every function has an AVX2 and an SSE2 implementation on x86-64
+// alongside a scalar fallback, the best one available on the running CPU is picked the first time any of them is used.
+
+namespace quart::scan {
+
+enum class InstructionSet : u8 {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+InstructionSet instruction_set();
+
+// Appends `i + 1` to `offsets` for every newline at index `i` in `code`
+void find_newlines(StringView code, Vector<size_t>& offsets);
+
+// All of the functions below return the index of the first character starting from `offset` that matches,
+// or `code.size()` if there's none.
+
+// First character that isn't whitespace as defined by `std::isspace`
+size_t skip_whitespace(StringView code, size_t offset);
+
+// First character that isn't alphanumeric or an underscore
+size_t skip_identifier(StringView code, size_t offset);
+
+// First newline or NUL character
+size_t find_line_end(StringView code, size_t offset);
+
+// First `*/` pair or NUL character, the returned index points at the `*` in the former case
+size_t find_comment_end(StringView code, size_t offset);
+
+}
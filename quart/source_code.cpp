@@ -1,5 +1,6 @@
 #include <quart/source_code.h>
 #include <quart/errors.h>
+#include <quart/scan.h>
 #include <algorithm>
 
 #include <llvm/ADT/StringExtras.h>
@@ -13,18 +14,25 @@ static const HashMap<SourceCode::MessageType, Pair<StringView, StringView>> MESS
 };
 
 static Vector<RefPtr<SourceCode>> s_source_codes; // NOLINT
+static std::mutex s_source_codes_mutex; // NOLINT
 
-SourceCode::SourceCode(String code, String filename, size_t index) : m_code(move(code)), m_filename(move(filename)), m_index(index) {
-    m_line_offsets.push_back(0);
+SourceCode::SourceCode(String code, String filename) : m_buffer(move(code)), m_code(m_buffer), m_filename(move(filename)) {}
 
-    for (size_t i = 0; i < m_code.size(); i++) {
-        if (m_code[i] == '\n') {
-            m_line_offsets.push_back(i + 1);
-        }
-    }
+SourceCode::SourceCode(
+    OwnPtr<fs::MappedFile> file, String filename
+) : m_file(move(file)), m_code(m_file->data()), m_filename(move(filename)) {}
+
+Vector<size_t> const& SourceCode::line_offsets() const {
+    std::call_once(m_line_offsets_flag, [this] {
+        m_line_offsets.push_back(0);
+        scan::find_newlines(m_code, m_line_offsets);
+    });
+
+    return m_line_offsets;
 }
 
 RefPtr<SourceCode> SourceCode::lookup(size_t index) {
+    std::lock_guard lock(s_source_codes_mutex);
     if (index >= s_source_codes.size()) {
         return nullptr;
     }
@@ -32,22 +40,42 @@ RefPtr<SourceCode> SourceCode::lookup(size_t index) {
     return s_source_codes[index];
 }
 
-RefPtr<SourceCode> SourceCode::create(String code, String filename) {
-    auto source_code = RefPtr<SourceCode>(new SourceCode(move(code), move(filename), s_source_codes.size()));
+RefPtr<SourceCode> SourceCode::add(SourceCode* code) {
+    auto source_code = RefPtr<SourceCode>(code);
+
+    std::lock_guard lock(s_source_codes_mutex);
+    source_code->m_index = s_source_codes.size();
     s_source_codes.push_back(source_code);
 
     return source_code;
 }
 
+RefPtr<SourceCode> SourceCode::create(String code, String filename) {
+    return SourceCode::add(new SourceCode(move(code), move(filename)));
+}
+
 RefPtr<SourceCode> SourceCode::from_path(fs::Path path) {
-    auto ss = path.read();
-    return SourceCode::create(ss.str(), path);
+    auto file = fs::MappedFile::create(path);
+    if (file) {
+        return SourceCode::add(new SourceCode(move(file), path));
+    }
+
+    // Pipes, stdin and anything else that can't be mapped get read into a single buffer instead
+    std::ifstream stream(String(path), std::ios::binary);
+    String code { std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+
+    return SourceCode::create(move(code), path);
+}
+
+StringView SourceCode::own(String value) {
+    return m_owned_strings.emplace_back(move(value));
 }
 
 Line SourceCode::line_for(size_t offset) const {
-    auto iterator = std::ranges::upper_bound(m_line_offsets, offset);
+    auto& line_offsets = this->line_offsets();
+    auto iterator = std::ranges::upper_bound(line_offsets, offset);
 
-    size_t line = (iterator--) - m_line_offsets.begin() - 1;
+    size_t line = (iterator--) - line_offsets.begin() - 1;
     return { line, *iterator };
 }
 
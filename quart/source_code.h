@@ -3,6 +3,8 @@
 #include <quart/common.h>
 #include <quart/filesystem.h>
 
+#include <mutex>
+
 namespace quart {
 
 class Span {
@@ -51,6 +53,10 @@ public:
     StringView code() const { return m_code; }
     StringView filename() const { return m_filename; }
 
+    // Keeps `value` alive for as long as this source code is and returns a view into it. Used by the lexer
+    // for token values that don't exist verbatim in the source (e.g. strings containing escape sequences).
+    StringView own(String value);
+
     Line line_for(size_t offset) const;
     size_t column_for(size_t offset) const;
 
@@ -62,17 +68,32 @@ public:
 
     static String format_generic_message(const Span&, StringView message, MessageType);
 private:
-    SourceCode(String code, String filename, size_t index);
+    SourceCode(String code, String filename);
+    SourceCode(OwnPtr<fs::MappedFile> file, String filename);
+
+    // Assigns the source code its index, safe to call from multiple threads
+    static RefPtr<SourceCode> add(SourceCode*);
+
+    // The line index is only ever needed for diagnostics so it's built on first use
+    Vector<size_t> const& line_offsets() const;
 
     size_t next_line_offset(size_t line) const {
-        return m_line_offsets[line + 1];
+        return this->line_offsets()[line + 1];
     }
 
-    String m_code;
+    // Either `m_buffer` or `m_file` owns the memory `m_code` points into
+    String m_buffer;
+    OwnPtr<fs::MappedFile> m_file;
+
+    StringView m_code;
     String m_filename;
 
-    size_t m_index;
-    Vector<size_t> m_line_offsets;
+    size_t m_index = 0;
+
+    mutable std::once_flag m_line_offsets_flag;
+    mutable Vector<size_t> m_line_offsets;
+
+    Deque<String> m_owned_strings;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include <quart/thread_pool.h>
+
+namespace quart {
+
+static thread_local ThreadPool* s_current_pool = nullptr;
+static thread_local size_t s_current_worker = 0;
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (!threads) {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    m_workers.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        m_workers.push_back(make<Worker>());
+    }
+
+    for (size_t i = 0; i < threads; i++) {
+        m_workers[i]->thread = std::thread([this, i] { this->run(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_work_available.notify_all();
+    for (auto& worker : m_workers) {
+        worker->thread.join();
+    }
+}
+
+void ThreadPool::submit(Task task) {
+    size_t index = 0;
+    if (s_current_pool == this) {
+        index = s_current_worker;
+    } else {
+        index = m_next_worker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+    }
+
+    // Count the task before it becomes visible so a worker can never finish it before it's accounted for
+    {
+        std::lock_guard lock(m_mutex);
+        m_pending++;
+        m_queued++;
+    }
+
+    {
+        std::lock_guard lock(m_workers[index]->mutex);
+        m_workers[index]->tasks.push_back(move(task));
+    }
+
+    m_work_available.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_pending == 0; });
+}
+
+Optional<ThreadPool::Task> ThreadPool::pop(size_t index) {
+    auto& worker = *m_workers[index];
+    std::lock_guard lock(worker.mutex);
+
+    if (worker.tasks.empty()) {
+        return {};
+    }
+
+    // Most recently submitted first, its data is more likely to still be in cache
+    Task task = move(worker.tasks.back());
+    worker.tasks.pop_back();
+
+    return task;
+}
+
+Optional<ThreadPool::Task> ThreadPool::steal(size_t index) {
+    for (size_t i = 1; i < m_workers.size(); i++) {
+        auto& victim = *m_workers[(index + i) % m_workers.size()];
+        std::lock_guard lock(victim.mutex);
+
+        if (victim.tasks.empty()) {
+            continue;
+        }
+
+        Task task = move(victim.tasks.front());
+        victim.tasks.pop_front();
+
+        return task;
+    }
+
+    return {};
+}
+
+void ThreadPool::run(size_t index) {
+    s_current_pool = this;
+    s_current_worker = index;
+
+    while (true) {
+        auto task = this->pop(index);
+        if (!task) {
+            task = this->steal(index);
+        }
+
+        if (!task) {
+            std::unique_lock lock(m_mutex);
+            if (m_stopping) {
+                return;
+            }
+
+            // `m_queued` can be non-zero while every queue looks empty if a task is in the middle of being
+            // submitted or taken by another worker, in which case we simply try again.
+            m_work_available.wait(lock, [this] { return m_stopping || m_queued > 0; });
+            continue;
+        }
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_queued--;
+        }
+
+        (*task)();
+
+        std::lock_guard lock(m_mutex);
+        if (--m_pending == 0) {
+            m_idle.notify_all();
+        }
+    }
+}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <quart/common.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+namespace quart {
+
+// A fixed-size pool of worker threads. Every worker has its own queue, tasks submitted from a worker go onto
+// that worker's queue and idle workers steal from the others, so tasks that spawn more tasks keep every thread busy.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    NO_COPY(ThreadPool)
+    NO_MOVE(ThreadPool)
+
+    // Uses one thread per hardware thread if `threads` is 0
+    ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    size_t size() const { return m_workers.size(); }
+
+    void submit(Task task);
+
+    // Blocks until every submitted task, including the ones submitted by other tasks, has finished
+    void wait();
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        Deque<Task> tasks;
+
+        std::thread thread;
+    };
+
+    void run(size_t index);
+
+    Optional<Task> pop(size_t index);
+    Optional<Task> steal(size_t index);
+
+    Vector<OwnPtr<Worker>> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_work_available;
+    std::condition_variable m_idle;
+
+    size_t m_pending = 0; // Tasks that were submitted but haven't finished yet
+    size_t m_queued = 0;  // Tasks that are sitting in a queue
+
+    std::atomic<size_t> m_next_worker = 0;
+    bool m_stopping = false;
+};
+
+}
@@ -10,6 +10,7 @@ import subprocess
 import sys
 import shlex
 import json
+import re
 
 cwd = pathlib.Path(__file__).parent
 
@@ -36,6 +37,39 @@ def run(executable: Union[str, os.PathLike[str]], args: Iterable[Any]) -> Tuple[
     assert process.stdout and process.stderr
     return process.returncode, process.stdout.read().decode(), process.stderr.read().decode()
 
+# Maps a function name to the number of times each instruction appears in it, before and after the bytecode passes
+BytecodeCounts = Dict[str, Dict[str, List[int]]]
+
+def count_instructions(dump: str) -> BytecodeCounts:
+    counts: BytecodeCounts = {}
+
+    stage = 0
+    function = None
+
+    for line in dump.splitlines():
+        if line == '; before passes':
+            stage, function = 0, None
+        elif line == '; after passes':
+            stage, function = 1, None
+        elif line.startswith('function '):
+            # Functions are dumped with their qualified name, tests only refer to them by their own name
+            name = line[len('function '):].split('(', 1)[0]
+            function = counts.setdefault(name.split('::')[-1], {})
+        elif line.startswith('  ') and function is not None:
+            opcode = line.split()[0]
+            function.setdefault(opcode, [0, 0])[stage] += 1
+
+    return counts
+
+# Compiler errors are printed in color and prefixed with the location they occurred at
+def error_message(stderr: str) -> str:
+    for line in re.sub(r'\x1b\[[0-9;]*m', '', stderr).splitlines():
+        _, separator, message = line.partition('error: ')
+        if separator:
+            return message
+
+    return ''
+
 class ExampleResult(TypedDict):
     returncode: int
     args: List[str]
@@ -46,8 +80,8 @@ class Example:
     def __init__(self, file: pathlib.Path) -> None:
         self.file = file
 
-    def compile(self) -> None:
-        returncode, stdout, stderr = run(EXECUTABLE, [self.file])
+    def compile(self, *args: str) -> str:
+        returncode, stdout, stderr = run(EXECUTABLE, [*args, self.file])
         if returncode != 0:
             print(stdout)
             print(stderr)
@@ -57,6 +91,68 @@ class Example:
 
             exit(returncode)        
 
+        return stdout
+
+    def has_bytecode_file(self) -> bool:
+        return self.file.with_suffix('.bytecode.json').exists()
+
+    def parse_bytecode_file(self) -> BytecodeCounts:
+        with open(self.file.with_suffix('.bytecode.json'), 'r') as f:
+            return json.load(f)
+
+    def check_bytecode(self) -> None:
+        expected = self.parse_bytecode_file()
+        actual = count_instructions(self.compile('--dump-bytecode'))
+
+        for function, opcodes in expected.items():
+            for opcode, counts in opcodes.items():
+                result = actual.get(function, {}).get(opcode, [0, 0])
+                if result != counts:
+                    print(f'Example {self.file} failed.')
+                    print(f'Expected {opcode} count in {function!r} (before, after passes):', counts)
+                    print(f'Actual {opcode} count in {function!r} (before, after passes):', result)
+
+                    exit(1)
+
+    def update_bytecode_file(self) -> None:
+        expected = self.parse_bytecode_file()
+        actual = count_instructions(self.compile('--dump-bytecode'))
+
+        for function, opcodes in expected.items():
+            for opcode in opcodes:
+                opcodes[opcode] = actual.get(function, {}).get(opcode, [0, 0])
+
+        with open(self.file.with_suffix('.bytecode.json'), 'w') as f:
+            json.dump(expected, f, indent=4)
+
+    def has_error_file(self) -> bool:
+        return self.file.with_suffix('.error.json').exists()
+
+    def parse_error_file(self) -> str:
+        with open(self.file.with_suffix('.error.json'), 'r') as f:
+            return json.load(f)['error']
+
+    def check_error(self) -> None:
+        expected = self.parse_error_file()
+        returncode, _, stderr = run(EXECUTABLE, [self.file])
+
+        if returncode == 0:
+            print(f'Example {self.file} compiled but was expected to fail.')
+            exit(1)
+
+        actual = error_message(stderr)
+        if actual != expected:
+            print(f'Example {self.file} failed.')
+            print('Expected error:', expected)
+            print('Actual error:', actual)
+
+            exit(1)
+
+    def update_error_file(self) -> None:
+        _, _, stderr = run(EXECUTABLE, [self.file])
+        with open(self.file.with_suffix('.error.json'), 'w') as f:
+            json.dump({'error': error_message(stderr)}, f, indent=4)
+
     def run(self) -> None:
         self.compile()
         
@@ -126,13 +222,31 @@ def main() -> None:
         example = Example(file)
         print(f'Running example {i} ({str(file)!r})')
 
+        # These examples are expected to fail to compile, there's nothing to run
+        if example.has_error_file():
+            if do_update:
+                example.update_error_file()
+                print('Updated error file.\n')
+            else:
+                example.check_error()
+                print()
+
+            i += 1
+            continue
+
         if not example.has_output_file() or do_update:
             example.update()
+            if example.has_bytecode_file():
+                example.update_bytecode_file()
+
             print('Updated output file.\n')
 
             i += 1
             continue
         
+        if example.has_bytecode_file():
+            example.check_bytecode()
+
         example.run()
         print()
         